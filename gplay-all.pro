@@ -13,5 +13,6 @@ SUBDIRS += \
     samples/racer/sample-racer.pro \
     samples/character/sample-character.pro \
     tools/encoder/gplay-encoder.pro \
+    tools/shaderpack/gplay-shaderpack.pro \
     #tools/luagen/gplay-luagen.pro \
 
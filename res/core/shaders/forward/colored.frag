@@ -63,6 +63,10 @@ uniform vec4 u_modulateColor;
 uniform vec4 u_modulateAlpha;
 #endif
 
+#if defined(LOD_FADE)
+uniform vec4 u_lodFade;
+#endif
+
 ///////////////////////////////////////////////////////////
 // Variables
 vec4 _baseColor;
@@ -106,6 +110,12 @@ void main()
     #if defined(CLIP_PLANE)
     if(v_clipDistance < 0.0) discard;
     #endif
+
+    #if defined(LOD_FADE)
+    // Dithered cross-fade between levels of detail, x is the fade amount and y the fade direction
+    float lodDither = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    if((lodDither - u_lodFade.x) * u_lodFade.y >= 0.0) discard;
+    #endif
  
     #if defined(LIGHTING)
 
@@ -29,7 +29,7 @@ public:
     static MyMouseEventRef create(Vector2 mousePos)
     {
         print("MyMouseEvent::create\n");
-        return MyMouseEventRef(new MyMouseEvent(mousePos));
+        return makeEventRef(new MyMouseEvent(mousePos));
     }
 
     ~MyMouseEvent()
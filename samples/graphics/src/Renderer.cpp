@@ -23,6 +23,8 @@ class NewRenderer : public Example
 
     SpriteBatch* _spriteBatch;
 
+    std::vector<Node*> _visibleNodes;
+
 public:
 
     NewRenderer()
@@ -148,6 +150,21 @@ public:
         nodeMonkey->setTranslation(-2, 0.5, 2);
         _scene->addNode(nodeMonkey);
 
+        // create a wall in front of the torus and the torus knot
+        Model* modelWall = Model::create(bundle->loadMesh("Cube_Mesh"));
+        modelWall->setMaterial(_matGBuffer->clone());
+        Node* nodeWall = Node::create("wall");
+        nodeWall->setDrawable(modelWall);
+        nodeWall->setScale(3.5f, 1.0f, 0.1f);
+        nodeWall->setTranslation(0, 1.0f, -1.0f);
+        _scene->addNode(nodeWall);
+
+        // use the wall as occluder, the nodes it hides are skipped by the geometry pass
+        OcclusionCuller* occlusionCuller = OcclusionCuller::create();
+        occlusionCuller->addOccluder(nodeWall, modelWall->getMesh()->getBoundingBox());
+        _scene->setOcclusionCuller(occlusionCuller);
+        SAFE_RELEASE(occlusionCuller);
+
         SAFE_RELEASE(bundle);
 
 #endif
@@ -456,6 +473,7 @@ public:
         static float pointLightColor[3] = { 1.0f, 1.0f, 1.0f };
         static bool showScissorRect = false;
         static bool useScissor = true;
+        static bool useOcclusionCulling = true;
 
         ImGui::Begin("Toolbox");
         ImGui::SliderInt("Dim", &dim, 1, 100);
@@ -465,6 +483,17 @@ public:
         ImGui::SliderFloat("radius", &pointlightRadius, -10.0f, 100.0f);
         ImGui::Checkbox("show scissor rect", &showScissorRect);
         ImGui::Checkbox("apply scissor", &useScissor);
+        ImGui::Checkbox("occlusion culling", &useOcclusionCulling);
+        OcclusionCuller* occlusionCuller = _scene->getOcclusionCuller();
+        if (occlusionCuller)
+            occlusionCuller->setEnabled(useOcclusionCulling);
+        ImGui::Text("visible nodes: %u", (unsigned int)_visibleNodes.size());
+        if (occlusionCuller && useOcclusionCulling)
+        {
+            const OcclusionCuller::Stats& stats = occlusionCuller->getStats();
+            ImGui::Text("occluders: %u (%u triangles)", stats.occluders, stats.triangles);
+            ImGui::Text("occluded nodes: %u / %u tested", stats.culled, stats.tested);
+        }
         ImGui::End();
 
 
@@ -473,7 +502,12 @@ public:
 
         View::getView(0)->bind();
         _gBuffer->bind();
-        _scene->visit(this, &NewRenderer::drawScene);
+
+        // only draw the nodes left by frustum and occlusion culling
+        _visibleNodes.clear();
+        _scene->findVisibleNodes(_scene->getActiveCamera(), _visibleNodes);
+        for (size_t i = 0, count = _visibleNodes.size(); i < count; ++i)
+            drawScene(_visibleNodes[i]);
 
 
         // 2. Lighting pass ---------
@@ -27,6 +27,7 @@ class Animation : public Ref
     friend class AnimationClip;
     friend class AnimationTarget;
     friend class Bundle;
+    friend class AnimationBlendTree;
 
 public:
 
@@ -125,6 +126,7 @@ private:
         friend class AnimationClip;
         friend class Animation;
         friend class AnimationTarget;
+        friend class AnimationBlendTree;
 
     private:
 
@@ -0,0 +1,471 @@
+#include "../core/Base.h"
+#include "../animation/AnimationBlendTree.h"
+#include "../animation/AnimationClip.h"
+#include "../animation/AnimationController.h"
+#include "../core/Game.h"
+#include "../graphics/Node.h"
+
+namespace gplay
+{
+
+/**
+ * Reads the value of a transform animation property into a local transform.
+ * The layout of the values matches Transform::setAnimationPropertyValue().
+ */
+static void readTransformValue(int propertyId, const float* value, Vector3* scale, Quaternion* rotation, Vector3* translation)
+{
+    switch (propertyId)
+    {
+    case Transform::ANIMATE_SCALE_UNIT:
+        scale->set(value[0], value[0], value[0]);
+        break;
+    case Transform::ANIMATE_SCALE:
+        scale->set(value[0], value[1], value[2]);
+        break;
+    case Transform::ANIMATE_SCALE_X:
+        scale->x = value[0];
+        break;
+    case Transform::ANIMATE_SCALE_Y:
+        scale->y = value[0];
+        break;
+    case Transform::ANIMATE_SCALE_Z:
+        scale->z = value[0];
+        break;
+    case Transform::ANIMATE_ROTATE:
+        rotation->set(value[0], value[1], value[2], value[3]);
+        break;
+    case Transform::ANIMATE_TRANSLATE:
+        translation->set(value[0], value[1], value[2]);
+        break;
+    case Transform::ANIMATE_TRANSLATE_X:
+        translation->x = value[0];
+        break;
+    case Transform::ANIMATE_TRANSLATE_Y:
+        translation->y = value[0];
+        break;
+    case Transform::ANIMATE_TRANSLATE_Z:
+        translation->z = value[0];
+        break;
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        rotation->set(value[0], value[1], value[2], value[3]);
+        translation->set(value[4], value[5], value[6]);
+        break;
+    case Transform::ANIMATE_SCALE_ROTATE:
+        scale->set(value[0], value[1], value[2]);
+        rotation->set(value[3], value[4], value[5], value[6]);
+        break;
+    case Transform::ANIMATE_SCALE_TRANSLATE:
+        scale->set(value[0], value[1], value[2]);
+        translation->set(value[3], value[4], value[5]);
+        break;
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        scale->set(value[0], value[1], value[2]);
+        rotation->set(value[3], value[4], value[5], value[6]);
+        translation->set(value[7], value[8], value[9]);
+        break;
+    default:
+        break;
+    }
+}
+
+static inline void lerpVector3(const Vector3& from, const Vector3& to, float t, Vector3* dst)
+{
+    dst->set(from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t, from.z + (to.z - from.z) * t);
+}
+
+AnimationBlendTree::BlendNode::BlendNode()
+    : type(BLEND_CLIP), weight(1.0f), clip(NULL), time(0.0f)
+{
+    inputs[0] = inputs[1] = 0;
+}
+
+AnimationBlendTree::AnimationBlendTree(Node* root)
+    : _root(root), _output(-1), _animatedTargetsDirty(true), _playing(false)
+{
+    GP_ASSERT(root);
+    _root->addRef();
+    addTarget(root);
+}
+
+AnimationBlendTree::~AnimationBlendTree()
+{
+    stop();
+
+    for (size_t i = 0, count = _blendNodes.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_blendNodes[i]->clip);
+        SAFE_DELETE(_blendNodes[i]);
+    }
+    _blendNodes.clear();
+
+    for (size_t i = 0, count = _targets.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_targets[i]);
+    }
+    _targets.clear();
+    SAFE_RELEASE(_root);
+}
+
+AnimationBlendTree* AnimationBlendTree::create(Node* root)
+{
+    GP_ASSERT(root);
+    return new AnimationBlendTree(root);
+}
+
+void AnimationBlendTree::addTarget(Node* node)
+{
+    node->addRef();
+    _targets.push_back(node);
+    _restPose.scales.push_back(node->getScale());
+    _restPose.rotations.push_back(node->getRotation());
+    _restPose.translations.push_back(node->getTranslation());
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        addTarget(child);
+    }
+}
+
+unsigned int AnimationBlendTree::addBlendNode(BlendType type, unsigned int input0, unsigned int input1, float weight)
+{
+    GP_ASSERT(type == BLEND_CLIP || (input0 < _blendNodes.size() && input1 < _blendNodes.size()));
+
+    BlendNode* node = new BlendNode();
+    node->type = type;
+    node->inputs[0] = input0;
+    node->inputs[1] = input1;
+    node->weight = weight;
+    copyPose(_restPose, node->pose);
+    _blendNodes.push_back(node);
+
+    _output = (int)_blendNodes.size() - 1;
+    _animatedTargetsDirty = true;
+    return (unsigned int)_output;
+}
+
+unsigned int AnimationBlendTree::addClip(AnimationClip* clip)
+{
+    GP_ASSERT(clip);
+
+    unsigned int index = addBlendNode(BLEND_CLIP, 0, 0, 1.0f);
+    BlendNode* node = _blendNodes[index];
+    node->clip = clip;
+    clip->addRef();
+
+    // Map the channels of the clip to our targets once.
+    const std::vector<Animation::Channel*>& channels = clip->_animation->_channels;
+    node->channelTargets.resize(channels.size(), -1);
+    node->cursors.resize(channels.size());
+    for (size_t i = 0, count = channels.size(); i < count; ++i)
+    {
+        AnimationTarget* target = channels[i]->_target;
+        for (size_t j = 0, targetCount = _targets.size(); j < targetCount; ++j)
+        {
+            if (static_cast<AnimationTarget*>(_targets[j]) == target)
+            {
+                node->channelTargets[i] = (int)j;
+                break;
+            }
+        }
+    }
+    return index;
+}
+
+unsigned int AnimationBlendTree::addLerp(unsigned int from, unsigned int to, float weight)
+{
+    return addBlendNode(BLEND_LERP, from, to, weight);
+}
+
+unsigned int AnimationBlendTree::addAdditive(unsigned int base, unsigned int additive, float weight)
+{
+    return addBlendNode(BLEND_ADDITIVE, base, additive, weight);
+}
+
+unsigned int AnimationBlendTree::addLayer(unsigned int base, unsigned int layer, float weight, Node* mask)
+{
+    GP_ASSERT(mask);
+
+    unsigned int index = addBlendNode(BLEND_LAYER, base, layer, weight);
+    BlendNode* node = _blendNodes[index];
+    node->mask.resize(_targets.size(), 0.0f);
+    for (size_t i = 0, count = _targets.size(); i < count; ++i)
+    {
+        // The target is masked in if the mask node is the target or one of its ancestors.
+        for (Node* n = _targets[i]; n != NULL; n = n->getParent())
+        {
+            if (n == mask)
+            {
+                node->mask[i] = 1.0f;
+                break;
+            }
+        }
+    }
+    return index;
+}
+
+unsigned int AnimationBlendTree::getBlendNodeCount() const
+{
+    return (unsigned int)_blendNodes.size();
+}
+
+void AnimationBlendTree::setWeight(unsigned int index, float weight)
+{
+    GP_ASSERT(index < _blendNodes.size());
+    GP_ASSERT(weight >= 0.0f && weight <= 1.0f);
+    _blendNodes[index]->weight = weight;
+}
+
+float AnimationBlendTree::getWeight(unsigned int index) const
+{
+    GP_ASSERT(index < _blendNodes.size());
+    return _blendNodes[index]->weight;
+}
+
+void AnimationBlendTree::setOutput(unsigned int index)
+{
+    GP_ASSERT(index < _blendNodes.size());
+    _output = (int)index;
+    _animatedTargetsDirty = true;
+}
+
+int AnimationBlendTree::getOutput() const
+{
+    return _output;
+}
+
+void AnimationBlendTree::play()
+{
+    if (_playing)
+        return;
+
+    _playing = true;
+    Game::getInstance()->getAnimationController()->schedule(this);
+}
+
+void AnimationBlendTree::stop()
+{
+    if (!_playing)
+        return;
+
+    _playing = false;
+    Game::getInstance()->getAnimationController()->unschedule(this);
+}
+
+bool AnimationBlendTree::isPlaying() const
+{
+    return _playing;
+}
+
+void AnimationBlendTree::updateAnimatedTargets()
+{
+    _animatedTargetsDirty = false;
+    _animatedTargets.clear();
+    if (_output < 0)
+        return;
+
+    std::vector<bool> animated(_targets.size(), false);
+    markAnimatedTargets((unsigned int)_output, animated);
+    for (size_t i = 0, count = animated.size(); i < count; ++i)
+    {
+        if (animated[i])
+            _animatedTargets.push_back((unsigned int)i);
+    }
+}
+
+void AnimationBlendTree::markAnimatedTargets(unsigned int index, std::vector<bool>& animated) const
+{
+    const BlendNode* node = _blendNodes[index];
+    if (node->type == BLEND_CLIP)
+    {
+        for (size_t i = 0, count = node->channelTargets.size(); i < count; ++i)
+        {
+            if (node->channelTargets[i] >= 0)
+                animated[node->channelTargets[i]] = true;
+        }
+    }
+    else
+    {
+        markAnimatedTargets(node->inputs[0], animated);
+        markAnimatedTargets(node->inputs[1], animated);
+    }
+}
+
+void AnimationBlendTree::evaluate(float elapsedTime)
+{
+    if (_animatedTargetsDirty)
+    {
+        updateAnimatedTargets();
+    }
+    if (_output < 0)
+        return;
+
+    // Advance all the clips, including the ones of blend nodes currently skipped
+    // because of their weight, so they stay in sync.
+    for (size_t i = 0, count = _blendNodes.size(); i < count; ++i)
+    {
+        BlendNode* node = _blendNodes[i];
+        if (node->type == BLEND_CLIP)
+        {
+            node->time += elapsedTime * node->clip->getSpeed();
+        }
+    }
+
+    evaluate((unsigned int)_output);
+}
+
+void AnimationBlendTree::evaluate(unsigned int index)
+{
+    BlendNode* node = _blendNodes[index];
+    switch (node->type)
+    {
+    case BLEND_CLIP:
+        sampleClip(*node);
+        break;
+
+    case BLEND_LERP:
+    {
+        // Only evaluate the inputs that contribute.
+        if (node->weight <= 0.0f || node->weight >= 1.0f)
+        {
+            unsigned int input = node->inputs[node->weight <= 0.0f ? 0 : 1];
+            evaluate(input);
+            copyPose(_blendNodes[input]->pose, node->pose);
+            break;
+        }
+        evaluate(node->inputs[0]);
+        evaluate(node->inputs[1]);
+        const Pose& from = _blendNodes[node->inputs[0]]->pose;
+        const Pose& to = _blendNodes[node->inputs[1]]->pose;
+        const float t = node->weight;
+        for (size_t i = 0, count = _animatedTargets.size(); i < count; ++i)
+        {
+            unsigned int j = _animatedTargets[i];
+            lerpVector3(from.scales[j], to.scales[j], t, &node->pose.scales[j]);
+            Quaternion::slerp(from.rotations[j], to.rotations[j], t, &node->pose.rotations[j]);
+            lerpVector3(from.translations[j], to.translations[j], t, &node->pose.translations[j]);
+        }
+        break;
+    }
+
+    case BLEND_ADDITIVE:
+    {
+        evaluate(node->inputs[0]);
+        copyPose(_blendNodes[node->inputs[0]]->pose, node->pose);
+        if (node->weight <= 0.0f)
+            break;
+
+        evaluate(node->inputs[1]);
+        const Pose& additive = _blendNodes[node->inputs[1]]->pose;
+        const float t = node->weight;
+        for (size_t i = 0, count = _animatedTargets.size(); i < count; ++i)
+        {
+            unsigned int j = _animatedTargets[i];
+
+            // Difference between the additive pose and the rest pose.
+            Vector3 scale(additive.scales[j] - _restPose.scales[j]);
+            Vector3 translation(additive.translations[j] - _restPose.translations[j]);
+            Quaternion rotation;
+            _restPose.rotations[j].inverse(&rotation);
+            rotation.multiply(additive.rotations[j]);
+            Quaternion::slerp(Quaternion::identity(), rotation, t, &rotation);
+
+            node->pose.scales[j] += scale * t;
+            node->pose.rotations[j].multiply(rotation);
+            node->pose.translations[j] += translation * t;
+        }
+        break;
+    }
+
+    case BLEND_LAYER:
+    {
+        evaluate(node->inputs[0]);
+        copyPose(_blendNodes[node->inputs[0]]->pose, node->pose);
+        if (node->weight <= 0.0f)
+            break;
+
+        evaluate(node->inputs[1]);
+        const Pose& layer = _blendNodes[node->inputs[1]]->pose;
+        for (size_t i = 0, count = _animatedTargets.size(); i < count; ++i)
+        {
+            unsigned int j = _animatedTargets[i];
+            const float t = node->weight * node->mask[j];
+            if (t <= 0.0f)
+                continue;
+
+            lerpVector3(node->pose.scales[j], layer.scales[j], t, &node->pose.scales[j]);
+            Quaternion::slerp(node->pose.rotations[j], layer.rotations[j], t, &node->pose.rotations[j]);
+            lerpVector3(node->pose.translations[j], layer.translations[j], t, &node->pose.translations[j]);
+        }
+        break;
+    }
+    }
+}
+
+void AnimationBlendTree::sampleClip(BlendNode& node)
+{
+    AnimationClip* clip = node.clip;
+    Animation* animation = clip->_animation;
+    GP_ASSERT(animation && animation->_duration > 0);
+
+    // Position within the clip, looping or clamped according to its repeat count.
+    const float duration = (float)clip->getDuration();
+    float percentComplete = 1.0f;
+    if (duration > 0.0f)
+    {
+        float time = node.time;
+        const float repeatCount = clip->getRepeatCount();
+        if (repeatCount != AnimationClip::REPEAT_INDEFINITE)
+        {
+            time = std::max(0.0f, std::min(time, duration * repeatCount));
+        }
+        if (repeatCount == AnimationClip::REPEAT_INDEFINITE || time < duration * repeatCount)
+        {
+            time = fmodf(time, duration);
+            if (time < 0.0f)
+                time += duration;
+            percentComplete = time / duration;
+        }
+    }
+
+    const float percentageStart = (float)clip->_startTime / (float)animation->_duration;
+    const float percentageEnd = (float)clip->_endTime / (float)animation->_duration;
+
+    // Start from the rest pose so targets not animated by this clip blend correctly.
+    copyPose(_restPose, node.pose);
+
+    float value[10];
+    for (size_t i = 0, count = node.channelTargets.size(); i < count; ++i)
+    {
+        int target = node.channelTargets[i];
+        if (target < 0)
+            continue;
+
+        Animation::Channel* channel = animation->_channels[i];
+        Curve* curve = channel->getCurve();
+        GP_ASSERT(curve->getComponentCount() <= 10);
+        curve->evaluate(percentComplete, percentageStart, percentageEnd, 0.0f, value, &node.cursors[i]);
+        readTransformValue(channel->_propertyId, value, &node.pose.scales[target], &node.pose.rotations[target], &node.pose.translations[target]);
+    }
+}
+
+void AnimationBlendTree::copyPose(const Pose& src, Pose& dst) const
+{
+    dst.scales = src.scales;
+    dst.rotations = src.rotations;
+    dst.translations = src.translations;
+}
+
+void AnimationBlendTree::apply()
+{
+    if (_output < 0)
+        return;
+
+    const Pose& pose = _blendNodes[_output]->pose;
+    for (size_t i = 0, count = _animatedTargets.size(); i < count; ++i)
+    {
+        unsigned int j = _animatedTargets[i];
+        _targets[j]->set(pose.scales[j], pose.rotations[j], pose.translations[j]);
+    }
+}
+
+}
@@ -0,0 +1,254 @@
+#ifndef ANIMATIONBLENDTREE_H_
+#define ANIMATIONBLENDTREE_H_
+
+#include "../core/Ref.h"
+#include "../math/Curve.h"
+#include "../math/Vector3.h"
+#include "../math/Quaternion.h"
+
+namespace gplay
+{
+
+class AnimationClip;
+class AnimationTarget;
+class Node;
+
+/**
+ * Defines a tree of blend nodes that combines animation clips into a single pose.
+ *
+ * A blend tree animates the local transforms (scale, rotation and translation) of a
+ * node hierarchy, such as the joints of a skinned model. Clip nodes sample the curves
+ * of an AnimationClip into a pose buffer, and lerp, additive and layer nodes combine the
+ * poses of their inputs. Once per update, the pose of the root blend node is written
+ * to the animated nodes with a single transform change per node, instead of each
+ * playing clip blending its values into the nodes.
+ *
+ * Nodes of the hierarchy that are not animated by a clip keep their rest pose, the
+ * local transform they had when the blend tree was created. Clips used by a blend
+ * tree are sampled by the tree, with their own speed and repeat count, and should
+ * not be played on their own at the same time.
+ *
+ * Blend nodes are identified by the index returned when they are added. The inputs
+ * of a blend node must be added before it.
+ */
+class AnimationBlendTree : public Ref
+{
+    friend class AnimationController;
+
+public:
+
+    /**
+     * Creates a blend tree animating the given node and all its descendants.
+     *
+     * @param root The root of the node hierarchy to animate.
+     *
+     * @return The new blend tree.
+     * @script{create}
+     */
+    static AnimationBlendTree* create(Node* root);
+
+    /**
+     * Adds a blend node that samples an animation clip.
+     *
+     * @param clip The clip to sample.
+     *
+     * @return The index of the new blend node.
+     */
+    unsigned int addClip(AnimationClip* clip);
+
+    /**
+     * Adds a blend node that interpolates between the poses of two blend nodes.
+     *
+     * @param from The index of the blend node used for a weight of 0.
+     * @param to The index of the blend node used for a weight of 1.
+     * @param weight The blend weight, between 0 and 1.
+     *
+     * @return The index of the new blend node.
+     */
+    unsigned int addLerp(unsigned int from, unsigned int to, float weight);
+
+    /**
+     * Adds a blend node that adds the difference between the pose of a blend node
+     * and the rest pose on top of the pose of another blend node.
+     *
+     * @param base The index of the base blend node.
+     * @param additive The index of the additive blend node.
+     * @param weight The weight of the additive pose, between 0 and 1.
+     *
+     * @return The index of the new blend node.
+     */
+    unsigned int addAdditive(unsigned int base, unsigned int additive, float weight);
+
+    /**
+     * Adds a blend node that overrides the pose of a blend node with the pose of
+     * another one, for the nodes of a sub hierarchy only (e.g. the upper body).
+     *
+     * @param base The index of the base blend node.
+     * @param layer The index of the layered blend node.
+     * @param weight The weight of the layered pose, between 0 and 1.
+     * @param mask The root of the sub hierarchy the layer applies to.
+     *
+     * @return The index of the new blend node.
+     */
+    unsigned int addLayer(unsigned int base, unsigned int layer, float weight, Node* mask);
+
+    /**
+     * Returns the number of blend nodes.
+     *
+     * @return The number of blend nodes.
+     */
+    unsigned int getBlendNodeCount() const;
+
+    /**
+     * Sets the weight of a lerp, additive or layer blend node.
+     *
+     * @param index The index of the blend node.
+     * @param weight The blend weight, between 0 and 1.
+     */
+    void setWeight(unsigned int index, float weight);
+
+    /**
+     * Returns the weight of a blend node.
+     *
+     * @param index The index of the blend node.
+     *
+     * @return The blend weight.
+     */
+    float getWeight(unsigned int index) const;
+
+    /**
+     * Sets the blend node which pose is written to the animated nodes.
+     *
+     * The last added blend node is used by default.
+     *
+     * @param index The index of the blend node.
+     */
+    void setOutput(unsigned int index);
+
+    /**
+     * Returns the blend node which pose is written to the animated nodes.
+     *
+     * @return The index of the output blend node, or -1 if the tree has no blend node.
+     */
+    int getOutput() const;
+
+    /**
+     * Starts updating the blend tree with the animation controller.
+     */
+    void play();
+
+    /**
+     * Stops updating the blend tree.
+     */
+    void stop();
+
+    /**
+     * Determines if the blend tree is playing.
+     *
+     * @return true if the blend tree is playing, false otherwise.
+     */
+    bool isPlaying() const;
+
+private:
+
+    /**
+     * Types of blend nodes.
+     */
+    enum BlendType
+    {
+        BLEND_CLIP,
+        BLEND_LERP,
+        BLEND_ADDITIVE,
+        BLEND_LAYER
+    };
+
+    /**
+     * Local transforms of all the animated nodes.
+     */
+    struct Pose
+    {
+        std::vector<Vector3> scales;
+        std::vector<Quaternion> rotations;
+        std::vector<Vector3> translations;
+    };
+
+    /**
+     * A node of the blend tree.
+     */
+    struct BlendNode
+    {
+        BlendNode();
+
+        BlendType type;
+        float weight;
+        unsigned int inputs[2];
+        AnimationClip* clip;
+        float time;                             // Elapsed time of the clip (in milliseconds).
+        std::vector<int> channelTargets;        // Index of the target of each channel of the clip, -1 if not animated.
+        std::vector<Curve::Cursor> cursors;     // Curve lookups of each channel of the clip.
+        std::vector<float> mask;                // Per target layer weight.
+        Pose pose;
+    };
+
+    /**
+     * Constructor.
+     */
+    AnimationBlendTree(Node* root);
+
+    /**
+     * Destructor. Hidden use release() instead.
+     */
+    ~AnimationBlendTree();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AnimationBlendTree(const AnimationBlendTree& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AnimationBlendTree& operator=(const AnimationBlendTree&);
+
+    void addTarget(Node* node);
+
+    unsigned int addBlendNode(BlendType type, unsigned int input0, unsigned int input1, float weight);
+
+    /**
+     * Collects the targets animated by the clips reachable from the output blend node.
+     */
+    void updateAnimatedTargets();
+
+    void markAnimatedTargets(unsigned int index, std::vector<bool>& animated) const;
+
+    /**
+     * Advances the clips and computes the pose of the output blend node.
+     *
+     * Called from the animation controller, can run on any thread.
+     */
+    void evaluate(float elapsedTime);
+
+    /**
+     * Writes the output pose to the animated nodes.
+     */
+    void apply();
+
+    void evaluate(unsigned int index);
+
+    void sampleClip(BlendNode& node);
+
+    void copyPose(const Pose& src, Pose& dst) const;
+
+    Node* _root;
+    std::vector<Node*> _targets;
+    std::vector<unsigned int> _animatedTargets;
+    Pose _restPose;
+    std::vector<BlendNode*> _blendNodes;
+    int _output;
+    bool _animatedTargetsDirty;
+    bool _playing;
+};
+
+}
+
+#endif
@@ -19,6 +19,7 @@ class AnimationClip : public Ref, public ScriptTarget
 {
     friend class AnimationController;
     friend class Animation;
+    friend class AnimationBlendTree;
 
     GP_SCRIPT_EVENTS_START();
     GP_SCRIPT_EVENT(clipBegin, "<AnimationClip>");
@@ -296,6 +297,16 @@ private:
     static const unsigned char CLIP_IS_PAUSED_BIT = 0x80;              // Bit representing if the clip is currently paused.
     static const unsigned char CLIP_ALL_BITS = 0xFF;                   // Bit mask for all the state bits.
 
+    /**
+     * Result of advancing the clip time.
+     */
+    enum UpdateResult
+    {
+        CLIP_UPDATE_SKIPPED,    // The clip is paused, nothing to evaluate.
+        CLIP_UPDATE_ENDED,      // The clip has ended and should be removed from the running clips.
+        CLIP_UPDATE_EVALUATE    // The clip must be evaluated and applied.
+    };
+
     /**
      * ListenerEvent.
      *
@@ -352,6 +363,28 @@ private:
      */
     bool update(float elapsedTime);
 
+    /**
+     * Advances the clip time, fires listener events and updates cross fade weights.
+     *
+     * Must be called on the main thread.
+     */
+    UpdateResult advance(float elapsedTime);
+
+    /**
+     * Evaluates the animation curves into the clip's animation values.
+     *
+     * Only reads the shared curves and writes to the clip's own values,
+     * so different clips can be evaluated concurrently.
+     */
+    void evaluate();
+
+    /**
+     * Applies the evaluated values to the animation targets.
+     *
+     * @return true if the clip has ended and should be removed from the running clips.
+     */
+    bool apply();
+
     /**
      * Handles when the AnimationClip begins.
      */
@@ -402,7 +435,9 @@ private:
     float _crossFadeOutElapsed;                         // The amount of time that has elapsed for the crossfade.
     unsigned long _crossFadeOutDuration;                // The duration of the cross fade.
     float _blendWeight;                                 // The clip's blendweight.
+    float _percentComplete;                             // The position within the clip evaluated by the last update.
     std::vector<AnimationValue*> _values;               // AnimationValue holder.
+    std::vector<Curve::Cursor> _cursors;                // Cached curve lookups of each channel, for forward playback.
     std::vector<Listener*>* _beginListeners;            // Collection of begin listeners on the clip.
     std::vector<Listener*>* _endListeners;              // Collection of end listeners on the clip.
     std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
@@ -46,12 +46,19 @@ void AnimationController::finalize()
         SAFE_RELEASE(clip);
     }
     _runningClips.clear();
+
+    for (size_t i = 0, count = _blendTrees.size(); i < count; ++i)
+    {
+        _blendTrees[i]->_playing = false;
+        SAFE_RELEASE(_blendTrees[i]);
+    }
+    _blendTrees.clear();
     _state = STOPPED;
 }
 
 void AnimationController::resume()
 {
-    if (_runningClips.empty())
+    if (_runningClips.empty() && _blendTrees.empty())
         _state = IDLE;
     else
         _state = RUNNING;
@@ -64,7 +71,7 @@ void AnimationController::pause()
 
 void AnimationController::schedule(AnimationClip* clip)
 {
-    if (_runningClips.empty())
+    if (_runningClips.empty() && _blendTrees.empty())
     {
         _state = RUNNING;
     }
@@ -89,7 +96,32 @@ void AnimationController::unschedule(AnimationClip* clip)
         clipItr++;
     }
 
-    if (_runningClips.empty())
+    if (_runningClips.empty() && _blendTrees.empty())
+        _state = IDLE;
+}
+
+void AnimationController::schedule(AnimationBlendTree* blendTree)
+{
+    if (_runningClips.empty() && _blendTrees.empty())
+    {
+        _state = RUNNING;
+    }
+
+    GP_ASSERT(blendTree);
+    blendTree->addRef();
+    _blendTrees.push_back(blendTree);
+}
+
+void AnimationController::unschedule(AnimationBlendTree* blendTree)
+{
+    std::vector<AnimationBlendTree*>::iterator itr = std::find(_blendTrees.begin(), _blendTrees.end(), blendTree);
+    if (itr != _blendTrees.end())
+    {
+        _blendTrees.erase(itr);
+        SAFE_RELEASE(blendTree);
+    }
+
+    if (_runningClips.empty() && _blendTrees.empty())
         _state = IDLE;
 }
 
@@ -100,7 +132,8 @@ void AnimationController::update(float elapsedTime)
     
     Transform::suspendTransformChanged();
 
-    // Loop through running clips and call update() on them.
+    // Advance the running clips and fire their events.
+    _evaluatedClips.clear();
     std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
     while (clipIter != _runningClips.end())
     {
@@ -114,22 +147,70 @@ void AnimationController::update(float elapsedTime)
             clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
             _runningClips.push_back(clip);
             clipIter = _runningClips.erase(clipIter);
+            clip->release();
+            continue;
         }
-        else if (clip->update(elapsedTime))
+
+        switch (clip->advance(elapsedTime))
         {
+        case AnimationClip::CLIP_UPDATE_ENDED:
             clip->release();
             clipIter = _runningClips.erase(clipIter);
+            clip->release();
+            break;
+        case AnimationClip::CLIP_UPDATE_EVALUATE:
+            // Keep our reference until the clip is applied.
+            _evaluatedClips.push_back(clip);
+            clipIter++;
+            break;
+        default:
+            clip->release();
+            clipIter++;
+            break;
         }
-        else
+    }
+
+    // Evaluate the curves of the clips in parallel, each clip only writes to its own values.
+    AnimationClip** clips = _evaluatedClips.empty() ? NULL : &_evaluatedClips[0];
+    Game::getInstance()->getJobScheduler()->parallelFor((unsigned int)_evaluatedClips.size(), 4, [clips](unsigned int start, unsigned int end)
+    {
+        for (unsigned int i = start; i < end; ++i)
         {
-            clipIter++;
+            clips[i]->evaluate();
+        }
+    });
+
+    // Apply the values to the targets in the running order, blending is not thread safe.
+    for (size_t i = 0, count = _evaluatedClips.size(); i < count; ++i)
+    {
+        AnimationClip* clip = _evaluatedClips[i];
+        if (clip->apply())
+        {
+            _runningClips.remove(clip);
+            clip->release();
         }
         clip->release();
     }
+    _evaluatedClips.clear();
+
+    // Sample and blend the poses of the blend trees in parallel, then write
+    // each output pose to the nodes, once per node.
+    AnimationBlendTree** trees = _blendTrees.empty() ? NULL : &_blendTrees[0];
+    Game::getInstance()->getJobScheduler()->parallelFor((unsigned int)_blendTrees.size(), 1, [trees, elapsedTime](unsigned int start, unsigned int end)
+    {
+        for (unsigned int i = start; i < end; ++i)
+        {
+            trees[i]->evaluate(elapsedTime);
+        }
+    });
+    for (size_t i = 0, count = _blendTrees.size(); i < count; ++i)
+    {
+        _blendTrees[i]->apply();
+    }
 
     Transform::resumeTransformChanged();
 
-    if (_runningClips.empty())
+    if (_runningClips.empty() && _blendTrees.empty())
         _state = IDLE;
 }
 
@@ -4,6 +4,7 @@
 #include "../animation/AnimationClip.h"
 #include "../animation/Animation.h"
 #include "../animation/AnimationTarget.h"
+#include "../animation/AnimationBlendTree.h"
 #include "../core/Properties.h"
 
 namespace gplay
@@ -17,6 +18,7 @@ class AnimationController
     friend class Game;
     friend class Animation;
     friend class AnimationClip;
+    friend class AnimationBlendTree;
     friend class SceneLoader;
 
 public:
@@ -90,6 +92,16 @@ private:
      * Unschedules an AnimationClip.
      */
     void unschedule(AnimationClip* clip);
+
+    /**
+     * Schedules an AnimationBlendTree to run.
+     */
+    void schedule(AnimationBlendTree* blendTree);
+
+    /**
+     * Unschedules an AnimationBlendTree.
+     */
+    void unschedule(AnimationBlendTree* blendTree);
     
     /**
      * Callback for when the controller receives a frame update event.
@@ -98,6 +110,8 @@ private:
     
     State _state;                                 // The current state of the AnimationController.
     std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    std::vector<AnimationClip*> _evaluatedClips;  // Clips evaluated by the current update.
+    std::vector<AnimationBlendTree*> _blendTrees; // The playing blend trees.
 };
 
 }
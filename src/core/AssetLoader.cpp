@@ -0,0 +1,389 @@
+#include "../core/Base.h"
+#include "../core/AssetLoader.h"
+#include "../core/Bundle.h"
+#include "../core/FileSystem.h"
+#include "../core/Properties.h"
+#include "../graphics/Material.h"
+#include "../graphics/SceneLoader.h"
+#include "../graphics/Texture.h"
+#include "../renderer/BGFXTexture.h"
+
+// Number of loader threads.
+#define ASSET_LOADER_THREAD_COUNT 2
+
+// Stride used to touch the pages of a memory mapped file.
+#define ASSET_LOADER_PAGE_SIZE 4096
+
+namespace gplay
+{
+
+/**
+ * Reads all the pages of a memory mapped stream, so that the file is read on the
+ * loader thread instead of on first access from the main thread.
+ */
+static void prefetch(Stream* stream)
+{
+    GP_ASSERT(stream);
+    const unsigned char* data = (const unsigned char*)stream->getData();
+    if (data)
+    {
+        volatile unsigned char touch = 0;
+        for (size_t i = 0, length = stream->length(); i < length; i += ASSET_LOADER_PAGE_SIZE)
+        {
+            touch = data[i];
+        }
+        (void)touch;
+    }
+}
+
+/**
+ * Returns the first namespace of a properties file when the URL has no namespace.
+ */
+static Properties* getRootNamespace(Properties* properties)
+{
+    GP_ASSERT(properties);
+    return (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+}
+
+AssetLoader::Request::Request(AssetType type, const char* url, const Callback& callback)
+    : _type(type), _url(url), _callback(callback), _state(PENDING), _asset(NULL), _generateMipmaps(false),
+      _cancelled(false), _stream(NULL), _image(NULL), _properties(NULL)
+{
+}
+
+AssetLoader::Request::~Request()
+{
+    GP_ASSERT(!_stream && !_image && !_properties);
+    SAFE_RELEASE(_asset);
+}
+
+AssetLoader::AssetType AssetLoader::Request::getType() const
+{
+    return _type;
+}
+
+const char* AssetLoader::Request::getUrl() const
+{
+    return _url.c_str();
+}
+
+AssetLoader::State AssetLoader::Request::getState() const
+{
+    return _state;
+}
+
+bool AssetLoader::Request::isDone() const
+{
+    return _state != PENDING;
+}
+
+Ref* AssetLoader::Request::getAsset() const
+{
+    return _asset;
+}
+
+void AssetLoader::Request::cancel()
+{
+    if (_state == PENDING)
+    {
+        _cancelled = true;
+    }
+}
+
+AssetLoader::AssetLoader()
+    : _pendingCount(0), _running(false)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    finalize();
+}
+
+void AssetLoader::initialize()
+{
+    _running = true;
+#if !defined(EMSCRIPTEN)
+    for (unsigned int i = 0; i < ASSET_LOADER_THREAD_COUNT; ++i)
+    {
+        _threads.push_back(new std::thread(&loaderThreadProc, this));
+    }
+#endif
+}
+
+void AssetLoader::finalize()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _wakeCondition.notify_all();
+
+    for (size_t i = 0, count = _threads.size(); i < count; ++i)
+    {
+        _threads[i]->join();
+        SAFE_DELETE(_threads[i]);
+    }
+    _threads.clear();
+
+    // Drop the requests that did not complete, without calling their callbacks.
+    _queue.insert(_queue.end(), _processed.begin(), _processed.end());
+    _processed.clear();
+    for (size_t i = 0, count = _queue.size(); i < count; ++i)
+    {
+        Request* request = _queue[i];
+        clear(request);
+        request->_state = CANCELLED;
+        SAFE_RELEASE(request);
+    }
+    _queue.clear();
+    _pendingCount = 0;
+}
+
+AssetLoader::Request* AssetLoader::loadBundle(const char* path, const Callback& callback)
+{
+    GP_ASSERT(path);
+    Request* request = new Request(BUNDLE, path, callback);
+
+    // Bundles already loaded complete on the next update.
+    request->_asset = Bundle::getCached(path);
+    return queue(request);
+}
+
+AssetLoader::Request* AssetLoader::loadTexture(const char* path, bool generateMipmaps, const Callback& callback)
+{
+    GP_ASSERT(path);
+    Request* request = new Request(TEXTURE, path, callback);
+    request->_generateMipmaps = generateMipmaps;
+
+    // Textures already loaded complete on the next update.
+    request->_asset = Texture::getCached(path, generateMipmaps);
+    return queue(request);
+}
+
+AssetLoader::Request* AssetLoader::loadMaterial(const char* url, const Callback& callback)
+{
+    GP_ASSERT(url);
+    return queue(new Request(MATERIAL, url, callback));
+}
+
+AssetLoader::Request* AssetLoader::loadScene(const char* url, const Callback& callback)
+{
+    GP_ASSERT(url);
+    return queue(new Request(SCENE, url, callback));
+}
+
+unsigned int AssetLoader::getPendingRequestCount() const
+{
+    return _pendingCount;
+}
+
+AssetLoader::Request* AssetLoader::queue(Request* request)
+{
+    GP_ASSERT(request);
+
+    // The loader keeps a reference until the request completes.
+    request->addRef();
+    ++_pendingCount;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (request->_asset)
+            _processed.push_back(request);
+        else
+            _queue.push_back(request);
+    }
+    _wakeCondition.notify_one();
+    return request;
+}
+
+void AssetLoader::process(Request* request)
+{
+    GP_ASSERT(request);
+    if (request->_cancelled)
+        return;
+
+    const char* url = request->_url.c_str();
+    switch (request->_type)
+    {
+    case BUNDLE:
+        request->_stream = FileSystem::open(url, FileSystem::READ | FileSystem::MAPPED);
+        if (request->_stream)
+            prefetch(request->_stream);
+        break;
+
+    case TEXTURE:
+        request->_image = BGFXTexture::loadImage(url, request->_generateMipmaps);
+        break;
+
+    case MATERIAL:
+        request->_properties = Properties::create(url);
+        break;
+
+    case SCENE:
+        request->_properties = Properties::create(url);
+        if (request->_properties)
+        {
+            // Read the main bundle of the scene, the file is then in the system cache when the scene is created.
+            Properties* sceneProperties = getRootNamespace(request->_properties);
+            std::string path;
+            if (sceneProperties && sceneProperties->getPath("path", &path))
+            {
+                Stream* stream = FileSystem::open(path.c_str(), FileSystem::READ | FileSystem::MAPPED);
+                if (stream)
+                {
+                    prefetch(stream);
+                    SAFE_DELETE(stream);
+                }
+            }
+        }
+        break;
+    }
+}
+
+void AssetLoader::complete(Request* request)
+{
+    GP_ASSERT(request);
+
+    const char* url = request->_url.c_str();
+    if (!request->_asset)
+    {
+        switch (request->_type)
+        {
+        case BUNDLE:
+            if (request->_stream)
+            {
+                // The bundle may have been loaded meanwhile.
+                request->_asset = Bundle::getCached(url);
+                if (!request->_asset)
+                {
+                    request->_asset = Bundle::create(url, request->_stream);
+                    request->_stream = NULL;
+                }
+            }
+            break;
+
+        case TEXTURE:
+            if (request->_image)
+            {
+                request->_asset = Texture::getCached(url, request->_generateMipmaps);
+                if (!request->_asset)
+                {
+                    Texture* texture = BGFXTexture::createFromImage(url, request->_image);
+                    request->_image = NULL;
+                    if (texture)
+                    {
+                        Texture::addCached(texture, url);
+                        request->_asset = texture;
+                    }
+                }
+            }
+            break;
+
+        case MATERIAL:
+            if (request->_properties)
+            {
+                request->_asset = Material::create(getRootNamespace(request->_properties));
+            }
+            break;
+
+        case SCENE:
+            if (request->_properties)
+            {
+                request->_asset = SceneLoader::load(url, request->_properties);
+                request->_properties = NULL;
+            }
+            break;
+        }
+    }
+    clear(request);
+
+    if (request->_asset)
+    {
+        request->_state = LOADED;
+    }
+    else
+    {
+        GP_WARN("Failed to load asset '%s'.", url);
+        request->_state = FAILED;
+    }
+}
+
+void AssetLoader::clear(Request* request)
+{
+    GP_ASSERT(request);
+    SAFE_DELETE(request->_stream);
+    BGFXTexture::freeImage(request->_image);
+    request->_image = NULL;
+    SAFE_DELETE(request->_properties);
+}
+
+void AssetLoader::update()
+{
+    if (_pendingCount == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Without loader threads, the requests are processed here.
+        if (_threads.empty())
+        {
+            while (!_queue.empty())
+            {
+                process(_queue.front());
+                _processed.push_back(_queue.front());
+                _queue.pop_front();
+            }
+        }
+
+        GP_ASSERT(_completing.empty());
+        _completing.swap(_processed);
+    }
+
+    // Callbacks may queue new requests.
+    for (size_t i = 0, count = _completing.size(); i < count; ++i)
+    {
+        Request* request = _completing[i];
+        --_pendingCount;
+        if (request->_cancelled)
+        {
+            clear(request);
+            SAFE_RELEASE(request->_asset);
+            request->_state = CANCELLED;
+        }
+        else
+        {
+            complete(request);
+            if (request->_callback)
+                request->_callback(request);
+        }
+        SAFE_RELEASE(request);
+    }
+    _completing.clear();
+}
+
+void AssetLoader::loaderThreadProc(AssetLoader* loader)
+{
+    GP_ASSERT(loader);
+    while (true)
+    {
+        Request* request = NULL;
+        {
+            std::unique_lock<std::mutex> lock(loader->_mutex);
+            loader->_wakeCondition.wait(lock, [loader] { return !loader->_running || !loader->_queue.empty(); });
+            if (!loader->_running)
+                break;
+            request = loader->_queue.front();
+            loader->_queue.pop_front();
+        }
+
+        loader->process(request);
+
+        {
+            std::lock_guard<std::mutex> lock(loader->_mutex);
+            loader->_processed.push_back(request);
+        }
+    }
+}
+
+}
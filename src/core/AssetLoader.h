@@ -0,0 +1,277 @@
+#ifndef ASSETLOADER_H_
+#define ASSETLOADER_H_
+
+#include "../core/Ref.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+namespace bimg
+{
+struct ImageContainer;
+}
+
+namespace gplay
+{
+
+class Properties;
+class Stream;
+
+/**
+ * Defines a loader that streams assets in the background.
+ *
+ * File I/O, image decoding and properties parsing run on the loader threads. The
+ * creation of the engine objects and of their GPU resources, which is not thread
+ * safe, is done on the main thread by Game::frame(), which then fires the completion
+ * callback of the request. Loading a bundle, texture, material or scene this way
+ * does not stall the game for the duration of the file reads.
+ *
+ * The loader is accessed with Game::getAssetLoader().
+ */
+class AssetLoader
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Types of assets.
+     */
+    enum AssetType
+    {
+        BUNDLE,
+        TEXTURE,
+        MATERIAL,
+        SCENE
+    };
+
+    /**
+     * States of a request.
+     */
+    enum State
+    {
+        PENDING,
+        LOADED,
+        FAILED,
+        CANCELLED
+    };
+
+    class Request;
+
+    /**
+     * Function called on the main thread when a request completes.
+     */
+    typedef std::function<void(Request* request)> Callback;
+
+    /**
+     * Defines a request for an asset.
+     */
+    class Request : public Ref
+    {
+        friend class AssetLoader;
+
+    public:
+
+        /**
+         * Returns the type of the requested asset.
+         *
+         * @return The type of the asset.
+         */
+        AssetType getType() const;
+
+        /**
+         * Returns the path or URL of the requested asset.
+         *
+         * @return The URL of the asset.
+         */
+        const char* getUrl() const;
+
+        /**
+         * Returns the state of the request.
+         *
+         * @return The state of the request.
+         */
+        State getState() const;
+
+        /**
+         * Determines if the request has completed, successfully or not.
+         *
+         * @return true if the request has completed, false if it is pending.
+         */
+        bool isDone() const;
+
+        /**
+         * Returns the loaded asset: a Bundle, Texture, Material or Scene depending on the type.
+         *
+         * The asset is owned by the request, call addRef() on it to keep it after the
+         * request is released.
+         *
+         * @return The loaded asset, or NULL if the request is not loaded.
+         */
+        Ref* getAsset() const;
+
+        /**
+         * Cancels a pending request. Its callback won't be called.
+         */
+        void cancel();
+
+    private:
+
+        /**
+         * Constructor.
+         */
+        Request(AssetType type, const char* url, const Callback& callback);
+
+        /**
+         * Destructor.
+         */
+        ~Request();
+
+        /**
+         * Hidden copy constructor.
+         */
+        Request(const Request& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        Request& operator=(const Request&);
+
+        AssetType _type;
+        std::string _url;
+        Callback _callback;
+        State _state;
+        Ref* _asset;
+        bool _generateMipmaps;
+        std::atomic<bool> _cancelled;
+        // Results of the loader thread, used to create the asset on the main thread.
+        Stream* _stream;
+        bimg::ImageContainer* _image;
+        Properties* _properties;
+    };
+
+    /**
+     * Loads a bundle in the background.
+     *
+     * @param path The path of the bundle.
+     * @param callback The function called when the request completes.
+     *
+     * @return The request. Call release() when no longer needed.
+     */
+    Request* loadBundle(const char* path, const Callback& callback = Callback());
+
+    /**
+     * Loads a texture in the background.
+     *
+     * @param path The path of the texture.
+     * @param generateMipmaps true to force a cached texture to generate its mipmap chain.
+     * @param callback The function called when the request completes.
+     *
+     * @return The request. Call release() when no longer needed.
+     */
+    Request* loadTexture(const char* path, bool generateMipmaps = false, const Callback& callback = Callback());
+
+    /**
+     * Loads a material in the background.
+     *
+     * The material file is read and parsed in the background, its effects and textures
+     * are created on the main thread.
+     *
+     * @param url The URL of the material.
+     * @param callback The function called when the request completes.
+     *
+     * @return The request. Call release() when no longer needed.
+     */
+    Request* loadMaterial(const char* url, const Callback& callback = Callback());
+
+    /**
+     * Loads a scene in the background.
+     *
+     * The scene file is read and parsed and its main bundle is read in the background,
+     * the scene is created on the main thread.
+     *
+     * @param url The URL of the scene.
+     * @param callback The function called when the request completes.
+     *
+     * @return The request. Call release() when no longer needed.
+     */
+    Request* loadScene(const char* url, const Callback& callback = Callback());
+
+    /**
+     * Returns the number of requests that are not completed yet.
+     *
+     * @return The number of pending requests.
+     */
+    unsigned int getPendingRequestCount() const;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    AssetLoader();
+
+    /**
+     * Destructor.
+     */
+    ~AssetLoader();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AssetLoader(const AssetLoader& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AssetLoader& operator=(const AssetLoader&);
+
+    /**
+     * Starts the loader threads.
+     */
+    void initialize();
+
+    /**
+     * Stops the loader threads and drops the pending requests.
+     */
+    void finalize();
+
+    /**
+     * Creates the assets of the requests processed by the loader threads and fires their callbacks.
+     *
+     * Called once per frame by Game::frame().
+     */
+    void update();
+
+    Request* queue(Request* request);
+
+    /**
+     * Does the background part of a request, on a loader thread.
+     */
+    void process(Request* request);
+
+    /**
+     * Creates the asset of a request, on the main thread.
+     */
+    void complete(Request* request);
+
+    /**
+     * Frees the results of the loader thread that were not used.
+     */
+    void clear(Request* request);
+
+    static void loaderThreadProc(AssetLoader* loader);
+
+    std::vector<std::thread*> _threads;
+    std::deque<Request*> _queue;
+    std::vector<Request*> _processed;
+    std::vector<Request*> _completing;
+    std::mutex _mutex;
+    std::condition_variable _wakeCondition;
+    unsigned int _pendingCount;
+    bool _running;
+};
+
+}
+
+#endif
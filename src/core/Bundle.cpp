@@ -4,6 +4,7 @@
 #include "../graphics/MeshPart.h"
 #include "../graphics/Scene.h"
 #include "../graphics/Joint.h"
+#include "../renderer/BGFXRenderer.h"
 
 // Minimum version numbers supported
 #define BUNDLE_VERSION_MAJOR_REQUIRED   1 
@@ -35,8 +36,151 @@ namespace gplay
 
 static std::vector<Bundle*> __bundleCache;
 
+static unsigned int getElementByteSize(const VertexFormat::Element& element)
+{
+    switch (element.type)
+    {
+    case VertexFormat::Uint8:
+        return element.size;
+    case VertexFormat::Int16:
+    case VertexFormat::Half:
+        return element.size * 2;
+    default:
+        return element.size * sizeof(float);
+    }
+}
+
+/**
+ * Converts the half float elements of vertex data to floats, for renderers without half float
+ * vertex attributes. Returns NULL when the vertex data has no half float elements.
+ */
+static unsigned char* convertHalfVertices(const VertexFormat& vertexFormat, const unsigned char* vertexData, unsigned int vertexCount,
+                                          std::vector<VertexFormat::Element>* elements)
+{
+    GP_ASSERT(elements);
+
+    bool hasHalf = false;
+    elements->clear();
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        VertexFormat::Element element = vertexFormat.getElement(i);
+        if (element.type == VertexFormat::Half)
+        {
+            element.type = VertexFormat::Float;
+            hasHalf = true;
+        }
+        elements->push_back(element);
+    }
+    if (!hasHalf || !vertexData)
+        return NULL;
+
+    const VertexFormat floatFormat(&(*elements)[0], (unsigned int)elements->size());
+    unsigned char* floatData = new unsigned char[floatFormat.getVertexSize() * vertexCount];
+    const unsigned char* src = vertexData;
+    unsigned char* dst = floatData;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+        {
+            const VertexFormat::Element& element = vertexFormat.getElement(i);
+            const unsigned int size = getElementByteSize(element);
+            if (element.type == VertexFormat::Half)
+            {
+                for (unsigned int c = 0; c < element.size; ++c)
+                {
+                    ((float*)dst)[c] = MathUtil::halfToFloat(((const unsigned short*)src)[c]);
+                }
+                dst += element.size * sizeof(float);
+            }
+            else
+            {
+                memcpy(dst, src, size);
+                dst += size;
+            }
+            src += size;
+        }
+    }
+    return floatData;
+}
+
+/**
+ * Computes the bounds of the vertices influenced by each joint index of a skinned mesh,
+ * leaving no bounds when the vertices have no float blend weights and indices.
+ */
+static void computeJointBounds(const VertexFormat& vertexFormat, const unsigned char* vertexData, unsigned int vertexCount,
+                               std::vector<BoundingBox>* jointBounds)
+{
+    GP_ASSERT(jointBounds);
+
+    const VertexFormat::Element* position = NULL;
+    const VertexFormat::Element* weights = NULL;
+    const VertexFormat::Element* indices = NULL;
+    unsigned int positionOffset = 0, weightsOffset = 0, indicesOffset = 0;
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = vertexFormat.getElement(i);
+        if (element.usage == VertexFormat::POSITION)
+        {
+            position = &element;
+            positionOffset = offset;
+        }
+        else if (element.usage == VertexFormat::BLENDWEIGHTS)
+        {
+            weights = &element;
+            weightsOffset = offset;
+        }
+        else if (element.usage == VertexFormat::BLENDINDICES)
+        {
+            indices = &element;
+            indicesOffset = offset;
+        }
+
+        offset += getElementByteSize(element);
+    }
+
+    jointBounds->clear();
+    if (!vertexData || !position || !weights || !indices || position->size < 3 ||
+        weights->type != VertexFormat::Float || indices->type != VertexFormat::Float ||
+        (position->type != VertexFormat::Float && position->type != VertexFormat::Half))
+    {
+        return;
+    }
+
+    const unsigned int influenceCount = std::min(weights->size, indices->size);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        const unsigned char* vertex = vertexData + i * offset;
+        Vector3 p;
+        if (position->type == VertexFormat::Half)
+        {
+            const unsigned short* v = (const unsigned short*)(vertex + positionOffset);
+            p.set(MathUtil::halfToFloat(v[0]), MathUtil::halfToFloat(v[1]), MathUtil::halfToFloat(v[2]));
+        }
+        else
+        {
+            p.set((const float*)(vertex + positionOffset));
+        }
+
+        const float* w = (const float*)(vertex + weightsOffset);
+        const float* j = (const float*)(vertex + indicesOffset);
+        for (unsigned int k = 0; k < influenceCount; ++k)
+        {
+            if (w[k] <= 0.0f || j[k] < 0.0f)
+                continue;
+
+            // Joints without vertices keep an inverted box.
+            const size_t joint = (size_t)j[k];
+            if (joint >= jointBounds->size())
+                jointBounds->resize(joint + 1, BoundingBox(Vector3(FLT_MAX, FLT_MAX, FLT_MAX), Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX)));
+
+            (*jointBounds)[joint].merge(BoundingBox(p, p));
+        }
+    }
+}
+
 Bundle::Bundle(const char* path) :
-    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _trackedNodes(NULL)
+    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _data(NULL), _trackedNodes(NULL)
 {
 }
 
@@ -141,6 +285,67 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     return true;
 }
 
+template <class T>
+bool Bundle::readArray(unsigned int* length, std::vector<T>* values, const T** ptr)
+{
+    GP_ASSERT(length);
+    GP_ASSERT(values);
+    GP_ASSERT(ptr);
+    GP_ASSERT(_stream);
+
+    *ptr = NULL;
+    if (!read(length))
+    {
+        GP_ERROR("Failed to read the length of an array of data.");
+        return false;
+    }
+    if (*length == 0)
+        return true;
+
+    // Reference the values in place if they are aligned, the strings of the bundle are not padded.
+    long int position = _stream->position();
+    if (_data && position >= 0 && (size_t)position % sizeof(T) == 0)
+    {
+        *ptr = (const T*)readInPlace(*length * sizeof(T));
+        if (*ptr)
+            return true;
+    }
+
+    values->resize(*length);
+    if (_stream->read(&(*values)[0], sizeof(T), *length) != *length)
+    {
+        GP_ERROR("Failed to read an array of data from bundle.");
+        return false;
+    }
+    *ptr = &(*values)[0];
+    return true;
+}
+
+bool Bundle::skipArray(unsigned int size)
+{
+    GP_ASSERT(_stream);
+
+    unsigned int length;
+    if (!read(&length))
+    {
+        GP_ERROR("Failed to read the length of an array of data.");
+        return false;
+    }
+    return length == 0 || _stream->seek((long int)length * size, SEEK_CUR);
+}
+
+unsigned char* Bundle::readInPlace(unsigned int size)
+{
+    GP_ASSERT(_stream);
+    if (!_data)
+        return NULL;
+
+    long int position = _stream->position();
+    if (position < 0 || (size_t)position + size > _stream->length() || !_stream->seek(size, SEEK_CUR))
+        return NULL;
+    return _data + position;
+}
+
 static std::string readString(Stream* stream)
 {
     GP_ASSERT(stream);
@@ -173,6 +378,27 @@ Bundle* Bundle::create(const char* path)
     GP_ASSERT(path);
 
     // Search the cache for this bundle.
+    Bundle* bundle = getCached(path);
+    if (bundle)
+    {
+        return bundle;
+    }
+
+    // Open the bundle, memory mapped when possible so that mesh and animation data can be used in place.
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAPPED);
+    if (!stream)
+    {
+        GP_WARN("Failed to open file '%s'.", path);
+        return NULL;
+    }
+
+    return create(path, stream);
+}
+
+Bundle* Bundle::getCached(const char* path)
+{
+    GP_ASSERT(path);
+
     for (size_t i = 0, count = __bundleCache.size(); i < count; ++i)
     {
         Bundle* p = __bundleCache[i];
@@ -184,14 +410,13 @@ Bundle* Bundle::create(const char* path)
             return p;
         }
     }
+    return NULL;
+}
 
-    // Open the bundle.
-    Stream* stream = FileSystem::open(path);
-    if (!stream)
-    {
-        GP_WARN("Failed to open file '%s'.", path);
-        return NULL;
-    }
+Bundle* Bundle::create(const char* path, Stream* stream)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(stream);
 
     // Read the GPB header info.
     char sig[9];
@@ -249,6 +474,19 @@ Bundle* Bundle::create(const char* path)
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
     bundle->_stream = stream;
+    bundle->_data = (unsigned char*)stream->getData();
+
+    // Index the ref table. The sort is stable so that the first of duplicated ids is found, as before.
+    bundle->_referencesById.resize(refCount);
+    for (unsigned int i = 0; i < refCount; ++i)
+    {
+        bundle->_referencesById[i] = &refs[i];
+    }
+    bundle->_referencesByOffset = bundle->_referencesById;
+    std::stable_sort(bundle->_referencesById.begin(), bundle->_referencesById.end(),
+        [](const Reference* r1, const Reference* r2) { return r1->id < r2->id; });
+    std::stable_sort(bundle->_referencesByOffset.begin(), bundle->_referencesByOffset.end(),
+        [](const Reference* r1, const Reference* r2) { return r1->offset < r2->offset; });
 
     return bundle;
 }
@@ -258,14 +496,13 @@ Bundle::Reference* Bundle::find(const char* id) const
     GP_ASSERT(id);
     GP_ASSERT(_references);
 
-    // Search the ref table for the given id (case-sensitive).
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    // Binary search of the ref table for the given id (case-sensitive).
+    std::vector<Reference*>::const_iterator itr = std::lower_bound(_referencesById.begin(), _referencesById.end(), id,
+        [](const Reference* ref, const char* id) { return ref->id.compare(id) < 0; });
+    if (itr != _referencesById.end() && (*itr)->id == id)
     {
-        if (_references[i].id == id)
-        {
-            // Found a match
-            return &_references[i];
-        }
+        // Found a match
+        return *itr;
     }
 
     return NULL;
@@ -292,11 +529,13 @@ const char* Bundle::getIdFromOffset(unsigned int offset) const
     if (offset > 0)
     {
         GP_ASSERT(_references);
-        for (unsigned int i = 0; i < _referenceCount; ++i)
+        std::vector<Reference*>::const_iterator itr = std::lower_bound(_referencesByOffset.begin(), _referencesByOffset.end(), offset,
+            [](const Reference* ref, unsigned int offset) { return ref->offset < offset; });
+        for (; itr != _referencesByOffset.end() && (*itr)->offset == offset; ++itr)
         {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
+            if ((*itr)->id.length() > 0)
             {
-                return _references[i].id.c_str();
+                return (*itr)->id.c_str();
             }
         }
     }
@@ -1023,6 +1262,38 @@ Model* Bundle::readModel(const char* nodeId)
                     }
                 }
             }
+
+            // In bundle version 1.6 we introduced levels of detail for models
+            if (getVersionMajor() >= 1 && getVersionMinor() >= 6)
+            {
+                unsigned int lodCount;
+                if (!read(&lodCount))
+                {
+                    GP_ERROR("Failed to load level of detail count for model with mesh '%s' in bundle '%s'.", xref.c_str() + 1, _path.c_str());
+                    SAFE_RELEASE(model);
+                    return NULL;
+                }
+                for (unsigned int i = 0; i < lodCount; ++i)
+                {
+                    std::string lodXref = readString(_stream);
+                    float screenSize;
+                    if (!read(&screenSize))
+                    {
+                        GP_ERROR("Failed to load level of detail screen size for model with mesh '%s' in bundle '%s'.", xref.c_str() + 1, _path.c_str());
+                        SAFE_RELEASE(model);
+                        return NULL;
+                    }
+                    if (lodXref.length() > 1 && lodXref[0] == '#')
+                    {
+                        Mesh* lodMesh = loadMesh(lodXref.c_str() + 1, nodeId);
+                        if (lodMesh)
+                        {
+                            model->addLod(lodMesh, screenSize);
+                            SAFE_RELEASE(lodMesh);
+                        }
+                    }
+                }
+            }
             return model;
         }
     }
@@ -1291,49 +1562,42 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
 {
     GP_ASSERT(id);
 
-    std::vector<unsigned int> keyTimes;
-    std::vector<float> values;
-    std::vector<float> tangentsIn;
-    std::vector<float> tangentsOut;
-    std::vector<unsigned int> interpolation;
+    // Key times and values are referenced in place when the bundle is memory mapped.
+    std::vector<unsigned int> keyTimesBuffer;
+    std::vector<float> valuesBuffer;
+    const unsigned int* keyTimes;
+    const float* values;
 
     // Length of the arrays.
     unsigned int keyTimesCount;
     unsigned int valuesCount;
-    unsigned int tangentsInCount;
-    unsigned int tangentsOutCount;
-    unsigned int interpolationCount;
 
     // Read key times.
-    if (!readArray(&keyTimesCount, &keyTimes, sizeof(unsigned int)))
+    if (!readArray(&keyTimesCount, &keyTimesBuffer, &keyTimes))
     {
         GP_ERROR("Failed to read key times for animation '%s'.", id);
         return NULL;
     }
 
     // Read key values.
-    if (!readArray(&valuesCount, &values))
+    if (!readArray(&valuesCount, &valuesBuffer, &values))
     {
         GP_ERROR("Failed to read key values for animation '%s'.", id);
         return NULL;
     }
 
-    // Read in-tangents.
-    if (!readArray(&tangentsInCount, &tangentsIn))
+    // Skip in-tangents, out-tangents and interpolations (unused, see below).
+    if (!skipArray(sizeof(float)))
     {
         GP_ERROR("Failed to read in tangents for animation '%s'.", id);
         return NULL;
     }
-
-    // Read out-tangents.
-    if (!readArray(&tangentsOutCount, &tangentsOut))
+    if (!skipArray(sizeof(float)))
     {
         GP_ERROR("Failed to read out tangents for animation '%s'.", id);
         return NULL;
     }
-
-    // Read interpolations.
-    if (!readArray(&interpolationCount, &interpolation, sizeof(unsigned int)))
+    if (!skipArray(sizeof(unsigned int)))
     {
         GP_ERROR("Failed to read the interpolation values for animation '%s'.", id);
         return NULL;
@@ -1342,15 +1606,15 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
     if (targetAttribute > 0)
     {
         GP_ASSERT(target);
-        GP_ASSERT(keyTimes.size() > 0 && values.size() > 0);
+        GP_ASSERT(keyTimesCount > 0 && valuesCount > 0);
         if (animation == NULL)
         {
             // TODO: This code currently assumes LINEAR only.
-            animation = target->createAnimation(id, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            animation = target->createAnimation(id, targetAttribute, keyTimesCount, const_cast<unsigned int*>(keyTimes), const_cast<float*>(values), Curve::LINEAR);
         }
         else
         {
-            animation->createChannel(target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            animation->createChannel(target, targetAttribute, keyTimesCount, const_cast<unsigned int*>(keyTimes), const_cast<float*>(values), Curve::LINEAR);
         }
     }
 
@@ -1391,12 +1655,28 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         return NULL;
     }
 
+    // Quantized meshes are drawn with float positions and texture coordinates on renderers
+    // without half float vertex attributes.
+    std::vector<VertexFormat::Element> floatElements;
+    unsigned char* floatVertexData = NULL;
+    if (!Renderer::getInstance().getCaps()._vertexAttribHalf)
+    {
+        floatVertexData = convertHalfVertices(meshData->vertexFormat, meshData->vertexData, meshData->vertexCount, &floatElements);
+        if (floatVertexData)
+        {
+            GP_WARN("Half float vertex attributes are not supported by the renderer, converting mesh '%s' to floats.", id);
+        }
+    }
+
     // Create mesh.
-    Mesh* mesh = Mesh::createMesh(meshData->vertexFormat, meshData->vertexCount, false);
+    Mesh* mesh = floatVertexData ?
+        Mesh::createMesh(VertexFormat(&floatElements[0], (unsigned int)floatElements.size()), meshData->vertexCount, false) :
+        Mesh::createMesh(meshData->vertexFormat, meshData->vertexCount, false);
     if (mesh == NULL)
     {
         GP_ERROR("Failed to create mesh '%s'.", id);
-        SAFE_DELETE_ARRAY(meshData);
+        SAFE_DELETE_ARRAY(floatVertexData);
+        SAFE_DELETE(meshData);
         return NULL;
     }
 
@@ -1404,11 +1684,29 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     mesh->_url += "#";
     mesh->_url += id;
 
-    mesh->setVertexData((float*)meshData->vertexData, 0, meshData->vertexCount);
+    if (floatVertexData)
+    {
+        mesh->setVertexData(floatVertexData, 0, meshData->vertexCount);
+        SAFE_DELETE_ARRAY(floatVertexData);
+    }
+    else if (meshData->releaseData)
+    {
+        // Vertex data is used in place, the renderer keeps the bundle mapped until it is uploaded.
+        void* handle = NULL;
+        Stream::ReleaseDataFunction release = _stream->retainData(&handle);
+        mesh->_vertexBuffer->setShared(meshData->vertexData, meshData->vertexCount, release, handle);
+    }
+    else
+    {
+        mesh->setVertexData((float*)meshData->vertexData, 0, meshData->vertexCount);
+    }
 
     mesh->_boundingBox.set(meshData->boundingBox);
     mesh->_boundingSphere.set(meshData->boundingSphere);
 
+    // Keep what each joint moves, so that the bounds of a skin stay conservative once animated.
+    computeJointBounds(meshData->vertexFormat, meshData->vertexData, meshData->vertexCount, &mesh->_jointBounds);
+
     // Create mesh parts.
     for (unsigned int i = 0; i < meshData->parts.size(); ++i)
     {
@@ -1422,7 +1720,16 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
             SAFE_DELETE(meshData);
             return NULL;
         }
-        part->setIndexData(partData->indexData, 0, partData->indexCount);
+        if (meshData->releaseData)
+        {
+            void* handle = NULL;
+            Stream::ReleaseDataFunction release = _stream->retainData(&handle);
+            part->_indexBuffer->setShared(partData->indexData, partData->indexCount, release, handle);
+        }
+        else
+        {
+            part->setIndexData(partData->indexData, 0, partData->indexCount);
+        }
     }
 
     SAFE_DELETE(meshData);
@@ -1471,11 +1778,32 @@ Bundle::MeshData* Bundle::readMeshData()
 
         vertexElements[i].usage = (VertexFormat::Usage)vUsage;
         vertexElements[i].size = vSize;
+
+        // In bundle version 1.7 we introduced the data type of vertex elements
+        if (getVersionMajor() >= 1 && getVersionMinor() >= 7)
+        {
+            unsigned int vType;
+            unsigned char vNormalized;
+            if (_stream->read(&vType, 4, 1) != 1 || _stream->read(&vNormalized, 1, 1) != 1)
+            {
+                GP_ERROR("Failed to load vertex type.");
+                SAFE_DELETE_ARRAY(vertexElements);
+                return NULL;
+            }
+            vertexElements[i].type = (VertexFormat::AttribType)vType;
+            vertexElements[i].normalized = vNormalized != 0;
+        }
     }
 
     MeshData* meshData = new MeshData(VertexFormat(vertexElements, vertexElementCount));
     SAFE_DELETE_ARRAY(vertexElements);
 
+    // Vertex and index data are used in place when the bundle is memory mapped.
+    if (_data)
+    {
+        meshData->releaseData = _stream->retainData(&meshData->dataHandle);
+    }
+
     // Read vertex data.
     unsigned int vertexByteCount;
     if (_stream->read(&vertexByteCount, 4, 1) != 1)
@@ -1493,12 +1821,25 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    if (meshData->releaseData)
     {
-        GP_ERROR("Failed to load vertex data.");
-        SAFE_DELETE(meshData);
-        return NULL;
+        meshData->vertexData = readInPlace(vertexByteCount);
+        if (meshData->vertexData == NULL)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
+    }
+    else
+    {
+        meshData->vertexData = new unsigned char[vertexByteCount];
+        if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
     }
 
     // Read mesh bounds (bounding box and bounding sphere).
@@ -1566,18 +1907,32 @@ Bundle::MeshData* Bundle::readMeshData()
             break;
         default:
             GP_ERROR("Unsupported index format for mesh part with index %d.", i);
+            SAFE_DELETE(meshData);
             return NULL;
         }
 
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        if (meshData->releaseData)
         {
-            GP_ERROR("Failed to read index data for mesh part with index %d.", i);
-            SAFE_DELETE(meshData);
-            return NULL;
+            partData->indexData = readInPlace(iByteCount);
+            if (partData->indexData == NULL)
+            {
+                GP_ERROR("Failed to read index data for mesh part with index %d.", i);
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
+        }
+        else
+        {
+            partData->indexData = new unsigned char[iByteCount];
+            if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+            {
+                GP_ERROR("Failed to read index data for mesh part with index %d.", i);
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
         }
     }
 
@@ -1881,12 +2236,24 @@ Bundle::MeshPartData::~MeshPartData()
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), primitiveType(Mesh::TRIANGLES)
+    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), primitiveType(Mesh::TRIANGLES),
+      releaseData(NULL), dataHandle(NULL)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
+    if (releaseData)
+    {
+        // The data belongs to the mapped bundle.
+        vertexData = NULL;
+        for (unsigned int i = 0; i < parts.size(); ++i)
+        {
+            parts[i]->indexData = NULL;
+        }
+        releaseData(dataHandle);
+    }
+
     SAFE_DELETE_ARRAY(vertexData);
 
     for (unsigned int i = 0; i < parts.size(); ++i)
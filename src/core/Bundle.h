@@ -6,6 +6,7 @@
 #include "../graphics/Node.h"
 #include "../core/Game.h"
 #include "../graphics/MeshSkin.h"
+#include "../core/Stream.h"
 
 namespace gplay
 {
@@ -18,6 +19,7 @@ class Bundle : public Ref
 {
     friend class PhysicsController;
     friend class SceneLoader;
+    friend class AssetLoader;
 
 public:
 
@@ -164,6 +166,9 @@ private:
         BoundingSphere boundingSphere;
         Mesh::PrimitiveType primitiveType;
         std::vector<MeshPartData*> parts;
+        // Reference on the mapped bundle when the vertex and index data point into it.
+        Stream::ReleaseDataFunction releaseData;
+        void* dataHandle;
     };
 
     Bundle(const char* path);
@@ -178,6 +183,21 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Returns the cached bundle for the given path, with an added reference, or NULL if not cached.
+     */
+    static Bundle* getCached(const char* path);
+
+    /**
+     * Creates a bundle from an opened stream, which it takes ownership of.
+     *
+     * @param path The path of the bundle.
+     * @param stream The stream of the bundle file.
+     *
+     * @return The new Bundle or NULL if there was an error.
+     */
+    static Bundle* create(const char* path, Stream* stream);
+
     /**
      * Finds a reference by ID.
      */
@@ -315,6 +335,39 @@ private:
      */
     template <class T>
     bool readArray(unsigned int* length, std::vector<T>* values, unsigned int readSize);
+
+    /**
+     * Reads an array of values and the array length from the current file position.
+     *
+     * When the bundle is memory mapped and the values are suitably aligned, they are
+     * referenced in place, otherwise they are copied to the given vector.
+     *
+     * @param length A pointer to where the length of the array will be copied to.
+     * @param values A pointer to the vector to copy the values to if they can't be referenced in place.
+     * @param ptr A pointer to where the address of the first value will be copied to.
+     *
+     * @return True if successful, false if an error occurred.
+     */
+    template <class T>
+    bool readArray(unsigned int* length, std::vector<T>* values, const T** ptr);
+
+    /**
+     * Skips an array of values of the given size at the current file position.
+     *
+     * @param size The size of each value.
+     *
+     * @return True if successful, false if an error occurred.
+     */
+    bool skipArray(unsigned int size);
+
+    /**
+     * Returns the data at the current file position of a memory mapped bundle and skips it.
+     *
+     * @param size The number of bytes to skip.
+     *
+     * @return A pointer to the data, or NULL if the bundle is not memory mapped.
+     */
+    unsigned char* readInPlace(unsigned int size);
     
     /**
      * Reads 16 floats from the current file position.
@@ -455,7 +508,10 @@ private:
     std::string _materialPath;
     unsigned int _referenceCount;
     Reference* _references;
+    std::vector<Reference*> _referencesById;        // Sorted by id, for find().
+    std::vector<Reference*> _referencesByOffset;    // Sorted by offset, for getIdFromOffset().
     Stream* _stream;
+    unsigned char* _data;                           // Content of the memory mapped bundle, NULL if not mapped.
 
     std::vector<MeshSkinData*> _meshSkins;
     std::map<std::string, Node*>* _trackedNodes;
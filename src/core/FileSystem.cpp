@@ -6,6 +6,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <atomic>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -18,6 +19,9 @@
     #define __EXT_POSIX2
     #include <libgen.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -126,6 +130,60 @@ private:
     bool _canWrite;
 };
 
+/**
+ * Read-only stream over a memory mapped file.
+ *
+ * Reads are plain memory copies and the whole content is available through getData().
+ * The mapping is reference counted so that data referenced in place (e.g. by the renderer)
+ * outlives the stream.
+ *
+ * @script{ignore}
+ */
+class MappedFileStream : public Stream
+{
+public:
+    friend class FileSystem;
+
+    ~MappedFileStream();
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+    virtual const void* getData();
+    virtual ReleaseDataFunction retainData(void** handle);
+
+    static MappedFileStream* create(const char* filePath);
+
+private:
+
+    struct Mapping
+    {
+        std::atomic<int> refCount;
+        unsigned char* data;
+        size_t size;
+#ifdef _WIN32
+        HANDLE file;
+        HANDLE fileMapping;
+#endif
+    };
+
+    MappedFileStream(Mapping* mapping);
+
+    static void releaseMapping(void* handle);
+
+private:
+    Mapping* _mapping;
+    size_t _position;
+};
+
 #ifdef __ANDROID__
 
 /**
@@ -357,6 +415,25 @@ bool FileSystem::fileExists(const char* filePath)
 
 }
 
+bool FileSystem::createDirectory(const char* dirPath)
+{
+    GP_ASSERT(dirPath);
+
+    std::string fullPath;
+    getFullPath(dirPath, fullPath);
+
+    gp_stat_struct s;
+    if (stat(fullPath.c_str(), &s) == 0)
+    {
+        return (s.st_mode & S_IFDIR) != 0;
+    }
+#ifdef _WIN32
+    return _mkdir(fullPath.c_str()) == 0;
+#else
+    return mkdir(fullPath.c_str(), 0777) == 0;
+#endif
+}
+
 Stream* FileSystem::open(const char* path, size_t streamMode)
 {
     char modeStr[] = "rb";
@@ -400,6 +477,13 @@ Stream* FileSystem::open(const char* path, size_t streamMode)
 #else
     std::string fullPath;
     getFullPath(path, fullPath);
+    if ((streamMode & MAPPED) != 0 && (streamMode & (WRITE | APPEND)) == 0)
+    {
+        // Fall back to a regular file stream if the file can't be mapped.
+        Stream* stream = MappedFileStream::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
     FileStream* stream = FileStream::create(fullPath.c_str(), modeStr);
     return stream;
 #endif
@@ -727,6 +811,232 @@ bool FileStream::rewind()
 
 ////////////////////////////////
 
+MappedFileStream::MappedFileStream(Mapping* mapping)
+    : _mapping(mapping), _position(0)
+{
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    if (_mapping)
+    {
+        close();
+    }
+}
+
+MappedFileStream* MappedFileStream::create(const char* filePath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    // Copy on write, so that data referenced in place can still be modified by its user.
+    HANDLE fileMapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (fileMapping == NULL)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+    void* data = MapViewOfFile(fileMapping, FILE_MAP_COPY, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(fileMapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    Mapping* mapping = new Mapping();
+    mapping->file = file;
+    mapping->fileMapping = fileMapping;
+    mapping->size = (size_t)size.QuadPart;
+#else
+    int fd = ::open(filePath, O_RDONLY);
+    if (fd == -1)
+        return NULL;
+
+    struct stat s;
+    if (fstat(fd, &s) != 0 || s.st_size == 0)
+    {
+        ::close(fd);
+        return NULL;
+    }
+
+    // Private mapping, so that data referenced in place can still be modified by its user.
+    void* data = mmap(NULL, (size_t)s.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    Mapping* mapping = new Mapping();
+    mapping->size = (size_t)s.st_size;
+#endif
+    mapping->data = (unsigned char*)data;
+    mapping->refCount = 1;
+
+    return new MappedFileStream(mapping);
+}
+
+void MappedFileStream::releaseMapping(void* handle)
+{
+    Mapping* mapping = (Mapping*)handle;
+    GP_ASSERT(mapping);
+    if (--mapping->refCount == 0)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping->data);
+        CloseHandle(mapping->fileMapping);
+        CloseHandle(mapping->file);
+#else
+        munmap(mapping->data, mapping->size);
+#endif
+        delete mapping;
+    }
+}
+
+bool MappedFileStream::canRead()
+{
+    return _mapping != NULL;
+}
+
+bool MappedFileStream::canWrite()
+{
+    return false;
+}
+
+bool MappedFileStream::canSeek()
+{
+    return _mapping != NULL;
+}
+
+void MappedFileStream::close()
+{
+    if (_mapping)
+        releaseMapping(_mapping);
+    _mapping = NULL;
+}
+
+size_t MappedFileStream::read(void* ptr, size_t size, size_t count)
+{
+    if (!_mapping || size == 0 || _position >= _mapping->size)
+        return 0;
+
+    // Only whole elements are read, like fread.
+    size_t available = (_mapping->size - _position) / size;
+    if (count > available)
+        count = available;
+    memcpy(ptr, _mapping->data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* MappedFileStream::readLine(char* str, int num)
+{
+    if (!_mapping || num <= 0 || _position >= _mapping->size)
+        return NULL;
+
+    // Same rules as fgets, with "\r" and "\r\n" also ending a line.
+    int i = 0;
+    while (i < num - 1 && _position < _mapping->size)
+    {
+        char c = (char)_mapping->data[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+        if (c == '\r')
+        {
+            if (i < num - 1 && _position < _mapping->size && _mapping->data[_position] == '\n')
+                str[i++] = (char)_mapping->data[_position++];
+            break;
+        }
+    }
+    str[i] = '\0';
+    return str;
+}
+
+size_t MappedFileStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
+bool MappedFileStream::eof()
+{
+    return !_mapping || _position >= _mapping->size;
+}
+
+size_t MappedFileStream::length()
+{
+    return _mapping ? _mapping->size : 0;
+}
+
+long int MappedFileStream::position()
+{
+    if (!_mapping)
+        return -1;
+    return (long int)_position;
+}
+
+bool MappedFileStream::seek(long int offset, int origin)
+{
+    if (!_mapping)
+        return false;
+
+    long int base = 0;
+    switch (origin)
+    {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = (long int)_position;
+        break;
+    case SEEK_END:
+        base = (long int)_mapping->size;
+        break;
+    default:
+        return false;
+    }
+    if (base + offset < 0)
+        return false;
+    _position = (size_t)(base + offset);
+    return true;
+}
+
+bool MappedFileStream::rewind()
+{
+    if (canSeek())
+    {
+        _position = 0;
+        return true;
+    }
+    return false;
+}
+
+const void* MappedFileStream::getData()
+{
+    return _mapping ? _mapping->data : NULL;
+}
+
+Stream::ReleaseDataFunction MappedFileStream::retainData(void** handle)
+{
+    GP_ASSERT(handle);
+    if (!_mapping)
+        return NULL;
+
+    ++_mapping->refCount;
+    *handle = _mapping;
+    return &MappedFileStream::releaseMapping;
+}
+
+////////////////////////////////
+
 #ifdef __ANDROID__
 
 FileStreamAndroid::FileStreamAndroid(AAsset* asset)
@@ -19,13 +19,17 @@ public:
     /**
      * Mode flags for opening a stream.
      *
+     * MAPPED can be combined with READ to memory map the file when the platform
+     * supports it, the content of the stream is then available with Stream::getData().
+     *
      * @script{ignore}
      */
     enum StreamMode
     {
         READ = 1,
         WRITE = 2,
-        APPEND = 4
+        APPEND = 4,
+        MAPPED = 8
     };
 
     /**
@@ -158,6 +162,15 @@ public:
      */
     static bool fileExists(const char* filePath);
 
+    /**
+     * Creates a directory, relative to the currently set resource path.
+     *
+     * @param dirPath The path of the directory to create. Its parent directory must exist.
+     *
+     * @return True if the directory was created or already exists, false otherwise.
+     */
+    static bool createDirectory(const char* dirPath);
+
     /**
      * Opens a byte stream for the given resource path.
      *
@@ -30,7 +30,7 @@ public:
 
     static FileWatcherEventRef create(WatchData data)
     {
-        return FileWatcherEventRef(new FileWatcherEvent(data));
+        return makeEventRef(new FileWatcherEvent(data));
     }
 
 private:
@@ -9,6 +9,8 @@
 #include "../ui/Theme.h"
 #include "../ui/Form.h"
 #include "../graphics/View.h"
+#include "../renderer/BGFXTexture.h"
+#include "../core/ResourceCache.h"
 
 
 /** @script{ignore} */
@@ -64,7 +66,7 @@ Game::Game()
       _frameLastFPS(0), _frameCount(0), _frameRate(0), _width(0), _height(0),
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
-      _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
+      _physicsController(NULL), _aiController(NULL), _jobScheduler(NULL), _assetLoader(NULL), _audioListener(NULL),
       _timeEvents(NULL), _scriptController(NULL), _scriptTarget(NULL), _inGameEditor(NULL)
 {
     setlocale(LC_NUMERIC, "C");
@@ -165,10 +167,20 @@ bool Game::startup()
     setViewport(Rectangle(0.0f, 0.0f, (float)_width, (float)_height));
     RenderState::initialize();
 
+    BGFXTexture::initialize();
+
+    ResourceCache::initialize();
+
     Effect::initialize();
 
     _eventManager = EventManager::create("Global", true);
 
+    _jobScheduler = new JobScheduler();
+    _jobScheduler->initialize();
+
+    _assetLoader = new AssetLoader();
+    _assetLoader->initialize();
+
     _animationController = new AnimationController();
     _animationController->initialize();
 
@@ -260,6 +272,10 @@ void Game::shutdown()
 		// Shutdown scripting system first so that any objects allocated in script are released before our subsystems are released
 		_scriptController->finalize();
 
+        // Drop the assets still loading.
+        _assetLoader->finalize();
+        SAFE_DELETE(_assetLoader);
+
         unsigned int gamepadCount = Gamepad::getGamepadCount();
         for (unsigned int i = 0; i < gamepadCount; i++)
         {
@@ -277,6 +293,9 @@ void Game::shutdown()
         SAFE_DELETE(_physicsController);
         _aiController->finalize();
         SAFE_DELETE(_aiController);
+
+        _jobScheduler->finalize();
+        SAFE_DELETE(_jobScheduler);
         
         _eventManager.reset();
 
@@ -291,8 +310,12 @@ void Game::shutdown()
 
         SAFE_DELETE(_audioListener);
 
+        ResourceCache::finalize();
+
         RenderState::finalize();
 
+        Effect::finalize();
+
         SAFE_DELETE(_properties);
 
 		_state = UNINITIALIZED;
@@ -384,6 +407,10 @@ void Game::frame()
     // Fire time events to scheduled TimeListeners
     fireTimeEvents(frameTime);
 
+    // Create the assets loaded in the background and fire their callbacks.
+    if (_assetLoader)
+        _assetLoader->update();
+
     if (_state == Game::RUNNING)
     {
         GP_ASSERT(_animationController);
@@ -467,6 +494,10 @@ void Game::frame()
         if (_scriptTarget)
             _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, render), 0);
     }
+
+    // Complete and recycle the jobs of this frame.
+    if (_jobScheduler)
+        _jobScheduler->endFrame();
 }
 
 void Game::renderOnce(const char* function)
@@ -14,6 +14,8 @@
 #include "../math/Rectangle.h"
 #include "../math/Vector4.h"
 #include "../core/TimeListener.h"
+#include "../core/JobScheduler.h"
+#include "../core/AssetLoader.h"
 #include "../events/EventManager.h"
 #include "../editor/InGameEditor.h"
 
@@ -270,6 +272,20 @@ public:
      */
     inline AIController* getAIController() const;
 
+    /**
+     * Gets the job scheduler used to run work in parallel on worker threads.
+     *
+     * @return The job scheduler for this game.
+     */
+    inline JobScheduler* getJobScheduler() const;
+
+    /**
+     * Gets the asset loader used to load assets in the background.
+     *
+     * @return The asset loader for this game.
+     */
+    inline AssetLoader* getAssetLoader() const;
+
     /**
      * Gets the script controller for managing control of Lua scripts
      * associated with the game.
@@ -778,6 +794,8 @@ private:
     AudioController* _audioController;          // Controls audio sources that are playing in the game.
     PhysicsController* _physicsController;      // Controls the simulation of a physics scene and entities.
     AIController* _aiController;                // Controls AI simulation.
+    JobScheduler* _jobScheduler;                // Runs jobs on worker threads.
+    AssetLoader* _assetLoader;                  // Loads assets in the background.
     AudioListener* _audioListener;              // The audio listener in 3D space.
     std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
     ScriptController* _scriptController;        // Controls the scripting engine.
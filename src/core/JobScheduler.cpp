@@ -0,0 +1,355 @@
+#include "../core/Base.h"
+#include "../core/JobScheduler.h"
+
+// Maximum number of worker threads.
+#define JOB_SCHEDULER_MAX_WORKERS 31
+
+namespace gplay
+{
+
+/**
+ * Index of the queue owned by the current thread, 0 for the main thread.
+ */
+static thread_local unsigned int __threadIndex = 0;
+
+class JobScheduler::Job
+{
+public:
+
+    JobFunction function;
+    Job* parent;
+    std::atomic<int> unfinished;    // 1 for the job itself + number of unfinished children
+    std::atomic<int> pending;       // number of unfinished dependencies + 1 until scheduled
+    std::atomic<bool> finished;
+    bool scheduled;
+    bool done;                      // protected by mutex, used to add dependencies safely
+    std::mutex mutex;
+    std::vector<Job*> dependents;
+};
+
+JobScheduler::JobScheduler()
+    : _queuedJobCount(0), _running(false)
+{
+}
+
+JobScheduler::~JobScheduler()
+{
+    finalize();
+}
+
+void JobScheduler::initialize()
+{
+    unsigned int workerCount = 0;
+#if !defined(EMSCRIPTEN)
+    unsigned int cores = std::thread::hardware_concurrency();
+    workerCount = cores > 1 ? std::min(cores - 1, (unsigned int)JOB_SCHEDULER_MAX_WORKERS) : 0;
+#endif
+
+    _queues.push_back(new WorkQueue());
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        _queues.push_back(new WorkQueue());
+    }
+
+    _running = true;
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        _threads.push_back(new std::thread(&workerThreadProc, this, i + 1));
+    }
+}
+
+void JobScheduler::finalize()
+{
+    if (_queues.empty())
+        return;
+
+    endFrame();
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _running = false;
+    }
+    _wakeCondition.notify_all();
+
+    for (size_t i = 0, count = _threads.size(); i < count; ++i)
+    {
+        _threads[i]->join();
+        SAFE_DELETE(_threads[i]);
+    }
+    _threads.clear();
+
+    for (size_t i = 0, count = _queues.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_queues[i]);
+    }
+    _queues.clear();
+
+    for (size_t i = 0, count = _freeJobs.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_freeJobs[i]);
+    }
+    _freeJobs.clear();
+}
+
+unsigned int JobScheduler::getThreadCount() const
+{
+    return (unsigned int)_threads.size() + 1;
+}
+
+JobScheduler::Job* JobScheduler::createJob(const JobFunction& function, Job* parent)
+{
+    Job* job = NULL;
+    {
+        std::lock_guard<std::mutex> lock(_jobsMutex);
+        if (_freeJobs.empty())
+        {
+            job = new Job();
+        }
+        else
+        {
+            job = _freeJobs.back();
+            _freeJobs.pop_back();
+        }
+        _jobs.push_back(job);
+    }
+
+    job->function = function;
+    job->parent = parent;
+    job->unfinished = 1;
+    job->pending = 1;
+    job->finished = false;
+    job->scheduled = false;
+    job->done = false;
+    job->dependents.clear();
+
+    if (parent)
+    {
+        GP_ASSERT(!parent->finished);
+        ++parent->unfinished;
+    }
+
+    return job;
+}
+
+void JobScheduler::addDependency(Job* job, Job* dependency)
+{
+    GP_ASSERT(job && dependency);
+    GP_ASSERT(!job->scheduled);
+
+    ++job->pending;
+
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if (dependency->done)
+    {
+        // Already finished, the job still holds its scheduling count so this can't reach zero.
+        --job->pending;
+    }
+    else
+    {
+        dependency->dependents.push_back(job);
+    }
+}
+
+void JobScheduler::run(Job* job)
+{
+    GP_ASSERT(job);
+    GP_ASSERT(!job->scheduled);
+
+    job->scheduled = true;
+    if (--job->pending == 0)
+    {
+        push(job);
+    }
+}
+
+bool JobScheduler::isFinished(const Job* job) const
+{
+    GP_ASSERT(job);
+    return job->finished;
+}
+
+void JobScheduler::wait(Job* job)
+{
+    GP_ASSERT(job);
+    GP_ASSERT(job->scheduled);
+
+    while (!job->finished)
+    {
+        Job* next = pop();
+        if (next)
+        {
+            execute(next);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobScheduler::parallelFor(unsigned int count, unsigned int grainSize, const RangeFunction& function)
+{
+    if (count == 0)
+        return;
+
+    if (grainSize == 0)
+        grainSize = 1;
+
+    if (_threads.empty() || count <= grainSize)
+    {
+        function(0, count);
+        return;
+    }
+
+    Job* root = createJob(JobFunction());
+    for (unsigned int start = 0; start < count; start += grainSize)
+    {
+        unsigned int end = std::min(start + grainSize, count);
+        run(createJob([&function, start, end]() { function(start, end); }, root));
+    }
+    run(root);
+    wait(root);
+}
+
+void JobScheduler::endFrame()
+{
+    // Jobs may create other jobs while we wait for them.
+    for (size_t i = 0; ; ++i)
+    {
+        Job* job = NULL;
+        {
+            std::lock_guard<std::mutex> lock(_jobsMutex);
+            if (i >= _jobs.size())
+                break;
+            job = _jobs[i];
+        }
+
+        if (job->scheduled)
+        {
+            wait(job);
+        }
+        else
+        {
+            GP_WARN("Job created but never scheduled.");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_jobsMutex);
+    for (size_t i = 0, count = _jobs.size(); i < count; ++i)
+    {
+        Job* job = _jobs[i];
+        job->function = JobFunction();
+        _freeJobs.push_back(job);
+    }
+    _jobs.clear();
+}
+
+void JobScheduler::push(Job* job)
+{
+    GP_ASSERT(__threadIndex < _queues.size());
+
+    WorkQueue* queue = _queues[__threadIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(job);
+    }
+    ++_queuedJobCount;
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wakeCondition.notify_one();
+}
+
+JobScheduler::Job* JobScheduler::pop()
+{
+    const unsigned int queueCount = (unsigned int)_queues.size();
+    const unsigned int index = __threadIndex;
+
+    // Most recent job of our own queue first.
+    WorkQueue* queue = _queues[index];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            Job* job = queue->jobs.back();
+            queue->jobs.pop_back();
+            --_queuedJobCount;
+            return job;
+        }
+    }
+
+    // Then steal the oldest job of another queue.
+    for (unsigned int i = 1; i < queueCount; ++i)
+    {
+        WorkQueue* victim = _queues[(index + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->jobs.empty())
+        {
+            Job* job = victim->jobs.front();
+            victim->jobs.pop_front();
+            --_queuedJobCount;
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+void JobScheduler::execute(Job* job)
+{
+    if (job->function)
+    {
+        job->function();
+    }
+    finish(job);
+}
+
+void JobScheduler::finish(Job* job)
+{
+    if (--job->unfinished != 0)
+        return;
+
+    std::vector<Job*> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done = true;
+        dependents.swap(job->dependents);
+    }
+
+    for (size_t i = 0, count = dependents.size(); i < count; ++i)
+    {
+        if (--dependents[i]->pending == 0)
+        {
+            push(dependents[i]);
+        }
+    }
+
+    if (job->parent)
+    {
+        finish(job->parent);
+    }
+
+    // Last access to the job: once finished it may be recycled.
+    job->finished = true;
+}
+
+void JobScheduler::workerThreadProc(JobScheduler* scheduler, unsigned int index)
+{
+    __threadIndex = index;
+
+    while (scheduler->_running)
+    {
+        Job* job = scheduler->pop();
+        if (job)
+        {
+            scheduler->execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(scheduler->_sleepMutex);
+        scheduler->_wakeCondition.wait(lock, [scheduler]() { return scheduler->_queuedJobCount > 0 || !scheduler->_running; });
+    }
+}
+
+}
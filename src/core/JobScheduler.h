@@ -0,0 +1,175 @@
+#ifndef JOBSCHEDULER_H_
+#define JOBSCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+namespace gplay
+{
+
+/**
+ * Defines a work-stealing job scheduler that runs jobs on a pool of worker threads.
+ *
+ * Each worker thread, and the main thread, owns a queue of jobs. A thread runs the
+ * jobs it scheduled itself most recent first, and steals the oldest jobs of the
+ * other threads when its own queue is empty. A thread waiting for a job keeps
+ * running other jobs meanwhile, so jobs can be scheduled and waited from jobs.
+ *
+ * Jobs can have a parent, that only finishes once all its children finished, and
+ * dependencies, which must all have finished before the job starts. Jobs are owned
+ * by the scheduler and are valid until the end of the frame they were created in.
+ *
+ * The scheduler is accessed with Game::getJobScheduler().
+ */
+class JobScheduler
+{
+    friend class Game;
+
+public:
+
+    /**
+     * A unit of work. Opaque handle.
+     */
+    class Job;
+
+    /**
+     * Function run by a job.
+     */
+    typedef std::function<void()> JobFunction;
+
+    /**
+     * Function run by parallelFor() on the [start, end) sub range of a range.
+     */
+    typedef std::function<void(unsigned int start, unsigned int end)> RangeFunction;
+
+    /**
+     * Creates a job. The job does not start until run() is called for it.
+     *
+     * @param function The function to run.
+     * @param parent An optional parent job. The parent is not finished until this job finishes.
+     *
+     * @return The new job.
+     */
+    Job* createJob(const JobFunction& function, Job* parent = NULL);
+
+    /**
+     * Adds a dependency edge: job will not start before dependency has finished.
+     *
+     * Must be called before run() is called for job.
+     *
+     * @param job The dependent job.
+     * @param dependency The job to wait for.
+     */
+    void addDependency(Job* job, Job* dependency);
+
+    /**
+     * Schedules a job. The job starts as soon as all its dependencies have finished.
+     *
+     * @param job The job to run.
+     */
+    void run(Job* job);
+
+    /**
+     * Waits for a job and all its children to finish, running other jobs meanwhile.
+     *
+     * @param job The job to wait for.
+     */
+    void wait(Job* job);
+
+    /**
+     * Determines if a job and all its children have finished.
+     *
+     * @param job The job.
+     *
+     * @return true if the job has finished, false otherwise.
+     */
+    bool isFinished(const Job* job) const;
+
+    /**
+     * Splits the range [0, count) in sub ranges of at most grainSize elements,
+     * runs the function on each of them in parallel and waits for completion.
+     *
+     * @param count The number of elements in the range.
+     * @param grainSize The maximum number of elements processed by one job.
+     * @param function The function to run on each sub range.
+     */
+    void parallelFor(unsigned int count, unsigned int grainSize, const RangeFunction& function);
+
+    /**
+     * Returns the number of threads running jobs, including the main thread.
+     *
+     * @return The number of threads.
+     */
+    unsigned int getThreadCount() const;
+
+private:
+
+    /**
+     * Queue of jobs owned by one thread.
+     */
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job*> jobs;
+    };
+
+    /**
+     * Constructor.
+     */
+    JobScheduler();
+
+    /**
+     * Destructor.
+     */
+    ~JobScheduler();
+
+    /**
+     * Hidden copy constructor.
+     */
+    JobScheduler(const JobScheduler& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    JobScheduler& operator=(const JobScheduler&);
+
+    /**
+     * Starts the worker threads.
+     */
+    void initialize();
+
+    /**
+     * Waits for the scheduled jobs and stops the worker threads.
+     */
+    void finalize();
+
+    /**
+     * Waits for the jobs of the frame and recycles them.
+     */
+    void endFrame();
+
+    void push(Job* job);
+
+    Job* pop();
+
+    void execute(Job* job);
+
+    void finish(Job* job);
+
+    static void workerThreadProc(JobScheduler* scheduler, unsigned int index);
+
+    std::vector<std::thread*> _threads;
+    std::vector<WorkQueue*> _queues;
+    std::vector<Job*> _jobs;
+    std::vector<Job*> _freeJobs;
+    std::mutex _jobsMutex;
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeCondition;
+    std::atomic<int> _queuedJobCount;
+    std::atomic<bool> _running;
+};
+
+}
+
+#endif
@@ -1,11 +1,18 @@
 #include "../core/Base.h"
 #include "../core/Properties.h"
 #include "../core/FileSystem.h"
+#include "../core/StringHash.h"
 #include "../math/Quaternion.h"
 
+// Version of the compiled properties files, written by gplay-encoder.
+#define PROPERTIES_BINARY_VERSION 1
+
 namespace gplay
 {
 
+// Identifier of the compiled properties files.
+static const char __binaryIdentifier[] = { '\xAB', 'G', 'P', 'P', '\xBB', '\r', '\n', '\x1A', '\n' };
+
 /**
  * Reads the next character from the stream. Returns EOF if the end of the stream is reached.
  */
@@ -25,13 +32,19 @@ void calculateNamespacePath(const std::string& urlString, std::string& fileStrin
 /** @script{ignore} */
 Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
+Properties::Property::Property(const char* name, const char* value)
+    : name(name), value(value), hash(hashString(name))
+{
+}
+
 Properties::Properties()
-    : _variables(NULL), _dirPath(NULL), _visited(false), _parent(NULL)
+    : _namespaceHash(""_hash), _idHash(""_hash), _variables(NULL), _indexedPropertyCount(0), _indexedNamespaceCount(0), _dirPath(NULL), _visited(false), _parent(NULL)
 {
 }
 
 Properties::Properties(const Properties& copy)
-    : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _properties(copy._properties), _variables(NULL), _dirPath(NULL), _visited(false), _parent(copy._parent)
+    : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _namespaceHash(copy._namespaceHash), _idHash(copy._idHash),
+      _properties(copy._properties), _variables(NULL), _indexedPropertyCount(0), _indexedNamespaceCount(0), _dirPath(NULL), _visited(false), _parent(copy._parent)
 {
     setDirectoryPath(copy._dirPath);
     _namespaces = std::vector<Properties*>();
@@ -45,18 +58,19 @@ Properties::Properties(const Properties& copy)
 }
 
 Properties::Properties(Stream* stream)
-    : _variables(NULL), _dirPath(NULL), _visited(false), _parent(NULL)
+    : _namespaceHash(""_hash), _idHash(""_hash), _variables(NULL), _indexedPropertyCount(0), _indexedNamespaceCount(0), _dirPath(NULL), _visited(false), _parent(NULL)
 {
     readProperties(stream);
     rewind();
 }
 
 Properties::Properties(Stream* stream, const char* name, const char* id, const char* parentID, Properties* parent)
-    : _namespace(name), _variables(NULL), _dirPath(NULL), _visited(false), _parent(parent)
+    : _namespace(name), _namespaceHash(hashString(name)), _idHash(""_hash), _variables(NULL), _indexedPropertyCount(0), _indexedNamespaceCount(0), _dirPath(NULL), _visited(false), _parent(parent)
 {
     if (id)
     {
         _id = id;
+        _idHash = hashString(id);
     }
     if (parentID)
     {
@@ -87,7 +101,28 @@ Properties* Properties::create(const char* url)
         return NULL;
     }
 
-    Properties* properties = new Properties(stream.get());
+    // Compiled files are identified by their first bytes, other files are parsed as text.
+    Properties* properties;
+    char identifier[sizeof(__binaryIdentifier)];
+    if (stream->read(identifier, 1, sizeof(identifier)) == sizeof(identifier) &&
+        memcmp(identifier, __binaryIdentifier, sizeof(identifier)) == 0)
+    {
+        properties = readBinary(stream.get());
+        if (properties == NULL)
+        {
+            GP_WARN("Failed to read compiled properties file '%s'.", fileString.c_str());
+            return NULL;
+        }
+    }
+    else
+    {
+        if (!stream->rewind())
+        {
+            GP_WARN("Failed to rewind file '%s'.", fileString.c_str());
+            return NULL;
+        }
+        properties = new Properties(stream.get());
+    }
     properties->resolveInheritance();
     stream->close();
 
@@ -378,6 +413,152 @@ void Properties::readProperties(Stream* stream)
     }
 }
 
+/**
+ * Reads an unsigned int of a compiled properties file.
+ */
+static unsigned int readUInt(const char* data)
+{
+    unsigned int value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+Properties* Properties::readBinary(Stream* stream)
+{
+    GP_ASSERT(stream);
+
+    const long int position = stream->position();
+    if (position < 0 || (size_t)position > stream->length())
+    {
+        GP_ERROR("Invalid position in compiled properties file.");
+        return NULL;
+    }
+    const size_t size = stream->length() - (size_t)position;
+
+    // Use the memory of mapped files directly, read the others at once.
+    const char* data = (const char*)stream->getData();
+    if (data)
+        return readBinary(data + position, size);
+
+    std::unique_ptr<char[]> buffer(new char[size]);
+    if (stream->read(buffer.get(), 1, size) != size)
+    {
+        GP_ERROR("Failed to read compiled properties file.");
+        return NULL;
+    }
+    return readBinary(buffer.get(), size);
+}
+
+Properties* Properties::readBinary(const char* data, size_t size)
+{
+    GP_ASSERT(data);
+
+    // Header: version, size of the string table, number of namespaces, properties and variables.
+    const size_t headerSize = 5 * sizeof(unsigned int);
+    const size_t namespaceSize = 8 * sizeof(unsigned int);
+    const size_t propertySize = 3 * sizeof(unsigned int);
+    if (size < headerSize || readUInt(data) != PROPERTIES_BINARY_VERSION)
+    {
+        GP_ERROR("Unsupported compiled properties version.");
+        return NULL;
+    }
+    const unsigned int stringTableSize = readUInt(data + 4);
+    const unsigned int namespaceCount = readUInt(data + 8);
+    const unsigned int propertyCount = readUInt(data + 12);
+    const unsigned int variableCount = readUInt(data + 16);
+    if (stringTableSize == 0 || namespaceCount == 0 ||
+        size != headerSize + stringTableSize + namespaceCount * namespaceSize + ((size_t)propertyCount + variableCount) * propertySize)
+    {
+        GP_ERROR("Invalid compiled properties size.");
+        return NULL;
+    }
+    const char* strings = data + headerSize;
+    const char* namespaces = strings + stringTableSize;
+    const char* properties = namespaces + namespaceCount * namespaceSize;
+    const char* variables = properties + propertyCount * propertySize;
+    if (strings[stringTableSize - 1] != 0)
+    {
+        GP_ERROR("Invalid compiled properties string table.");
+        return NULL;
+    }
+
+    // Namespaces are stored parents first, the root namespace being the first one. Each one has
+    // its parent index, name, id and parent id offsets, name and id hashes and its property range.
+    std::vector<Properties*> spaces(namespaceCount, (Properties*)NULL);
+    bool valid = true;
+    for (unsigned int i = 0; i < namespaceCount && valid; ++i)
+    {
+        const char* record = namespaces + i * namespaceSize;
+        const unsigned int parent = readUInt(record);
+        const unsigned int name = readUInt(record + 4);
+        const unsigned int id = readUInt(record + 8);
+        const unsigned int parentID = readUInt(record + 12);
+        const unsigned int firstProperty = readUInt(record + 24);
+        const unsigned int count = readUInt(record + 28);
+        if ((i > 0 && parent >= i) || name >= stringTableSize || id >= stringTableSize || parentID >= stringTableSize ||
+            firstProperty > propertyCount || count > propertyCount - firstProperty)
+        {
+            valid = false;
+            break;
+        }
+
+        Properties* space = new Properties();
+        space->_namespace = strings + name;
+        space->_id = strings + id;
+        space->_parentID = strings + parentID;
+        space->_namespaceHash = readUInt(record + 16);
+        space->_idHash = readUInt(record + 20);
+        spaces[i] = space;
+        if (i > 0)
+        {
+            space->_parent = spaces[parent];
+            spaces[parent]->_namespaces.push_back(space);
+        }
+
+        // Properties: name hash, name and value offsets.
+        for (unsigned int j = firstProperty; j < firstProperty + count; ++j)
+        {
+            const char* property = properties + j * propertySize;
+            const unsigned int propertyName = readUInt(property + 4);
+            const unsigned int value = readUInt(property + 8);
+            if (propertyName >= stringTableSize || value >= stringTableSize)
+            {
+                valid = false;
+                break;
+            }
+            space->_properties.push_back(Property(strings + propertyName, strings + value, readUInt(property)));
+        }
+    }
+
+    // Variables: namespace index, name and value offsets, in the order they are assigned in the text.
+    for (unsigned int i = 0; i < variableCount && valid; ++i)
+    {
+        const char* variable = variables + i * propertySize;
+        const unsigned int space = readUInt(variable);
+        const unsigned int name = readUInt(variable + 4);
+        const unsigned int value = readUInt(variable + 8);
+        if (space >= namespaceCount || name >= stringTableSize || value >= stringTableSize)
+        {
+            valid = false;
+            break;
+        }
+        spaces[space]->setVariable(strings + name, strings + value);
+    }
+
+    if (!valid)
+    {
+        GP_ERROR("Invalid compiled properties data.");
+        SAFE_DELETE(spaces[0]);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < namespaceCount; ++i)
+    {
+        spaces[i]->rewind();
+    }
+    return spaces[0];
+}
+
 Properties::~Properties()
 {
     SAFE_DELETE(_dirPath);
@@ -478,6 +659,7 @@ void Properties::resolveInheritance(const char* id)
                 // Copy data from the parent into the child.
                 derived->_properties = parent->_properties;
                 derived->_namespaces = std::vector<Properties*>();
+                derived->clearIndexes();
                 std::vector<Properties*>::const_iterator itt;
                 for (itt = parent->_namespaces.begin(); itt < parent->_namespaces.end(); ++itt)
                 {
@@ -604,22 +786,37 @@ Properties* Properties::getNamespace(const char* id, bool searchNames, bool recu
 {
     GP_ASSERT(id);
 
-    for (std::vector<Properties*>::const_iterator it = _namespaces.begin(); it < _namespaces.end(); ++it)
+    return findNamespace(id, hashString(id), searchNames, recurse);
+}
+
+Properties* Properties::findNamespace(const char* id, unsigned int hash, bool searchNames, bool recurse) const
+{
+    updateNamespaceIndex();
+
+    // First direct child with this id or name.
+    const std::unordered_multimap<unsigned int, size_t>& index = searchNames ? _namespaceNameIndex : _namespaceIdIndex;
+    const size_t count = _namespaces.size();
+    size_t first = count;
+    std::pair<std::unordered_multimap<unsigned int, size_t>::const_iterator, std::unordered_multimap<unsigned int, size_t>::const_iterator> range = index.equal_range(hash);
+    for (std::unordered_multimap<unsigned int, size_t>::const_iterator it = range.first; it != range.second; ++it)
+    {
+        const Properties* p = _namespaces[it->second];
+        if (it->second < first && strcmp(searchNames ? p->_namespace.c_str() : p->_id.c_str(), id) == 0)
+            first = it->second;
+    }
+
+    if (recurse)
     {
-        Properties* p = *it;
-        if (strcmp(searchNames ? p->_namespace.c_str() : p->_id.c_str(), id) == 0)
-            return p;
-        
-        if (recurse)
+        // Namespaces nested in the children before the first match are found first.
+        for (size_t i = 0; i < first; ++i)
         {
-            // Search recursively.
-            p = p->getNamespace(id, searchNames, true);
+            Properties* p = _namespaces[i]->findNamespace(id, hash, searchNames, true);
             if (p)
                 return p;
         }
     }
 
-    return NULL;
+    return first < count ? _namespaces[first] : NULL;
 }
 
 const char* Properties::getNamespace() const
@@ -637,13 +834,62 @@ bool Properties::exists(const char* name) const
     if (name == NULL)
         return false;
 
-    for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+    return findProperty(name) != NULL;
+}
+
+Properties::Property* Properties::findProperty(const char* name) const
+{
+    GP_ASSERT(name);
+
+    updatePropertyIndex();
+    std::pair<std::unordered_multimap<unsigned int, Property*>::const_iterator, std::unordered_multimap<unsigned int, Property*>::const_iterator> range = _propertyIndex.equal_range(hashString(name));
+    for (std::unordered_multimap<unsigned int, Property*>::const_iterator itr = range.first; itr != range.second; ++itr)
     {
-        if (itr->name == name)
-            return true;
+        if (itr->second->name == name)
+            return itr->second;
     }
 
-    return false;
+    return NULL;
+}
+
+void Properties::updatePropertyIndex() const
+{
+    if (_indexedPropertyCount == _properties.size())
+        return;
+
+    // Properties are only appended, index the new ones. The index holds the first property of each name.
+    std::list<Property>& properties = const_cast<std::list<Property>&>(_properties);
+    std::list<Property>::iterator itr = properties.end();
+    std::advance(itr, -(long)(properties.size() - _indexedPropertyCount));
+    for (; itr != properties.end(); ++itr)
+    {
+        bool indexed = false;
+        std::pair<std::unordered_multimap<unsigned int, Property*>::iterator, std::unordered_multimap<unsigned int, Property*>::iterator> range = _propertyIndex.equal_range(itr->hash);
+        for (std::unordered_multimap<unsigned int, Property*>::iterator i = range.first; i != range.second && !indexed; ++i)
+            indexed = i->second->name == itr->name;
+        if (!indexed)
+            _propertyIndex.insert(std::make_pair(itr->hash, &*itr));
+    }
+    _indexedPropertyCount = _properties.size();
+}
+
+void Properties::updateNamespaceIndex() const
+{
+    for (size_t i = _indexedNamespaceCount, count = _namespaces.size(); i < count; ++i)
+    {
+        _namespaceIdIndex.insert(std::make_pair(_namespaces[i]->_idHash, i));
+        _namespaceNameIndex.insert(std::make_pair(_namespaces[i]->_namespaceHash, i));
+    }
+    _indexedNamespaceCount = _namespaces.size();
+}
+
+void Properties::clearIndexes()
+{
+    _propertyIndex.clear();
+    _indexedPropertyCount = 0;
+    _namespaceIdIndex.clear();
+    _namespaceNameIndex.clear();
+    _indexedNamespaceCount = 0;
 }
 
 static const bool isStringNumeric(const char* str)
@@ -727,14 +973,9 @@ const char* Properties::getString(const char* name, const char* defaultValue) co
             return getVariable(variable, defaultValue);
         }
 
-        for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
-        {
-            if (itr->name == name)
-            {
-                value = itr->value.c_str();
-                break;
-            }
-        }
+        const Property* property = findProperty(name);
+        if (property)
+            value = property->value.c_str();
     }
     else
     {
@@ -761,14 +1002,12 @@ bool Properties::setString(const char* name, const char* value)
 {
     if (name)
     {
-        for (std::list<Property>::iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+        // Update the first property that matches this name
+        Property* property = findProperty(name);
+        if (property)
         {
-            if (itr->name == name)
-            {
-                // Update the first property that matches this name
-                itr->value = value ? value : "";
-                return true;
-            }
+            property->value = value ? value : "";
+            return true;
         }
 
         // There is no property with this name, so add one
@@ -1013,6 +1252,8 @@ Properties* Properties::clone()
     p->_namespace = _namespace;
     p->_id = _id;
     p->_parentID = _parentID;
+    p->_namespaceHash = _namespaceHash;
+    p->_idHash = _idHash;
     p->_properties = _properties;
     p->_propertiesItr = p->_properties.end();
     p->setDirectoryPath(_dirPath);
@@ -122,6 +122,12 @@ class Properties;
  * modified to do so.  Also note that nothing in a properties file indicates the type
  * of a property. If the type is unknown, its string can be retrieved and interpreted
  * as necessary.
+ *
+ * Properties files can also be compiled to a binary form by gplay-encoder (a string table,
+ * the flat arrays of the namespaces, properties and variables, and the hashes of their
+ * names), which create() detects from its identifier and loads with a single read instead
+ * of parsing the text. Keep the text files for authoring and ship the compiled ones under
+ * the same name.
  */
 class Properties
 {
@@ -515,7 +521,9 @@ private:
     {
         std::string name;
         std::string value;
-        Property(const char* name, const char* value) : name(name), value(value) { }
+        unsigned int hash;
+        Property(const char* name, const char* value);
+        Property(const char* name, const char* value, unsigned int hash) : name(name), value(value), hash(hash) { }
     };
 
     /**
@@ -540,6 +548,42 @@ private:
 
     void readProperties(Stream* stream);
 
+    /**
+     * Creates the namespaces of a compiled properties file, read after its identifier.
+     *
+     * @return The root namespace, or NULL if the data is invalid.
+     */
+    static Properties* readBinary(Stream* stream);
+
+    static Properties* readBinary(const char* data, size_t size);
+
+    /**
+     * Finds the first property with a name through the hash index of the properties.
+     *
+     * @return The property, or NULL if there is no property with this name.
+     */
+    Property* findProperty(const char* name) const;
+
+    /**
+     * Finds the first namespace with an id or name through the hash indexes of the namespaces.
+     */
+    Properties* findNamespace(const char* id, unsigned int hash, bool searchNames, bool recurse) const;
+
+    /**
+     * Adds the properties added since the last update to the property index.
+     */
+    void updatePropertyIndex() const;
+
+    /**
+     * Adds the namespaces added since the last update to the namespace indexes.
+     */
+    void updateNamespaceIndex() const;
+
+    /**
+     * Clears the indexes after the properties or namespaces were replaced.
+     */
+    void clearIndexes();
+
     void setDirectoryPath(const std::string* path);
 
     void setDirectoryPath(const std::string& path);
@@ -558,11 +602,19 @@ private:
     std::string _namespace;
     std::string _id;
     std::string _parentID;
+    unsigned int _namespaceHash;
+    unsigned int _idHash;
     std::list<Property> _properties;
     std::list<Property>::iterator _propertiesItr;
     std::vector<Properties*> _namespaces;
     std::vector<Properties*>::const_iterator _namespacesItr;
     std::vector<Property>* _variables;
+    // First property of each name and namespace positions by hash, updated on lookup.
+    mutable std::unordered_multimap<unsigned int, Property*> _propertyIndex;
+    mutable size_t _indexedPropertyCount;
+    mutable std::unordered_multimap<unsigned int, size_t> _namespaceIdIndex;
+    mutable std::unordered_multimap<unsigned int, size_t> _namespaceNameIndex;
+    mutable size_t _indexedNamespaceCount;
     std::string* _dirPath;
     bool _visited;
     Properties* _parent;
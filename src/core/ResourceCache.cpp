@@ -0,0 +1,222 @@
+#include "../core/Base.h"
+#include "../core/ResourceCache.h"
+#include "../core/Game.h"
+#include "../core/StringHash.h"
+
+namespace gplay
+{
+
+/**
+ * A cached resource.
+ */
+struct ResourceCacheEntry
+{
+    std::string key;
+    Ref* resource;
+    size_t memory;
+    bool retained;
+    unsigned int lastUse;
+};
+
+typedef std::unordered_multimap<uint32_t, ResourceCacheEntry> ResourceCacheMap;
+
+static ResourceCacheMap __resources[ResourceCache::TYPE_COUNT];
+static ResourceCache::Stats __stats[ResourceCache::TYPE_COUNT] =
+{
+    { 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0 },
+};
+static unsigned int __useCount = 0;
+
+static ResourceCacheEntry* findEntry(ResourceCache::Type type, const char* key, Ref* resource)
+{
+    std::pair<ResourceCacheMap::iterator, ResourceCacheMap::iterator> range = __resources[type].equal_range(hashString(key));
+    for (ResourceCacheMap::iterator itr = range.first; itr != range.second; ++itr)
+    {
+        if ((resource == NULL || itr->second.resource == resource) && itr->second.key == key)
+            return &itr->second;
+    }
+    return NULL;
+}
+
+Ref* ResourceCache::find(Type type, const char* key)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+    GP_ASSERT(key);
+
+    ResourceCacheEntry* entry = findEntry(type, key, NULL);
+    if (entry == NULL)
+    {
+        ++__stats[type].misses;
+        return NULL;
+    }
+    ++__stats[type].hits;
+    entry->lastUse = ++__useCount;
+    return entry->resource;
+}
+
+void ResourceCache::add(Type type, const char* key, Ref* resource, size_t memory)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+    GP_ASSERT(key);
+    GP_ASSERT(resource);
+    GP_ASSERT(findEntry(type, key, NULL) == NULL);
+
+    ResourceCacheEntry entry;
+    entry.key = key;
+    entry.resource = resource;
+    entry.memory = memory;
+    entry.retained = __stats[type].budget > 0;
+    entry.lastUse = ++__useCount;
+    __resources[type].insert(std::make_pair(hashString(key), entry));
+
+    Stats& stats = __stats[type];
+    ++stats.count;
+    stats.memory += memory;
+
+    if (entry.retained)
+    {
+        resource->addRef();
+        trim(type);
+    }
+}
+
+void ResourceCache::remove(Type type, const char* key, Ref* resource)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+    GP_ASSERT(key);
+
+    std::pair<ResourceCacheMap::iterator, ResourceCacheMap::iterator> range = __resources[type].equal_range(hashString(key));
+    for (ResourceCacheMap::iterator itr = range.first; itr != range.second; ++itr)
+    {
+        if (itr->second.resource == resource)
+        {
+            // A retained resource is only destroyed once the cache released it.
+            GP_ASSERT(!itr->second.retained);
+            Stats& stats = __stats[type];
+            --stats.count;
+            stats.memory -= itr->second.memory;
+            __resources[type].erase(itr);
+            return;
+        }
+    }
+}
+
+void ResourceCache::setMemory(Type type, const char* key, Ref* resource, size_t memory)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+    GP_ASSERT(key);
+
+    ResourceCacheEntry* entry = findEntry(type, key, resource);
+    if (entry)
+    {
+        Stats& stats = __stats[type];
+        stats.memory = stats.memory - entry->memory + memory;
+        entry->memory = memory;
+        if (entry->retained)
+            trim(type);
+    }
+}
+
+void ResourceCache::setBudget(Type type, size_t budget)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+
+    __stats[type].budget = budget;
+    if (budget == 0)
+    {
+        // Stop keeping the resources, the unused ones are released.
+        std::vector<Ref*> released;
+        for (ResourceCacheMap::iterator itr = __resources[type].begin(); itr != __resources[type].end(); ++itr)
+        {
+            if (itr->second.retained)
+            {
+                itr->second.retained = false;
+                released.push_back(itr->second.resource);
+            }
+        }
+        for (size_t i = 0, count = released.size(); i < count; ++i)
+        {
+            released[i]->release();
+        }
+    }
+    else
+    {
+        trim(type);
+    }
+}
+
+size_t ResourceCache::getBudget(Type type)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+    return __stats[type].budget;
+}
+
+void ResourceCache::trim(Type type, bool all)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+
+    Stats& stats = __stats[type];
+    if (!all && stats.memory <= stats.budget)
+        return;
+
+    // Release the unused resources, least recently used first.
+    std::vector<ResourceCacheEntry*> unused;
+    for (ResourceCacheMap::iterator itr = __resources[type].begin(); itr != __resources[type].end(); ++itr)
+    {
+        if (itr->second.retained && itr->second.resource->getRefCount() == 1)
+            unused.push_back(&itr->second);
+    }
+    std::sort(unused.begin(), unused.end(), [](const ResourceCacheEntry* a, const ResourceCacheEntry* b)
+    {
+        return a->lastUse < b->lastUse;
+    });
+
+    for (size_t i = 0, count = unused.size(); i < count && (all || stats.memory > stats.budget); ++i)
+    {
+        // The resource removes its entry when it is destroyed.
+        Ref* resource = unused[i]->resource;
+        unused[i]->retained = false;
+        ++stats.evictions;
+        resource->release();
+    }
+}
+
+ResourceCache::Stats ResourceCache::getStats(Type type)
+{
+    GP_ASSERT(type < TYPE_COUNT);
+
+    Stats stats = __stats[type];
+    stats.unusedCount = 0;
+    for (ResourceCacheMap::const_iterator itr = __resources[type].begin(); itr != __resources[type].end(); ++itr)
+    {
+        if (itr->second.retained && itr->second.resource->getRefCount() == 1)
+            ++stats.unusedCount;
+    }
+    return stats;
+}
+
+void ResourceCache::initialize()
+{
+    Properties* config = Game::getInstance()->getConfig()->getNamespace("resourceCache", true);
+    if (config)
+    {
+        static const char* budgetNames[TYPE_COUNT] = { "textureBudget", "effectBudget", "materialBudget" };
+        for (int i = 0; i < TYPE_COUNT; ++i)
+        {
+            if (config->exists(budgetNames[i]))
+                setBudget((Type)i, (size_t)std::max(config->getInt(budgetNames[i]), 0) * 1024);
+        }
+    }
+}
+
+void ResourceCache::finalize()
+{
+    // Materials reference effects and textures, release them first.
+    setBudget(MATERIAL, 0);
+    setBudget(EFFECT, 0);
+    setBudget(TEXTURE, 0);
+}
+
+}
@@ -0,0 +1,166 @@
+#ifndef RESOURCECACHE_H_
+#define RESOURCECACHE_H_
+
+#include "../core/Ref.h"
+
+namespace gplay
+{
+
+/**
+ * Defines the cache of the resources loaded from files, shared by the engine.
+ *
+ * Resources are indexed by the hash of their key (usually the path they were loaded
+ * from), so that finding a resource doesn't depend on the number of resources loaded.
+ *
+ * Each resource type has a memory budget. With a budget of zero, a resource stays in the
+ * cache as long as it is used and is removed when its last reference is released. With a
+ * budget, the cache keeps its own reference to the resources so that unused resources
+ * can be found again without being reloaded, and releases the least recently used unused
+ * resources when the memory of the type exceeds the budget.
+ *
+ * Budgets are read from the 'resourceCache' namespace of the game config, in kilobytes:
+ *
+ * @verbatim
+    resourceCache
+    {
+        textureBudget = 65536
+        materialBudget = 1024
+    }
+   @endverbatim
+ *
+ * All budgets are zero unless configured. Materials are cached as prototypes that
+ * Material::create() clones, and are only cached with a budget, so that by default each
+ * created material is loaded from its file and the effects and textures it uses are
+ * released with it. The memory of effects is not known, with a budget unused effects are
+ * kept until they are trimmed.
+ */
+class ResourceCache
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Types of the cached resources.
+     */
+    enum Type
+    {
+        TEXTURE,
+        EFFECT,
+        MATERIAL,
+        TYPE_COUNT
+    };
+
+    /**
+     * Statistics of the resources of a type.
+     */
+    struct Stats
+    {
+        /** Number of resources in the cache. */
+        unsigned int count;
+        /** Number of resources only used by the cache. */
+        unsigned int unusedCount;
+        /** Memory used by the resources, in bytes. */
+        size_t memory;
+        /** Memory budget of the resources, in bytes, or 0 if unused resources are not kept. */
+        size_t budget;
+        /** Number of lookups that found a resource. */
+        unsigned int hits;
+        /** Number of lookups that didn't find a resource. */
+        unsigned int misses;
+        /** Number of unused resources released to fit the budget. */
+        unsigned int evictions;
+    };
+
+    /**
+     * Finds a resource.
+     *
+     * @param type The type of the resource.
+     * @param key The key of the resource.
+     *
+     * @return The resource, without an added reference, or NULL if it is not cached.
+     */
+    static Ref* find(Type type, const char* key);
+
+    /**
+     * Adds a resource, which must not be in the cache.
+     *
+     * If the type has a budget, the cache keeps a reference to the resource and releases
+     * unused resources until the memory fits the budget.
+     *
+     * @param type The type of the resource.
+     * @param key The key of the resource.
+     * @param resource The resource.
+     * @param memory The memory used by the resource, in bytes.
+     */
+    static void add(Type type, const char* key, Ref* resource, size_t memory);
+
+    /**
+     * Removes a resource, called by the resources when they are destroyed.
+     *
+     * @param type The type of the resource.
+     * @param key The key of the resource.
+     * @param resource The resource.
+     */
+    static void remove(Type type, const char* key, Ref* resource);
+
+    /**
+     * Updates the memory used by a cached resource.
+     *
+     * @param type The type of the resource.
+     * @param key The key of the resource.
+     * @param resource The resource.
+     * @param memory The memory used by the resource, in bytes.
+     */
+    static void setMemory(Type type, const char* key, Ref* resource, size_t memory);
+
+    /**
+     * Sets the memory budget of a type and releases the unused resources that exceed it.
+     *
+     * @param type The resource type.
+     * @param budget The budget, in bytes, or 0 to not keep unused resources.
+     */
+    static void setBudget(Type type, size_t budget);
+
+    /**
+     * Gets the memory budget of a type.
+     *
+     * @param type The resource type.
+     *
+     * @return The budget, in bytes, or 0 if unused resources are not kept.
+     */
+    static size_t getBudget(Type type);
+
+    /**
+     * Releases the unused resources of a type that exceed its budget.
+     *
+     * @param type The resource type.
+     * @param all True to release all the unused resources of the type.
+     */
+    static void trim(Type type, bool all = false);
+
+    /**
+     * Gets the statistics of a type.
+     *
+     * @param type The resource type.
+     *
+     * @return The statistics.
+     */
+    static Stats getStats(Type type);
+
+private:
+
+    /**
+     * Reads the budgets of the game config.
+     */
+    static void initialize();
+
+    /**
+     * Releases the references kept by the cache.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
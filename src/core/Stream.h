@@ -155,6 +155,33 @@ public:
      */
     virtual bool rewind() = 0;
 
+    /**
+     * Function releasing a reference acquired with retainData().
+     */
+    typedef void (*ReleaseDataFunction)(void* handle);
+
+    /**
+     * Returns the content of the stream when it is entirely in memory, such as a memory mapped file.
+     *
+     * The memory stays valid until the stream is destroyed, or until all the references
+     * acquired with retainData() are released.
+     *
+     * @return A pointer to the first byte of the stream, or NULL if the stream is not in memory.
+     */
+    virtual const void* getData() { return NULL; }
+
+    /**
+     * Acquires a reference that keeps the memory returned by getData() valid after the stream is destroyed.
+     *
+     * The reference is released by calling the returned function with the handle, which can be
+     * done from any thread (e.g. by the renderer once it is done with the data).
+     *
+     * @param handle The handle of the reference. (out param)
+     *
+     * @return The function releasing the reference, or NULL if the stream is not in memory.
+     */
+    virtual ReleaseDataFunction retainData(void** handle) { return NULL; }
+
 protected:
     Stream() {};
 private:
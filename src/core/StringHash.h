@@ -8,10 +8,10 @@
 ///----------------------------------------------------------------------------------------------------
 namespace detail
 {
-    // FNV-1a 32bit hashing algorithm.
+    // FNV-1a 32bit hashing algorithm, bytes are unsigned so that hashes don't depend on the platform.
     constexpr std::uint32_t fnv1a_32(char const* s, std::size_t count)
     {
-        return ((count ? fnv1a_32(s, count - 1) : 2166136261u) ^ s[count]) * 16777619u;
+        return ((count ? fnv1a_32(s, count - 1) : 2166136261u) ^ (unsigned char)s[count]) * 16777619u;
     }
 }
 
@@ -20,5 +20,19 @@ constexpr std::uint32_t operator"" _hash(char const* s, std::size_t count)
     return detail::fnv1a_32(s, count);
 }
 
+///----------------------------------------------------------------------------------------------------
+/// Runtime hash of null terminated strings, equal to the _hash of the same literal.
+///----------------------------------------------------------------------------------------------------
+inline std::uint32_t hashString(char const* s)
+{
+    std::uint32_t hash = 2166136261u;
+    do
+    {
+        hash = (hash ^ (unsigned char)*s) * 16777619u;
+    }
+    while (*s++);
+    return hash;
+}
+
 
 #endif // STRINGHASH_H
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
+
+#include "../events/EventPool.h"
 
 using EventDataRef = std::shared_ptr<class EventData>;
 using EventID = uint64_t;
@@ -13,13 +16,33 @@ public:
     typedef EventID id_t;
     virtual id_t getEventID() const = 0;
     virtual const char* getName() const = 0;    // used only for debug
+
+    //! events are stored in the event pool.
+    static void* operator new( size_t size ) { return EventPool::allocate( size ); }
+    static void operator delete( void* event, size_t size ) { EventPool::deallocate( event, size ); }
+
+    //! returns a new event type ID, event type IDs are numbered from 0 so that
+    //! listener tables can be indexed by event type.
+    static id_t newEventID()
+    {
+        static std::atomic<id_t> sNextID( 0 );
+        return sNextID.fetch_add( 1, std::memory_order_relaxed );
+    }
 };
 
 
+//! creates the ref of a new event, with its control block in the event pool.
+//! ex: return makeEventRef(new MyEvent(args));
+template<class T>
+inline std::shared_ptr<T> makeEventRef( T* event )
+{
+    return std::shared_ptr<T>( event, std::default_delete<T>(), EventPoolAllocator<T>() );
+}
+
+
 //! macro for automatic overriding needed methods in derived classes
 #define GP_DECLARE_EVENT(type) \
-    static EventData::id_t ID() { return reinterpret_cast<EventData::id_t>(&ID); } \
+    static EventData::id_t ID() { static const EventData::id_t id = EventData::newEventID(); return id; } \
     EventData::id_t getEventID() const override { return ID(); } \
     const char* getName() const override { return #type; } \
 
-
@@ -0,0 +1,55 @@
+#include "../core/Base.h"
+#include "../events/ConcurrentEventQueue.h"
+#include "../events/EventPool.h"
+
+ConcurrentEventQueue::ConcurrentEventQueue()
+{
+    // The queue always keeps the node of the last popped event, initially empty.
+    Node* stub = createNode();
+    mHead.store( stub, std::memory_order_relaxed );
+    mTail = stub;
+}
+
+ConcurrentEventQueue::~ConcurrentEventQueue()
+{
+    EventDataRef event;
+    while( pop( event ) )
+        event.reset();
+    destroyNode( mTail );
+}
+
+void ConcurrentEventQueue::push( const EventDataRef &event )
+{
+    Node* node = createNode();
+    node->mEvent = event;
+
+    Node* prev = mHead.exchange( node, std::memory_order_acq_rel );
+    prev->mNext.store( node, std::memory_order_release );
+}
+
+bool ConcurrentEventQueue::pop( EventDataRef &event )
+{
+    Node* tail = mTail;
+    Node* next = tail->mNext.load( std::memory_order_acquire );
+    if( next == nullptr )
+        return false;
+
+    event = std::move( next->mEvent );
+    next->mEvent.reset();
+    mTail = next;
+    destroyNode( tail );
+    return true;
+}
+
+ConcurrentEventQueue::Node* ConcurrentEventQueue::createNode()
+{
+    Node* node = new ( EventPool::allocate( sizeof(Node) ) ) Node;
+    node->mNext.store( nullptr, std::memory_order_relaxed );
+    return node;
+}
+
+void ConcurrentEventQueue::destroyNode( Node *node )
+{
+    node->~Node();
+    EventPool::deallocate( node, sizeof(Node) );
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+#include "../events/BaseEventData.h"
+
+//! Lock-free queue of events, filled by any number of threads and emptied by a
+//! single thread.
+//!
+//! Producers link their node at the head of the queue with a single atomic
+//! exchange, so posting an event never waits for other producers or for the
+//! consumer. Nodes are allocated from the event pool. A push is visible to the
+//! consumer once its node is linked, until then the queue may look empty.
+class ConcurrentEventQueue
+{
+public:
+
+    ConcurrentEventQueue();
+    ~ConcurrentEventQueue();
+
+    //! Adds an event at the end of the queue. This function is Thread Safe.
+    void push( const EventDataRef &event );
+
+    //! Removes the event at the front of the queue. Must only be called from the
+    //! consumer thread. Returns false if the queue is empty.
+    bool pop( EventDataRef &event );
+
+private:
+
+    struct Node
+    {
+        std::atomic<Node*> mNext;
+        EventDataRef mEvent;
+    };
+
+    ConcurrentEventQueue( const ConcurrentEventQueue & ) = delete;
+    ConcurrentEventQueue& operator=( const ConcurrentEventQueue & ) = delete;
+
+    static Node* createNode();
+    static void destroyNode( Node *node );
+
+    std::atomic<Node*> mHead;   // last node pushed, written by producers
+    Node* mTail;                // node preceding the front event, owned by the consumer
+};
@@ -6,9 +6,10 @@
 #define LOG_EVENT
 
 EventManager::EventManager( const std::string &name, bool setAsGlobal )
-    : EventManagerBase( name, setAsGlobal ), mActiveQueue( 0 )
+    : EventManagerBase( name, setAsGlobal ), mActiveQueue( 0 ), mThreadId( std::this_thread::get_id() )
 {
-
+    mThreadedEventListenerTables.emplace_back( new EventListenerTable() );
+    mThreadedEventListeners.store( mThreadedEventListenerTables.back().get() );
 }
 
 EventManagerRef EventManager::create( const std::string &name, bool setAsGlobal )
@@ -24,7 +25,8 @@ EventManager::~EventManager()
     mQueues[1].clear();
     GP_INFO( "Removing all threaded events" );
     std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
-    mThreadedEventListeners.clear();
+    mThreadedEventListeners.store( nullptr );
+    mThreadedEventListenerTables.clear();
     GP_INFO( "Removed ALL EVENT LISTENERS" );
 }
 
@@ -32,17 +34,17 @@ bool EventManager::addListener( const EventListenerDelegate &eventDelegate, cons
 {
     LOG_EVENT( "Attempting to add delegate function for event type: 0x%x", type);
 
+    if( type >= mEventListeners.size() )
+        mEventListeners.resize( type + 1 );
+
     auto & eventDelegateList = mEventListeners[type];
-    auto listenIt = eventDelegateList.begin();
-    auto end = eventDelegateList.end();
-    while ( listenIt != end )
+    for ( auto & delegate : eventDelegateList )
     {
-        if ( eventDelegate == (*listenIt) )
+        if ( eventDelegate == delegate )
         {
             GP_WARN("Attempting to double-register a delegate");
             return false;
         }
-        ++listenIt;
     }
     eventDelegateList.push_back(eventDelegate);
     GP_INFO("Successfully added delegate for event type: 0x%x", type);
@@ -52,24 +54,26 @@ bool EventManager::addListener( const EventListenerDelegate &eventDelegate, cons
 bool EventManager::removeListener( const EventListenerDelegate &eventDelegate, const EventID &type )
 {
     LOG_EVENT("Attempting to remove delegate function from event type: 0x%x", type);
-    bool success = false;
 
-    auto found = mEventListeners.find(type);
-    if( found != mEventListeners.end() )
+    if( type < mEventListeners.size() )
     {
-        auto & listeners = found->second;
+        auto & listeners = mEventListeners[type];
         for( auto listIt = listeners.begin(); listIt != listeners.end(); ++listIt )
         {
             if( eventDelegate == (*listIt) )
             {
                 listeners.erase(listIt);
                 LOG_EVENT("Successfully removed delegate function from event type: 0x%x", type);
-                success = true;
-                break;
+                return true;
             }
         }
     }
-    return success;
+    return false;
+}
+
+bool EventManager::hasListeners( const EventID &type ) const
+{
+    return type < mEventListeners.size() && ! mEventListeners[type].empty();
 }
 
 bool EventManager::triggerEvent( const EventDataRef &event )
@@ -77,17 +81,14 @@ bool EventManager::triggerEvent( const EventDataRef &event )
     LOG_EVENT("Attempting to trigger event: %s", event->getName());
     bool processed = false;
 
-    auto found = mEventListeners.find(event->getEventID());
-    if( found != mEventListeners.end() )
+    // Listeners may add or remove listeners, the tables are indexed again for each delegate.
+    const EventID type = event->getEventID();
+    for( size_t i = 0; type < mEventListeners.size() && i < mEventListeners[type].size(); ++i )
     {
-        const auto & eventListenerList = found->second;
-        for( auto listIt = eventListenerList.begin(); listIt != eventListenerList.end(); ++listIt )
-        {
-            auto& listener = (*listIt);
-            LOG_EVENT("Sending event %s to delegate.", event->getName());
-            listener( event );
-            processed = true;
-        }
+        EventListenerDelegate listener = mEventListeners[type][i];
+        LOG_EVENT("Sending event %s to delegate.", event->getName());
+        listener( event );
+        processed = true;
     }
 
     return processed;
@@ -101,12 +102,20 @@ bool EventManager::queueEvent( const EventDataRef &event )
     if( !event )
     {
         GP_ERROR("Invalid event in queueEvent");
+        return false;
+    }
+
+    // Events of other threads are checked for listeners when moved to the active queue.
+    if( std::this_thread::get_id() != mThreadId )
+    {
+        mPostedEvents.push( event );
+        LOG_EVENT("Successfully posted event: %s", event->getName());
+        return true;
     }
 
     LOG_EVENT("Attempting to queue event: %s", event->getName());
 
-    auto found = mEventListeners.find( event->getEventID() );
-    if( found != mEventListeners.end() )
+    if( hasListeners( event->getEventID() ) )
     {
         mQueues[mActiveQueue].push_back(event);
         LOG_EVENT("Successfully queued event: %s", event->getName());
@@ -124,28 +133,42 @@ bool EventManager::queueEvent( const EventDataRef &event )
     }
 }
 
+void EventManager::flushPostedEvents()
+{
+    auto & eventQueue = mQueues[mActiveQueue];
+    EventDataRef event;
+    while( mPostedEvents.pop( event ) )
+    {
+        if( hasListeners( event->getEventID() ) )
+            eventQueue.push_back( std::move(event) );
+        event.reset();
+    }
+}
+
 bool EventManager::abortEvent( const EventID &type, bool allOfType )
 {
-    GP_ASSERT(mActiveQueue >= 0);
-    GP_ASSERT(mActiveQueue > NUM_QUEUES);
+    GP_ASSERT(mActiveQueue < NUM_QUEUES);
 
-    bool success = false;
-    auto found = mEventListeners.find( type );
+    if( ! hasListeners( type ) )
+        return false;
+
+    flushPostedEvents();
 
-    if( found != mEventListeners.end() )
+    bool success = false;
+    auto & eventQueue = mQueues[mActiveQueue];
+    auto eventIt = eventQueue.begin();
+    while( eventIt != eventQueue.end() )
     {
-        auto & eventQueue = mQueues[mActiveQueue];
-        auto eventIt = eventQueue.begin();
-        auto end = eventQueue.end();
-        while( eventIt != end )
+        if( (*eventIt)->getEventID() == type )
         {
-            if( (*eventIt)->getEventID() == type )
-            {
-                eventIt = eventQueue.erase(eventIt);
-                success = true;
-                if( ! allOfType )
-                    break;
-            }
+            eventIt = eventQueue.erase(eventIt);
+            success = true;
+            if( ! allOfType )
+                break;
+        }
+        else
+        {
+            ++eventIt;
         }
     }
 
@@ -156,16 +179,25 @@ bool EventManager::addThreadedListener( const EventListenerDelegate &eventDelega
 {
     std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
 
-    auto & eventDelegateList = mThreadedEventListeners[type];
-    for ( auto & delegate : eventDelegateList )
+    const EventListenerTable* listeners = mThreadedEventListeners.load();
+    if( type < listeners->size() )
     {
-        if ( eventDelegate == delegate )
+        for ( auto & delegate : (*listeners)[type] )
         {
-            GP_WARN("Attempting to double-register a delegate");
-            return false;
+            if ( eventDelegate == delegate )
+            {
+                GP_WARN("Attempting to double-register a delegate");
+                return false;
+            }
         }
     }
-    eventDelegateList.push_back(eventDelegate);
+
+    EventListenerTable* table = new EventListenerTable( *listeners );
+    if( type >= table->size() )
+        table->resize( type + 1 );
+    (*table)[type].push_back(eventDelegate);
+    mThreadedEventListenerTables.emplace_back( table );
+    mThreadedEventListeners.store( table );
     GP_INFO("Successfully added delegate for event type: %d", type);
     return true;
 }
@@ -174,15 +206,18 @@ bool EventManager::removeThreadedListener( const EventListenerDelegate &eventDel
 {
     std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
 
-    auto found = mThreadedEventListeners.find(type);
-    if( found != mThreadedEventListeners.end() )
+    const EventListenerTable* listeners = mThreadedEventListeners.load();
+    if( type < listeners->size() )
     {
-        auto & listeners = found->second;
-        for( auto listIt = listeners.begin(); listIt != listeners.end(); ++listIt )
+        const auto & delegates = (*listeners)[type];
+        for( size_t i = 0; i < delegates.size(); ++i )
         {
-            if( eventDelegate == (*listIt) )
+            if( eventDelegate == delegates[i] )
             {
-                listeners.erase(listIt);
+                EventListenerTable* table = new EventListenerTable( *listeners );
+                (*table)[type].erase( (*table)[type].begin() + i );
+                mThreadedEventListenerTables.emplace_back( table );
+                mThreadedEventListeners.store( table );
                 LOG_EVENT("Successfully removed delegate function from event type: %d", type);
                 return true;
             }
@@ -194,19 +229,19 @@ bool EventManager::removeThreadedListener( const EventListenerDelegate &eventDel
 void EventManager::removeAllThreadedListeners()
 {
     std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
-    mThreadedEventListeners.clear();
+    EventListenerTable* table = new EventListenerTable();
+    mThreadedEventListenerTables.emplace_back( table );
+    mThreadedEventListeners.store( table );
 }
 
 bool EventManager::triggerThreadedEvent( const EventDataRef &event )
 {
-    std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
-
     bool processed = false;
-    auto found = mThreadedEventListeners.find(event->getEventID());
-    if( found != mThreadedEventListeners.end() )
+    const EventListenerTable* listeners = mThreadedEventListeners.load();
+    const EventID type = event->getEventID();
+    if( listeners && type < listeners->size() )
     {
-        const auto & eventListenerList = found->second;
-        for( auto & listener : eventListenerList )
+        for( auto & listener : (*listeners)[type] )
         {
             listener( event );
             processed = true;
@@ -224,6 +259,8 @@ bool EventManager::update( uint64_t maxMillis )
     uint64_t currMs = gplay::Platform::getAbsoluteTime();
     uint64_t maxMs = (( maxMillis == EventManager::kINFINITE ) ? (EventManager::kINFINITE) : (currMs + maxMillis) );
 
+    flushPostedEvents();
+
     int queueToProcess = mActiveQueue;
     mActiveQueue = (mActiveQueue + 1) % NUM_QUEUES;
     mQueues[mActiveQueue].clear();
@@ -236,29 +273,20 @@ bool EventManager::update( uint64_t maxMillis )
         processNotify = true;
     }
 
-    while (!mQueues[queueToProcess].empty())
+    // Events queued by the listeners go to the new active queue, the processed one only shrinks.
+    auto & eventQueue = mQueues[queueToProcess];
+    size_t processedCount = 0;
+    while( processedCount < eventQueue.size() )
     {
-        auto event = mQueues[queueToProcess].front();
-        mQueues[queueToProcess].pop_front();
+        EventDataRef event = std::move( eventQueue[processedCount++] );
         LOG_EVENT("\t\tProcessing Event %s", event->getName());
 
-        const auto & eventType = event->getEventID();
-
-        auto found = mEventListeners.find(eventType);
-        if (found != mEventListeners.end())
+        const EventID eventType = event->getEventID();
+        for( size_t i = 0; eventType < mEventListeners.size() && i < mEventListeners[eventType].size(); ++i )
         {
-            const auto & eventListeners = found->second;
-            LOG_EVENT("\t\tFound %d delegates", eventListeners.size());
-
-            auto listIt = eventListeners.begin();
-            auto end = eventListeners.end();
-            while (listIt != end)
-            {
-                auto listener = (*listIt);
-                LOG_EVENT("\t\tSending Event %s to delegate", event->getName());
-                listener(event);
-                listIt++;
-            }
+            EventListenerDelegate listener = mEventListeners[eventType][i];
+            LOG_EVENT("\t\tSending Event %s to delegate", event->getName());
+            listener(event);
         }
 
         currMs = gplay::Platform::getAbsoluteTime();
@@ -269,16 +297,15 @@ bool EventManager::update( uint64_t maxMillis )
         }
     }
 
-    bool queueFlushed = mQueues[queueToProcess].empty();
+    bool queueFlushed = processedCount == eventQueue.size();
     if( ! queueFlushed )
     {
-        while( ! mQueues[queueToProcess].empty() )
-        {
-            auto event = mQueues[queueToProcess].back();
-            mQueues[queueToProcess].pop_back();
-            mQueues[mActiveQueue].push_front(event);
-        }
+        auto & activeQueue = mQueues[mActiveQueue];
+        activeQueue.insert( activeQueue.begin(),
+                            std::make_move_iterator( eventQueue.begin() + processedCount ),
+                            std::make_move_iterator( eventQueue.end() ) );
     }
+    eventQueue.clear();
 
     return queueFlushed;
 }
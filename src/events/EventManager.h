@@ -1,23 +1,30 @@
 #pragma once
 
-#include <deque>
-#include <map>
+#include <vector>
 #include <array>
-#include <list>
 #include <atomic>
 #include <mutex>
+#include <thread>
+#include <memory>
 
 #include "../events/EventManagerBase.h"
+#include "../events/ConcurrentEventQueue.h"
 
 const uint32_t NUM_QUEUES = 2u;
 using EventManagerRef = std::shared_ptr<class EventManager>;
 
 
+//! Event manager dispatching events to the delegates listening to their type.
+//!
+//! Listeners are stored in tables indexed by event ID. Events queued from the
+//! thread owning the manager go straight to the active queue, events queued from
+//! other threads are posted to a lock-free queue moved to the active queue on
+//! update, so worker threads never wait for each other nor for the main thread.
 class EventManager : public EventManagerBase
 {
-    using EventListenerList = std::list<EventListenerDelegate>;
-    using EventListenerMap	= std::map<EventID, EventListenerList>;
-    using EventQueue		= std::deque<EventDataRef>;
+    using EventListenerList     = std::vector<EventListenerDelegate>;
+    using EventListenerTable    = std::vector<EventListenerList>;   // indexed by event ID
+    using EventQueue            = std::vector<EventDataRef>;
 
 public:
 
@@ -42,13 +49,23 @@ public:
 private:
     explicit EventManager( const std::string &name, bool setAsGlobal );
 
+    bool hasListeners( const EventID &type ) const;
+    void flushPostedEvents();
+
+    //! threaded listeners are read without lock from a table replaced on each change,
+    //! replaced tables are kept until destruction since they may still be read.
     std::mutex mThreadedEventListenerMutex;
-    EventListenerMap mThreadedEventListeners;
+    std::atomic<const EventListenerTable*> mThreadedEventListeners;
+    std::vector<std::unique_ptr<const EventListenerTable>> mThreadedEventListenerTables;
 
-    EventListenerMap mEventListeners;
+    EventListenerTable mEventListeners;
     std::array<EventQueue, NUM_QUEUES> mQueues;
     uint32_t mActiveQueue;
 
+    //! events queued from other threads than the one owning the manager.
+    std::thread::id mThreadId;
+    ConcurrentEventQueue mPostedEvents;
+
 };
 
 
@@ -67,7 +84,7 @@ class NAME : public EventData \
 { \
 public: \
     GP_DECLARE_EVENT(NAME) \
-    static std::shared_ptr<class NAME> create() { return  std::shared_ptr<class NAME>(new NAME); } \
+    static std::shared_ptr<class NAME> create() { return makeEventRef(new NAME); } \
 private: \
     explicit NAME() : EventData() {} \
 public: \
@@ -29,6 +29,8 @@ public:
 
     //! Fires off event. This uses the queue and will call the delegate
     //! function on the next call to tickUpdate. assuming there's enough time.
+    //! This function is Thread Safe, events queued from other threads than the
+    //! one owning the manager are dispatched on its next update.
     virtual bool queueEvent( const EventDataRef &event ) = 0;
 
     //! Finds the next-available instance of the named event type and remove it
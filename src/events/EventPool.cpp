@@ -0,0 +1,152 @@
+#include "../core/Base.h"
+#include "../events/EventPool.h"
+
+#include <atomic>
+
+// Number of blocks allocated at once when a size class has no free block.
+#define EVENT_POOL_CHUNK_BLOCKS 1024
+
+// Maximum number of chunks of a size class, blocks are allocated from the heap beyond.
+#define EVENT_POOL_MAX_CHUNKS 256
+
+// Size of the header preceding each block, keeps blocks aligned on 16 bytes.
+#define EVENT_POOL_HEADER_SIZE 16
+
+// Index of the blocks allocated from the heap.
+#define EVENT_POOL_HEAP_BLOCK 0xFFFFFFFFu
+
+namespace
+{
+
+//! Header preceding each block, owned by the pool.
+struct BlockHeader
+{
+    std::atomic<uint32_t> next;     // index + 1 of the next free block, 0 for none
+    uint32_t index;                 // index of the block in its size class
+};
+
+//! Blocks of the same size, with a free list indexed by block.
+struct SizeClass
+{
+    std::atomic<uint64_t> head;     // version in the high 32 bits, index + 1 of the first free block in the low bits
+    std::atomic<uint32_t> chunkCount;
+    std::atomic<char*> chunks[EVENT_POOL_MAX_CHUNKS];
+};
+
+const unsigned int kSIZE_CLASS_COUNT = EventPool::kMAX_BLOCK_SIZE / 16;
+
+// Zero initialized before any event is created.
+SizeClass sSizeClasses[kSIZE_CLASS_COUNT];
+
+inline size_t blockStride( unsigned int sizeClass )
+{
+    return EVENT_POOL_HEADER_SIZE + (sizeClass + 1) * 16;
+}
+
+inline BlockHeader* headerOf( void* block )
+{
+    return reinterpret_cast<BlockHeader*>( static_cast<char*>( block ) - EVENT_POOL_HEADER_SIZE );
+}
+
+inline BlockHeader* headerAt( SizeClass &sizeClass, unsigned int classIndex, uint32_t index )
+{
+    char* chunk = sizeClass.chunks[index / EVENT_POOL_CHUNK_BLOCKS].load( std::memory_order_acquire );
+    return reinterpret_cast<BlockHeader*>( chunk + (index % EVENT_POOL_CHUNK_BLOCKS) * blockStride( classIndex ) );
+}
+
+inline uint64_t nextHead( uint64_t head, uint32_t first )
+{
+    return ( ( ( head >> 32 ) + 1 ) << 32 ) | first;
+}
+
+//! Allocates a new chunk of blocks, returns its first block and adds the others to the free list.
+void* grow( SizeClass &sizeClass, unsigned int classIndex )
+{
+    const size_t stride = blockStride( classIndex );
+    const uint32_t chunkIndex = sizeClass.chunkCount.fetch_add( 1, std::memory_order_relaxed );
+    if( chunkIndex >= EVENT_POOL_MAX_CHUNKS )
+    {
+        static std::atomic<bool> warned( false );
+        if( ! warned.exchange( true ) )
+            GP_WARN( "Event pool is full for blocks of %u bytes, allocating them from the heap.", (unsigned int)(stride - EVENT_POOL_HEADER_SIZE) );
+
+        BlockHeader* header = static_cast<BlockHeader*>( malloc( stride ) );
+        header->index = EVENT_POOL_HEAP_BLOCK;
+        return reinterpret_cast<char*>( header ) + EVENT_POOL_HEADER_SIZE;
+    }
+
+    char* chunk = static_cast<char*>( malloc( stride * EVENT_POOL_CHUNK_BLOCKS ) );
+    const uint32_t first = chunkIndex * EVENT_POOL_CHUNK_BLOCKS;
+    for( uint32_t i = 0; i < EVENT_POOL_CHUNK_BLOCKS; ++i )
+    {
+        BlockHeader* header = new ( chunk + i * stride ) BlockHeader;
+        header->index = first + i;
+        header->next.store( first + i + 2, std::memory_order_relaxed );
+    }
+    sizeClass.chunks[chunkIndex].store( chunk, std::memory_order_release );
+
+    // Push the blocks following the first one at once.
+    BlockHeader* last = reinterpret_cast<BlockHeader*>( chunk + (EVENT_POOL_CHUNK_BLOCKS - 1) * stride );
+    uint64_t head = sizeClass.head.load( std::memory_order_relaxed );
+    do
+    {
+        last->next.store( static_cast<uint32_t>( head ), std::memory_order_relaxed );
+    }
+    while( ! sizeClass.head.compare_exchange_weak( head, nextHead( head, first + 2 ), std::memory_order_release, std::memory_order_relaxed ) );
+
+    return chunk + EVENT_POOL_HEADER_SIZE;
+}
+
+}
+
+void* EventPool::allocate( size_t size )
+{
+    if( size > kMAX_BLOCK_SIZE )
+        return ::operator new( size );
+
+    const unsigned int classIndex = size > 0 ? static_cast<unsigned int>( (size - 1) / 16 ) : 0;
+    SizeClass &sizeClass = sSizeClasses[classIndex];
+
+    // The version of the head protects from blocks released and allocated again between
+    // reading the first block and replacing it.
+    uint64_t head = sizeClass.head.load( std::memory_order_acquire );
+    while( true )
+    {
+        const uint32_t first = static_cast<uint32_t>( head );
+        if( first == 0 )
+            return grow( sizeClass, classIndex );
+
+        BlockHeader* header = headerAt( sizeClass, classIndex, first - 1 );
+        const uint32_t next = header->next.load( std::memory_order_relaxed );
+        if( sizeClass.head.compare_exchange_weak( head, nextHead( head, next ), std::memory_order_acquire, std::memory_order_acquire ) )
+            return reinterpret_cast<char*>( header ) + EVENT_POOL_HEADER_SIZE;
+    }
+}
+
+void EventPool::deallocate( void* block, size_t size )
+{
+    if( block == nullptr )
+        return;
+
+    if( size > kMAX_BLOCK_SIZE )
+    {
+        ::operator delete( block );
+        return;
+    }
+
+    BlockHeader* header = headerOf( block );
+    if( header->index == EVENT_POOL_HEAP_BLOCK )
+    {
+        free( header );
+        return;
+    }
+
+    const unsigned int classIndex = size > 0 ? static_cast<unsigned int>( (size - 1) / 16 ) : 0;
+    SizeClass &sizeClass = sSizeClasses[classIndex];
+    uint64_t head = sizeClass.head.load( std::memory_order_relaxed );
+    do
+    {
+        header->next.store( static_cast<uint32_t>( head ), std::memory_order_relaxed );
+    }
+    while( ! sizeClass.head.compare_exchange_weak( head, nextHead( head, header->index + 1 ), std::memory_order_release, std::memory_order_relaxed ) );
+}
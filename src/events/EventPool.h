@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+//! Lock-free pool of fixed size blocks, used to store events and the shared_ptr
+//! control blocks referencing them without going through the heap.
+//!
+//! Blocks are sorted in size classes of 16 bytes, up to EventPool::kMAX_BLOCK_SIZE
+//! bytes. Each size class grows by chunks of blocks which are never returned to
+//! the heap, so once the pool is warm, allocating and releasing events costs a
+//! compare-and-swap on the free list of their size class. Blocks can be allocated
+//! and released from any thread. Larger allocations fall back to the heap.
+class EventPool
+{
+public:
+
+    enum eConstants { kMAX_BLOCK_SIZE = 256 };
+
+    //! Allocates a block of at least size bytes, aligned on 16 bytes.
+    static void* allocate( size_t size );
+
+    //! Releases a block allocated with the same size.
+    static void deallocate( void* block, size_t size );
+};
+
+
+//! Allocator using the event pool, to allocate the control blocks of event refs.
+template<class T>
+class EventPoolAllocator
+{
+public:
+
+    typedef T value_type;
+
+    EventPoolAllocator() {}
+
+    template<class U>
+    EventPoolAllocator( const EventPoolAllocator<U> & ) {}
+
+    T* allocate( size_t n )
+    {
+        return static_cast<T*>( EventPool::allocate( n * sizeof(T) ) );
+    }
+
+    void deallocate( T* p, size_t n )
+    {
+        EventPool::deallocate( p, n * sizeof(T) );
+    }
+};
+
+template<class T, class U>
+inline bool operator==( const EventPoolAllocator<T> &, const EventPoolAllocator<U> & ) { return true; }
+
+template<class T, class U>
+inline bool operator!=( const EventPoolAllocator<T> &, const EventPoolAllocator<U> & ) { return false; }
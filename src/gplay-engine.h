@@ -9,6 +9,7 @@
 #include "input/Gamepad.h"
 #include "core/FileSystem.h"
 #include "core/Bundle.h"
+#include "core/ResourceCache.h"
 #include "math/MathUtil.h"
 #include "core/Logger.h"
 #include "core/Singleton.h"
@@ -31,23 +32,31 @@
 // Graphics
 #include "graphics/Image.h"
 #include "graphics/Texture.h"
+#include "graphics/TextureAtlas.h"
 #include "graphics/Mesh.h"
 #include "graphics/MeshPart.h"
 #include "graphics/Effect.h"
 #include "graphics/Material.h"
 #include "graphics/RenderState.h"
+#include "graphics/RenderQueue.h"
 #include "graphics/VertexFormat.h"
 #include "graphics/Drawable.h"
 #include "graphics/Model.h"
+#include "graphics/InstancedModel.h"
 #include "graphics/Camera.h"
 #include "graphics/Light.h"
 #include "graphics/Node.h"
+#include "graphics/TransformHierarchy.h"
 #include "graphics/Joint.h"
 #include "graphics/Scene.h"
+#include "graphics/SpatialIndex.h"
+#include "graphics/OcclusionCuller.h"
 #include "graphics/Font.h"
+#include "graphics/GlyphCache.h"
 #include "graphics/SpriteBatch.h"
 #include "graphics/Sprite.h"
 #include "graphics/Text.h"
+#include "graphics/TextLayout.h"
 #include "graphics/TileSet.h"
 #include "graphics/ParticleEmitter.h"
 #include "graphics/FrameBuffer.h"
@@ -70,6 +79,7 @@
 #include "animation/AnimationValue.h"
 #include "animation/Animation.h"
 #include "animation/AnimationClip.h"
+#include "animation/AnimationBlendTree.h"
 
 // Physics
 #include "physics/PhysicsController.h"
@@ -61,6 +61,7 @@ HEADERS += \
     ai/AIState.h \
     ai/AIStateMachine.h \
     animation/Animation.h \
+    animation/AnimationBlendTree.h \
     animation/AnimationClip.h \
     animation/AnimationController.h \
     animation/AnimationTarget.h \
@@ -69,24 +70,29 @@ HEADERS += \
     audio/AudioController.h \
     audio/AudioListener.h \
     audio/AudioSource.h \
+    core/AssetLoader.h \
     core/Base.h \
     core/Bundle.h \
     core/DebugNew.h \
     core/FileSystem.h \
     core/FileWatcher.h \
     core/Game.h \
+    core/JobScheduler.h \
     core/Logger.h \
     core/Platform.h \
     core/Properties.h \
     core/Ref.h \
+    core/ResourceCache.h \
     core/Singleton.h \
     core/Stream.h \
     core/StringHash.h \
     core/TimeListener.h \
     core/Variant.h \
     events/BaseEventData.h \
+    events/ConcurrentEventQueue.h \
     events/EventManager.h \
     events/EventManagerBase.h \
+    events/EventPool.h \
     events/FastDelegate.h \
     events/FastDelegateBind.h \
     graphics/Camera.h \
@@ -94,8 +100,10 @@ HEADERS += \
     graphics/Effect.h \
     graphics/Font.h \
     graphics/FrameBuffer.h \
+    graphics/GlyphCache.h \
     graphics/HeightField.h \
     graphics/Image.h \
+    graphics/InstancedModel.h \
     graphics/Joint.h \
     graphics/Light.h \
     graphics/Material.h \
@@ -106,20 +114,26 @@ HEADERS += \
     graphics/MeshSkin.h \
     graphics/Model.h \
     graphics/Node.h \
+    graphics/OcclusionCuller.h \
     graphics/ParticleEmitter.h \
     graphics/Pass.h \
+    graphics/RenderQueue.h \
     graphics/RenderState.h \
     graphics/Scene.h \
     graphics/SceneLoader.h \
     graphics/ScreenDisplayer.h \
+    graphics/SpatialIndex.h \
     graphics/Sprite.h \
     graphics/SpriteBatch.h \
     graphics/Technique.h \
     graphics/Terrain.h \
     graphics/TerrainPatch.h \
     graphics/Text.h \
+    graphics/TextLayout.h \
     graphics/Texture.h \
+    graphics/TextureAtlas.h \
     graphics/TileSet.h \
+    graphics/TransformHierarchy.h \
     graphics/VertexFormat.h \
     input/Gamepad.h \
     input/Gesture.h \
@@ -202,6 +216,7 @@ SOURCES += \
     ai/AIState.cpp \
     ai/AIStateMachine.cpp \
     animation/Animation.cpp \
+    animation/AnimationBlendTree.cpp \
     animation/AnimationClip.cpp \
     animation/AnimationController.cpp \
     animation/AnimationTarget.cpp \
@@ -210,25 +225,32 @@ SOURCES += \
     audio/AudioController.cpp \
     audio/AudioListener.cpp \
     audio/AudioSource.cpp \
+    core/AssetLoader.cpp \
     core/Bundle.cpp \
     core/DebugNew.cpp \
     core/FileSystem.cpp \
     core/FileWatcher.cpp \
     core/Game.cpp \
+    core/JobScheduler.cpp \
     core/Logger.cpp \
     core/Platform.cpp \
     core/PlatformSDL2.cpp \
     core/Properties.cpp \
     core/Ref.cpp \
+    core/ResourceCache.cpp \
+    events/ConcurrentEventQueue.cpp \
     events/EventManager.cpp \
     events/EventManagerBase.cpp \
+    events/EventPool.cpp \
     graphics/Camera.cpp \
     graphics/Drawable.cpp \
     graphics/Effect.cpp \
     graphics/Font.cpp \
     graphics/FrameBuffer.cpp \
+    graphics/GlyphCache.cpp \
     graphics/HeightField.cpp \
     graphics/Image.cpp \
+    graphics/InstancedModel.cpp \
     graphics/Joint.cpp \
     graphics/Light.cpp \
     graphics/Material.cpp \
@@ -239,20 +261,26 @@ SOURCES += \
     graphics/MeshSkin.cpp \
     graphics/Model.cpp \
     graphics/Node.cpp \
+    graphics/OcclusionCuller.cpp \
     graphics/ParticleEmitter.cpp \
     graphics/Pass.cpp \
+    graphics/RenderQueue.cpp \
     graphics/RenderState.cpp \
     graphics/Scene.cpp \
     graphics/SceneLoader.cpp \
     graphics/ScreenDisplayer.cpp \
+    graphics/SpatialIndex.cpp \
     graphics/Sprite.cpp \
     graphics/SpriteBatch.cpp \
     graphics/Technique.cpp \
     graphics/Terrain.cpp \
     graphics/TerrainPatch.cpp \
     graphics/Text.cpp \
+    graphics/TextLayout.cpp \
     graphics/Texture.cpp \
+    graphics/TextureAtlas.cpp \
     graphics/TileSet.cpp \
+    graphics/TransformHierarchy.cpp \
     graphics/VertexFormat.cpp \
     input/Gamepad.cpp \
     input/JoystickControl.cpp \
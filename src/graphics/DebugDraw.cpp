@@ -24,6 +24,7 @@ BulletDebugDraw::BulletDebugDraw()
         VertexFormat::Element(VertexFormat::COLOR, 4),
     };
     _meshBatch = MeshBatch::create(VertexFormat(elements, 2), Mesh::LINES, material, false, 4096, 4096);
+    _meshBatch->setTransient(true);
     SAFE_RELEASE(material);
     SAFE_RELEASE(effect);
 }
@@ -26,6 +26,22 @@ void Drawable::setNode(Node* node)
     _node = node;
 }
 
+bool Drawable::getBounds(BoundingBox* box, BoundingSphere* sphere) const
+{
+    return false;
+}
+
+void Drawable::setBoundsDirty()
+{
+    if (_node)
+        _node->setBoundsDirty();
+}
+
+bool Drawable::getCachedBounds(BoundingSphere* sphere) const
+{
+    return _node && _node->getDrawableBounds(sphere);
+}
+
 void Drawable::useMask(unsigned char mask)
 {
     _mask |= mask;
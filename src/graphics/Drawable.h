@@ -6,6 +6,8 @@ namespace gplay
 
 class Node;
 class NodeCloneContext;
+class BoundingBox;
+class BoundingSphere;
 
 /**
  * Defines a drawable object that can be attached to a Node.
@@ -34,6 +36,20 @@ public:
 
     virtual unsigned int draw() = 0;
 
+    /**
+     * Gets the world-space bounds of the drawable, used to cull it.
+     *
+     * The bounds are cached by the node of the drawable until its transform changes
+     * or setBoundsDirty() is called. The default implementation returns false, for
+     * drawables which bounds are unknown and which are never culled.
+     *
+     * @param box Populated with the world-space bounding box of the drawable.
+     * @param sphere Populated with the world-space bounding sphere of the drawable.
+     *
+     * @return True if the drawable has bounds, false otherwise.
+     */
+    virtual bool getBounds(BoundingBox* box, BoundingSphere* sphere) const;
+
     /**
      * Gets the node this drawable is attached to.
      *
@@ -74,6 +90,21 @@ protected:
      */
     virtual void setNode(Node* node);
 
+    /**
+     * Notifies the node this drawable is attached to that the bounds of the drawable
+     * changed, other than by a change of the node transform.
+     */
+    void setBoundsDirty();
+
+    /**
+     * Gets the world-space bounding sphere of the drawable cached by its node.
+     *
+     * @param sphere Populated with the bounding sphere of the drawable.
+     *
+     * @return False if the drawable is not attached to a node or has no bounds.
+     */
+    bool getCachedBounds(BoundingSphere* sphere) const;
+
     /**
      * Node this drawable is attached to.
      */
@@ -2,6 +2,7 @@
 #include "../graphics/Effect.h"
 #include "../core/FileSystem.h"
 #include "../core/Game.h"
+#include "../core/ResourceCache.h"
 
 #define OPENGL_ES_DEFINE  "OPENGL_ES"
 
@@ -10,8 +11,6 @@
 
 namespace gplay {
 
-// Cache of unique effects.
-static std::map<std::string, Effect*> __effectCache;
 static Effect* __currentEffect = nullptr;
 
 // Invalid effect used by default to replace shaders in error.
@@ -25,7 +24,7 @@ Effect::Effect() : _gpuProgram(0)
 Effect::~Effect()
 {
     // Remove this effect from the cache.
-    __effectCache.erase(_id);
+    ResourceCache::remove(ResourceCache::EFFECT, _id.c_str(), this);
 
     // Free uniforms.
     for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
@@ -59,13 +58,12 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
 
     if(useCache)
     {
-        std::map<std::string, Effect*>::const_iterator itr = __effectCache.find(uniqueId);
-        if (itr != __effectCache.end())
+        Effect* cached = static_cast<Effect*>(ResourceCache::find(ResourceCache::EFFECT, uniqueId.c_str()));
+        if (cached)
         {
             // Found an exiting effect with this id, so increase its ref count and return it.
-            GP_ASSERT(itr->second);
-            itr->second->addRef();
-            return itr->second;
+            cached->addRef();
+            return cached;
         }
     }
 
@@ -112,9 +110,10 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     }
 
 
-    // Store this effect in the cache.
+    // Store this effect in the cache, unless an effect was created with the same id without the cache.
     effect->_id = uniqueId;
-    __effectCache[uniqueId] = effect;
+    if (useCache || ResourceCache::find(ResourceCache::EFFECT, uniqueId.c_str()) == NULL)
+        ResourceCache::add(ResourceCache::EFFECT, uniqueId.c_str(), effect, 0);
 
     return effect;
 }
@@ -301,11 +300,24 @@ Effect* Effect::getCurrentEffect()
 
 void Effect::initialize()
 {
+    // Load the precompiled shaders of the game.
+    Properties* graphicsConfig = Game::getInstance()->getConfig()->getNamespace("graphics", true);
+    const char* shaderArchive = graphicsConfig ? graphicsConfig->getString("shaderArchive") : NULL;
+    if (shaderArchive && strlen(shaderArchive) > 0)
+    {
+        BGFXGpuProgram::loadShaderArchive(shaderArchive);
+    }
+
     // create invalid shader
     Effect::_invalidEffect = Effect::createFromFile(INVALID_VS, INVALID_FS);
     GP_ASSERT(Effect::_invalidEffect);
 }
 
+void Effect::finalize()
+{
+    BGFXGpuProgram::unloadShaderArchive();
+}
+
 Effect* Effect::GetInvalidEffect()
 {
     return _invalidEffect;
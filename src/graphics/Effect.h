@@ -108,6 +108,7 @@ public:
     const BGFXGpuProgram * getGpuProgram() const;
     BGFXGpuProgram* getGpuProgram();
     static void initialize();
+    static void finalize();
     static Effect* GetInvalidEffect();
 
 private:
@@ -1,5 +1,6 @@
 #include "../core/Base.h"
 #include "../graphics/Font.h"
+#include "../graphics/GlyphCache.h"
 #include "../graphics/Text.h"
 #include "../core/Game.h"
 #include "../core/FileSystem.h"
@@ -10,6 +11,12 @@
 #define FONT_VSH "res/core/shaders/font.vert"
 #define FONT_FSH "res/core/shaders/font.frag"
 
+// Size of the fonts created from font files without a size
+#define FONT_DEFAULT_SIZE 16
+
+// Maximum number of sizes rasterized for a bitmap font file, other sizes scale the closest one
+#define FONT_MAX_RUNTIME_SIZES 8
+
 namespace gplay
 {
 
@@ -18,7 +25,7 @@ static std::vector<Font*> __fontCache;
 static Effect* __fontEffect = NULL;
 
 Font::Font() :
-    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
+    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _glyphCache(NULL), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
 {
 }
 
@@ -34,6 +41,7 @@ Font::~Font()
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
     SAFE_RELEASE(_texture);
+    SAFE_RELEASE(_glyphCache);
 
     // Free child fonts
     for (size_t i = 0, count = _sizes.size(); i < count; ++i)
@@ -59,6 +67,12 @@ Font* Font::create(const char* path, const char* id)
         }
     }
 
+    // Font files are rasterized at runtime.
+    if (GlyphCache::isFontFile(path))
+    {
+        return create(path, FONT_DEFAULT_SIZE, BITMAP);
+    }
+
     // Load the bundle.
     Bundle* bundle = Bundle::create(path);
     if (bundle == NULL)
@@ -98,10 +112,60 @@ Font* Font::create(const char* path, const char* id)
     return font;
 }
 
+Font* Font::create(const char* path, unsigned int size, Format format)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(size);
+
+    // Search the font cache for a font with the given path, size and format.
+    for (size_t i = 0, count = __fontCache.size(); i < count; ++i)
+    {
+        Font* f = __fontCache[i];
+        GP_ASSERT(f);
+        if (f->_glyphCache && f->_path == path && f->_size == size && f->_format == format)
+        {
+            f->addRef();
+            return f;
+        }
+    }
+
+    GlyphCache* glyphCache = GlyphCache::create(path, format);
+    if (glyphCache == NULL)
+    {
+        GP_WARN("Failed to load font file '%s'.", path);
+        return NULL;
+    }
+
+    Font* font = create(glyphCache, size);
+    SAFE_RELEASE(glyphCache);
+    if (font)
+    {
+        font->_path = path;
+
+        // Add this font to the cache.
+        __fontCache.push_back(font);
+    }
+
+    return font;
+}
+
+Font* Font::create(GlyphCache* glyphCache, unsigned int size)
+{
+    GP_ASSERT(glyphCache);
+
+    Font* font = create(glyphCache->getFamily(), glyphCache->getStyle(), size, NULL, 0, glyphCache->getTexture(), glyphCache->getFormat());
+    if (font)
+    {
+        glyphCache->addRef();
+        font->_glyphCache = glyphCache;
+    }
+    return font;
+}
+
 Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format)
 {
     GP_ASSERT(family);
-    GP_ASSERT(glyphs);
+    GP_ASSERT(glyphs || glyphCount == 0);
     GP_ASSERT(texture);
 
     // Create the effect for the font's sprite batch.
@@ -152,9 +216,12 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     font->_batch = batch;
 
     // Copy the glyphs array.
-    font->_glyphs = new Glyph[glyphCount];
-    memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
-    font->_glyphCount = glyphCount;
+    if (glyphCount > 0)
+    {
+        font->_glyphs = new Glyph[glyphCount];
+        memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
+        font->_glyphCount = glyphCount;
+    }
 
     return font;
 }
@@ -179,11 +246,64 @@ Font::Format Font::getFormat()
 
 bool Font::isCharacterSupported(int character) const
 {
-    // TODO: Update this once we support unicode fonts
+    if (_glyphCache)
+        return character >= 0 && _glyphCache->isCharacterSupported((unsigned int)character);
+
     int glyphIndex = character - 32; // HACK for ASCII
     return (glyphIndex >= 0 && glyphIndex < (int)_glyphCount);
 }
 
+const Font::Glyph* Font::getGlyph(const char* character) const
+{
+    GP_ASSERT(character);
+
+    // Decode the UTF-8 character.
+    unsigned int code = (unsigned char)character[0];
+    if (code >= 0x80)
+    {
+        unsigned int length;
+        if (code >= 0xF0)
+        {
+            code &= 0x07;
+            length = 3;
+        }
+        else if (code >= 0xE0)
+        {
+            code &= 0x0F;
+            length = 2;
+        }
+        else if (code >= 0xC0)
+        {
+            code &= 0x1F;
+            length = 1;
+        }
+        else
+        {
+            // Continuation bytes are drawn with the first byte of their character.
+            return NULL;
+        }
+        for (unsigned int i = 1; i <= length; ++i)
+        {
+            const unsigned char byte = (unsigned char)character[i];
+            if ((byte & 0xC0) != 0x80)
+                return NULL;
+            code = (code << 6) | (byte & 0x3F);
+        }
+    }
+
+    if (_glyphCache)
+        return _glyphCache->getGlyph(code, _size);
+
+    int glyphIndex = (int)code - 32; // HACK for ASCII
+    return (glyphIndex >= 0 && glyphIndex < (int)_glyphCount) ? &_glyphs[glyphIndex] : NULL;
+}
+
+unsigned int Font::getSpaceAdvance() const
+{
+    const Glyph* glyph = getGlyph(" ");
+    return glyph ? glyph->advance : _size / 4;
+}
+
 void Font::start()
 {
     // no-op : fonts now are lazily started on the first draw call
@@ -204,6 +324,13 @@ void Font::lazyStart()
         _batch->setProjectionMatrix(projectionMatrix);
     }
 
+    if (_format == DISTANCE_FIELD && _cutoffParam == NULL)
+    {
+        _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
+        // TODO: Fix me so that smaller font are much smoother
+        _cutoffParam->setVector2(Vector2(1.0, 1.0));
+    }
+
     _batch->start();
 }
 
@@ -226,6 +353,29 @@ Font* Font::findClosestSize(int size)
     if (size == (int)_size)
         return this;
 
+    if (_glyphCache && _format == BITMAP && size > 0)
+    {
+        // Bitmap glyphs are rasterized at the size they are drawn at.
+        for (size_t i = 0, count = _sizes.size(); i < count; ++i)
+        {
+            if (_sizes[i]->_size == (unsigned int)size)
+                return _sizes[i];
+        }
+
+        // Once the limit is reached, reuse the closest existing size instead of
+        // filling the shared atlas with yet another copy of the glyphs.
+        if (_sizes.size() < FONT_MAX_RUNTIME_SIZES)
+        {
+            Font* f = create(_glyphCache, size);
+            if (f)
+            {
+                f->_path = _path;
+                _sizes.push_back(f);
+                return f;
+            }
+        }
+    }
+
     int diff = abs(size - (int)_size);
     Font* closest = this;
     for (size_t i = 0, count = _sizes.size(); i < count; ++i)
@@ -294,7 +444,7 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
                 switch (delimiter)
                 {
                 case ' ':
-                    xPos += _glyphs[0].advance;
+                    xPos += getSpaceAdvance();
                     break;
                 case '\r':
                 case '\n':
@@ -302,7 +452,7 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
                     xPos = x;
                     break;
                 case '\t':
-                    xPos += _glyphs[0].advance * 4;
+                    xPos += getSpaceAdvance() * 4;
                     break;
                 case 0:
                     done = true;
@@ -327,7 +477,7 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
             iteration = 1;
         }
 
-        GP_ASSERT(_glyphs);
+        GP_ASSERT(_glyphs || _glyphCache);
         GP_ASSERT(_batch);
         for (size_t i = startIndex; i < length; i += (size_t)iteration)
         {
@@ -345,7 +495,7 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
             switch (c)
             {
             case ' ':
-                xPos += _glyphs[0].advance;
+                xPos += getSpaceAdvance();
                 break;
             case '\r':
             case '\n':
@@ -353,21 +503,14 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
                 xPos = x;
                 break;
             case '\t':
-                xPos += _glyphs[0].advance * 4;
+                xPos += getSpaceAdvance() * 4;
                 break;
             default:
-                int index = c - 32; // HACK for ASCII
-                if (index >= 0 && index < (int)_glyphCount)
+                const Glyph* glyph = getGlyph(rightToLeft ? cursor + i : text + i);
+                if (glyph)
                 {
-                    Glyph& g = _glyphs[index];
+                    const Glyph& g = *glyph;
 
-                    if (getFormat() == DISTANCE_FIELD )
-                    {
-                        if (_cutoffParam == NULL)
-                            _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
-                        // TODO: Fix me so that smaller font are much smoother
-                        _cutoffParam->setVector2(Vector2(1.0, 1.0));
-                    }
                     _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
                     xPos += floor(g.advance * scale + spacing);
                     break;
@@ -412,7 +555,31 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         }
     }
 
+    // Lay out the glyphs, then draw them.
+    _quads.clear();
+    layoutText(text, area, size, justify, wrap, rightToLeft, &_quads);
+
     lazyStart();
+    const bool clipped = clip != Rectangle(0, 0, 0, 0);
+    for (size_t i = 0, count = _quads.size(); i < count; ++i)
+    {
+        const GlyphQuad& q = _quads[i];
+        if (clipped)
+        {
+            _batch->draw(q.x, q.y, q.width, q.height, q.uvs[0], q.uvs[1], q.uvs[2], q.uvs[3], color, clip);
+        }
+        else
+        {
+            _batch->draw(q.x, q.y, q.width, q.height, q.uvs[0], q.uvs[1], q.uvs[2], q.uvs[3], color);
+        }
+    }
+}
+
+void Font::layoutText(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
+                      std::vector<GlyphQuad>* quads)
+{
+    GP_ASSERT(text);
+    GP_ASSERT(quads);
 
     float scale = (float)size / _size;
     int spacing = (int)(size * _spacing);
@@ -503,16 +670,13 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
             break;
         }
 
-        GP_ASSERT(_glyphs);
-        GP_ASSERT(_batch);
+        GP_ASSERT(_glyphs || _glyphCache);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(token + i);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -522,24 +686,12 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
                 }
                 else if (xPos >= (int)area.x)
                 {
-                    // Draw this character.
+                    // Place this character.
                     if (draw)
                     {
-                        if (getFormat() == DISTANCE_FIELD)
-                        {
-                            if (_cutoffParam == NULL)
-                                _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
-                            // TODO: Fix me so that smaller font are much smoother
-                            _cutoffParam->setVector2(Vector2(1.0, 1.0));
-                        }
-                        if (clip != Rectangle(0, 0, 0, 0))
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color, clip);
-                        }
-                        else
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
-                        }
+                        GlyphQuad quad = { g.code, (float)(xPos + (int)(g.bearingX * scale)), (float)yPos, g.width * scale, (float)size,
+                                           { g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3] } };
+                        quads->push_back(quad);
                     }
                 }
                 xPos += (int)(g.advance)*scale + spacing;
@@ -731,7 +883,7 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
                 switch (delimiter)
                 {
                     case ' ':
-                        delimWidth += _glyphs[0].advance;
+                        delimWidth += getSpaceAdvance();
                         break;
                     case '\r':
                     case '\n':
@@ -767,7 +919,7 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
                         delimWidth = 0;
                         break;
                     case '\t':
-                        delimWidth += _glyphs[0].advance * 4;
+                        delimWidth += getSpaceAdvance() * 4;
                         break;
                     case 0:
                         reachedEOF = true;
@@ -1067,7 +1219,7 @@ void Font::getMeasurementInfo(const char* text, const Rectangle& area, unsigned
                     switch (delimiter)
                     {
                         case ' ':
-                            delimWidth += _glyphs[0].advance;
+                            delimWidth += getSpaceAdvance();
                             lineLength++;
                             break;
                         case '\r':
@@ -1084,7 +1236,7 @@ void Font::getMeasurementInfo(const char* text, const Rectangle& area, unsigned
                             delimWidth = 0;
                             break;
                         case '\t':
-                            delimWidth += _glyphs[0].advance * 4;
+                            delimWidth += getSpaceAdvance() * 4;
                             lineLength++;
                             break;
                         case 0:
@@ -1353,15 +1505,13 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
             break;
         }
 
-        GP_ASSERT(_glyphs);
+        GP_ASSERT(_glyphs || _glyphCache);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(token + i);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -1468,10 +1618,21 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
     return -1;
 }
 
+void Font::useGlyphs(const std::vector<GlyphQuad>& quads)
+{
+    if (_glyphCache == NULL)
+        return;
+
+    for (size_t i = 0, count = quads.size(); i < count; ++i)
+    {
+        _glyphCache->getGlyph(quads[i].code, _size);
+    }
+}
+
 unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigned int size, float scale)
 {
     GP_ASSERT(token);
-    GP_ASSERT(_glyphs);
+    GP_ASSERT(_glyphs || _glyphCache);
 
     if (size == 0)
         size = _size;
@@ -1486,16 +1647,16 @@ unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigne
         switch (c)
         {
         case ' ':
-            tokenWidth += _glyphs[0].advance;
+            tokenWidth += getSpaceAdvance();
             break;
         case '\t':
-            tokenWidth += _glyphs[0].advance * 4;
+            tokenWidth += getSpaceAdvance() * 4;
             break;
         default:
-            int glyphIndex = c - 32;
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(token + i);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
                 tokenWidth += floor(g.advance * scale + spacing);
             }
             break;
@@ -1560,7 +1721,7 @@ int Font::handleDelimiters(const char** token, const unsigned int size, const in
         switch (delimiter)
         {
             case ' ':
-                *xPos += _glyphs[0].advance;
+                *xPos += getSpaceAdvance();
                 (*lineLength)++;
                 if (charIndex)
                 {
@@ -1592,7 +1753,7 @@ int Font::handleDelimiters(const char** token, const unsigned int size, const in
                 }
                 break;
             case '\t':
-                *xPos += _glyphs[0].advance * 4;
+                *xPos += getSpaceAdvance() * 4;
                 (*lineLength)++;
                 if (charIndex)
                 {
@@ -6,14 +6,22 @@
 namespace gplay
 {
 
+class GlyphCache;
+
 /**
  * Defines a font for text rendering.
+ *
+ * Fonts are either loaded from bundles, with glyphs pre-rendered by the encoder at a few
+ * sizes, or created from TrueType and OpenType files, whose glyphs are rasterized when they
+ * are first drawn into a glyph cache shared by the fonts of the file. Text is UTF-8 encoded.
  */
 class Font : public Ref
 {
     friend class Bundle;
+    friend class GlyphCache;
     friend class Text;
     friend class TextBox;
+    friend class TextLayout;
 
 public:
 
@@ -69,6 +77,9 @@ public:
      * If a font for the given path has already been loaded, the existing font will be
      * returned with its reference count increased.
      *
+     * TrueType (.ttf) and OpenType (.otf) files are created as bitmap fonts of 16 pixels,
+     * the 'id' parameter being ignored.
+     *
      * @param path The path to a bundle file containing a font resource.
      * @param id An optional ID of the font resource within the bundle (NULL for the first/only resource).
      *
@@ -77,6 +88,24 @@ public:
      */
     static Font* create(const char* path, const char* id = NULL);
 
+    /**
+     * Creates a font from a TrueType (.ttf) or OpenType (.otf) file.
+     *
+     * Glyphs are rasterized when they are first drawn. Bitmap fonts rasterize the glyphs at
+     * each size they are drawn at, distance field fonts at the given size and scale them.
+     *
+     * If a font for the given path, size and format has already been created, the existing
+     * font will be returned with its reference count increased.
+     *
+     * @param path The path to the font file.
+     * @param size The default size of the font, in pixels.
+     * @param format The format of the rasterized glyphs.
+     *
+     * @return The specified Font or NULL if there was an error.
+     * @script{create}
+     */
+    static Font* create(const char* path, unsigned int size, Format format);
+
     /**
      * Gets the font size (max height of glyphs) in pixels, at the specified index.
      *
@@ -274,6 +303,19 @@ private:
         float uvs[4];
     };
 
+    /**
+     * Defines a glyph placed by the layout of a text.
+     */
+    struct GlyphQuad
+    {
+        unsigned int code;
+        float x;
+        float y;
+        float width;
+        float height;
+        float uvs[4];
+    };
+
     /**
      * Constructor.
      */
@@ -312,6 +354,49 @@ private:
      */
     static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format);
 
+    /**
+     * Creates a font of the given size drawing the glyphs of a glyph cache.
+     *
+     * @param glyphCache The glyph cache.
+     * @param size The font size.
+     *
+     * @return The new Font or NULL if there was an error.
+     */
+    static Font* create(GlyphCache* glyphCache, unsigned int size);
+
+    /**
+     * Gets the glyph of the UTF-8 character at the given position of a text.
+     *
+     * @param character The first byte of the character.
+     *
+     * @return The glyph, or NULL if the font has no glyph for the character or for the
+     *         continuation bytes of multi-byte characters.
+     */
+    const Glyph* getGlyph(const char* character) const;
+
+    unsigned int getSpaceAdvance() const;
+
+    /**
+     * Lays out a text within a rectangular area, as drawn by drawText().
+     *
+     * @param text The text to lay out.
+     * @param area The viewport area to lay out within.
+     * @param size The size of the text, which this font must be the closest size of.
+     * @param justify Justification of text within the viewport.
+     * @param wrap Wraps text to fit within the width of the viewport if true.
+     * @param rightToLeft Whether to lay out text from right to left.
+     * @param quads Receives the glyphs to draw.
+     */
+    void layoutText(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
+                    std::vector<GlyphQuad>* quads);
+
+    /**
+     * Marks the glyphs of a layout as used, so that the glyph cache keeps them in the atlas.
+     *
+     * @param quads The glyphs of the layout.
+     */
+    void useGlyphs(const std::vector<GlyphQuad>& quads);
+
     void getMeasurementInfo(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
                             std::vector<int>* xPositions, int* yPosition, std::vector<unsigned int>* lineLengths);
 
@@ -343,10 +428,12 @@ private:
     float _spacing;
     Glyph* _glyphs;
     unsigned int _glyphCount;
+    GlyphCache* _glyphCache;
     Texture* _texture;
     SpriteBatch* _batch;
     Rectangle _viewport;
     MaterialParameter* _cutoffParam;
+    std::vector<GlyphQuad> _quads; // scratch glyphs of drawText(), kept to reuse its capacity
 };
 
 }
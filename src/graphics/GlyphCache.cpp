@@ -0,0 +1,486 @@
+#include "../core/Base.h"
+#include "../graphics/GlyphCache.h"
+#include "../core/FileSystem.h"
+#include "../renderer/BGFXRenderer.h"
+#include "../renderer/BGFXTexture.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <edtaa3func/edtaa3func.h>
+
+// Padding around the glyphs of bitmap fonts, so that filtering doesn't bleed neighbour glyphs.
+#define GLYPH_CACHE_BITMAP_PADDING 1
+
+// Padding around the glyphs of distance field fonts, covered by the distance field.
+#define GLYPH_CACHE_DISTANCE_FIELD_PADDING 4
+
+// Marks a glyph without pixels in the atlas.
+#define GLYPH_CACHE_NO_SHELF 0xFFFFFFFF
+
+namespace gplay
+{
+
+static FT_Library __library = NULL;
+static unsigned int __libraryUseCount = 0;
+static std::vector<GlyphCache*> __glyphCaches;
+
+/**
+ * Replaces a glyph image by its distance field, as done by the font encoder.
+ */
+static void createDistanceField(unsigned char* image, unsigned int width, unsigned int height)
+{
+    const unsigned int pixelCount = width * height;
+    std::vector<short> xDistance(pixelCount);
+    std::vector<short> yDistance(pixelCount);
+    std::vector<double> gx(pixelCount, 0.0);
+    std::vector<double> gy(pixelCount, 0.0);
+    std::vector<double> data(pixelCount);
+    std::vector<double> outside(pixelCount);
+    std::vector<double> inside(pixelCount);
+
+    // Rescale the image levels between 0 and 1.
+    unsigned char imageMax = 1;
+    for (unsigned int i = 0; i < pixelCount; ++i)
+        imageMax = std::max(imageMax, image[i]);
+    for (unsigned int i = 0; i < pixelCount; ++i)
+        data[i] = (double)image[i] / imageMax;
+
+    // Transform the background.
+    computegradient(&data[0], width, height, &gx[0], &gy[0]);
+    edtaa3(&data[0], &gx[0], &gy[0], width, height, &xDistance[0], &yDistance[0], &outside[0]);
+
+    // Transform the foreground.
+    std::fill(gx.begin(), gx.end(), 0.0);
+    std::fill(gy.begin(), gy.end(), 0.0);
+    for (unsigned int i = 0; i < pixelCount; ++i)
+        data[i] = 1.0 - data[i];
+    computegradient(&data[0], width, height, &gx[0], &gy[0]);
+    edtaa3(&data[0], &gx[0], &gy[0], width, height, &xDistance[0], &yDistance[0], &inside[0]);
+
+    // Bipolar distance field, inside the glyph above 128.
+    for (unsigned int i = 0; i < pixelCount; ++i)
+    {
+        const double distance = std::max(outside[i], 0.0) - std::max(inside[i], 0.0);
+        image[i] = 255 - (unsigned char)std::min(std::max(128.0 + distance * 16.0, 0.0), 255.0);
+    }
+}
+
+GlyphCache::GlyphCache()
+    : _format(Font::BITMAP), _fontData(NULL), _face(NULL), _faceSize(0), _baseline(0), _texture(NULL), _atlasSize(0),
+      _padding(GLYPH_CACHE_BITMAP_PADDING), _shelvesHeight(0), _glyphCount(0), _evictionCount(0), _warningFrame(UINT_MAX)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+    std::vector<GlyphCache*>::iterator itr = std::find(__glyphCaches.begin(), __glyphCaches.end(), this);
+    if (itr != __glyphCaches.end())
+    {
+        __glyphCaches.erase(itr);
+    }
+
+    SAFE_RELEASE(_texture);
+    if (_face)
+    {
+        FT_Done_Face(_face);
+    }
+    SAFE_DELETE_ARRAY(_fontData);
+
+    GP_ASSERT(__libraryUseCount > 0);
+    if (--__libraryUseCount == 0)
+    {
+        FT_Done_FreeType(__library);
+        __library = NULL;
+    }
+}
+
+GlyphCache* GlyphCache::create(const char* path, Font::Format format, unsigned int atlasSize)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(atlasSize > 0);
+
+    // Fonts created from the same file share their glyphs.
+    for (size_t i = 0, count = __glyphCaches.size(); i < count; ++i)
+    {
+        GlyphCache* cache = __glyphCaches[i];
+        if (cache->_path == path && cache->_format == format)
+        {
+            cache->addRef();
+            return cache;
+        }
+    }
+
+    if (__libraryUseCount == 0 && FT_Init_FreeType(&__library))
+    {
+        GP_WARN("Failed to initialize FreeType.");
+        return NULL;
+    }
+    ++__libraryUseCount;
+
+    GlyphCache* cache = new GlyphCache();
+    cache->_path = path;
+    cache->_format = format;
+    cache->_atlasSize = atlasSize;
+    cache->_padding = format == Font::DISTANCE_FIELD ? GLYPH_CACHE_DISTANCE_FIELD_PADDING : GLYPH_CACHE_BITMAP_PADDING;
+
+    // The face reads the font data as long as it is used.
+    int fileSize = 0;
+    cache->_fontData = FileSystem::readAll(path, &fileSize);
+    if (cache->_fontData == NULL)
+    {
+        GP_WARN("Failed to read font file '%s'.", path);
+        SAFE_RELEASE(cache);
+        return NULL;
+    }
+    if (FT_New_Memory_Face(__library, (const FT_Byte*)cache->_fontData, fileSize, 0, &cache->_face) ||
+        FT_Select_Charmap(cache->_face, FT_ENCODING_UNICODE))
+    {
+        GP_WARN("Failed to load font face '%s'.", path);
+        SAFE_RELEASE(cache);
+        return NULL;
+    }
+
+    char id[32];
+    sprintf(id, "glyphs_%p", (void*)cache);
+    cache->_texture = Texture::create(id, atlasSize, atlasSize, Texture::ALPHA);
+    if (cache->_texture == NULL)
+    {
+        GP_WARN("Failed to create glyph atlas (%dx%d) for font '%s'.", atlasSize, atlasSize, path);
+        SAFE_RELEASE(cache);
+        return NULL;
+    }
+
+    __glyphCaches.push_back(cache);
+    return cache;
+}
+
+bool GlyphCache::isFontFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    std::string extension = FileSystem::getExtension(path);
+    return extension == ".TTF" || extension == ".OTF";
+}
+
+const char* GlyphCache::getPath() const
+{
+    return _path.c_str();
+}
+
+Font::Format GlyphCache::getFormat() const
+{
+    return _format;
+}
+
+Texture* GlyphCache::getTexture() const
+{
+    return _texture;
+}
+
+bool GlyphCache::isCharacterSupported(unsigned int character) const
+{
+    GP_ASSERT(_face);
+    return FT_Get_Char_Index(_face, character) != 0;
+}
+
+unsigned int GlyphCache::getGlyphCount() const
+{
+    return _glyphCount;
+}
+
+unsigned int GlyphCache::getEvictionCount() const
+{
+    return _evictionCount;
+}
+
+const char* GlyphCache::getFamily() const
+{
+    GP_ASSERT(_face);
+    return _face->family_name ? _face->family_name : "";
+}
+
+Font::Style GlyphCache::getStyle() const
+{
+    GP_ASSERT(_face);
+    const bool bold = (_face->style_flags & FT_STYLE_FLAG_BOLD) != 0;
+    const bool italic = (_face->style_flags & FT_STYLE_FLAG_ITALIC) != 0;
+    if (bold && italic)
+        return Font::BOLD_ITALIC;
+    if (bold)
+        return Font::BOLD;
+    return italic ? Font::ITALIC : Font::PLAIN;
+}
+
+const Font::Glyph* GlyphCache::getGlyph(unsigned int character, unsigned int size)
+{
+    GP_ASSERT(_face);
+
+    const uint64_t key = ((uint64_t)size << 32) | character;
+    const uint32_t frame = BGFXRenderer::getInstance().getFrameNumber();
+
+    // The entries are kept from the most to the least recently used.
+    std::unordered_map<uint64_t, EntryList::iterator>::iterator itr = _glyphs.find(key);
+    if (itr != _glyphs.end())
+    {
+        EntryList::iterator entry = itr->second;
+        entry->lastUse = frame;
+        _entries.splice(_entries.begin(), _entries, entry);
+        return entry->missing ? NULL : &entry->glyph;
+    }
+
+    Entry entry;
+    memset(&entry.glyph, 0, sizeof(Font::Glyph));
+    entry.key = key;
+    entry.glyph.code = character;
+    entry.missing = true;
+    entry.shelf = GLYPH_CACHE_NO_SHELF;
+    entry.x = 0;
+    entry.width = 0;
+    entry.lastUse = frame;
+
+    const FT_UInt index = FT_Get_Char_Index(_face, character);
+    if (index != 0 && setSize(size) && FT_Load_Glyph(_face, index, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT) == 0)
+    {
+        const FT_GlyphSlot slot = _face->glyph;
+        entry.missing = false;
+        entry.glyph.width = slot->bitmap.width;
+        entry.glyph.bearingX = (int)(slot->metrics.horiBearingX >> 6);
+        entry.glyph.advance = (unsigned int)(slot->metrics.horiAdvance >> 6);
+
+        // Glyphs without pixels, such as spaces, don't use the atlas.
+        if (slot->bitmap.width > 0 && slot->bitmap.rows > 0 && !addToAtlas(entry, size, frame))
+        {
+            if (_warningFrame != frame)
+            {
+                GP_WARN("Glyph atlas of font '%s' is full of glyphs drawn in the current frame.", _path.c_str());
+                _warningFrame = frame;
+            }
+            return NULL;
+        }
+    }
+
+    _entries.push_front(entry);
+    _glyphs[key] = _entries.begin();
+    return entry.missing ? NULL : &_entries.front().glyph;
+}
+
+bool GlyphCache::setSize(unsigned int size)
+{
+    if (size == _faceSize)
+        return true;
+
+    // Scale the face so that its lines, from the ascender to the descender, fit in the size.
+    FT_UInt pixelSize = size;
+    const int lineHeight = _face->ascender - _face->descender;
+    if (FT_IS_SCALABLE(_face) && lineHeight > 0)
+    {
+        pixelSize = std::max(1u, size * _face->units_per_EM / lineHeight);
+    }
+    if (FT_Set_Pixel_Sizes(_face, 0, pixelSize))
+    {
+        GP_WARN("Failed to set size %u of font '%s'.", size, _path.c_str());
+        _faceSize = 0;
+        return false;
+    }
+
+    _faceSize = size;
+    _baseline = (int)((_face->size->metrics.ascender + 32) >> 6);
+    return true;
+}
+
+bool GlyphCache::addToAtlas(Entry& entry, unsigned int size, uint32_t frame)
+{
+    const FT_Bitmap& bitmap = _face->glyph->bitmap;
+    const unsigned int width = bitmap.width + _padding * 2;
+    const unsigned int height = size + _padding * 2;
+    if (width > _atlasSize || height > _atlasSize)
+    {
+        GP_WARN("Glyph %u of size %u doesn't fit in the atlas of font '%s'.", entry.glyph.code, size, _path.c_str());
+        entry.missing = true;
+        return true;
+    }
+
+    unsigned int shelf;
+    unsigned int x;
+    if (!allocate(width, height, frame, &shelf, &x))
+        return false;
+    ++_shelves[shelf].glyphCount;
+    ++_glyphCount;
+    entry.shelf = shelf;
+    entry.x = x;
+    entry.width = width;
+    const unsigned int y = _shelves[shelf].y;
+
+    // Copy the glyph into its cell, on the baseline of the line.
+    const bgfx::Memory* mem = bgfx::alloc(width * height);
+    memset(mem->data, 0, width * height);
+    const int top = (int)_padding + _baseline - _face->glyph->bitmap_top;
+    for (unsigned int row = 0; row < bitmap.rows; ++row)
+    {
+        const int cellY = top + (int)row;
+        if (cellY < (int)_padding || cellY >= (int)(_padding + size))
+            continue;
+
+        const unsigned char* src = bitmap.buffer + row * bitmap.pitch;
+        unsigned char* dst = mem->data + cellY * width + _padding;
+        for (unsigned int column = 0; column < bitmap.width; ++column)
+        {
+            if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+                dst[column] = (src[column >> 3] & (0x80 >> (column & 7))) ? 255 : 0;
+            else
+                dst[column] = src[column];
+        }
+    }
+    if (_format == Font::DISTANCE_FIELD)
+    {
+        createDistanceField(mem->data, width, height);
+    }
+
+    GP_ASSERT(_texture && _texture->getHandle());
+    _texture->getHandle()->update(x, y, width, height, mem);
+
+    entry.glyph.uvs[0] = (float)(x + _padding) / _atlasSize;
+    entry.glyph.uvs[1] = (float)(y + _padding) / _atlasSize;
+    entry.glyph.uvs[2] = (float)(x + _padding + bitmap.width) / _atlasSize;
+    entry.glyph.uvs[3] = (float)(y + _padding + size) / _atlasSize;
+    return true;
+}
+
+bool GlyphCache::allocate(unsigned int width, unsigned int height, uint32_t frame, unsigned int* shelf, unsigned int* x)
+{
+    if (allocate(width, height, shelf, x))
+        return true;
+
+    // Evict the least recently used glyphs until the glyph fits. The glyphs drawn in the
+    // current frame are kept, their cells are read by the draw calls of the frame.
+    EntryList::iterator itr = _entries.end();
+    while (itr != _entries.begin())
+    {
+        --itr;
+        if (itr->lastUse == frame)
+            break;
+        if (itr->shelf == GLYPH_CACHE_NO_SHELF)
+            continue;
+
+        EntryList::iterator evicted = itr++;
+        evict(evicted);
+        if (allocate(width, height, shelf, x))
+            return true;
+    }
+    return false;
+}
+
+bool GlyphCache::allocate(unsigned int width, unsigned int height, unsigned int* shelf, unsigned int* x)
+{
+    for (unsigned int i = 0, count = (unsigned int)_shelves.size(); i < count; ++i)
+    {
+        if (allocateInShelf(i, width, height, x))
+        {
+            *shelf = i;
+            return true;
+        }
+    }
+
+    // Add a shelf below the others.
+    if (_shelvesHeight + height > _atlasSize)
+        return false;
+    Shelf newShelf;
+    newShelf.y = _shelvesHeight;
+    newShelf.height = height;
+    newShelf.used = 0;
+    newShelf.glyphCount = 0;
+    _shelves.push_back(newShelf);
+    _shelvesHeight += height;
+
+    *shelf = (unsigned int)_shelves.size() - 1;
+    return allocateInShelf(*shelf, width, height, x);
+}
+
+bool GlyphCache::allocateInShelf(unsigned int index, unsigned int width, unsigned int height, unsigned int* x)
+{
+    Shelf& shelf = _shelves[index];
+
+    // Shelves contain glyphs of similar heights, an empty shelf takes any glyph it can hold.
+    if (shelf.height < height || (shelf.glyphCount > 0 && shelf.height > height + height / 4))
+        return false;
+
+    for (size_t i = 0, count = shelf.freeSpans.size(); i < count; ++i)
+    {
+        Span& span = shelf.freeSpans[i];
+        if (span.width >= width)
+        {
+            *x = span.x;
+            span.x += width;
+            span.width -= width;
+            if (span.width == 0)
+                shelf.freeSpans.erase(shelf.freeSpans.begin() + i);
+            return true;
+        }
+    }
+
+    if (shelf.used + width > _atlasSize)
+        return false;
+    *x = shelf.used;
+    shelf.used += width;
+    return true;
+}
+
+void GlyphCache::freeSpan(Shelf& shelf, unsigned int x, unsigned int width)
+{
+    std::vector<Span>& spans = shelf.freeSpans;
+    std::vector<Span>::iterator itr = spans.begin();
+    while (itr != spans.end() && itr->x < x)
+        ++itr;
+    Span span = { x, width };
+    itr = spans.insert(itr, span);
+
+    // Merge with the neighbour spans.
+    if (itr + 1 != spans.end() && itr->x + itr->width == (itr + 1)->x)
+    {
+        itr->width += (itr + 1)->width;
+        spans.erase(itr + 1);
+    }
+    if (itr != spans.begin() && (itr - 1)->x + (itr - 1)->width == itr->x)
+    {
+        (itr - 1)->width += itr->width;
+        itr = spans.erase(itr) - 1;
+    }
+
+    // A span at the end of the shelf gives its pixels back.
+    if (itr->x + itr->width == shelf.used)
+    {
+        shelf.used = itr->x;
+        spans.erase(itr);
+    }
+}
+
+void GlyphCache::evict(EntryList::iterator entry)
+{
+    GP_ASSERT(entry->shelf < _shelves.size());
+
+    Shelf& shelf = _shelves[entry->shelf];
+    GP_ASSERT(shelf.glyphCount > 0);
+    if (--shelf.glyphCount == 0)
+    {
+        shelf.used = 0;
+        shelf.freeSpans.clear();
+    }
+    else
+    {
+        freeSpan(shelf, entry->x, entry->width);
+    }
+
+    // Empty shelves at the bottom give their height back.
+    while (!_shelves.empty() && _shelves.back().glyphCount == 0)
+    {
+        _shelvesHeight = _shelves.back().y;
+        _shelves.pop_back();
+    }
+
+    _glyphs.erase(entry->key);
+    _entries.erase(entry);
+    --_glyphCount;
+    ++_evictionCount;
+}
+
+}
@@ -0,0 +1,188 @@
+#ifndef GLYPHCACHE_H_
+#define GLYPHCACHE_H_
+
+#include "../core/Ref.h"
+#include "../graphics/Font.h"
+
+struct FT_FaceRec_;
+
+namespace gplay
+{
+
+/**
+ * Defines a cache of the glyphs of a TrueType or OpenType font, rasterized with FreeType
+ * when they are first drawn.
+ *
+ * Glyphs are rasterized at the exact size they are drawn at, as bitmaps or as distance
+ * fields, into a single channel atlas texture. The atlas is divided into shelves as high
+ * as the glyphs they contain, and each new glyph is uploaded into its cell with a sub-rect
+ * texture update. When the atlas is full, the least recently used glyphs are evicted to make
+ * room, except the glyphs drawn in the current frame whose cells are still in use.
+ *
+ * The cache is shared by the fonts created from the same file and format, so the memory
+ * used by a font only depends on the size of its atlas, whatever its character set.
+ */
+class GlyphCache : public Ref
+{
+    friend class Font;
+
+public:
+
+    /**
+     * Creates the glyph cache of a font file, or returns the existing one.
+     *
+     * @param path The path of the TrueType or OpenType font file.
+     * @param format The format of the rasterized glyphs.
+     * @param atlasSize The width and height of the atlas texture, in pixels.
+     *
+     * @return The glyph cache, or NULL if the font file can't be loaded.
+     */
+    static GlyphCache* create(const char* path, Font::Format format = Font::BITMAP, unsigned int atlasSize = 1024);
+
+    /**
+     * Checks if a file is a font file rasterized with a glyph cache, from its extension.
+     *
+     * @param path The path of the file.
+     *
+     * @return True for TrueType (.ttf) and OpenType (.otf) files.
+     */
+    static bool isFontFile(const char* path);
+
+    /**
+     * Gets the path of the font file.
+     */
+    const char* getPath() const;
+
+    /**
+     * Gets the format of the rasterized glyphs.
+     */
+    Font::Format getFormat() const;
+
+    /**
+     * Gets the atlas texture containing the rasterized glyphs.
+     */
+    Texture* getTexture() const;
+
+    /**
+     * Determines if the font has a glyph for the specified character code.
+     *
+     * @param character The unicode character code.
+     *
+     * @return True if the font has a glyph for the character, false otherwise.
+     */
+    bool isCharacterSupported(unsigned int character) const;
+
+    /**
+     * Gets the number of glyphs in the atlas.
+     */
+    unsigned int getGlyphCount() const;
+
+    /**
+     * Gets the number of glyphs evicted from the atlas to make room for new glyphs.
+     */
+    unsigned int getEvictionCount() const;
+
+private:
+
+    /**
+     * A span of free pixels in a shelf.
+     */
+    struct Span
+    {
+        unsigned int x;
+        unsigned int width;
+    };
+
+    /**
+     * A row of the atlas containing glyphs of similar heights.
+     */
+    struct Shelf
+    {
+        unsigned int y;
+        unsigned int height;
+        unsigned int used;
+        unsigned int glyphCount;
+        std::vector<Span> freeSpans;
+    };
+
+    /**
+     * A glyph of the cache, at a given size.
+     */
+    struct Entry
+    {
+        uint64_t key;
+        Font::Glyph glyph;
+        bool missing;
+        unsigned int shelf;
+        unsigned int x;
+        unsigned int width;
+        uint32_t lastUse;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    /**
+     * Constructor.
+     */
+    GlyphCache();
+
+    /**
+     * Destructor.
+     */
+    ~GlyphCache();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    GlyphCache& operator=(const GlyphCache&);
+
+    /**
+     * Gets the glyph of a character at a size, rasterizing it if it isn't in the atlas.
+     *
+     * @param character The unicode character code.
+     * @param size The size of the font, in pixels.
+     *
+     * @return The glyph, or NULL if the font has no glyph for the character or if the atlas
+     *         is full of glyphs drawn in the current frame.
+     */
+    const Font::Glyph* getGlyph(unsigned int character, unsigned int size);
+
+    const char* getFamily() const;
+
+    Font::Style getStyle() const;
+
+    bool setSize(unsigned int size);
+
+    bool addToAtlas(Entry& entry, unsigned int size, uint32_t frame);
+
+    bool allocate(unsigned int width, unsigned int height, uint32_t frame, unsigned int* shelf, unsigned int* x);
+
+    bool allocate(unsigned int width, unsigned int height, unsigned int* shelf, unsigned int* x);
+
+    bool allocateInShelf(unsigned int shelf, unsigned int width, unsigned int height, unsigned int* x);
+
+    void freeSpan(Shelf& shelf, unsigned int x, unsigned int width);
+
+    void evict(EntryList::iterator entry);
+
+    std::string _path;
+    Font::Format _format;
+    char* _fontData;
+    FT_FaceRec_* _face;
+    unsigned int _faceSize;
+    int _baseline;
+    Texture* _texture;
+    unsigned int _atlasSize;
+    unsigned int _padding;
+    std::vector<Shelf> _shelves;
+    unsigned int _shelvesHeight;
+    EntryList _entries;
+    std::unordered_map<uint64_t, EntryList::iterator> _glyphs;
+    unsigned int _glyphCount;
+    unsigned int _evictionCount;
+    uint32_t _warningFrame;
+};
+
+}
+
+#endif
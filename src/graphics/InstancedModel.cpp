@@ -0,0 +1,253 @@
+#include "../core/Base.h"
+#include "../graphics/InstancedModel.h"
+#include "../graphics/Model.h"
+#include "../graphics/MeshPart.h"
+#include "../graphics/Technique.h"
+#include "../graphics/Pass.h"
+#include "../graphics/Node.h"
+#include "../graphics/Scene.h"
+#include "../graphics/Camera.h"
+#include "../renderer/BGFXRenderer.h"
+
+namespace gplay
+{
+
+InstancedModel::InstancedModel(Model* model) : Drawable(),
+    _model(model), _culling(true)
+{
+    GP_ASSERT(model);
+    model->addRef();
+}
+
+InstancedModel::~InstancedModel()
+{
+    removeAllInstances();
+    SAFE_RELEASE(_model);
+}
+
+InstancedModel* InstancedModel::create(Model* model)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(model->getNode() == NULL);
+    return new InstancedModel(model);
+}
+
+Model* InstancedModel::getModel() const
+{
+    return _model;
+}
+
+void InstancedModel::addInstance(Node* node)
+{
+    GP_ASSERT(node);
+    node->addRef();
+    _instances.push_back(node);
+}
+
+void InstancedModel::removeInstance(Node* node)
+{
+    std::vector<Node*>::iterator itr = std::find(_instances.begin(), _instances.end(), node);
+    if (itr != _instances.end())
+    {
+        _instances.erase(itr);
+        SAFE_RELEASE(node);
+    }
+}
+
+void InstancedModel::removeAllInstances()
+{
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_instances[i]);
+    }
+    _instances.clear();
+}
+
+unsigned int InstancedModel::getInstanceCount() const
+{
+    return (unsigned int)_instances.size();
+}
+
+Node* InstancedModel::getInstance(unsigned int index) const
+{
+    GP_ASSERT(index < _instances.size());
+    return _instances[index];
+}
+
+void InstancedModel::setCullingEnabled(bool enabled)
+{
+    _culling = enabled;
+}
+
+bool InstancedModel::isCullingEnabled() const
+{
+    return _culling;
+}
+
+unsigned int InstancedModel::getVisibleInstanceCount() const
+{
+    return (unsigned int)_transforms.size();
+}
+
+void InstancedModel::setNode(Node* node)
+{
+    Drawable::setNode(node);
+
+    // Bind the material auto-bindings of the model to our node.
+    _model->setNode(node);
+}
+
+void InstancedModel::gatherInstances()
+{
+    _transforms.clear();
+
+    Camera* camera = NULL;
+    if (_culling && _node && _node->getScene())
+    {
+        camera = _node->getScene()->getActiveCamera();
+    }
+
+    // Instance transforms are relative to our node, which world matrix is
+    // already part of the auto-bound matrices of the material.
+    Matrix inverseWorld;
+    bool relative = _node && !_node->getWorldMatrix().isIdentity();
+    if (relative)
+    {
+        _node->getWorldMatrix().invert(&inverseWorld);
+    }
+
+    const BoundingSphere& meshBounds = _model->getMesh()->getBoundingSphere();
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        Node* instance = _instances[i];
+        if (!instance->isEnabled())
+            continue;
+
+        const Matrix& world = instance->getWorldMatrix();
+        if (camera)
+        {
+            BoundingSphere bounds(meshBounds);
+            bounds.transform(world);
+            if (!bounds.intersects(camera->getFrustum()))
+                continue;
+        }
+
+        if (relative)
+        {
+            Matrix m;
+            Matrix::multiply(inverseWorld, world, &m);
+            _transforms.push_back(m);
+        }
+        else
+        {
+            _transforms.push_back(world);
+        }
+    }
+}
+
+unsigned int InstancedModel::draw()
+{
+    GP_ASSERT(_model && _model->getMesh());
+
+    if (!Renderer::getInstance().getCaps()._instancing)
+    {
+        GP_WARN("Instancing is not supported by the renderer.");
+        return 0;
+    }
+
+    gatherInstances();
+    if (_transforms.empty())
+        return 0;
+
+    const uint16_t stride = sizeof(Matrix);
+    uint32_t instanceCount = (uint32_t)_transforms.size();
+    uint32_t available = bgfx::getAvailInstanceDataBuffer(instanceCount, stride);
+    if (available < instanceCount)
+    {
+        GP_WARN("Instance data buffer full, drawing %u of %u instances.", available, instanceCount);
+        instanceCount = available;
+        if (instanceCount == 0)
+            return 0;
+    }
+
+    // One instance data buffer is shared by all the submits of this frame.
+    bgfx::InstanceDataBuffer idb;
+    bgfx::allocInstanceDataBuffer(&idb, instanceCount, stride);
+    memcpy(idb.data, &_transforms[0], instanceCount * stride);
+
+    Mesh* mesh = _model->getMesh();
+    unsigned int drawCount = 0;
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (no index buffers).
+        Material* material = _model->getMaterial();
+        if (material)
+        {
+            Technique* technique = material->getTechnique();
+            GP_ASSERT(technique);
+            unsigned int passCount = technique->getPassCount();
+            for (unsigned int i = 0; i < passCount; ++i)
+            {
+                Pass* pass = technique->getPassByIndex(i);
+                GP_ASSERT(pass);
+                pass->bind(mesh->getPrimitiveType());
+                mesh->_vertexBuffer->bind();
+                bgfx::setInstanceDataBuffer(&idb);
+                pass->unbind();
+                ++drawCount;
+            }
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            MeshPart* part = mesh->getPart(i);
+            GP_ASSERT(part);
+
+            Material* material = _model->getMaterial(i);
+            if (material)
+            {
+                Technique* technique = material->getTechnique();
+                GP_ASSERT(technique);
+                unsigned int passCount = technique->getPassCount();
+                for (unsigned int j = 0; j < passCount; ++j)
+                {
+                    Pass* pass = technique->getPassByIndex(j);
+                    GP_ASSERT(pass);
+                    pass->bind(part->getPrimitiveType());
+                    mesh->_vertexBuffer->bind();
+                    part->_indexBuffer->bind();
+                    bgfx::setInstanceDataBuffer(&idb);
+                    pass->unbind();
+                    ++drawCount;
+                }
+            }
+        }
+    }
+    return drawCount;
+}
+
+Drawable* InstancedModel::clone(NodeCloneContext& context)
+{
+    Model* model = static_cast<Model*>(_model->clone(context));
+    if (!model)
+    {
+        GP_ERROR("Failed to clone instanced model.");
+        return NULL;
+    }
+
+    InstancedModel* instancedModel = new InstancedModel(model);
+    model->release();
+    instancedModel->_culling = _culling;
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        // Instances that are part of the cloned hierarchy are remapped to their clone.
+        Node* clonedNode = context.findClonedNode(_instances[i]);
+        instancedModel->addInstance(clonedNode ? clonedNode : _instances[i]);
+    }
+    return instancedModel;
+}
+
+}
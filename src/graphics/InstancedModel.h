@@ -0,0 +1,153 @@
+#ifndef INSTANCEDMODEL_H_
+#define INSTANCEDMODEL_H_
+
+#include "../core/Ref.h"
+#include "../graphics/Drawable.h"
+#include "../math/Matrix.h"
+
+namespace gplay
+{
+
+class Model;
+
+/**
+ * Defines a drawable that renders many copies of a Model in one draw call per mesh part and pass.
+ *
+ * The world matrices of the instance nodes are gathered into a bgfx instance data buffer,
+ * instances outside the frustum of the active scene camera being skipped. The material of
+ * the model must use a shader that reads the instance transform from the i_data0..i_data3
+ * attributes (e.g. the forward shaders compiled with the INSTANCED define).
+ *
+ * Material auto-bindings are resolved against the node this InstancedModel is attached to,
+ * instance transforms are uploaded relative to that node. Instance nodes do not need to be
+ * part of the scene, and should not have their own drawable for the same model.
+ */
+class InstancedModel : public Ref, public Drawable
+{
+    friend class Node;
+
+public:
+
+    /**
+     * Creates an instanced model that draws the mesh and materials of the given model.
+     *
+     * The model should not be attached to a node itself.
+     *
+     * @param model The model to draw instances of.
+     *
+     * @return The new instanced model.
+     * @script{create}
+     */
+    static InstancedModel* create(Model* model);
+
+    /**
+     * Returns the model drawn by this instanced model.
+     *
+     * @return The model.
+     */
+    Model* getModel() const;
+
+    /**
+     * Adds an instance. The world matrix of the node is used as the instance transform.
+     *
+     * @param node The instance node.
+     */
+    void addInstance(Node* node);
+
+    /**
+     * Removes an instance.
+     *
+     * @param node The instance node to remove.
+     */
+    void removeInstance(Node* node);
+
+    /**
+     * Removes all instances.
+     */
+    void removeAllInstances();
+
+    /**
+     * Returns the number of instances.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Returns the instance node at the given index.
+     *
+     * @param index The index of the instance.
+     *
+     * @return The instance node.
+     */
+    Node* getInstance(unsigned int index) const;
+
+    /**
+     * Enables or disables per instance frustum culling (enabled by default).
+     *
+     * @param enabled true to cull instances against the frustum of the active camera.
+     */
+    void setCullingEnabled(bool enabled);
+
+    /**
+     * Determines if per instance frustum culling is enabled.
+     *
+     * @return true if culling is enabled, false otherwise.
+     */
+    bool isCullingEnabled() const;
+
+    /**
+     * Returns the number of instances drawn by the last call to draw().
+     *
+     * @return The number of visible instances.
+     */
+    unsigned int getVisibleInstanceCount() const;
+
+    /**
+     * @see Drawable::draw
+     */
+    unsigned int draw();
+
+protected:
+
+    /**
+     * @see Drawable::setNode
+     */
+    void setNode(Node* node);
+
+    /**
+     * @see Drawable::clone
+     */
+    Drawable* clone(NodeCloneContext& context);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    InstancedModel(Model* model);
+
+    /**
+     * Destructor. Hidden use release() instead.
+     */
+    ~InstancedModel();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    InstancedModel& operator=(const InstancedModel&);
+
+    /**
+     * Collects the transforms of the visible instances into _transforms.
+     */
+    void gatherInstances();
+
+    Model* _model;
+    std::vector<Node*> _instances;
+    std::vector<Matrix> _transforms;
+    bool _culling;
+};
+
+}
+
+#endif
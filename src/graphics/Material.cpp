@@ -6,6 +6,7 @@
 #include "../graphics/Pass.h"
 #include "../core/Properties.h"
 #include "../graphics/Node.h"
+#include "../core/ResourceCache.h"
 
 namespace gplay
 {
@@ -17,6 +18,9 @@ Material::Material() :
 
 Material::~Material()
 {
+    if (!_cacheKey.empty())
+        ResourceCache::remove(ResourceCache::MATERIAL, _cacheKey.c_str(), this);
+
     // Destroy all the techniques.
     for (size_t i = 0, count = _techniques.size(); i < count; ++i)
     {
@@ -45,6 +49,15 @@ Material* Material::create(const char* url)
 
 Material* Material::create(const char* url, PassCallback callback, void* cookie)
 {
+    // Clone the material loaded from this url. A callback can change the passes, these materials are not cached.
+    const bool cached = callback == NULL && ResourceCache::getBudget(ResourceCache::MATERIAL) > 0;
+    if (cached)
+    {
+        Material* prototype = static_cast<Material*>(ResourceCache::find(ResourceCache::MATERIAL, url));
+        if (prototype)
+            return prototype->clone();
+    }
+
     // Load the material properties from file.
     Properties* properties = Properties::create(url);
     if (properties == NULL)
@@ -56,6 +69,16 @@ Material* Material::create(const char* url, PassCallback callback, void* cookie)
     Material* material = create((strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace(), callback, cookie);
     SAFE_DELETE(properties);
 
+    if (material && cached)
+    {
+        // The cache keeps the loaded material as the prototype of the materials of this url.
+        material->_cacheKey = url;
+        ResourceCache::add(ResourceCache::MATERIAL, url, material, material->getMemorySize());
+        Material* clone = material->clone();
+        material->release();
+        return clone;
+    }
+
     return material;
 }
 
@@ -511,6 +534,21 @@ void Material::loadRenderState(RenderState* renderState, Properties* properties)
     }
 }
 
+size_t Material::getMemorySize() const
+{
+    size_t size = sizeof(Material) + getParameterCount() * sizeof(MaterialParameter);
+    for (size_t i = 0, count = _techniques.size(); i < count; ++i)
+    {
+        const Technique* technique = _techniques[i];
+        size += sizeof(Technique) + technique->getParameterCount() * sizeof(MaterialParameter);
+        for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+        {
+            size += sizeof(Pass) + technique->getPassByIndex(j)->getParameterCount() * sizeof(MaterialParameter);
+        }
+    }
+    return size;
+}
+
 bool Material::reload()
 {
     bool sucessAll = true;
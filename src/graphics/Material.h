@@ -46,6 +46,9 @@ public:
      * Creates a material using the data from the Properties object defined at the specified URL, 
      * where the URL is of the format "<file-path>.<extension>#<namespace-id>/<namespace-id>/.../<namespace-id>"
      * (and "#<namespace-id>/<namespace-id>/.../<namespace-id>" is optional). 
+     *
+     * The material loaded from an URL is kept in the ResourceCache, so that the next materials
+     * created from the same URL are cloned from it instead of being loaded again.
      * 
      * @param url The URL pointing to the Properties object defining the material.
      * 
@@ -224,8 +227,14 @@ private:
      */
     static void loadRenderState(RenderState* renderState, Properties* properties);
 
+    /**
+     * Returns an estimate of the memory used by the material.
+     */
+    size_t getMemorySize() const;
+
     Technique* _currentTechnique;
     std::vector<Technique*> _techniques;
+    std::string _cacheKey;
 };
 
 }
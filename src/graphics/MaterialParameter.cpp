@@ -524,21 +524,33 @@ void MaterialParameter::bind(Effect* effect)
     // we need to update our uniform to point to the new effect's uniform.
     if (!_uniform || _uniform->getEffect() != effect)
     {
-        //@@_uniform = effect->getUniform(_name.c_str());
-        _uniform = effect->getUniform(_uniformName.c_str());
-
+        _uniform = resolveUniform(effect);
         if (!_uniform)
-        {
-            if ((_loggerDirtyBits & UNIFORM_NOT_FOUND) == 0)
-            {
-                // This parameter was not found in the specified effect, so do nothing.
-                GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
-                _loggerDirtyBits |= UNIFORM_NOT_FOUND;
-            }
             return;
-        }
     }
 
+    upload(effect);
+}
+
+Uniform* MaterialParameter::resolveUniform(Effect* effect)
+{
+    GP_ASSERT(effect);
+
+    //@@Uniform* uniform = effect->getUniform(_name.c_str());
+    Uniform* uniform = effect->getUniform(_uniformName.c_str());
+    if (!uniform && (_loggerDirtyBits & UNIFORM_NOT_FOUND) == 0)
+    {
+        // This parameter was not found in the specified effect, so do nothing.
+        GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
+        _loggerDirtyBits |= UNIFORM_NOT_FOUND;
+    }
+    return uniform;
+}
+
+void MaterialParameter::upload(Effect* effect)
+{
+    GP_ASSERT(_uniform);
+
     switch (_type)
     {
     case MaterialParameter::FLOAT:
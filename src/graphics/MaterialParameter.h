@@ -435,6 +435,16 @@ private:
 
     void bind(Effect* effect);
 
+    /**
+     * Looks up the uniform of this parameter in the given effect, logging once if it is missing.
+     */
+    Uniform* resolveUniform(Effect* effect);
+
+    /**
+     * Uploads the value of this parameter to its current uniform.
+     */
+    void upload(Effect* effect);
+
     void applyAnimationValue(AnimationValue* value, float blendWeight, int components);
 
     void cloneInto(MaterialParameter* materialParameter) const;
@@ -25,6 +25,9 @@ class Mesh : public Ref
 {
     friend class Model;
     friend class Bundle;
+    friend class RenderQueue;
+    friend class InstancedModel;
+    friend class MeshSkin;
 
 public:
 
@@ -362,6 +365,8 @@ private:
     bool _dynamic;
     BoundingBox _boundingBox;
     BoundingSphere _boundingSphere;
+    // Bounds of the vertices influenced by each joint of skinned meshes loaded from bundles.
+    std::vector<BoundingBox> _jointBounds;
 
 private:
     VertexBuffer * _vertexBuffer;
@@ -7,7 +7,8 @@ namespace gplay {
 
 MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
     : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _started(false)
+    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _started(false),
+    _transient(false), _reservedVertexCount(0), _reservedIndexCount(0), _minCapacity(initialCapacity), _frameVertexCount(0)
 {
     BGFXVertexBuffer::createVertexDecl(vertexFormat, _vertexDecl);
 
@@ -48,14 +49,18 @@ MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveTy
 void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
 {
     GP_ASSERT(vertices);
-    
+
+    // Transient batches are flushed instead of growing.
+    if (_transient && !ensureTransientSpace(vertexCount, indexCount))
+        return;
+
     unsigned int newVertexCount = _vertexCount + vertexCount;
     unsigned int newIndexCount = _indexCount + indexCount;
     if (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
         newIndexCount += 2; // need an extra 2 indices for connecting strips with degenerate triangles
     
     // Do we need to grow the batch?
-    while (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity))
+    while (!_transient && (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity)))
     {
         if (_growSize == 0)
             return; // growing disabled, just clip batch
@@ -112,9 +117,134 @@ unsigned int MeshBatch::getCapacity() const
 
 void MeshBatch::setCapacity(unsigned int capacity)
 {
+    if (resize(capacity))
+        _minCapacity = capacity;
+}
+
+void MeshBatch::setTransient(bool transient)
+{
+    GP_ASSERT(!_started);
+    if (transient == _transient)
+        return;
+
+    _transient = transient;
+
+    // Transient batches don't use the CPU side arrays, reallocate them for the current capacity.
+    SAFE_DELETE_ARRAY(_vertices);
+    SAFE_DELETE_ARRAY(_indices);
+    _verticesPtr = NULL;
+    _indicesPtr = NULL;
+    _vertexCount = 0;
+    _indexCount = 0;
+    unsigned int capacity = _capacity;
+    _capacity = 0;
     resize(capacity);
 }
 
+bool MeshBatch::isTransient() const
+{
+    return _transient;
+}
+
+void MeshBatch::reserveTransientBuffers()
+{
+    _frameVertexCount += _vertexCount;
+    _vertexCount = 0;
+    _indexCount = 0;
+
+    _reservedVertexCount = bgfx::getAvailTransientVertexBuffer(_vertexCapacity, _vertexDecl);
+    if (_reservedVertexCount < _vertexCapacity)
+        GP_WARN("Available transient vertices count is less than requested %d/%d.", _reservedVertexCount, _vertexCapacity);
+    _reservedIndexCount = 0;
+    if (_indexed)
+    {
+        _reservedIndexCount = bgfx::getAvailTransientIndexBuffer(_indexCapacity);
+        if (_reservedIndexCount < _indexCapacity)
+            GP_WARN("Available transient indices count is less than requested %d/%d.", _reservedIndexCount, _indexCapacity);
+    }
+
+    _verticesPtr = NULL;
+    _indicesPtr = NULL;
+    if (_reservedVertexCount > 0)
+    {
+        bgfx::allocTransientVertexBuffer(&_transientVertexBuffer, _reservedVertexCount, _vertexDecl);
+        _verticesPtr = _transientVertexBuffer.data;
+    }
+    if (_reservedIndexCount > 0)
+    {
+        bgfx::allocTransientIndexBuffer(&_transientIndexBuffer, _reservedIndexCount);
+        _indicesPtr = (unsigned short*)_transientIndexBuffer.data;
+    }
+}
+
+bool MeshBatch::ensureTransientSpace(unsigned int vertexCount, unsigned int indexCount)
+{
+    GP_ASSERT(_started);
+
+    // Buffers are reserved by the first add() after start(), a batch that stays empty reserves nothing.
+    unsigned int stitchCount = (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0) ? 2 : 0;
+    if (_reservedVertexCount > 0 && _vertexCount + vertexCount <= _reservedVertexCount && (!_indexed || _indexCount + indexCount + stitchCount <= _reservedIndexCount))
+        return true;
+
+    // Draw what has been added so far and continue in new buffers, which are grown
+    // like the arrays of a non transient batch so that later batches flush less.
+    if (_vertexCount > 0)
+    {
+        submit(_vertexCount, _indexCount);
+        growTransient();
+    }
+
+    // Grow the batch until the primitives fit in an empty batch.
+    while (vertexCount > _vertexCapacity || (_indexed && indexCount > _indexCapacity))
+    {
+        if (!growTransient())
+        {
+            GP_WARN("Primitives exceed the capacity of the mesh batch (%d vertices, %d indices).", vertexCount, indexCount);
+            reserveTransientBuffers();
+            return false;
+        }
+    }
+
+    reserveTransientBuffers();
+    return vertexCount <= _reservedVertexCount && (!_indexed || indexCount <= _reservedIndexCount);
+}
+
+bool MeshBatch::growTransient()
+{
+    if (_growSize == 0)
+        return false;
+
+    // Don't grow past what is left of the transient buffers in this frame, the
+    // reservation would be clipped anyway. Indices are 16-bit, the capacity of
+    // an indexed batch is also limited to USHRT_MAX vertices.
+    unsigned int vertexCapacity = getVertexCapacity(_capacity + _growSize);
+    if (bgfx::getAvailTransientVertexBuffer(vertexCapacity, _vertexDecl) < vertexCapacity)
+        return false;
+    if (_indexed && (vertexCapacity > USHRT_MAX || bgfx::getAvailTransientIndexBuffer(vertexCapacity) < vertexCapacity))
+        return false;
+
+    return resize(_capacity + _growSize);
+}
+
+unsigned int MeshBatch::getVertexCapacity(unsigned int capacity) const
+{
+    switch (_primitiveType)
+    {
+    case Mesh::LINES:
+        return capacity * 2;
+    case Mesh::LINE_STRIP:
+        return capacity + 1;
+    case Mesh::POINTS:
+        return capacity;
+    case Mesh::TRIANGLES:
+        return capacity * 3;
+    case Mesh::TRIANGLE_STRIP:
+        return capacity + 2;
+    default:
+        return 0;
+    }
+}
+
 bool MeshBatch::resize(unsigned int capacity)
 {
     if (capacity == 0)
@@ -130,25 +260,9 @@ bool MeshBatch::resize(unsigned int capacity)
     unsigned char* oldVertices = _vertices;
     unsigned short* oldIndices = _indices;
 
-    unsigned int vertexCapacity = 0;
-    switch (_primitiveType)
+    unsigned int vertexCapacity = getVertexCapacity(capacity);
+    if (vertexCapacity == 0)
     {
-    case Mesh::LINES:
-        vertexCapacity = capacity * 2;
-        break;
-    case Mesh::LINE_STRIP:
-        vertexCapacity = capacity + 1;
-        break;
-    case Mesh::POINTS:
-        vertexCapacity = capacity;
-        break;
-    case Mesh::TRIANGLES:
-        vertexCapacity = capacity * 3;
-        break;
-    case Mesh::TRIANGLE_STRIP:
-        vertexCapacity = capacity + 2;
-        break;
-    default:
         GP_ERROR("Unsupported primitive type for mesh batch (%d).", _primitiveType);
         return false;
     }
@@ -163,6 +277,17 @@ bool MeshBatch::resize(unsigned int capacity)
         return false;
     }
 
+    // Assign new capacities
+    unsigned int oldVertexCapacity = _vertexCapacity;
+    unsigned int oldIndexCapacity = _indexCapacity;
+    _capacity = capacity;
+    _vertexCapacity = vertexCapacity;
+    _indexCapacity = indexCapacity;
+
+    // Transient batches reserve their capacity in transient buffers when primitives are added.
+    if (_transient)
+        return true;
+
     // Allocate new data and reset pointers.
     unsigned int voffset = _verticesPtr - _vertices;
     unsigned int vBytes = vertexCapacity * _vertexFormat.getVertexSize();
@@ -182,17 +307,12 @@ bool MeshBatch::resize(unsigned int capacity)
 
     // Copy old data back in
     if (oldVertices)
-        memcpy(_vertices, oldVertices, std::min(_vertexCapacity, vertexCapacity) * _vertexFormat.getVertexSize());
+        memcpy(_vertices, oldVertices, std::min(oldVertexCapacity, vertexCapacity) * _vertexFormat.getVertexSize());
     SAFE_DELETE_ARRAY(oldVertices);
     if (oldIndices)
-        memcpy(_indices, oldIndices, std::min(_indexCapacity, indexCapacity) * sizeof(unsigned short));
+        memcpy(_indices, oldIndices, std::min(oldIndexCapacity, indexCapacity) * sizeof(unsigned short));
     SAFE_DELETE_ARRAY(oldIndices);
 
-    // Assign new capacities
-    _capacity = capacity;
-    _vertexCapacity = vertexCapacity;
-    _indexCapacity = indexCapacity;
-
     return true;
 }
 
@@ -203,11 +323,24 @@ void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsig
 
 void MeshBatch::start()
 {
+    _started = true;
+    if (_transient)
+    {
+        // Transient buffers are reserved lazily by add().
+        _vertexCount = 0;
+        _indexCount = 0;
+        _frameVertexCount = 0;
+        _reservedVertexCount = 0;
+        _reservedIndexCount = 0;
+        _verticesPtr = NULL;
+        _indicesPtr = NULL;
+        return;
+    }
+
     _vertexCount = 0;
     _indexCount = 0;
     _verticesPtr = _vertices;
     _indicesPtr = _indices;
-    _started = true;
 }
 
 bool MeshBatch::isStarted() const
@@ -218,6 +351,14 @@ bool MeshBatch::isStarted() const
 void MeshBatch::finish()
 {
     _started = false;
+
+    // Give back one grow step of a transient batch when the primitives added since start()
+    // would have fit without it, so that a batch that grew for a peak stops reserving it.
+    if (_transient && _growSize > 0 && _capacity >= _minCapacity + _growSize &&
+        _frameVertexCount + _vertexCount <= getVertexCapacity(_capacity - _growSize))
+    {
+        resize(_capacity - _growSize);
+    }
 }
 
 void MeshBatch::draw()
@@ -225,29 +366,38 @@ void MeshBatch::draw()
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
+    // Transient batches are already in transient buffers.
+    if (_transient)
+    {
+        submit(_vertexCount, _indexCount);
+        return;
+    }
+
     // using bgfx transient buffers
 
     uint32_t maxVertices = bgfx::getAvailTransientVertexBuffer(_vertexCount, _vertexDecl);
     if(maxVertices < _vertexCount)
         GP_WARN("Available transient vertices count is less than requested %d/%d.", _vertexCount, maxVertices);
 
-    bgfx::TransientVertexBuffer tvb;
-    bgfx::allocTransientVertexBuffer(&tvb, maxVertices, _vertexDecl);
-    memcpy(tvb.data, &_vertices[0], _vertexDecl.getSize(maxVertices));
-    bgfx::setVertexBuffer(0, &tvb, 0, maxVertices);
+    bgfx::allocTransientVertexBuffer(&_transientVertexBuffer, maxVertices, _vertexDecl);
+    memcpy(_transientVertexBuffer.data, &_vertices[0], _vertexDecl.getSize(maxVertices));
 
+    uint32_t maxIndices = 0;
     if(_indexed)
     {
-        uint32_t maxIndices = bgfx::getAvailTransientIndexBuffer(_indexCount);
+        maxIndices = bgfx::getAvailTransientIndexBuffer(_indexCount);
         if(maxIndices < _indexCount)
             GP_WARN("Available transient indices count is less than requested %d/%d.", _indexCount, maxIndices);
 
-        bgfx::TransientIndexBuffer tib;
-        bgfx::allocTransientIndexBuffer(&tib, maxIndices);
-        memcpy(tib.data, &_indices[0], sizeof(unsigned short)*maxIndices);
-        bgfx::setIndexBuffer(&tib, 0, maxIndices);
+        bgfx::allocTransientIndexBuffer(&_transientIndexBuffer, maxIndices);
+        memcpy(_transientIndexBuffer.data, &_indices[0], sizeof(unsigned short)*maxIndices);
     }
 
+    submit(maxVertices, maxIndices);
+}
+
+void MeshBatch::submit(unsigned int vertexCount, unsigned int indexCount)
+{
     // Bind the material.
     Technique* technique = _material->getTechnique();
     GP_ASSERT(technique);
@@ -256,11 +406,15 @@ void MeshBatch::draw()
     {
         Pass* pass = technique->getPassByIndex(i);
         GP_ASSERT(pass);
+
+        // Buffers are unbound by each submit.
+        bgfx::setVertexBuffer(0, &_transientVertexBuffer, 0, vertexCount);
+        if(_indexed)
+            bgfx::setIndexBuffer(&_transientIndexBuffer, 0, indexCount);
+
         pass->bind(_primitiveType);
         pass->unbind();
     }
-
-    return;
-}    
+}
 
 }
@@ -64,6 +64,31 @@ public:
      */
     void setCapacity(unsigned int capacity);
 
+    /**
+     * Sets whether the batch writes its primitives directly into transient GPU buffers.
+     *
+     * A transient batch reserves bgfx transient vertex and index buffers for its capacity
+     * on the first add() after it is started, then writes the primitives in place instead
+     * of copying them to a CPU side array that draw() copies again. When the reserved buffers
+     * are full, the primitives already added are drawn and new buffers are reserved, so a
+     * batch is never clipped by the 16-bit index range. The capacity grows up to what is
+     * left of the transient buffers and shrinks back in finish() when it was not needed.
+     *
+     * Transient buffers only live for the current frame: a transient batch must be started,
+     * filled and drawn in the same frame, and is drawn with its material as it is when the
+     * batch is flushed. The batch must not be started when changing this mode.
+     *
+     * @param transient true to write into transient buffers, false to use CPU side arrays.
+     */
+    void setTransient(bool transient);
+
+    /**
+     * Determines if the batch writes its primitives directly into transient GPU buffers.
+     *
+     * @return true if the batch is transient, false otherwise.
+     */
+    bool isTransient() const;
+
     /**
      * Returns the material for this mesh batch.
      *
@@ -160,8 +185,31 @@ private:
 
     void add(const void* vertices, size_t size, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
 
+    unsigned int getVertexCapacity(unsigned int capacity) const;
+
     bool resize(unsigned int capacity);
 
+    /**
+     * Reserves transient buffers for the capacity of the batch and resets the batch position.
+     */
+    void reserveTransientBuffers();
+
+    /**
+     * Makes room for primitives in the transient buffers, drawing the batch and reserving
+     * new buffers when they are full. Returns false if the primitives can't be added.
+     */
+    bool ensureTransientSpace(unsigned int vertexCount, unsigned int indexCount);
+
+    /**
+     * Grows a transient batch by its grow size, unless it would exceed the transient buffers left.
+     */
+    bool growTransient();
+
+    /**
+     * Binds the batch buffers and submits a draw call for each pass of the material.
+     */
+    void submit(unsigned int vertexCount, unsigned int indexCount);
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -177,6 +225,13 @@ private:
     unsigned short* _indices;
     unsigned short* _indicesPtr;
     bool _started;
+    bool _transient;
+    unsigned int _reservedVertexCount;
+    unsigned int _reservedIndexCount;
+    unsigned int _minCapacity;
+    unsigned int _frameVertexCount;
+    bgfx::TransientVertexBuffer _transientVertexBuffer;
+    bgfx::TransientIndexBuffer _transientIndexBuffer;
     bgfx::VertexDecl _vertexDecl;
 };
 
@@ -16,7 +16,10 @@ typedef GeometryBuffer IndexBuffer;
 class MeshPart
 {
     friend class Mesh;
+    friend class Bundle;
     friend class Model;
+    friend class RenderQueue;
+    friend class InstancedModel;
 
 public:
 
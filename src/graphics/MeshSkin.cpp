@@ -2,6 +2,7 @@
 #include "../graphics/MeshSkin.h"
 #include "../graphics/Joint.h"
 #include "../graphics/Model.h"
+#include "../math/MathUtil.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
@@ -10,7 +11,8 @@ namespace gplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL),
+      _paletteDirty(true), _bindMatricesDirty(true), _boundsPadding(0.0f)
 {
 }
 
@@ -29,6 +31,8 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    _bindMatricesDirty = true;
+    _paletteDirty = true;
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -147,6 +151,8 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
     }
 
     _joints[index] = joint;
+    _bindMatricesDirty = true;
+    _paletteDirty = true;
 
     if (joint)
     {
@@ -159,12 +165,121 @@ Vector4* MeshSkin::getMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
+    if (_bindMatricesDirty)
+    {
+        updateBindMatrices();
+    }
+
+    // Joints flag us when they move, the palette is reused by all the passes until then.
+    if (_paletteDirty)
+    {
+        _paletteDirty = false;
+
+        float* palette = &_matrixPalette[0].x;
+        for (size_t i = 0, count = _joints.size(); i < count; i++)
+        {
+            GP_ASSERT(_joints[i]);
+            MathUtil::multiplyMatrixRows3(_joints[i]->getWorldMatrix().m, _bindMatrices[i].m, palette + i * PALETTE_ROWS * 4);
+        }
+    }
+    return _matrixPalette;
+}
+
+void MeshSkin::updateBindMatrices() const
+{
+    _bindMatricesDirty = false;
+    _paletteDirty = true;
+
+    _bindMatrices.resize(_joints.size());
     for (size_t i = 0, count = _joints.size(); i < count; i++)
     {
         GP_ASSERT(_joints[i]);
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        Matrix::multiply(_joints[i]->getInverseBindPose(), _bindShape, &_bindMatrices[i]);
     }
-    return _matrixPalette;
+
+    // Each joint moves the vertices it influences rigidly, keeping their distance to it, and the
+    // skinned vertices are blends of these moved positions. They are therefore bounded by the box
+    // of the moving joints enlarged by the largest distance between a joint and its vertices.
+    _boundsPadding = 0.0f;
+    if (_joints.empty() || !_model || !_model->getMesh())
+        return;
+
+    const Mesh* mesh = _model->getMesh();
+    float distanceSq = 0.0f;
+    for (size_t i = 0, count = _joints.size(); i < count; i++)
+    {
+        // Without the bounds of the vertices of each joint, any joint may move the whole mesh.
+        BoundingBox vertices;
+        if (mesh->_jointBounds.empty())
+            vertices.set(mesh->getBoundingBox());
+        else if (i < mesh->_jointBounds.size() && mesh->_jointBounds[i].min.x <= mesh->_jointBounds[i].max.x)
+            vertices.set(mesh->_jointBounds[i]);
+        else
+            continue;
+        vertices.transform(_bindShape);
+
+        Matrix bindPose;
+        Vector3 position;
+        _joints[i]->getInverseBindPose().invert(&bindPose);
+        bindPose.getTranslation(&position);
+
+        // The vertices are inside their box, the farthest point of the box from the joint is a corner.
+        Vector3 corners[8];
+        vertices.getCorners(corners);
+        for (unsigned int j = 0; j < 8; j++)
+        {
+            distanceSq = std::max(distanceSq, position.distanceSquared(corners[j]));
+        }
+    }
+    _boundsPadding = sqrt(distanceSq);
+}
+
+void MeshSkin::jointTransformChanged()
+{
+    _paletteDirty = true;
+    if (_model && _model->getNode())
+    {
+        _model->getNode()->setBoundsDirty();
+    }
+}
+
+bool MeshSkin::getBounds(const Matrix& world, BoundingBox* box) const
+{
+    GP_ASSERT(box);
+
+    if (_joints.empty())
+        return false;
+
+    if (_bindMatricesDirty)
+    {
+        updateBindMatrices();
+    }
+
+    Vector3 position;
+    for (size_t i = 0, count = _joints.size(); i < count; i++)
+    {
+        GP_ASSERT(_joints[i]);
+        _joints[i]->getWorldMatrix().getTranslation(&position);
+        world.transformPoint(&position);
+        if (i == 0)
+            box->set(position, position);
+        else
+            box->merge(BoundingBox(position, position));
+    }
+
+    // The padding is scaled along with the skeleton.
+    Matrix skeleton;
+    Vector3 scale;
+    Matrix::multiply(world, (_rootJoint ? _rootJoint : _joints[0])->getWorldMatrix(), &skeleton);
+    skeleton.getScale(&scale);
+    const float padding = _boundsPadding * std::max(std::max(fabs(scale.x), fabs(scale.y)), fabs(scale.z));
+    box->min.x -= padding;
+    box->min.y -= padding;
+    box->min.z -= padding;
+    box->max.x += padding;
+    box->max.y += padding;
+    box->max.z += padding;
+    return true;
 }
 
 unsigned int MeshSkin::getMatrixPaletteSize() const
@@ -221,12 +336,8 @@ void MeshSkin::transformChanged(Transform* transform, long cookie)
     switch (cookie)
     {
     case 1:
-        // The direct parent of our joint hierarchy has changed.
-        // Dirty the bounding volume for our model's node. This special
-        // case allows us to have much tighter bounding volumes for
-        // skinned meshes by only considering local skin/joint transformations
-        // during bounding volume computation instead of fully resolved
-        // joint transformations.
+        // The direct parent of our joint hierarchy has changed, which moves
+        // the joints the bounding volume of our model's node is computed from.
         if (_model && _model->getNode())
         {
             _model->getNode()->setBoundsDirty();
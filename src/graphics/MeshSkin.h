@@ -2,6 +2,7 @@
 #define MESHSKIN_H_
 
 #include "../math/Matrix.h"
+#include "../math/BoundingBox.h"
 #include "../math/Transform.h"
 
 namespace gplay
@@ -92,6 +93,9 @@ public:
 
     /**
      * Returns the pointer to the Vector4 array for the purpose of binding to a shader.
+     *
+     * The palette is only recomputed when a joint moved since the last call, so
+     * drawing the skin in several passes or views computes it once per change.
      * 
      * @return The pointer to the matrix palette.
      */
@@ -175,6 +179,26 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Computes the inverse bind pose times bind shape matrix of each joint.
+     */
+    void updateBindMatrices() const;
+
+    /**
+     * Called by the joints when they move, the palette and the bounds of the model follow them.
+     */
+    void jointTransformChanged();
+
+    /**
+     * Gets the world-space bounds of the skinned mesh from the positions of the joints.
+     *
+     * @param world The world matrix of the node of the model.
+     * @param box Populated with the bounding box of the skinned mesh.
+     *
+     * @return False if the skin has no joints.
+     */
+    bool getBounds(const Matrix& world, BoundingBox* box) const;
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -189,7 +213,18 @@ private:
     // Each 4x3 row-wise matrix is represented as 3 Vector4's.
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
+
+    // The model using this skin.
     Model* _model;
+
+    // Per joint product of the inverse bind pose and the bind shape.
+    mutable std::vector<Matrix> _bindMatrices;
+    // Set when a joint moved since the palette was last computed.
+    mutable bool _paletteDirty;
+    // Set when the bind shape or an inverse bind pose changed.
+    mutable bool _bindMatricesDirty;
+    // Largest distance between a joint and the vertices it influences in bind pose, in skin space.
+    mutable float _boundsPadding;
 };
 
 }
@@ -5,16 +5,26 @@
 #include "../graphics/Technique.h"
 #include "../graphics/Pass.h"
 #include "../graphics/Node.h"
+#include "../graphics/RenderQueue.h"
+#include "../core/Game.h"
+
+// The default hysteresis of the level of detail selection.
+#define MODEL_LOD_HYSTERESIS 0.1f
+
+// Maximum number of cameras a level of detail is kept for, the least recently drawn is replaced.
+#define MODEL_LOD_CAMERA_MAX 4
 
 namespace gplay {
 
 Model::Model() : Drawable(),
-    _mesh(NULL), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL)
+    _mesh(NULL), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL),
+    _lod(0), _lodHysteresis(MODEL_LOD_HYSTERESIS), _lodFadeTime(0.0f), _lodFadeParametersDirty(true), _lodFading(false)
 {
 }
 
 Model::Model(Mesh* mesh) : Drawable(),
-    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL)
+    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _skin(NULL),
+    _lod(0), _lodHysteresis(MODEL_LOD_HYSTERESIS), _lodFadeTime(0.0f), _lodFadeParametersDirty(true), _lodFading(false)
 {
     GP_ASSERT(mesh);
     _partCount = mesh->getPartCount();
@@ -31,6 +41,10 @@ Model::~Model()
         }
         SAFE_DELETE_ARRAY(_partMaterials);
     }
+    for (size_t i = 0, count = _lods.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_lods[i].mesh);
+    }
     SAFE_RELEASE(_mesh);
     SAFE_DELETE(_skin);
 }
@@ -128,6 +142,7 @@ void Model::setMaterial(Material* material, int partIndex)
     {
         SAFE_RELEASE(oldMaterial);
     }
+    _lodFadeParametersDirty = true;
 
     if (material)
     {
@@ -198,6 +213,7 @@ void Model::setSkin(MeshSkin* skin)
         _skin = skin;
         if (_skin)
             _skin->_model = this;
+        setBoundsDirty();
     }
 }
 
@@ -229,7 +245,51 @@ unsigned int Model::draw()
 {
     GP_ASSERT(_mesh);
 
-    unsigned int partCount = _mesh->getPartCount();
+    LodState* lodState = _lods.empty() ? NULL : updateLod();
+    Mesh* mesh = getLodMesh(_lod);
+
+    if (_lodFadeParametersDirty)
+    {
+        updateLodFadeParameters();
+    }
+
+    RenderQueue* queue = RenderQueue::getCurrent();
+    if (!queue && lodState && lodState->fadingLod != lodState->lod)
+    {
+        // While fading, the previous level keeps the pixels the new level discards.
+        const float fade = _lodFadeTime > 0.0f ? (float)(Game::getGameTime() - lodState->fadeStartTime) / _lodFadeTime : 1.0f;
+        if (fade < 1.0f && !_lodFadeParameters.empty())
+        {
+            setLodFade(fade, -1.0f);
+            unsigned int drawCount = drawMesh(getLodMesh(lodState->fadingLod));
+            setLodFade(fade, 1.0f);
+            drawCount += drawMesh(mesh);
+
+            // Materials may be shared with models which are not fading.
+            setLodFade(1.0f, 1.0f);
+            return drawCount;
+        }
+        lodState->fadingLod = lodState->lod;
+    }
+
+    // Draws which don't fade keep all the pixels.
+    if (_lodFading)
+    {
+        setLodFade(1.0f, 1.0f);
+    }
+
+    if (queue)
+    {
+        return drawQueued(queue, mesh);
+    }
+    return drawMesh(mesh);
+}
+
+unsigned int Model::drawMesh(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    unsigned int partCount = mesh->getPartCount();
     if (partCount == 0)
     {
         // No mesh parts (no index buffers).
@@ -242,9 +302,9 @@ unsigned int Model::draw()
             {
                 Pass* pass = technique->getPassByIndex(i);
                 GP_ASSERT(pass);
-                pass->bind(_mesh->getPrimitiveType());
-                _mesh->_vertexBuffer->bind();
-                _mesh->draw();
+                pass->bind(mesh->getPrimitiveType());
+                mesh->_vertexBuffer->bind();
+                mesh->draw();
                 pass->unbind();
             }
         }
@@ -253,7 +313,7 @@ unsigned int Model::draw()
     {
         for (unsigned int i = 0; i < partCount; ++i)
         {
-            MeshPart* part = _mesh->getPart(i);
+            MeshPart* part = mesh->getPart(i);
             GP_ASSERT(part);
 
             // Get the material for this mesh part.
@@ -269,7 +329,7 @@ unsigned int Model::draw()
                     GP_ASSERT(pass);
                     pass->bind(part->getPrimitiveType());                  
 
-                    _mesh->_vertexBuffer->bind();
+                    mesh->_vertexBuffer->bind();
                     part->_indexBuffer->bind();
                     part->draw();
                     pass->unbind();
@@ -280,6 +340,270 @@ unsigned int Model::draw()
     return partCount;
 }
 
+bool Model::getBounds(BoundingBox* box, BoundingSphere* sphere) const
+{
+    GP_ASSERT(box);
+    GP_ASSERT(sphere);
+
+    if (!_node || !_mesh)
+        return false;
+
+    if (_skin)
+    {
+        if (!_skin->getBounds(_node->getWorldMatrix(), box))
+            return false;
+        sphere->set(*box);
+        return true;
+    }
+
+    const Matrix& world = _node->getWorldMatrix();
+    box->set(_mesh->getBoundingBox());
+    box->transform(world);
+    sphere->set(_mesh->getBoundingSphere());
+    sphere->transform(world);
+    return true;
+}
+
+unsigned int Model::drawQueued(RenderQueue* queue, Mesh* mesh)
+{
+    GP_ASSERT(queue);
+    GP_ASSERT(mesh);
+
+    // Distance from the camera, used to sort the draw items of this model.
+    float depth = _node ? -_node->getTranslationView().z : 0.0f;
+
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (no index buffers).
+        if (_material)
+        {
+            Technique* technique = _material->getTechnique();
+            GP_ASSERT(technique);
+            unsigned int passCount = technique->getPassCount();
+            for (unsigned int i = 0; i < passCount; ++i)
+            {
+                queue->add(technique->getPassByIndex(i), mesh, NULL, depth);
+            }
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            MeshPart* part = mesh->getPart(i);
+            GP_ASSERT(part);
+
+            Material* material = getMaterial(i);
+            if (material)
+            {
+                Technique* technique = material->getTechnique();
+                GP_ASSERT(technique);
+                unsigned int passCount = technique->getPassCount();
+                for (unsigned int j = 0; j < passCount; ++j)
+                {
+                    queue->add(technique->getPassByIndex(j), mesh, part, depth);
+                }
+            }
+        }
+    }
+    return partCount;
+}
+
+bool Model::addLod(Mesh* mesh, float screenSize)
+{
+    GP_ASSERT(mesh);
+    GP_ASSERT(_mesh);
+
+    if (mesh->getPartCount() != _mesh->getPartCount())
+    {
+        GP_WARN("Level of detail mesh '%s' has %d parts instead of %d.", mesh->getUrl(), mesh->getPartCount(), _mesh->getPartCount());
+        return false;
+    }
+    if (screenSize >= getLodScreenSize(getLodCount() - 1))
+    {
+        GP_WARN("Level of detail mesh '%s' must have a smaller screen size than the previous level.", mesh->getUrl());
+        return false;
+    }
+
+    Lod lod;
+    lod.mesh = mesh;
+    lod.screenSize = screenSize;
+    mesh->addRef();
+    _lods.push_back(lod);
+    return true;
+}
+
+unsigned int Model::getLodCount() const
+{
+    return (unsigned int)_lods.size() + 1;
+}
+
+Mesh* Model::getLodMesh(unsigned int level) const
+{
+    GP_ASSERT(level <= _lods.size());
+    return level == 0 ? _mesh : _lods[level - 1].mesh;
+}
+
+float Model::getLodScreenSize(unsigned int level) const
+{
+    GP_ASSERT(level <= _lods.size());
+    return level == 0 ? FLT_MAX : _lods[level - 1].screenSize;
+}
+
+unsigned int Model::getLod() const
+{
+    return _lod;
+}
+
+void Model::setLodHysteresis(float hysteresis)
+{
+    _lodHysteresis = hysteresis;
+}
+
+float Model::getLodHysteresis() const
+{
+    return _lodHysteresis;
+}
+
+void Model::setLodFadeTime(float time)
+{
+    _lodFadeTime = time;
+}
+
+float Model::getLodFadeTime() const
+{
+    return _lodFadeTime;
+}
+
+unsigned int Model::getLodForScreenSize(float screenSize) const
+{
+    unsigned int level = 0;
+    while (level < _lods.size() && screenSize < _lods[level].screenSize)
+    {
+        ++level;
+    }
+    return level;
+}
+
+Model::LodState* Model::updateLod()
+{
+    Scene* scene = _node ? _node->getScene() : NULL;
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    if (!camera)
+        return NULL;
+
+    // Each camera keeps its own level and cross-fade, so that drawing the model from another
+    // camera in the same frame doesn't switch the level or restart the fade of the others.
+    const double time = Game::getGameTime();
+    LodState* state = NULL;
+    for (size_t i = 0, count = _lodStates.size(); i < count; ++i)
+    {
+        if (_lodStates[i].camera == camera)
+        {
+            state = &_lodStates[i];
+            break;
+        }
+    }
+    const bool created = state == NULL;
+    if (created)
+    {
+        if (_lodStates.size() < MODEL_LOD_CAMERA_MAX)
+        {
+            _lodStates.push_back(LodState());
+            state = &_lodStates.back();
+        }
+        else
+        {
+            state = &_lodStates[0];
+            for (size_t i = 1, count = _lodStates.size(); i < count; ++i)
+            {
+                if (_lodStates[i].drawTime < state->drawTime)
+                    state = &_lodStates[i];
+            }
+        }
+        state->camera = camera;
+        state->lod = 0;
+        state->fadingLod = 0;
+        state->fadeStartTime = time;
+    }
+    state->drawTime = time;
+
+    BoundingSphere bounds;
+    if (getCachedBounds(&bounds))
+    {
+        // Projected diameter of the bounds as a fraction of the viewport height,
+        // the most detailed level is kept while the camera is inside of the bounds.
+        const float* m = camera->getViewProjectionMatrix().m;
+        const Vector3& center = bounds.center;
+        const float w = m[3] * center.x + m[7] * center.y + m[11] * center.z + m[15];
+        const float screenSize = w > bounds.radius ? bounds.radius * fabs(camera->getProjectionMatrix().m[5]) / w : FLT_MAX;
+
+        unsigned int level = getLodForScreenSize(screenSize * (1.0f + _lodHysteresis));
+        if (level <= state->lod)
+        {
+            level = std::min(state->lod, getLodForScreenSize(screenSize * (1.0f - _lodHysteresis)));
+        }
+        if (level != state->lod)
+        {
+            // A new fade starts from the level currently drawn, a new camera starts without fading.
+            state->fadingLod = created ? level : state->lod;
+            state->fadeStartTime = time;
+            state->lod = level;
+        }
+    }
+
+    _lod = state->lod;
+    return state;
+}
+
+void Model::updateLodFadeParameters()
+{
+    _lodFadeParametersDirty = false;
+    _lodFadeParameters.clear();
+
+    Material* materials[1] = { _material };
+    Material** list = _partMaterials ? _partMaterials : materials;
+    const unsigned int count = _partMaterials ? _partCount : 1;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Material* material = list[i];
+        if (!material)
+            continue;
+
+        // Only materials which effects declare the uniform get the parameter, others would warn when bound.
+        bool declared = false;
+        for (unsigned int t = 0, techniqueCount = material->getTechniqueCount(); t < techniqueCount && !declared; ++t)
+        {
+            Technique* technique = material->getTechniqueByIndex(t);
+            for (unsigned int p = 0, passCount = technique->getPassCount(); p < passCount && !declared; ++p)
+            {
+                Effect* effect = technique->getPassByIndex(p)->getEffect();
+                declared = effect && effect->getUniform("u_lodFade") != NULL;
+            }
+        }
+        if (declared)
+        {
+            MaterialParameter* parameter = material->getParameter("u_lodFade");
+            if (std::find(_lodFadeParameters.begin(), _lodFadeParameters.end(), parameter) == _lodFadeParameters.end())
+                _lodFadeParameters.push_back(parameter);
+        }
+    }
+
+    // The uniform is zero until set, which discards every pixel.
+    _lodFading = true;
+}
+
+void Model::setLodFade(float threshold, float direction)
+{
+    const Vector4 fade(threshold, direction, 0.0f, 0.0f);
+    for (size_t i = 0, count = _lodFadeParameters.size(); i < count; ++i)
+    {
+        _lodFadeParameters[i]->setValue(fade);
+    }
+    _lodFading = threshold < 1.0f;
+}
+
 void Model::setMaterialNodeBinding(Material *material)
 {
     GP_ASSERT(material);
@@ -303,6 +627,12 @@ Drawable* Model::clone(NodeCloneContext& context)
     {
         model->setSkin(getSkin()->clone(context));
     }
+    for (size_t i = 0, count = _lods.size(); i < count; ++i)
+    {
+        model->addLod(_lods[i].mesh, _lods[i].screenSize);
+    }
+    model->_lodHysteresis = _lodHysteresis;
+    model->_lodFadeTime = _lodFadeTime;
     if (getMaterial())
     {
         Material* materialClone = getMaterial()->clone(context);
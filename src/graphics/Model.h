@@ -10,7 +10,9 @@ namespace gplay
 {
 
 class Bundle;
+class Camera;
 class MeshSkin;
+class RenderQueue;
 
 
 /**
@@ -25,6 +27,7 @@ class Model : public Ref, public Drawable
     friend class Scene;
     friend class Mesh;
     friend class Bundle;
+    friend class InstancedModel;
 
 public:
 
@@ -138,11 +141,136 @@ public:
      * Any other state necessary to render the Mesh, such as
      * rendering states, shader state, and so on, should be set
      * up before calling this method.
+     *
+     * If a RenderQueue is recording, the draw calls are added to
+     * the queue and submitted when the queue ends.
      */
     unsigned int draw();
 
+    /**
+     * @see Drawable::getBounds
+     *
+     * The bounds of a skinned model are the box of the world positions of its
+     * joints, enlarged by how far the mesh extends past the joints in bind pose.
+     */
+    bool getBounds(BoundingBox* box, BoundingSphere* sphere) const;
+
+    /**
+     * Adds a level of detail to this model.
+     *
+     * A level is drawn instead of the mesh of the model when the projected diameter of the
+     * bounding sphere of the model, as seen by the active camera of the scene, falls below
+     * its screen size. Levels must be added from the most to the least detailed.
+     *
+     * The level is selected for each camera the model is drawn with, so passes drawing the
+     * scene from other cameras (shadow maps, reflections, split screens) set as the active
+     * camera while they draw keep their own level and cross-fade.
+     *
+     * The mesh of a level must have the same number of parts as the mesh of the model,
+     * which are drawn with the same materials, and must be skinned by the same joints
+     * when the model has a skin.
+     *
+     * @param mesh The mesh of the level.
+     * @param screenSize The projected diameter, as a fraction of the viewport height,
+     *        below which the level is drawn.
+     *
+     * @return True if the level was added, false if it doesn't match the model.
+     */
+    bool addLod(Mesh* mesh, float screenSize);
+
+    /**
+     * Returns the number of levels of detail, including the mesh of the model as level 0.
+     *
+     * @return The number of levels of detail.
+     */
+    unsigned int getLodCount() const;
+
+    /**
+     * Returns the mesh of a level of detail.
+     *
+     * @param level The level, 0 being the mesh of the model.
+     *
+     * @return The mesh of the level.
+     */
+    Mesh* getLodMesh(unsigned int level) const;
+
+    /**
+     * Returns the screen size below which a level of detail is drawn.
+     *
+     * @param level The level, 0 being the mesh of the model which is drawn at any size.
+     *
+     * @return The screen size of the level, as a fraction of the viewport height.
+     */
+    float getLodScreenSize(unsigned int level) const;
+
+    /**
+     * Returns the level of detail drawn by the last draw.
+     *
+     * @return The current level of detail.
+     */
+    unsigned int getLod() const;
+
+    /**
+     * Sets the hysteresis of the selection of the level of detail.
+     *
+     * The screen size of the model must be below the screen size of a level by this
+     * fraction to switch to it, and above it by this fraction to switch back, so that
+     * models at the limit of two levels don't switch every frame.
+     *
+     * @param hysteresis The fraction of the screen sizes (0.1 by default).
+     */
+    void setLodHysteresis(float hysteresis);
+
+    /**
+     * Returns the hysteresis of the selection of the level of detail.
+     *
+     * @return The fraction of the screen sizes.
+     */
+    float getLodHysteresis() const;
+
+    /**
+     * Sets the duration of the cross-fade between levels of detail.
+     *
+     * During a cross-fade both levels are drawn, discarding complementary dithered pixels
+     * set by the u_lodFade uniform of the materials, which must be compiled with the
+     * LOD_FADE define. The uniform is only set on the materials which effects declare it.
+     * The cross-fade is skipped when the model is drawn in a RenderQueue.
+     *
+     * @param time The duration of the cross-fade in milliseconds, 0 to switch levels
+     *        immediately (the default).
+     */
+    void setLodFadeTime(float time);
+
+    /**
+     * Returns the duration of the cross-fade between levels of detail.
+     *
+     * @return The duration of the cross-fade in milliseconds.
+     */
+    float getLodFadeTime() const;
+
 private:
 
+    /**
+     * A level of detail of the model.
+     */
+    struct Lod
+    {
+        Mesh* mesh;
+        float screenSize;
+    };
+
+    /**
+     * The level of detail selected for a camera drawing the model.
+     */
+    struct LodState
+    {
+        Camera* camera;
+        unsigned int lod;
+        unsigned int fadingLod;
+        double fadeStartTime;
+        double drawTime;
+    };
+
     /**
      * Constructor.
      */
@@ -185,6 +313,38 @@ private:
      */
     void setMaterialNodeBinding(Material *m);
 
+    /**
+     * Draws the given mesh with the materials of this model.
+     */
+    unsigned int drawMesh(Mesh* mesh);
+
+    /**
+     * Adds the draw items of the given mesh to the given render queue.
+     */
+    unsigned int drawQueued(RenderQueue* queue, Mesh* mesh);
+
+    /**
+     * Returns the level of detail drawn at the given screen size, ignoring the hysteresis.
+     */
+    unsigned int getLodForScreenSize(float screenSize) const;
+
+    /**
+     * Selects the level of detail for the active camera from the screen size of the model.
+     *
+     * @return The level of detail state of the camera, NULL if there is no active camera.
+     */
+    LodState* updateLod();
+
+    /**
+     * Finds the u_lodFade parameters of the materials which effects declare the uniform.
+     */
+    void updateLodFadeParameters();
+
+    /**
+     * Sets the u_lodFade uniform of the materials of this model.
+     */
+    void setLodFade(float threshold, float direction);
+
     void validatePartCount();
 
     Mesh* _mesh;
@@ -192,6 +352,14 @@ private:
     unsigned int _partCount;
     Material** _partMaterials;
     MeshSkin* _skin;
+    std::vector<Lod> _lods;
+    unsigned int _lod;
+    std::vector<LodState> _lodStates;
+    float _lodHysteresis;
+    float _lodFadeTime;
+    std::vector<MaterialParameter*> _lodFadeParameters;
+    bool _lodFadeParametersDirty;
+    bool _lodFading;
 };
 
 }
@@ -11,6 +11,8 @@
 #include "../graphics/Terrain.h"
 #include "../core/Game.h"
 #include "../graphics/Drawable.h"
+#include "../graphics/TransformHierarchy.h"
+#include "../graphics/SpatialIndex.h"
 #include "../ui/Form.h"
 #include "../core/Ref.h"
 
@@ -18,7 +20,8 @@
 #define NODE_DIRTY_WORLD 1
 #define NODE_DIRTY_BOUNDS 2
 #define NODE_DIRTY_HIERARCHY 4
-#define NODE_DIRTY_ALL (NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS | NODE_DIRTY_HIERARCHY)
+#define NODE_DIRTY_DRAWABLE_BOUNDS 8
+#define NODE_DIRTY_ALL (NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS | NODE_DIRTY_HIERARCHY | NODE_DIRTY_DRAWABLE_BOUNDS)
 
 namespace gplay
 {
@@ -26,7 +29,7 @@ namespace gplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0), _enabled(true), _tags(NULL),
     _drawable(NULL), _camera(NULL), _light(NULL), _audioSource(NULL), _collisionObject(NULL), _agent(NULL), _userObject(NULL),
-      _dirtyBits(NODE_DIRTY_ALL)
+      _drawableBounded(false), _dirtyBits(NODE_DIRTY_ALL), _transformHierarchy(NULL), _transformIndex(0), _spatialIndex(NULL), _spatialProxy(-1)
 {
     GP_REGISTER_SCRIPT_EVENTS();
     if (id)
@@ -38,6 +41,10 @@ Node::Node(const char* id)
 Node::~Node()
 {
     removeAllChildren();
+    if (_transformHierarchy)
+        _transformHierarchy->nodeDestroyed(_transformIndex);
+    if (_spatialIndex)
+        _spatialIndex->remove(this);
     if (_drawable)
         _drawable->setNode(NULL);
     if (_audioSource)
@@ -120,12 +127,23 @@ void Node::addChild(Node* child)
     }
     child->_parent = this;
     ++_childCount;
-    setBoundsDirty();
+    setHierarchyBoundsDirty();
+
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->setStructureDirty();
+    }
 
     if (_dirtyBits & NODE_DIRTY_HIERARCHY)
     {
         hierarchyChanged();
     }
+
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->_spatialIndex->insertHierarchy(child);
+    }
 }
 
 void Node::removeChild(Node* child)
@@ -153,6 +171,13 @@ void Node::removeAllChildren()
 
 void Node::remove()
 {
+    // Remove our drawables from the spatial index of our scene.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->_spatialIndex->removeHierarchy(this);
+    }
+
     // Re-link our neighbours.
     if (_prevSibling)
     {
@@ -176,9 +201,18 @@ void Node::remove()
     _prevSibling = NULL;
     _parent = NULL;
 
-    if (parent && parent->_dirtyBits & NODE_DIRTY_HIERARCHY)
+    if (_transformHierarchy)
     {
-        parent->hierarchyChanged();
+        _transformHierarchy->nodeRemoved(this);
+    }
+
+    if (parent)
+    {
+        parent->setHierarchyBoundsDirty();
+        if (parent->_dirtyBits & NODE_DIRTY_HIERARCHY)
+        {
+            parent->hierarchyChanged();
+        }
     }
 }
 
@@ -435,6 +469,12 @@ bool Node::isStatic() const
 
 const Matrix& Node::getWorldMatrix() const
 {
+    if ((_dirtyBits & NODE_DIRTY_WORLD) && _transformHierarchy)
+    {
+        // Resolve all the pending changes of our hierarchy in one pass.
+        _transformHierarchy->update();
+    }
+
     if (_dirtyBits & NODE_DIRTY_WORLD)
     {
         // Clear our dirty flag immediately to prevent this block from being entered if our
@@ -466,6 +506,11 @@ const Matrix& Node::getWorldMatrix() const
     return _world;
 }
 
+TransformHierarchy* Node::getTransformHierarchy() const
+{
+    return _transformHierarchy;
+}
+
 const Matrix& Node::getWorldViewMatrix() const
 {
     static Matrix worldView;
@@ -667,8 +712,17 @@ void Node::hierarchyChanged()
 
 void Node::transformChanged()
 {
-    // Our local transform was changed, so mark our world matrices dirty.
-    _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    // Our local transform was changed, so mark our world matrices and bounds dirty.
+    _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_DRAWABLE_BOUNDS;
+    setHierarchyBoundsDirty();
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->setDirty(_transformIndex);
+    }
+    if (_spatialIndex)
+    {
+        _spatialIndex->setDirty(_spatialProxy);
+    }
 
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
@@ -692,12 +746,23 @@ void Node::transformChanged()
 
 void Node::setBoundsDirty()
 {
-    // Mark ourself and our parent nodes as dirty
-    _dirtyBits |= NODE_DIRTY_BOUNDS;
+    // The bounds of our drawable or light changed, along with the bounds of our hierarchy.
+    _dirtyBits |= NODE_DIRTY_DRAWABLE_BOUNDS;
+    if (_spatialIndex)
+    {
+        _spatialIndex->setDirty(_spatialProxy);
+    }
+    setHierarchyBoundsDirty();
+}
 
-    // Mark our parent bounds as dirty as well
-    if (_parent)
-        _parent->setBoundsDirty();
+void Node::setHierarchyBoundsDirty()
+{
+    // The ancestors of a node with dirty hierarchy bounds are dirty as well,
+    // so a moving node only walks up to the first dirty ancestor.
+    for (Node* node = this; node && !(node->_dirtyBits & NODE_DIRTY_BOUNDS); node = node->_parent)
+    {
+        node->_dirtyBits |= NODE_DIRTY_BOUNDS;
+    }
 }
 
 Animation* Node::getAnimation(const char* id) const
@@ -838,121 +903,145 @@ void Node::setDrawable(Drawable* drawable)
                 ref->addRef();
             _drawable->setNode(this);
         }
+
+        // Add or remove this node from the spatial index of our scene.
+        Scene* scene = getScene();
+        if (scene && _drawable)
+        {
+            scene->_spatialIndex->insert(this);
+        }
+        else if (_spatialIndex && !_drawable)
+        {
+            _spatialIndex->remove(this);
+        }
     }
     setBoundsDirty();
 }
 
-const BoundingSphere& Node::getBoundingSphere() const
+bool Node::getDrawableBounds(BoundingSphere* sphere, BoundingBox* box) const
 {
-    if (_dirtyBits & NODE_DIRTY_BOUNDS)
+    if (_dirtyBits & NODE_DIRTY_DRAWABLE_BOUNDS)
     {
-        _dirtyBits &= ~NODE_DIRTY_BOUNDS;
+        _dirtyBits &= ~NODE_DIRTY_DRAWABLE_BOUNDS;
+        _drawableBounded = _drawable && _drawable->getBounds(&_drawableBox, &_drawableSphere);
+    }
+    if (!_drawableBounded)
+        return false;
 
-        const Matrix& worldMatrix = getWorldMatrix();
+    if (sphere)
+        sphere->set(_drawableSphere);
+    if (box)
+        box->set(_drawableBox);
+    return true;
+}
 
-        // Start with our local bounding sphere
-        // TODO: Incorporate bounds from entities other than mesh (i.e. particleemitters, audiosource, etc)
-        bool empty = true;
-        Terrain* terrain = dynamic_cast<Terrain*>(_drawable);
-        if (terrain)
-        {
-            _bounds.set(terrain->getBoundingBox());
-            empty = false;
-        }
-        Model* model = dynamic_cast<Model*>(_drawable);
-        if (model && model->getMesh())
+/**
+ * Gets the world-space bounds lit by a light, false for directional lights.
+ */
+static bool getLightBounds(const Light* light, const Matrix& world, BoundingSphere* sphere)
+{
+    switch (light->getLightType())
+    {
+    case Light::POINT:
+        sphere->set(Vector3::zero(), light->getRange());
+        break;
+    case Light::SPOT:
         {
-            if (empty)
+            // Smallest sphere around the cone, which axis is the forward vector of the node.
+            // Wide cones are bounded by their base, narrow cones by the sphere through
+            // their apex and base circle.
+            const float range = light->getRange();
+            const float angle = light->getOuterAngle();
+            if (angle >= MATH_PIOVER2)
             {
-                _bounds.set(model->getMesh()->getBoundingSphere());
-                empty = false;
+                sphere->set(Vector3::zero(), range);
             }
-            else
+            else if (angle >= MATH_PIOVER4)
             {
-                _bounds.merge(model->getMesh()->getBoundingSphere());
+                sphere->set(Vector3(0, 0, -range * cos(angle)), range * sin(angle));
             }
-        }
-        if (_light)
-        {
-            switch (_light->getLightType())
+            else
             {
-            case Light::POINT:
-                if (empty)
-                {
-                    _bounds.set(Vector3::zero(), _light->getRange());
-                    empty = false;
-                }
-                else
-                {
-                    _bounds.merge(BoundingSphere(Vector3::zero(), _light->getRange()));
-                }
-                break;
-            case Light::SPOT:
-                // TODO: Implement spot light bounds
-                break;
+                const float radius = range / (2.0f * cos(angle));
+                sphere->set(Vector3(0, 0, -radius), radius);
             }
         }
+        break;
+    default:
+        return false;
+    }
+    sphere->transform(world);
+    return true;
+}
+
+void Node::updateBounds() const
+{
+    _dirtyBits &= ~NODE_DIRTY_BOUNDS;
+
+    // Start with our drawable bounds, cached until our drawable or transform changes.
+    bool empty = !getDrawableBounds(&_bounds, &_boundingBox);
+    BoundingSphere lightBounds;
+    if (_light && getLightBounds(_light, getWorldMatrix(), &lightBounds))
+    {
         if (empty)
         {
-            // Empty bounding sphere, set the world translation with zero radius
-            worldMatrix.getTranslation(&_bounds.center);
-            _bounds.radius = 0;
+            _bounds.set(lightBounds);
+            _boundingBox.set(lightBounds);
+            empty = false;
         }
-
-        // Transform the sphere (if not empty) into world space.
-        if (!empty)
+        else
         {
-            bool applyWorldTransform = true;
-            if (model && model->getSkin())
-            {
-                // Special case: If the root joint of our mesh skin is parented by any nodes, 
-                // multiply the world matrix of the root joint's parent by this node's
-                // world matrix. This computes a final world matrix used for transforming this
-                // node's bounding volume. This allows us to store a much smaller bounding
-                // volume approximation than would otherwise be possible for skinned meshes,
-                // since joint parent nodes that are not in the matrix palette do not need to
-                // be considered as directly transforming vertices on the GPU (they can instead
-                // be applied directly to the bounding volume transformation below).
-                GP_ASSERT(model->getSkin()->getRootJoint());
-                Node* jointParent = model->getSkin()->getRootJoint()->getParent();
-                if (jointParent)
-                {
-                    // TODO: Should we protect against the case where joints are nested directly
-                    // in the node hierachy of the model (this is normally not the case)?
-                    Matrix boundsMatrix;
-                    Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
-                    _bounds.transform(boundsMatrix);
-                    applyWorldTransform = false;
-                }
-            }
-            if (applyWorldTransform)
-            {
-                _bounds.transform(getWorldMatrix());
-            }
+            _bounds.merge(lightBounds);
+            _boundingBox.merge(lightBounds);
         }
+    }
+    if (empty)
+    {
+        // Empty bounding volumes, set the world translation with zero size
+        getWorldMatrix().getTranslation(&_bounds.center);
+        _bounds.radius = 0;
+        _boundingBox.set(_bounds.center, _bounds.center);
+    }
 
-        // Merge this world-space bounding sphere with our childrens' bounding volumes.
-        for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
+    // Merge with the bounds of our children, only the dirty ones are computed again.
+    for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
+    {
+        const BoundingSphere& childSphere = n->getBoundingSphere();
+        if (!childSphere.isEmpty())
         {
-            const BoundingSphere& childSphere = n->getBoundingSphere();
-            if (!childSphere.isEmpty())
+            if (empty)
             {
-                if (empty)
-                {
-                    _bounds.set(childSphere);
-                    empty = false;
-                }
-                else
-                {
-                    _bounds.merge(childSphere);
-                }
+                _bounds.set(childSphere);
+                _boundingBox.set(n->_boundingBox);
+                empty = false;
+            }
+            else
+            {
+                _bounds.merge(childSphere);
+                _boundingBox.merge(n->_boundingBox);
             }
         }
     }
+}
 
+const BoundingSphere& Node::getBoundingSphere() const
+{
+    if (_dirtyBits & NODE_DIRTY_BOUNDS)
+    {
+        updateBounds();
+    }
     return _bounds;
 }
 
+const BoundingBox& Node::getBoundingBox() const
+{
+    if (_dirtyBits & NODE_DIRTY_BOUNDS)
+    {
+        updateBounds();
+    }
+    return _boundingBox;
+}
+
 Node* Node::clone() const
 {
     NodeCloneContext context;
@@ -1029,6 +1118,7 @@ void Node::cloneInto(Node* node, NodeCloneContext& context) const
 
     node->_world = _world;
     node->_bounds = _bounds;
+    node->_boundingBox = _boundingBox;
 
     // TODO: Clone the rest of the node data.
 }
@@ -25,6 +25,9 @@ class Light;
 class AudioSource;
 class AIAgent;
 class Drawable;
+class TransformHierarchy;
+class SpatialIndex;
+class OcclusionCuller;
 
 /**
  * Defines a hierarchical structure of objects in 3D transformation spaces.
@@ -41,6 +44,10 @@ class Node : public Transform, public Ref
     friend class Bundle;
     friend class MeshSkin;
     friend class Light;
+    friend class Drawable;
+    friend class TransformHierarchy;
+    friend class SpatialIndex;
+    friend class OcclusionCuller;
 
     GP_SCRIPT_EVENTS_START();
     GP_SCRIPT_EVENT(update, "<Node>f");
@@ -276,6 +283,15 @@ public:
      */
     virtual const Matrix& getWorldMatrix() const;
 
+    /**
+     * Returns the flattened transform hierarchy this node belongs to.
+     *
+     * @return The transform hierarchy, or NULL if the world matrix of this node is evaluated recursively.
+     *
+     * @see TransformHierarchy
+     */
+    TransformHierarchy* getTransformHierarchy() const;
+
     /**
      * Gets the world view matrix corresponding to this node.
      *
@@ -607,6 +623,19 @@ public:
      */
     const BoundingSphere& getBoundingSphere() const;
 
+    /**
+     * Returns the axis-aligned bounding box for the Node, in world space.
+     *
+     * The bounding box contains the same data as the bounding sphere of the node,
+     * usually more tightly, and is updated along with it.
+     *
+     * A node that does not occupy any space will return an empty bounding box
+     * located at the node translation.
+     *
+     * @return The world-space bounding box for the node.
+     */
+    const BoundingBox& getBoundingBox() const;
+
     /**
      * Clones the node and all of its child nodes.
      *
@@ -669,10 +698,33 @@ protected:
     void hierarchyChanged();
 
     /**
-     * Marks the bounding volume of the node as dirty.
+     * Marks the bounding volume of the drawable or light of the node as dirty,
+     * along with the bounding volumes of the node and of its ancestors.
      */
     void setBoundsDirty();
 
+    /**
+     * Marks the bounding volumes of the node and of its ancestors as dirty.
+     */
+    void setHierarchyBoundsDirty();
+
+    /**
+     * Gets the world-space bounds of the drawable of this node, without its children.
+     *
+     * The bounds are cached until the transform of the node changes or setBoundsDirty() is called.
+     *
+     * @param sphere The bounding sphere to populate, may be NULL.
+     * @param box The bounding box to populate, may be NULL.
+     *
+     * @return False if the node has no drawable or if its drawable has no bounds.
+     */
+    bool getDrawableBounds(BoundingSphere* sphere, BoundingBox* box = NULL) const;
+
+    /**
+     * Computes the bounding volumes of the node from its drawable, light and children.
+     */
+    void updateBounds() const;
+
     /**
      * Returns the first child node that matches the given ID.
      *
@@ -758,8 +810,24 @@ protected:
     mutable Matrix _world;
     /** The bounding sphere for this node. */
     mutable BoundingSphere _bounds;
+    /** The bounding box for this node. */
+    mutable BoundingBox _boundingBox;
+    /** The cached world-space bounding sphere of the drawable of this node. */
+    mutable BoundingSphere _drawableSphere;
+    /** The cached world-space bounding box of the drawable of this node. */
+    mutable BoundingBox _drawableBox;
+    /** Whether the drawable of this node has bounds, as of the last update. */
+    mutable bool _drawableBounded;
     /** The dirty bits used for optimization. */
     mutable int _dirtyBits;
+    /** The flattened transform hierarchy this node belongs to, if any. */
+    TransformHierarchy* _transformHierarchy;
+    /** The index of this node in its transform hierarchy. */
+    unsigned int _transformIndex;
+    /** The spatial index of the scene this node's drawable is in, if any. */
+    SpatialIndex* _spatialIndex;
+    /** The proxy of this node in its spatial index. */
+    int _spatialProxy;
 };
 
 /**
@@ -0,0 +1,396 @@
+#include "../core/Base.h"
+#include "../graphics/OcclusionCuller.h"
+#include "../graphics/Node.h"
+#include "../graphics/Camera.h"
+
+// Bounds closer to the camera plane, in clip space w, are never occluded.
+#define OCCLUSION_NEAR_W 0.001f
+
+// Depth of the pixels without occluder, nothing is hidden behind them.
+#define OCCLUSION_EMPTY_DEPTH FLT_MAX
+
+namespace gplay
+{
+
+/**
+ * Returns the signed area of the parallelogram defined by the edge from a to b and the point p.
+ *
+ * The edge is always evaluated from the same endpoint, whatever its direction, so the values of
+ * the triangles sharing an edge are exactly opposite and leave no gap between them.
+ */
+static float edgeFunction(float ax, float ay, float bx, float by, float px, float py)
+{
+    if (ax > bx || (ax == bx && ay > by))
+        return -((ax - bx) * (py - by) - (ay - by) * (px - bx));
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height)
+    : _width(width), _height(height), _minSize(0.05f), _enabled(true), _rendered(false)
+{
+    memset(&_stats, 0, sizeof(_stats));
+
+    // Level 0 is the depth buffer, each level halves the previous one down to 1x1.
+    unsigned int offset = 0;
+    unsigned int levelWidth = width;
+    unsigned int levelHeight = height;
+    while (true)
+    {
+        _levelOffsets.push_back(offset);
+        _levelWidths.push_back(levelWidth);
+        _levelHeights.push_back(levelHeight);
+        offset += levelWidth * levelHeight;
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        levelWidth = std::max(1u, (levelWidth + 1) / 2);
+        levelHeight = std::max(1u, (levelHeight + 1) / 2);
+    }
+    _depth.resize(offset, OCCLUSION_EMPTY_DEPTH);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    removeAllOccluders();
+}
+
+OcclusionCuller* OcclusionCuller::create(unsigned int width, unsigned int height)
+{
+    GP_ASSERT(width > 0 && height > 0);
+    return new OcclusionCuller(width, height);
+}
+
+void OcclusionCuller::addOccluder(Node* node, const BoundingBox& box)
+{
+    Vector3 corners[8];
+    box.getCorners(corners);
+
+    // Corners 0-3 are the near face and 4-7 the far face, as returned by BoundingBox::getCorners().
+    static const unsigned short indices[36] =
+    {
+        0, 1, 2, 0, 2, 3,
+        4, 5, 6, 4, 6, 7,
+        3, 2, 5, 3, 5, 4,
+        7, 6, 1, 7, 1, 0,
+        1, 6, 5, 1, 5, 2,
+        7, 0, 3, 7, 3, 4
+    };
+    addOccluder(node, corners, 8, indices, 36);
+}
+
+void OcclusionCuller::addOccluder(Node* node, const Vector3* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+{
+    GP_ASSERT(node);
+    GP_ASSERT(vertices && vertexCount > 0);
+    GP_ASSERT(indices && indexCount % 3 == 0);
+
+    Occluder occluder;
+    occluder.node = node;
+    occluder.vertices.assign(vertices, vertices + vertexCount);
+    occluder.indices.assign(indices, indices + indexCount);
+
+    BoundingBox box(vertices[0], vertices[0]);
+    for (unsigned int i = 1; i < vertexCount; ++i)
+    {
+        box.merge(BoundingBox(vertices[i], vertices[i]));
+    }
+    occluder.bounds.set(box);
+
+    node->addRef();
+    _occluders.push_back(occluder);
+}
+
+void OcclusionCuller::removeOccluders(Node* node)
+{
+    for (size_t i = 0; i < _occluders.size();)
+    {
+        if (_occluders[i].node == node)
+        {
+            SAFE_RELEASE(_occluders[i].node);
+            _occluders.erase(_occluders.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void OcclusionCuller::removeAllOccluders()
+{
+    for (size_t i = 0, count = _occluders.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_occluders[i].node);
+    }
+    _occluders.clear();
+}
+
+unsigned int OcclusionCuller::getOccluderCount() const
+{
+    return (unsigned int)_occluders.size();
+}
+
+void OcclusionCuller::setOccluderMinSize(float size)
+{
+    _minSize = size;
+}
+
+void OcclusionCuller::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+}
+
+bool OcclusionCuller::isEnabled() const
+{
+    return _enabled;
+}
+
+const OcclusionCuller::Stats& OcclusionCuller::getStats() const
+{
+    return _stats;
+}
+
+void OcclusionCuller::render(Camera* camera)
+{
+    GP_ASSERT(camera);
+
+    std::fill(_depth.begin(), _depth.begin() + _width * _height, OCCLUSION_EMPTY_DEPTH);
+    _viewProjection = camera->getViewProjectionMatrix();
+    _stats.occluders = 0;
+    _stats.triangles = 0;
+
+    const Frustum& frustum = camera->getFrustum();
+    const float projectionScale = fabsf(camera->getProjectionMatrix().m[5]);
+    const float* m = _viewProjection.m;
+    for (size_t i = 0, count = _occluders.size(); i < count; ++i)
+    {
+        const Occluder& occluder = _occluders[i];
+        if (!occluder.node->isEnabledInHierarchy())
+            continue;
+
+        BoundingSphere bounds(occluder.bounds);
+        bounds.transform(occluder.node->getWorldMatrix());
+        if (!bounds.intersects(frustum))
+            continue;
+
+        // Skip the occluders which projected diameter is too small, unless the camera is inside of their bounds.
+        const Vector3& center = bounds.center;
+        const float w = m[3] * center.x + m[7] * center.y + m[11] * center.z + m[15];
+        if (w > bounds.radius && bounds.radius * projectionScale < _minSize * w)
+            continue;
+
+        rasterizeOccluder(occluder, _viewProjection);
+        ++_stats.occluders;
+    }
+
+    buildHierarchy();
+    _rendered = true;
+}
+
+void OcclusionCuller::rasterizeOccluder(const Occluder& occluder, const Matrix& viewProjection)
+{
+    Matrix worldViewProjection;
+    Matrix::multiply(viewProjection, occluder.node->getWorldMatrix(), &worldViewProjection);
+
+    _clipVertices.resize(occluder.vertices.size());
+    for (size_t i = 0, count = occluder.vertices.size(); i < count; ++i)
+    {
+        const Vector3& v = occluder.vertices[i];
+        worldViewProjection.transformVector(Vector4(v.x, v.y, v.z, 1.0f), &_clipVertices[i]);
+    }
+
+    for (size_t i = 0, count = occluder.indices.size(); i + 2 < count; i += 3)
+    {
+        const Vector4* triangle[3] =
+        {
+            &_clipVertices[occluder.indices[i]],
+            &_clipVertices[occluder.indices[i + 1]],
+            &_clipVertices[occluder.indices[i + 2]]
+        };
+
+        // Clip the triangle against the near plane (z >= -w), into a polygon of up to 4 vertices,
+        // so that the occluders around the camera only hide what they hide in the scene.
+        Vector4 polygon[4];
+        unsigned int polygonSize = 0;
+        for (int j = 0; j < 3; ++j)
+        {
+            const Vector4& a = *triangle[j];
+            const Vector4& b = *triangle[(j + 1) % 3];
+            const float da = a.z + a.w;
+            const float db = b.z + b.w;
+            if (da >= 0.0f)
+                polygon[polygonSize++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                const float t = da / (da - db);
+                polygon[polygonSize++].set(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
+            }
+        }
+
+        for (unsigned int j = 2; j < polygonSize; ++j)
+        {
+            rasterizeTriangle(polygon[0], polygon[j - 1], polygon[j]);
+            ++_stats.triangles;
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const Vector4& a, const Vector4& b, const Vector4& c)
+{
+    // To pixel coordinates, the depth z/w is linear in screen space.
+    const float halfWidth = _width * 0.5f;
+    const float halfHeight = _height * 0.5f;
+    const float x0 = (a.x / a.w + 1.0f) * halfWidth;
+    const float y0 = (1.0f - a.y / a.w) * halfHeight;
+    const float z0 = a.z / a.w;
+    const float x1 = (b.x / b.w + 1.0f) * halfWidth;
+    const float y1 = (1.0f - b.y / b.w) * halfHeight;
+    const float z1 = b.z / b.w;
+    const float x2 = (c.x / c.w + 1.0f) * halfWidth;
+    const float y2 = (1.0f - c.y / c.w) * halfHeight;
+    const float z2 = c.z / c.w;
+
+    const float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (fabsf(area) < 1e-6f)
+        return;
+
+    const int minX = std::max(0, (int)floorf(std::min(x0, std::min(x1, x2))));
+    const int maxX = std::min((int)_width - 1, (int)ceilf(std::max(x0, std::max(x1, x2))));
+    const int minY = std::max(0, (int)floorf(std::min(y0, std::min(y1, y2))));
+    const int maxY = std::min((int)_height - 1, (int)ceilf(std::max(y0, std::max(y1, y2))));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    // Barycentric coordinates of the pixel centers, from the edge functions of the edges
+    // opposite to each vertex.
+    const float invArea = 1.0f / area;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float py = y + 0.5f;
+        float* row = &_depth[y * _width];
+        for (int x = minX; x <= maxX; ++x)
+        {
+            const float px = x + 0.5f;
+            const float e0 = edgeFunction(x1, y1, x2, y2, px, py) * invArea;
+            const float e1 = edgeFunction(x2, y2, x0, y0, px, py) * invArea;
+            const float e2 = edgeFunction(x0, y0, x1, y1, px, py) * invArea;
+            if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+            {
+                const float z = e0 * z0 + e1 * z1 + e2 * z2;
+                if (z < row[x])
+                    row[x] = z;
+            }
+        }
+    }
+}
+
+void OcclusionCuller::buildHierarchy()
+{
+    // Each texel keeps the farthest depth of the 2x2 texels it covers in the previous level.
+    for (size_t level = 1, count = _levelOffsets.size(); level < count; ++level)
+    {
+        const float* src = &_depth[_levelOffsets[level - 1]];
+        const unsigned int srcWidth = _levelWidths[level - 1];
+        const unsigned int srcHeight = _levelHeights[level - 1];
+        float* dst = &_depth[_levelOffsets[level]];
+        const unsigned int width = _levelWidths[level];
+        const unsigned int height = _levelHeights[level];
+        for (unsigned int y = 0; y < height; ++y)
+        {
+            const unsigned int sy0 = y * 2;
+            const unsigned int sy1 = std::min(sy0 + 1, srcHeight - 1);
+            for (unsigned int x = 0; x < width; ++x)
+            {
+                const unsigned int sx0 = x * 2;
+                const unsigned int sx1 = std::min(sx0 + 1, srcWidth - 1);
+                dst[y * width + x] = std::max(std::max(src[sy0 * srcWidth + sx0], src[sy0 * srcWidth + sx1]),
+                                              std::max(src[sy1 * srcWidth + sx0], src[sy1 * srcWidth + sx1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isOccluded(const BoundingSphere& sphere) const
+{
+    if (!_rendered || sphere.isEmpty())
+        return false;
+
+    // Project the corners of the box around the sphere, to find its screen rectangle and its nearest depth.
+    const float* m = _viewProjection.m;
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearestDepth = FLT_MAX;
+    for (int i = 0; i < 8; ++i)
+    {
+        const float x = sphere.center.x + ((i & 1) ? sphere.radius : -sphere.radius);
+        const float y = sphere.center.y + ((i & 2) ? sphere.radius : -sphere.radius);
+        const float z = sphere.center.z + ((i & 4) ? sphere.radius : -sphere.radius);
+        const float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+
+        // Bounds reaching the camera plane can't be hidden.
+        if (cw < OCCLUSION_NEAR_W)
+            return false;
+
+        const float invW = 1.0f / cw;
+        const float nx = (m[0] * x + m[4] * y + m[8] * z + m[12]) * invW;
+        const float ny = (m[1] * x + m[5] * y + m[9] * z + m[13]) * invW;
+        const float nz = (m[2] * x + m[6] * y + m[10] * z + m[14]) * invW;
+        minX = std::min(minX, nx);
+        maxX = std::max(maxX, nx);
+        minY = std::min(minY, ny);
+        maxY = std::max(maxY, ny);
+        nearestDepth = std::min(nearestDepth, nz);
+    }
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+        return false;
+
+    const int x0 = std::max(0, (int)floorf((minX + 1.0f) * 0.5f * _width));
+    const int x1 = std::min((int)_width - 1, (int)floorf((maxX + 1.0f) * 0.5f * _width));
+    const int y0 = std::max(0, (int)floorf((1.0f - maxY) * 0.5f * _height));
+    const int y1 = std::min((int)_height - 1, (int)floorf((1.0f - minY) * 0.5f * _height));
+
+    // Find the level where the rectangle covers at most 2x2 texels.
+    unsigned int level = 0;
+    while (level + 1 < _levelOffsets.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    {
+        ++level;
+    }
+
+    const float* depth = &_depth[_levelOffsets[level]];
+    const unsigned int width = _levelWidths[level];
+    for (int y = y0 >> level; y <= (y1 >> level); ++y)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); ++x)
+        {
+            if (depth[y * width + x] >= nearestDepth)
+                return false;
+        }
+    }
+    return true;
+}
+
+unsigned int OcclusionCuller::cull(Camera* camera, std::vector<Node*>& nodes, unsigned int first)
+{
+    render(camera);
+
+    _stats.tested = 0;
+    _stats.culled = 0;
+    size_t kept = first;
+    for (size_t i = first, count = nodes.size(); i < count; ++i)
+    {
+        Node* node = nodes[i];
+        BoundingSphere bounds;
+        if (node->getDrawableBounds(&bounds))
+        {
+            ++_stats.tested;
+            if (isOccluded(bounds))
+            {
+                ++_stats.culled;
+                continue;
+            }
+        }
+        nodes[kept++] = node;
+    }
+    nodes.resize(kept);
+    return _stats.culled;
+}
+
+}
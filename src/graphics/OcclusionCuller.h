@@ -0,0 +1,219 @@
+#ifndef OCCLUSIONCULLER_H_
+#define OCCLUSIONCULLER_H_
+
+#include "../core/Ref.h"
+#include "../math/BoundingBox.h"
+#include "../math/BoundingSphere.h"
+#include "../math/Matrix.h"
+#include "../math/Vector4.h"
+
+namespace gplay
+{
+
+class Node;
+class Camera;
+
+/**
+ * Defines an occlusion culling stage, removing the nodes hidden behind large occluders
+ * from the visible nodes of a scene.
+ *
+ * Occluders are simple closed shapes (boxes or low polygon meshes) attached to nodes, which
+ * must be inside the solid geometry they stand for, such as the walls of a building.
+ * For each camera, the occluders in the frustum are rasterized on the CPU into a low
+ * resolution depth buffer, from which a hierarchical depth (Hi-Z) chain is built, each
+ * level keeping the farthest depth of 2x2 texels of the previous one. The bounds of each
+ * visible node are then projected to a screen rectangle and compared with the farthest
+ * occluder depth of the level where the rectangle covers at most 2x2 texels, so a test
+ * costs at most 9 reads whatever the size of the node on screen.
+ *
+ * Set the occlusion culler of a scene with Scene::setOcclusionCuller(), the culling is then
+ * applied by Scene::findVisibleNodes() after frustum culling. Since the culling is done on
+ * the CPU in the same frame, hidden nodes are skipped without any latency.
+ */
+class OcclusionCuller : public Ref
+{
+public:
+
+    /**
+     * Statistics of the last culling.
+     */
+    struct Stats
+    {
+        /** The number of occluders rasterized. */
+        unsigned int occluders;
+        /** The number of occluder triangles rasterized. */
+        unsigned int triangles;
+        /** The number of nodes tested. */
+        unsigned int tested;
+        /** The number of nodes culled. */
+        unsigned int culled;
+    };
+
+    /**
+     * Creates an occlusion culler.
+     *
+     * @param width The width of the depth buffer, in pixels.
+     * @param height The height of the depth buffer, in pixels.
+     *
+     * @return The new occlusion culler.
+     * @script{create}
+     */
+    static OcclusionCuller* create(unsigned int width = 256, unsigned int height = 128);
+
+    /**
+     * Adds a box occluder to a node.
+     *
+     * @param node The node the occluder is attached to.
+     * @param box The box, in the local space of the node, which must be inside the solid
+     *        geometry of the node.
+     */
+    void addOccluder(Node* node, const BoundingBox& box);
+
+    /**
+     * Adds a mesh occluder to a node.
+     *
+     * @param node The node the occluder is attached to.
+     * @param vertices The positions of the vertices, in the local space of the node.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices of the triangles.
+     * @param indexCount The number of indices.
+     * @script{ignore}
+     */
+    void addOccluder(Node* node, const Vector3* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
+
+    /**
+     * Removes the occluders of a node.
+     *
+     * @param node The node to remove the occluders of.
+     */
+    void removeOccluders(Node* node);
+
+    /**
+     * Removes all the occluders.
+     */
+    void removeAllOccluders();
+
+    /**
+     * Returns the number of occluders.
+     *
+     * @return The number of occluders.
+     */
+    unsigned int getOccluderCount() const;
+
+    /**
+     * Sets the minimum size of the occluders rasterized, as a fraction of the viewport height.
+     *
+     * Small occluders hide little and are skipped to save rasterization time.
+     *
+     * @param size The minimum projected diameter of the bounds of the occluders (0.05 by default).
+     */
+    void setOccluderMinSize(float size);
+
+    /**
+     * Sets if the occlusion culler is enabled.
+     *
+     * @param enabled True to cull nodes, false to keep all nodes.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * Checks if the occlusion culler is enabled.
+     *
+     * @return True if the occlusion culler is enabled.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Rasterizes the occluders visible by a camera and builds the Hi-Z chain.
+     *
+     * @param camera The camera to rasterize the occluders for.
+     */
+    void render(Camera* camera);
+
+    /**
+     * Checks if a bounding sphere is hidden by the occluders of the last render.
+     *
+     * @param sphere The world-space bounding sphere to test.
+     *
+     * @return True if the sphere is hidden by the occluders.
+     */
+    bool isOccluded(const BoundingSphere& sphere) const;
+
+    /**
+     * Renders the occluders for a camera and removes the occluded nodes from a vector of nodes.
+     *
+     * Nodes which drawable has no bounds are never removed.
+     *
+     * @param camera The camera the nodes are visible by.
+     * @param nodes The visible nodes, the occluded nodes are removed from.
+     * @param first The index of the first node to test, the nodes before are kept.
+     *
+     * @return The number of nodes removed.
+     * @script{ignore}
+     */
+    unsigned int cull(Camera* camera, std::vector<Node*>& nodes, unsigned int first = 0);
+
+    /**
+     * Gets the statistics of the last culling.
+     *
+     * @return The statistics.
+     */
+    const Stats& getStats() const;
+
+private:
+
+    /**
+     * The triangles of an occluder, in the local space of its node.
+     */
+    struct Occluder
+    {
+        Node* node;
+        BoundingSphere bounds;
+        std::vector<Vector3> vertices;
+        std::vector<unsigned short> indices;
+    };
+
+    /**
+     * Constructor.
+     */
+    OcclusionCuller(unsigned int width, unsigned int height);
+
+    /**
+     * Destructor.
+     */
+    ~OcclusionCuller();
+
+    /**
+     * Hidden copy constructor.
+     */
+    OcclusionCuller(const OcclusionCuller& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    OcclusionCuller& operator=(const OcclusionCuller&);
+
+    void rasterizeOccluder(const Occluder& occluder, const Matrix& viewProjection);
+
+    void rasterizeTriangle(const Vector4& a, const Vector4& b, const Vector4& c);
+
+    void buildHierarchy();
+
+    unsigned int _width;
+    unsigned int _height;
+    std::vector<Occluder> _occluders;
+    float _minSize;
+    bool _enabled;
+    bool _rendered;
+    Matrix _viewProjection;
+    std::vector<float> _depth;
+    std::vector<unsigned int> _levelOffsets;
+    std::vector<unsigned int> _levelWidths;
+    std::vector<unsigned int> _levelHeights;
+    std::vector<Vector4> _clipVertices;
+    Stats _stats;
+};
+
+}
+
+#endif
@@ -977,6 +977,42 @@ void ParticleEmitter::update(float elapsedTime)
             --_particleCount;
         }
     }
+
+    // Bound the living particles, which are in world space, the size of a particle
+    // bounds its sprite whatever its rotation.
+    if (_particleCount > 0)
+    {
+        const Particle* p = &_particles[0];
+        _bounds.set(p->_position.x - p->_size, p->_position.y - p->_size, p->_position.z - p->_size,
+                    p->_position.x + p->_size, p->_position.y + p->_size, p->_position.z + p->_size);
+        for (unsigned int i = 1; i < _particleCount; ++i)
+        {
+            p = &_particles[i];
+            _bounds.min.x = std::min(_bounds.min.x, p->_position.x - p->_size);
+            _bounds.min.y = std::min(_bounds.min.y, p->_position.y - p->_size);
+            _bounds.min.z = std::min(_bounds.min.z, p->_position.z - p->_size);
+            _bounds.max.x = std::max(_bounds.max.x, p->_position.x + p->_size);
+            _bounds.max.y = std::max(_bounds.max.y, p->_position.y + p->_size);
+            _bounds.max.z = std::max(_bounds.max.z, p->_position.z + p->_size);
+        }
+    }
+    else if (_node)
+    {
+        Vector3 translation;
+        _node->getWorldMatrix().getTranslation(&translation);
+        _bounds.set(translation, translation);
+    }
+    setBoundsDirty();
+}
+
+bool ParticleEmitter::getBounds(BoundingBox* box, BoundingSphere* sphere) const
+{
+    GP_ASSERT(box);
+    GP_ASSERT(sphere);
+
+    box->set(_bounds);
+    sphere->set(_bounds);
+    return true;
 }
 
 unsigned int ParticleEmitter::draw()
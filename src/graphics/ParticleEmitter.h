@@ -7,6 +7,7 @@
 #include "../math/Vector4.h"
 #include "../graphics/Texture.h"
 #include "../math/Rectangle.h"
+#include "../math/BoundingBox.h"
 #include "../graphics/SpriteBatch.h"
 #include "../core/Properties.h"
 #include "../graphics/Drawable.h"
@@ -714,6 +715,13 @@ public:
      */
     unsigned int draw();
 
+    /**
+     * @see Drawable::getBounds
+     *
+     * The bounds contain the particles alive as of the last update.
+     */
+    bool getBounds(BoundingBox* box, BoundingSphere* sphere) const;
+
 private:
 
     /**
@@ -840,6 +848,7 @@ private:
     float _timePerEmission;
     float _emitTime;
     double _lastUpdated;
+    BoundingBox _bounds;
 };
 
 }
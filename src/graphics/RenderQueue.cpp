@@ -0,0 +1,215 @@
+#include "../core/Base.h"
+#include "../graphics/RenderQueue.h"
+#include "../graphics/MeshPart.h"
+#include "../graphics/Pass.h"
+#include "../graphics/Effect.h"
+#include "../graphics/View.h"
+#include "../renderer/BGFXRenderer.h"
+#include "../renderer/BGFXGpuProgram.h"
+#include "../renderer/BGFXUniform.h"
+
+// Sort key layout (most significant bits first).
+// Opaque:      view (8) | translucent = 0 (1) | program (9) | state (14) | depth (32)
+// Translucent: view (8) | translucent = 1 (1) | inverted depth (32) | program (9) | state (14)
+#define KEY_VIEW_SHIFT          56
+#define KEY_TRANSLUCENT_BIT     (uint64_t(1) << 55)
+#define KEY_PROGRAM_BITS        9
+#define KEY_STATE_BITS          14
+#define KEY_PROGRAM_MASK        ((1 << KEY_PROGRAM_BITS) - 1)
+#define KEY_STATE_MASK          ((1 << KEY_STATE_BITS) - 1)
+
+namespace gplay
+{
+
+static RenderQueue* __currentQueue = NULL;
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+    if (__currentQueue == this)
+        __currentQueue = NULL;
+}
+
+RenderQueue* RenderQueue::getCurrent()
+{
+    return __currentQueue;
+}
+
+void RenderQueue::begin()
+{
+    GP_ASSERT(__currentQueue == NULL);
+    __currentQueue = this;
+    _items.clear();
+}
+
+unsigned int RenderQueue::getItemCount() const
+{
+    return (unsigned int)_items.size();
+}
+
+void RenderQueue::add(Pass* pass, Mesh* mesh, MeshPart* part, float depth)
+{
+    GP_ASSERT(pass);
+    GP_ASSERT(mesh);
+
+    DrawItem item;
+    item.pass = pass;
+    item.mesh = mesh;
+    item.part = part;
+    item.state = pass->resolveState(part ? part->getPrimitiveType() : mesh->getPrimitiveType());
+    item.viewId = View::getCurrentViewId();
+
+    // The bit pattern of a non-negative float increases with its value,
+    // so it can be sorted as an unsigned integer.
+    if (!(depth > 0.0f))
+        depth = 0.0f;
+    memcpy(&item.depth, &depth, sizeof(uint32_t));
+
+    _items.push_back(item);
+}
+
+bool RenderQueue::isSequential(unsigned short viewId)
+{
+    View* view = View::getView(viewId);
+    return view && view->getViewSortingMode() == View::SortingMode::SEQUENTIAL;
+}
+
+uint64_t RenderQueue::makeKey(unsigned short viewId, unsigned short program, uint64_t state, uint32_t depth)
+{
+    // Fold the render state into a small hash, collisions only affect draw call grouping.
+    uint64_t h = state * 0x9E3779B97F4A7C15ULL;
+    uint64_t stateHash = (h >> (64 - KEY_STATE_BITS)) & KEY_STATE_MASK;
+    uint64_t programBits = program & KEY_PROGRAM_MASK;
+
+    uint64_t key = uint64_t(viewId & 0xff) << KEY_VIEW_SHIFT;
+    if (state & BGFX_STATE_BLEND_MASK)
+    {
+        // Translucent, back-to-front.
+        key |= KEY_TRANSLUCENT_BIT;
+        key |= uint64_t(~depth) << (KEY_PROGRAM_BITS + KEY_STATE_BITS);
+        key |= programBits << KEY_STATE_BITS;
+        key |= stateHash;
+    }
+    else
+    {
+        // Opaque, grouped by program and state then front-to-back.
+        key |= programBits << (KEY_STATE_BITS + 32);
+        key |= stateHash << 32;
+        key |= depth;
+    }
+    return key;
+}
+
+void RenderQueue::sort()
+{
+    const size_t count = _items.size();
+    _keys.resize(count);
+    _indices.resize(count);
+    _keysTemp.resize(count);
+    _indicesTemp.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const DrawItem& item = _items[i];
+        const BGFXGpuProgram* program = item.pass->getEffect()->getGpuProgram();
+        _keys[i] = makeKey(item.viewId, program->getProgram().idx, item.state, item.depth);
+        _indices[i] = (uint32_t)i;
+    }
+
+    // LSD radix sort on 8-bit digits, skipping the digits shared by all keys.
+    uint64_t* keys = &_keys[0];
+    uint32_t* indices = &_indices[0];
+    uint64_t* keysTemp = &_keysTemp[0];
+    uint32_t* indicesTemp = &_indicesTemp[0];
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        unsigned int histogram[256] = { 0 };
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++histogram[(keys[i] >> shift) & 0xff];
+        }
+        if (histogram[(keys[0] >> shift) & 0xff] == count)
+            continue;
+
+        unsigned int offset = 0;
+        for (unsigned int d = 0; d < 256; ++d)
+        {
+            unsigned int n = histogram[d];
+            histogram[d] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned int dst = histogram[(keys[i] >> shift) & 0xff]++;
+            keysTemp[dst] = keys[i];
+            indicesTemp[dst] = indices[i];
+        }
+        std::swap(keys, keysTemp);
+        std::swap(indices, indicesTemp);
+    }
+
+    if (indices != &_indices[0])
+    {
+        _indices.swap(_indicesTemp);
+    }
+}
+
+unsigned int RenderQueue::end()
+{
+    GP_ASSERT(__currentQueue == this);
+    __currentQueue = NULL;
+
+    const unsigned int count = (unsigned int)_items.size();
+    if (count == 0)
+        return 0;
+
+    sort();
+
+    Pass* lastPass = NULL;
+    unsigned short lastViewId = _items[_indices[0]].viewId;
+    bool sequential = isSequential(lastViewId);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const DrawItem& item = _items[_indices[i]];
+        Pass* pass = item.pass;
+        Effect* effect = pass->getEffect();
+
+        if (item.viewId != lastViewId)
+        {
+            BGFXUniform::invalidateValueCache();
+            sequential = isSequential(item.viewId);
+            lastViewId = item.viewId;
+            lastPass = NULL;
+        }
+
+        if (pass != lastPass || !sequential)
+        {
+            effect->bind();
+            pass->bindParameters(pass);
+            lastPass = pass;
+        }
+        else
+        {
+            // Draw calls of a sequential view are executed in submission order, so
+            // uniform values are still bound, texture bindings are not.
+            pass->bindParameters(pass, true);
+        }
+
+        bgfx::setState(item.state);
+        item.mesh->_vertexBuffer->bind();
+        if (item.part)
+        {
+            item.part->_indexBuffer->bind();
+        }
+
+        BGFXRenderer::getInstance().submit(effect->getGpuProgram(), item.viewId, item.depth);
+    }
+
+    _items.clear();
+    return count;
+}
+
+}
@@ -0,0 +1,125 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include "../graphics/Mesh.h"
+#include <vector>
+
+namespace gplay
+{
+
+class Pass;
+class MeshPart;
+
+/**
+ * Defines a queue of draw calls that are sorted before being submitted to the renderer.
+ *
+ * While a render queue is active (between begin() and end()), models do not submit
+ * their draw calls immediately. Instead each mesh part and pass is recorded as a draw
+ * item with a 64-bit sort key built from the view id, the translucency of the render
+ * state, the shader program, the render state and the view depth. On end(), the items
+ * are radix sorted by key and submitted in a tight loop, which groups draw calls by
+ * program and state and orders opaque geometry front-to-back and translucent geometry
+ * back-to-front within each view.
+ *
+ * Material parameters are evaluated when the queue is submitted, so the scene
+ * camera and the nodes must not change between begin() and end(). Use one queue
+ * (or one begin/end pair) per camera.
+ *
+ * Since the queue already sorts its draw calls, it works best with views in
+ * View::SortingMode::SEQUENTIAL: the submission order is then kept by bgfx and
+ * unchanged uniform values are not uploaded again between consecutive draw calls.
+ */
+class RenderQueue
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    RenderQueue();
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Begins recording draw items. Makes this queue the current render queue.
+     */
+    void begin();
+
+    /**
+     * Sorts and submits all recorded draw items, then clears the queue.
+     *
+     * @return The number of draw calls submitted.
+     */
+    unsigned int end();
+
+    /**
+     * Adds a draw item to the queue.
+     *
+     * The render state of the pass is resolved immediately, parameters are bound
+     * when the queue is submitted.
+     *
+     * @param pass The pass to draw with.
+     * @param mesh The mesh to draw.
+     * @param part The mesh part to draw or NULL to draw the mesh vertices without index.
+     * @param depth The distance of the drawn object from the camera in view space.
+     */
+    void add(Pass* pass, Mesh* mesh, MeshPart* part, float depth = 0.0f);
+
+    /**
+     * Returns the number of draw items recorded since begin().
+     *
+     * @return The number of draw items.
+     */
+    unsigned int getItemCount() const;
+
+    /**
+     * Returns the render queue currently recording, if any.
+     *
+     * @return The current render queue or NULL.
+     */
+    static RenderQueue* getCurrent();
+
+private:
+
+    /**
+     * A recorded draw call.
+     */
+    struct DrawItem
+    {
+        Pass* pass;
+        Mesh* mesh;
+        MeshPart* part;
+        uint64_t state;
+        uint32_t depth;
+        unsigned short viewId;
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderQueue& operator=(const RenderQueue&);
+
+    static bool isSequential(unsigned short viewId);
+
+    static uint64_t makeKey(unsigned short viewId, unsigned short program, uint64_t state, uint32_t depth);
+
+    void sort();
+
+    std::vector<DrawItem> _items;
+    std::vector<uint64_t> _keys;
+    std::vector<uint32_t> _indices;
+    std::vector<uint64_t> _keysTemp;
+    std::vector<uint32_t> _indicesTemp;
+};
+
+}
+
+#endif
@@ -27,9 +27,10 @@ namespace gplay
 
 RenderState::StateBlock* RenderState::StateBlock::_defaultState = NULL;
 std::vector<RenderState::AutoBindingResolver*> RenderState::_customAutoBindingResolvers;
+unsigned int RenderState::_parametersVersion = 0;
 
 RenderState::RenderState()
-    : _nodeBinding(NULL), _state(NULL), _parent(NULL)
+    : _nodeBinding(NULL), _state(NULL), _parent(NULL), _bindingEffect(NULL), _bindingVersion(0)
 {
 }
 
@@ -42,6 +43,8 @@ RenderState::~RenderState()
     {
         SAFE_RELEASE(_parameters[i]);
     }
+    if (!_parameters.empty())
+        ++_parametersVersion;
 }
 
 void RenderState::initialize()
@@ -131,6 +134,7 @@ MaterialParameter* RenderState::getParameter(const char* name) const
 
     param->_uniformName = baseName;
     _parameters.push_back(param);
+    ++_parametersVersion;
 
     return param;
 }
@@ -149,6 +153,7 @@ void RenderState::addParameter(MaterialParameter* param)
 {
     _parameters.push_back(param);
     param->addRef();
+    ++_parametersVersion;
 }
 
 void RenderState::removeParameter(const char* name)
@@ -160,6 +165,7 @@ void RenderState::removeParameter(const char* name)
         {
             _parameters.erase(_parameters.begin() + i);
             SAFE_RELEASE(p);
+            ++_parametersVersion;
             break;
         }
     }
@@ -487,6 +493,66 @@ void RenderState::bind(Pass* pass, Mesh::PrimitiveType primitiveType)
 {
     GP_ASSERT(pass);
 
+    // Apply parameter bindings for the entire hierarchy, top-down.
+    bindParameters(pass);
+
+    // Apply bgfx render state
+    bgfx::setState(resolveState(primitiveType));
+}
+
+void RenderState::bindParameters(Pass* pass, bool samplersOnly)
+{
+    GP_ASSERT(pass);
+
+    Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+    if (_bindingEffect != effect || _bindingVersion != _parametersVersion)
+    {
+        buildBindingTable(effect);
+    }
+
+    for (size_t i = 0, count = _bindings.size(); i < count; ++i)
+    {
+        const UniformBinding& binding = _bindings[i];
+        MaterialParameter* param = binding.parameter;
+        if (samplersOnly && param->_type != MaterialParameter::SAMPLER && param->_type != MaterialParameter::SAMPLER_ARRAY)
+            continue;
+        param->_uniform = binding.uniform;
+        param->upload(effect);
+    }
+}
+
+void RenderState::buildBindingTable(Effect* effect)
+{
+    GP_ASSERT(effect);
+
+    _bindings.clear();
+
+    // Parameters are bound top-down, so that values of the most derived
+    // RenderState are uploaded last.
+    RenderState* rs = NULL;
+    while ((rs = getTopmost(rs)))
+    {
+        for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
+        {
+            MaterialParameter* param = rs->_parameters[i];
+            GP_ASSERT(param);
+            UniformBinding binding;
+            binding.parameter = param;
+            binding.uniform = param->resolveUniform(effect);
+            if (binding.uniform)
+            {
+                _bindings.push_back(binding);
+            }
+        }
+    }
+
+    _bindingEffect = effect;
+    _bindingVersion = _parametersVersion;
+}
+
+uint64_t RenderState::resolveState(Mesh::PrimitiveType primitiveType)
+{
     // Get the combined modified state bits for our RenderState hierarchy.
     long stateOverrideBits = _state ? _state->_bits : 0;
     RenderState* rs = _parent;
@@ -502,25 +568,17 @@ void RenderState::bind(Pass* pass, Mesh::PrimitiveType primitiveType)
     // Restore renderer state to its default, except for explicitly specified states
     StateBlock::restore(stateOverrideBits);
 
-    // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
+    // Apply renderer state for the entire hierarchy, top-down.
     rs = NULL;
-    Effect* effect = pass->getEffect();
     while ((rs = getTopmost(rs)))
     {
-        for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
-        {
-            GP_ASSERT(rs->_parameters[i]);
-            rs->_parameters[i]->bind(effect);
-        }
-
         if (rs->_state)
         {
             rs->_state->bindNoRestore();
         }
     }
 
-    // Apply bgfx render state
-    StateBlock::apply(primitiveType);
+    return StateBlock::getBgfxState(primitiveType);
 }
 
 RenderState* RenderState::getTopmost(RenderState* below)
@@ -569,6 +627,7 @@ void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context)
 
         renderState->_parameters.push_back(paramCopy);
     }
+    ++_parametersVersion;
 
     // Clone our state block
     if (_state)
@@ -737,6 +796,11 @@ void RenderState::StateBlock::bindNoRestore()
 }
 
 void RenderState::StateBlock::apply(Mesh::PrimitiveType primitiveType)
+{
+    bgfx::setState(getBgfxState(primitiveType));
+}
+
+uint64_t RenderState::StateBlock::getBgfxState(Mesh::PrimitiveType primitiveType)
 {
     GP_ASSERT(_defaultState);
 
@@ -800,7 +864,7 @@ void RenderState::StateBlock::apply(Mesh::PrimitiveType primitiveType)
 
    // bgfxBits |= BGFX_STATE_MSAA;
 
-    bgfx::setState(bgfxBits);
+    return bgfxBits;
 }
 
 void RenderState::StateBlock::restore(long stateOverrideBits)
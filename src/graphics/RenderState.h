@@ -10,6 +10,8 @@ namespace gplay
 {
 
 class MaterialParameter;
+class Effect;
+class Uniform;
 class Node;
 class NodeCloneContext;
 class Pass;
@@ -24,6 +26,7 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class RenderQueue;
 
 public:
 
@@ -448,6 +451,7 @@ public:
         void bindNoRestore();
 
         static void apply(Mesh::PrimitiveType primitiveType);
+        static uint64_t getBgfxState(Mesh::PrimitiveType primitiveType);
         static void restore(long stateOverrideBits);
 
         static void enableDepthWrite();
@@ -619,6 +623,26 @@ protected:
      */
     void bind(Pass* pass, Mesh::PrimitiveType primitiveType);
 
+    /**
+     * Binds the material parameters of this RenderState and any of its parents,
+     * top-down, for the given pass.
+     *
+     * @param pass The pass whose effect receives the parameters.
+     * @param samplersOnly true to only bind sampler parameters (texture bindings are
+     *        discarded by bgfx after each submit while uniform values are kept).
+     */
+    void bindParameters(Pass* pass, bool samplersOnly = false);
+
+    /**
+     * Resolves the fixed-function render states of this RenderState hierarchy
+     * into the bgfx state bits used for drawing the given primitive type.
+     *
+     * @param primitiveType The primitive type to be drawn.
+     *
+     * @return The bgfx state bits.
+     */
+    uint64_t resolveState(Mesh::PrimitiveType primitiveType);
+
     /**
      * Returns the topmost RenderState in the hierarchy below the given RenderState.
      */
@@ -632,6 +656,14 @@ protected:
      */
     void cloneInto(RenderState* renderState, NodeCloneContext& context) const;
 
+    /**
+     * Resolves the uniforms of all the material parameters of this RenderState
+     * hierarchy for the given effect, in top-down binding order.
+     *
+     * @param effect The effect to resolve uniforms from.
+     */
+    void buildBindingTable(Effect* effect);
+
 private:
 
     /**
@@ -690,6 +722,35 @@ protected:
      */
     RenderState* _parent;
 
+    /**
+     * A material parameter of the hierarchy and the uniform it binds to.
+     */
+    struct UniformBinding
+    {
+        MaterialParameter* parameter;
+        Uniform* uniform;
+    };
+
+    /**
+     * Parameters of the hierarchy with their resolved uniforms for _bindingEffect.
+     */
+    std::vector<UniformBinding> _bindings;
+
+    /**
+     * The effect the binding table was built for.
+     */
+    Effect* _bindingEffect;
+
+    /**
+     * Value of _parametersVersion when the binding table was built.
+     */
+    unsigned int _bindingVersion;
+
+    /**
+     * Incremented each time material parameters are added to or removed from any RenderState.
+     */
+    static unsigned int _parametersVersion;
+
     /**
      * Map of custom auto binding resolvers.
      */
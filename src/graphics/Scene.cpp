@@ -61,8 +61,9 @@ static bool endsWith(const char* str, const char* suffix, bool ignoreCase)
 
 Scene::Scene()
     : _id(""), _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true), 
-      _nextItr(NULL), _nextReset(true)
+      _nextItr(NULL), _nextReset(true), _spatialIndex(NULL), _occlusionCuller(NULL)
 {
+    _spatialIndex = new SpatialIndex();
     __sceneList.push_back(this);
 }
 
@@ -80,8 +81,11 @@ Scene::~Scene()
         SAFE_RELEASE(_activeCamera);
     }
 
+    SAFE_RELEASE(_occlusionCuller);
+
     // Remove all nodes from the scene
     removeAllNodes();
+    SAFE_DELETE(_spatialIndex);
 
     // Remove the scene from global list
     std::vector<Scene*>::iterator itr = std::find(__sceneList.begin(), __sceneList.end(), this);
@@ -273,6 +277,8 @@ void Scene::addNode(Node* node)
 
     ++_nodeCount;
 
+    _spatialIndex->insertHierarchy(node);
+
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
     {
@@ -363,6 +369,41 @@ void Scene::setActiveCamera(Camera* camera)
     }
 }
 
+unsigned int Scene::findVisibleNodes(Camera* camera, std::vector<Node*>& nodes)
+{
+    GP_ASSERT(camera);
+    const unsigned int first = (unsigned int)nodes.size();
+    unsigned int count = _spatialIndex->query(camera->getFrustum(), nodes);
+    if (_occlusionCuller && _occlusionCuller->isEnabled())
+    {
+        count -= _occlusionCuller->cull(camera, nodes, first);
+    }
+    return count;
+}
+
+SpatialIndex* Scene::getSpatialIndex() const
+{
+    return _spatialIndex;
+}
+
+void Scene::setOcclusionCuller(OcclusionCuller* culler)
+{
+    if (_occlusionCuller != culler)
+    {
+        SAFE_RELEASE(_occlusionCuller);
+        _occlusionCuller = culler;
+        if (_occlusionCuller)
+        {
+            _occlusionCuller->addRef();
+        }
+    }
+}
+
+OcclusionCuller* Scene::getOcclusionCuller() const
+{
+    return _occlusionCuller;
+}
+
 void Scene::bindAudioListenerToCamera(bool bind)
 {
     if (_bindAudioListenerToCamera != bind)
@@ -399,6 +440,9 @@ void Scene::reset()
 {
     _nextItr = NULL;
     _nextReset = true;
+
+    // Refit the drawables which bounds changed, to know which ones can be culled.
+    _spatialIndex->update();
 }
 
 Node* Scene::getNext()
@@ -448,14 +492,14 @@ bool Scene::isNodeVisible(Node* node)
     if (!node->isEnabled())
         return false;
 
-    if (node->getDrawable() || node->getLight() || node->getCamera())
-    {
+    if (node->getLight() || node->getCamera())
         return true;
-    }
-    else
-    {
-        return node->getBoundingSphere().intersects(_activeCamera->getFrustum());
-    }
+
+    // Drawables without bounds can't be culled.
+    if (node->getDrawable() && !_spatialIndex->isBounded(node))
+        return true;
+
+    return node->getBoundingSphere().intersects(_activeCamera->getFrustum());
 }
 
 }
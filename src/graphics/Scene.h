@@ -6,6 +6,8 @@
 #include "../script/ScriptController.h"
 #include "../graphics/Light.h"
 #include "../graphics/Model.h"
+#include "../graphics/SpatialIndex.h"
+#include "../graphics/OcclusionCuller.h"
 
 namespace gplay
 {
@@ -17,6 +19,8 @@ namespace gplay
  */
 class Scene : public Ref
 {
+    friend class Node;
+
 public:
 
     /**
@@ -147,6 +151,48 @@ public:
      */
     void setActiveCamera(Camera* camera);
 
+    /**
+     * Finds the enabled nodes of the scene which drawable is visible by a camera.
+     *
+     * The nodes are found with the spatial index of the scene, instead of testing
+     * the bounds of all the nodes, and are appended in no particular order. Nodes
+     * which drawable has no bounds are always returned.
+     *
+     * When the scene has an enabled occlusion culler, the nodes hidden by its occluders
+     * are removed from the nodes found.
+     *
+     * @param camera The camera to find the visible nodes of.
+     * @param nodes Vector of nodes to be populated with the visible nodes.
+     *
+     * @return The number of visible nodes found.
+     * @script{ignore}
+     */
+    unsigned int findVisibleNodes(Camera* camera, std::vector<Node*>& nodes);
+
+    /**
+     * Gets the spatial index of the nodes of the scene that have a drawable.
+     *
+     * @return The spatial index of the scene.
+     * @script{ignore}
+     */
+    SpatialIndex* getSpatialIndex() const;
+
+    /**
+     * Sets the occlusion culler applied to the visible nodes of the scene.
+     *
+     * @param culler The occlusion culler, or NULL to disable occlusion culling.
+     * @script{ignore}
+     */
+    void setOcclusionCuller(OcclusionCuller* culler);
+
+    /**
+     * Gets the occlusion culler applied to the visible nodes of the scene.
+     *
+     * @return The occlusion culler, or NULL if none is set.
+     * @script{ignore}
+     */
+    OcclusionCuller* getOcclusionCuller() const;
+
     /**
      * Sets the audio listener to transform along with the active camera if set to true.
      * If you have a 2D game that doesn't require it, then set to false.  This is on by default for the scene.
@@ -308,6 +354,8 @@ private:
     bool _bindAudioListenerToCamera;
     Node* _nextItr;
     bool _nextReset;
+    SpatialIndex* _spatialIndex;
+    OcclusionCuller* _occlusionCuller;
 };
 
 template <class T>
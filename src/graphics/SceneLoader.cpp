@@ -24,18 +24,23 @@ SceneLoader::SceneLoader() : _scene(NULL)
 Scene* SceneLoader::load(const char* url)
 {
     SceneLoader loader;
-    return loader.loadInternal(url);
+    return loader.loadInternal(url, Properties::create(url));
 }
 
-Scene* SceneLoader::loadInternal(const char* url)
+Scene* SceneLoader::load(const char* url, Properties* properties)
+{
+    SceneLoader loader;
+    return loader.loadInternal(url, properties);
+}
+
+Scene* SceneLoader::loadInternal(const char* url, Properties* properties)
 {
     // Get the file part of the url that we are loading the scene from.
     std::string urlStr = url ? url : "";
     std::string id;
     splitURL(urlStr, &_path, &id);
 
-    // Load the scene properties from file.
-    Properties* properties = Properties::create(url);
+    // Check the scene properties loaded from file.
     if (properties == NULL)
     {
         GP_ERROR("Failed to load scene file '%s'.", url);
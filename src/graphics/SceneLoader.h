@@ -18,6 +18,7 @@ namespace gplay
 class SceneLoader
 {
     friend class Scene;
+    friend class AssetLoader;
 
 private:
 
@@ -29,6 +30,14 @@ private:
      * @param url The URL pointing to the Properties object defining the scene.
      */
     static Scene* load(const char* url);
+
+    /**
+     * Loads a scene from the Properties object already read from the specified URL.
+     *
+     * @param url The URL pointing to the Properties object defining the scene.
+     * @param properties The properties read from the URL, deleted by the loader.
+     */
+    static Scene* load(const char* url, Properties* properties);
     
     /**
      * Helper structures and functions for SceneLoader::load(const char*).
@@ -88,7 +97,7 @@ private:
 
     SceneLoader();
 
-    Scene* loadInternal(const char* url);
+    Scene* loadInternal(const char* url, Properties* properties);
 
     void applyTags(SceneNode& sceneNode);
 
@@ -0,0 +1,673 @@
+#include "../core/Base.h"
+#include "../graphics/SpatialIndex.h"
+#include "../graphics/Node.h"
+
+#ifdef GP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// Margin added around the bounds of the leaves, relative to their radius.
+#define SPATIAL_INDEX_MARGIN 0.25f
+
+#define SPATIAL_INDEX_NULL -1
+
+// Mask of the 6 planes of a frustum.
+#define SPATIAL_INDEX_ALL_PLANES 0x3F
+
+namespace gplay
+{
+
+static float surfaceArea(const BoundingBox& box)
+{
+    const float dx = box.max.x - box.min.x;
+    const float dy = box.max.y - box.min.y;
+    const float dz = box.max.z - box.min.z;
+    return dx * dy + dy * dz + dz * dx;
+}
+
+static BoundingBox mergeBoxes(const BoundingBox& a, const BoundingBox& b)
+{
+    BoundingBox box(a);
+    box.merge(b);
+    return box;
+}
+
+static bool containsBox(const BoundingBox& outer, const BoundingBox& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+SpatialIndex::SpatialIndex()
+    : _root(SPATIAL_INDEX_NULL), _freeNode(SPATIAL_INDEX_NULL), _nodeCount(0)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    for (size_t i = 0, count = _proxies.size(); i < count; ++i)
+    {
+        Node* node = _proxies[i].node;
+        if (node)
+        {
+            node->_spatialIndex = NULL;
+            node->_spatialProxy = SPATIAL_INDEX_NULL;
+        }
+    }
+}
+
+unsigned int SpatialIndex::getNodeCount() const
+{
+    return _nodeCount;
+}
+
+int SpatialIndex::getHeight() const
+{
+    return _root == SPATIAL_INDEX_NULL ? 0 : _nodes[_root].height;
+}
+
+void SpatialIndex::insertHierarchy(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->getDrawable())
+        insert(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        insertHierarchy(child);
+    }
+}
+
+void SpatialIndex::removeHierarchy(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->_spatialIndex == this)
+        remove(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        removeHierarchy(child);
+    }
+}
+
+void SpatialIndex::insert(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->_spatialIndex == this)
+        return;
+    if (node->_spatialIndex)
+        node->_spatialIndex->remove(node);
+
+    int proxy;
+    if (_freeProxies.empty())
+    {
+        proxy = (int)_proxies.size();
+        _proxies.push_back(Proxy());
+    }
+    else
+    {
+        proxy = _freeProxies.back();
+        _freeProxies.pop_back();
+    }
+    Proxy& p = _proxies[proxy];
+    p.node = node;
+    p.leaf = SPATIAL_INDEX_NULL;
+    p.unbounded = SPATIAL_INDEX_NULL;
+    p.dirty = false;
+    node->_spatialIndex = this;
+    node->_spatialProxy = proxy;
+    ++_nodeCount;
+
+    // The node is placed in the tree on the next update.
+    setDirty(proxy);
+}
+
+void SpatialIndex::remove(Node* node)
+{
+    GP_ASSERT(node && node->_spatialIndex == this);
+
+    const int proxy = node->_spatialProxy;
+    Proxy& p = _proxies[proxy];
+    if (p.leaf != SPATIAL_INDEX_NULL)
+    {
+        removeLeaf(p.leaf);
+        freeNode(p.leaf);
+        p.leaf = SPATIAL_INDEX_NULL;
+    }
+    if (p.unbounded != SPATIAL_INDEX_NULL)
+    {
+        removeUnbounded(proxy);
+    }
+    p.node = NULL;
+    p.dirty = false;
+    _freeProxies.push_back(proxy);
+    node->_spatialIndex = NULL;
+    node->_spatialProxy = SPATIAL_INDEX_NULL;
+    --_nodeCount;
+}
+
+void SpatialIndex::setDirty(int proxy)
+{
+    Proxy& p = _proxies[proxy];
+    if (!p.dirty)
+    {
+        p.dirty = true;
+        _dirty.push_back(proxy);
+    }
+}
+
+void SpatialIndex::update()
+{
+    for (size_t i = 0, count = _dirty.size(); i < count; ++i)
+    {
+        const int proxy = _dirty[i];
+        Proxy& p = _proxies[proxy];
+
+        // Removed nodes are no longer dirty, and a proxy may be listed twice if it was reused.
+        if (!p.dirty)
+            continue;
+        p.dirty = false;
+        GP_ASSERT(p.node);
+
+        BoundingSphere sphere;
+        if (!p.node->getDrawableBounds(&sphere))
+        {
+            if (p.leaf != SPATIAL_INDEX_NULL)
+            {
+                removeLeaf(p.leaf);
+                freeNode(p.leaf);
+                p.leaf = SPATIAL_INDEX_NULL;
+            }
+            if (p.unbounded == SPATIAL_INDEX_NULL)
+                addUnbounded(proxy);
+            continue;
+        }
+
+        if (p.unbounded != SPATIAL_INDEX_NULL)
+            removeUnbounded(proxy);
+
+        BoundingBox box;
+        box.set(sphere);
+        if (p.leaf != SPATIAL_INDEX_NULL)
+        {
+            // Keep the leaf while the bounds stay within its box.
+            TreeNode& leaf = _nodes[p.leaf];
+            leaf.sphere = sphere;
+            if (containsBox(leaf.box, box))
+                continue;
+            removeLeaf(p.leaf);
+        }
+        else
+        {
+            p.leaf = allocateNode();
+        }
+
+        TreeNode& leaf = _nodes[p.leaf];
+        const float margin = sphere.radius * SPATIAL_INDEX_MARGIN;
+        leaf.box.set(box.min.x - margin, box.min.y - margin, box.min.z - margin,
+                     box.max.x + margin, box.max.y + margin, box.max.z + margin);
+        leaf.sphere = sphere;
+        leaf.proxy = proxy;
+        insertLeaf(p.leaf);
+    }
+    _dirty.clear();
+}
+
+bool SpatialIndex::isBounded(const Node* node) const
+{
+    if (node->_spatialIndex != this)
+        return false;
+    return _proxies[node->_spatialProxy].leaf != SPATIAL_INDEX_NULL;
+}
+
+int SpatialIndex::allocateNode()
+{
+    int index;
+    if (_freeNode == SPATIAL_INDEX_NULL)
+    {
+        index = (int)_nodes.size();
+        _nodes.push_back(TreeNode());
+    }
+    else
+    {
+        index = _freeNode;
+        _freeNode = _nodes[index].parent;
+    }
+    TreeNode& node = _nodes[index];
+    node.parent = SPATIAL_INDEX_NULL;
+    node.child1 = SPATIAL_INDEX_NULL;
+    node.child2 = SPATIAL_INDEX_NULL;
+    node.height = 0;
+    node.proxy = SPATIAL_INDEX_NULL;
+    return index;
+}
+
+void SpatialIndex::freeNode(int index)
+{
+    _nodes[index].parent = _freeNode;
+    _nodes[index].height = -1;
+    _freeNode = index;
+}
+
+void SpatialIndex::insertLeaf(int leaf)
+{
+    if (_root == SPATIAL_INDEX_NULL)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = SPATIAL_INDEX_NULL;
+        return;
+    }
+
+    // Find the best sibling by descending the tree, minimizing the surface area added to the tree.
+    const BoundingBox leafBox = _nodes[leaf].box;
+    int index = _root;
+    while (_nodes[index].child1 != SPATIAL_INDEX_NULL)
+    {
+        const TreeNode& node = _nodes[index];
+        const float area = surfaceArea(node.box);
+        const float combinedArea = surfaceArea(mergeBoxes(node.box, leafBox));
+
+        // Cost of creating a new parent for this node and the new leaf, and cost of
+        // pushing the leaf further down the tree.
+        const float cost = 2.0f * combinedArea;
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        const int children[2] = { node.child1, node.child2 };
+        for (int i = 0; i < 2; ++i)
+        {
+            const TreeNode& child = _nodes[children[i]];
+            const float childArea = surfaceArea(mergeBoxes(child.box, leafBox));
+            if (child.child1 == SPATIAL_INDEX_NULL)
+                childCosts[i] = childArea + inheritanceCost;
+            else
+                childCosts[i] = childArea - surfaceArea(child.box) + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+    const int sibling = index;
+
+    // Create a new parent for the sibling and the leaf.
+    const int oldParent = _nodes[sibling].parent;
+    const int newParent = allocateNode();
+    TreeNode& parent = _nodes[newParent];
+    parent.parent = oldParent;
+    parent.box = mergeBoxes(leafBox, _nodes[sibling].box);
+    parent.height = _nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+    if (oldParent != SPATIAL_INDEX_NULL)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    // Refit and balance the ancestors.
+    index = _nodes[leaf].parent;
+    while (index != SPATIAL_INDEX_NULL)
+    {
+        index = balance(index);
+        TreeNode& node = _nodes[index];
+        node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+        node.box = mergeBoxes(_nodes[node.child1].box, _nodes[node.child2].box);
+        index = node.parent;
+    }
+}
+
+void SpatialIndex::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = SPATIAL_INDEX_NULL;
+        return;
+    }
+
+    const int parent = _nodes[leaf].parent;
+    const int grandParent = _nodes[parent].parent;
+    const int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    // Replace the parent by the sibling.
+    if (grandParent != SPATIAL_INDEX_NULL)
+    {
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != SPATIAL_INDEX_NULL)
+        {
+            index = balance(index);
+            TreeNode& node = _nodes[index];
+            node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+            node.box = mergeBoxes(_nodes[node.child1].box, _nodes[node.child2].box);
+            index = node.parent;
+        }
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = SPATIAL_INDEX_NULL;
+        freeNode(parent);
+    }
+    _nodes[leaf].parent = SPATIAL_INDEX_NULL;
+}
+
+int SpatialIndex::balance(int iA)
+{
+    TreeNode* a = &_nodes[iA];
+    if (a->child1 == SPATIAL_INDEX_NULL || a->height < 2)
+        return iA;
+
+    const int iB = a->child1;
+    const int iC = a->child2;
+    TreeNode* b = &_nodes[iB];
+    TreeNode* c = &_nodes[iC];
+    const int difference = c->height - b->height;
+
+    if (difference > 1)
+    {
+        // Rotate C up, A becomes its first child.
+        const int iF = c->child1;
+        const int iG = c->child2;
+        TreeNode* f = &_nodes[iF];
+        TreeNode* g = &_nodes[iG];
+
+        c->child1 = iA;
+        c->parent = a->parent;
+        a->parent = iC;
+        if (c->parent != SPATIAL_INDEX_NULL)
+        {
+            if (_nodes[c->parent].child1 == iA)
+                _nodes[c->parent].child1 = iC;
+            else
+                _nodes[c->parent].child2 = iC;
+        }
+        else
+        {
+            _root = iC;
+        }
+
+        // The highest child of C stays with C, the other one replaces C in A.
+        if (f->height > g->height)
+        {
+            c->child2 = iF;
+            a->child2 = iG;
+            g->parent = iA;
+            a->box = mergeBoxes(b->box, g->box);
+            c->box = mergeBoxes(a->box, f->box);
+            a->height = 1 + std::max(b->height, g->height);
+            c->height = 1 + std::max(a->height, f->height);
+        }
+        else
+        {
+            c->child2 = iG;
+            a->child2 = iF;
+            f->parent = iA;
+            a->box = mergeBoxes(b->box, f->box);
+            c->box = mergeBoxes(a->box, g->box);
+            a->height = 1 + std::max(b->height, f->height);
+            c->height = 1 + std::max(a->height, g->height);
+        }
+        return iC;
+    }
+
+    if (difference < -1)
+    {
+        // Rotate B up, A becomes its first child.
+        const int iD = b->child1;
+        const int iE = b->child2;
+        TreeNode* d = &_nodes[iD];
+        TreeNode* e = &_nodes[iE];
+
+        b->child1 = iA;
+        b->parent = a->parent;
+        a->parent = iB;
+        if (b->parent != SPATIAL_INDEX_NULL)
+        {
+            if (_nodes[b->parent].child1 == iA)
+                _nodes[b->parent].child1 = iB;
+            else
+                _nodes[b->parent].child2 = iB;
+        }
+        else
+        {
+            _root = iB;
+        }
+
+        // The highest child of B stays with B, the other one replaces B in A.
+        if (d->height > e->height)
+        {
+            b->child2 = iD;
+            a->child1 = iE;
+            e->parent = iA;
+            a->box = mergeBoxes(c->box, e->box);
+            b->box = mergeBoxes(a->box, d->box);
+            a->height = 1 + std::max(c->height, e->height);
+            b->height = 1 + std::max(a->height, d->height);
+        }
+        else
+        {
+            b->child2 = iE;
+            a->child1 = iD;
+            d->parent = iA;
+            a->box = mergeBoxes(c->box, d->box);
+            b->box = mergeBoxes(a->box, e->box);
+            a->height = 1 + std::max(c->height, d->height);
+            b->height = 1 + std::max(a->height, e->height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void SpatialIndex::addUnbounded(int proxy)
+{
+    _proxies[proxy].unbounded = (int)_unbounded.size();
+    _unbounded.push_back(proxy);
+}
+
+void SpatialIndex::removeUnbounded(int proxy)
+{
+    const int index = _proxies[proxy].unbounded;
+    const int last = _unbounded.back();
+    _unbounded[index] = last;
+    _proxies[last].unbounded = index;
+    _unbounded.pop_back();
+    _proxies[proxy].unbounded = SPATIAL_INDEX_NULL;
+}
+
+unsigned int SpatialIndex::query(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    update();
+
+    const size_t first = nodes.size();
+    for (size_t i = 0, count = _unbounded.size(); i < count; ++i)
+    {
+        addNode(_unbounded[i], nodes);
+    }
+
+    if (_root != SPATIAL_INDEX_NULL)
+    {
+        // The planes as (normal, distance), points inside the frustum have a positive distance to all of them.
+        const Plane* planes[6] = { &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(),
+                                   &frustum.getRight(), &frustum.getBottom(), &frustum.getTop() };
+        float planeData[24];
+        for (int i = 0; i < 6; ++i)
+        {
+            const Vector3& normal = planes[i]->getNormal();
+            planeData[i * 4 + 0] = normal.x;
+            planeData[i * 4 + 1] = normal.y;
+            planeData[i * 4 + 2] = normal.z;
+            planeData[i * 4 + 3] = planes[i]->getDistance();
+        }
+
+        _packed.clear();
+        _packedProxies.clear();
+        _stack.clear();
+        _stack.push_back(std::make_pair(_root, (unsigned int)SPATIAL_INDEX_ALL_PLANES));
+        while (!_stack.empty())
+        {
+            const int index = _stack.back().first;
+            unsigned int mask = _stack.back().second;
+            _stack.pop_back();
+
+            const TreeNode& node = _nodes[index];
+            if (node.child1 == SPATIAL_INDEX_NULL)
+            {
+                // The spheres of the leaves are tested in batches.
+                const size_t slot = _packedProxies.size();
+                if ((slot & 3) == 0)
+                    _packed.resize(_packed.size() + 16);
+                float* group = &_packed[(slot >> 2) * 16];
+                group[slot & 3] = node.sphere.center.x;
+                group[4 + (slot & 3)] = node.sphere.center.y;
+                group[8 + (slot & 3)] = node.sphere.center.z;
+                group[12 + (slot & 3)] = node.sphere.radius;
+                _packedProxies.push_back(node.proxy);
+                continue;
+            }
+
+            // Test the box against the planes it isn't known to be inside of.
+            const float cx = (node.box.min.x + node.box.max.x) * 0.5f;
+            const float cy = (node.box.min.y + node.box.max.y) * 0.5f;
+            const float cz = (node.box.min.z + node.box.max.z) * 0.5f;
+            const float ex = (node.box.max.x - node.box.min.x) * 0.5f;
+            const float ey = (node.box.max.y - node.box.min.y) * 0.5f;
+            const float ez = (node.box.max.z - node.box.min.z) * 0.5f;
+            bool outside = false;
+            for (int i = 0; i < 6; ++i)
+            {
+                if (!(mask & (1 << i)))
+                    continue;
+                const float* p = &planeData[i * 4];
+                const float distance = p[0] * cx + p[1] * cy + p[2] * cz + p[3];
+                const float extent = fabsf(p[0] * ex) + fabsf(p[1] * ey) + fabsf(p[2] * ez);
+                if (distance < -extent)
+                {
+                    outside = true;
+                    break;
+                }
+                if (distance > extent)
+                    mask &= ~(1 << i);
+            }
+            if (outside)
+                continue;
+
+            if (mask == 0)
+            {
+                // The subtree is inside of the frustum.
+                addSubtree(index, nodes);
+            }
+            else
+            {
+                _stack.push_back(std::make_pair(node.child1, mask));
+                _stack.push_back(std::make_pair(node.child2, mask));
+            }
+        }
+
+        if (!_packedProxies.empty())
+            testPacked(planeData, nodes);
+    }
+
+    return (unsigned int)(nodes.size() - first);
+}
+
+void SpatialIndex::addSubtree(int index, std::vector<Node*>& nodes)
+{
+    const size_t base = _stack.size();
+    _stack.push_back(std::make_pair(index, 0u));
+    while (_stack.size() > base)
+    {
+        const TreeNode& node = _nodes[_stack.back().first];
+        _stack.pop_back();
+        if (node.child1 == SPATIAL_INDEX_NULL)
+        {
+            addNode(node.proxy, nodes);
+        }
+        else
+        {
+            _stack.push_back(std::make_pair(node.child1, 0u));
+            _stack.push_back(std::make_pair(node.child2, 0u));
+        }
+    }
+}
+
+void SpatialIndex::addNode(int proxy, std::vector<Node*>& nodes)
+{
+    Node* node = _proxies[proxy].node;
+    if (node->isEnabledInHierarchy())
+        nodes.push_back(node);
+}
+
+void SpatialIndex::testPacked(const float* planes, std::vector<Node*>& nodes)
+{
+    // Pad the last group with spheres which are never visible.
+    const size_t count = _packedProxies.size();
+    for (size_t slot = count; slot & 3; ++slot)
+    {
+        float* group = &_packed[(slot >> 2) * 16];
+        group[slot & 3] = 0.0f;
+        group[4 + (slot & 3)] = 0.0f;
+        group[8 + (slot & 3)] = 0.0f;
+        group[12 + (slot & 3)] = -FLT_MAX;
+    }
+
+    // A sphere is visible if its signed distance to each plane is not below -radius.
+    for (size_t groupIndex = 0; groupIndex * 4 < count; ++groupIndex)
+    {
+        const float* group = &_packed[groupIndex * 16];
+        unsigned int visible;
+#ifdef GP_USE_SSE
+        const __m128 x = _mm_loadu_ps(group);
+        const __m128 y = _mm_loadu_ps(group + 4);
+        const __m128 z = _mm_loadu_ps(group + 8);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(group + 12));
+        __m128 inside = _mm_cmpge_ps(_mm_setzero_ps(), _mm_setzero_ps());
+        for (int i = 0; i < 6; ++i)
+        {
+            const float* p = &planes[i * 4];
+            __m128 distance = _mm_mul_ps(x, _mm_set1_ps(p[0]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(p[1])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(p[2])));
+            distance = _mm_add_ps(distance, _mm_set1_ps(p[3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        visible = (unsigned int)_mm_movemask_ps(inside);
+#else
+        visible = 0xF;
+        for (int i = 0; i < 6; ++i)
+        {
+            const float* p = &planes[i * 4];
+            for (int j = 0; j < 4; ++j)
+            {
+                const float distance = p[0] * group[j] + p[1] * group[4 + j] + p[2] * group[8 + j] + p[3];
+                if (distance < -group[12 + j])
+                    visible &= ~(1u << j);
+            }
+        }
+#endif
+        for (int j = 0; j < 4 && visible; ++j, visible >>= 1)
+        {
+            if (visible & 1)
+                addNode(_packedProxies[groupIndex * 4 + j], nodes);
+        }
+    }
+}
+
+}
@@ -0,0 +1,170 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include "../math/BoundingBox.h"
+#include "../math/BoundingSphere.h"
+#include "../math/Frustum.h"
+
+namespace gplay
+{
+
+class Node;
+
+/**
+ * Defines a spatial index of the nodes of a scene that have a drawable, used to find
+ * the drawables visible by a camera without testing every node of the scene.
+ *
+ * The index is a dynamic bounding volume hierarchy: each node is a leaf holding the
+ * world bounding sphere of its drawable, inside a box enlarged by a margin, and the
+ * tree is kept balanced by rotations as leaves are inserted and removed. Nodes notify
+ * the index when their bounds change, and only the changed nodes are refitted on the
+ * next query. A node moving within the margin of its box keeps its leaf.
+ *
+ * Queries test the boxes of the tree against the planes of the frustum, skipping
+ * subtrees outside of the frustum and planes a subtree is fully inside of. The bounding
+ * spheres of the leaves that still need testing are packed and tested four at a time
+ * (with SSE when available).
+ *
+ * Drawables without bounds (such as particle emitters, forms or sprites) can't be
+ * culled and are returned by all queries.
+ */
+class SpatialIndex
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Finds the enabled nodes which drawable intersects a frustum.
+     *
+     * @param frustum The frustum to test against, in world space.
+     * @param nodes The vector the visible nodes are appended to.
+     *
+     * @return The number of visible nodes found.
+     */
+    unsigned int query(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Returns the number of nodes in the index.
+     *
+     * @return The number of nodes.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Returns the height of the tree, for diagnostics.
+     *
+     * @return The height of the tree, 0 if it has a single leaf.
+     */
+    int getHeight() const;
+
+private:
+
+    /**
+     * A node of the tree, leaves reference the proxy of a scene node.
+     */
+    struct TreeNode
+    {
+        BoundingBox box;
+        BoundingSphere sphere;
+        int parent;
+        int child1;
+        int child2;
+        int height;
+        int proxy;
+    };
+
+    /**
+     * The entry of a scene node in the index.
+     */
+    struct Proxy
+    {
+        Node* node;
+        int leaf;
+        int unbounded;
+        bool dirty;
+    };
+
+    /**
+     * Constructor.
+     */
+    SpatialIndex();
+
+    /**
+     * Destructor.
+     */
+    ~SpatialIndex();
+
+    /**
+     * Hidden copy constructor.
+     */
+    SpatialIndex(const SpatialIndex& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    SpatialIndex& operator=(const SpatialIndex&);
+
+    /**
+     * Adds the nodes of the hierarchy of the given node that have a drawable.
+     */
+    void insertHierarchy(Node* node);
+
+    /**
+     * Removes the nodes of the hierarchy of the given node.
+     */
+    void removeHierarchy(Node* node);
+
+    void insert(Node* node);
+
+    void remove(Node* node);
+
+    void setDirty(int proxy);
+
+    /**
+     * Refits the leaves of the nodes which bounds changed.
+     */
+    void update();
+
+    /**
+     * Checks if the drawable of a node in the index has bounds, as of the last update.
+     */
+    bool isBounded(const Node* node) const;
+
+    int allocateNode();
+
+    void freeNode(int index);
+
+    void insertLeaf(int leaf);
+
+    void removeLeaf(int leaf);
+
+    int balance(int index);
+
+    void addUnbounded(int proxy);
+
+    void removeUnbounded(int proxy);
+
+    void addSubtree(int index, std::vector<Node*>& nodes);
+
+    void addNode(int proxy, std::vector<Node*>& nodes);
+
+    void testPacked(const float* planes, std::vector<Node*>& nodes);
+
+    std::vector<TreeNode> _nodes;
+    int _root;
+    int _freeNode;
+    std::vector<Proxy> _proxies;
+    std::vector<int> _freeProxies;
+    std::vector<int> _dirty;
+    std::vector<int> _unbounded;
+    unsigned int _nodeCount;
+    std::vector<std::pair<int, unsigned int> > _stack;
+    std::vector<float> _packed;
+    std::vector<int> _packedProxies;
+};
+
+}
+
+#endif
@@ -25,12 +25,19 @@ namespace gplay
 static Effect* __spriteEffect = NULL;
 
 SpriteBatch::SpriteBatch()
-    : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
+    : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f),
+      _atlas(NULL), _atlasEffect(NULL), _atlasCapacity(0)
 {
 }
 
 SpriteBatch::~SpriteBatch()
 {
+    for (size_t i = 0, count = _pageBatches.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_pageBatches[i]);
+    }
+    SAFE_RELEASE(_atlasEffect);
+    SAFE_RELEASE(_atlas);
     SAFE_DELETE(_batch);
     SAFE_RELEASE(_sampler);
     if (!_customEffect)
@@ -123,6 +130,8 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
 
     // Create the mesh batch
     MeshBatch* meshBatch = MeshBatch::create(vertexFormat, Mesh::TRIANGLE_STRIP, material, true, initialCapacity > 0 ? initialCapacity : SPRITE_BATCH_DEFAULT_SIZE);
+    // Sprites are written directly in transient buffers, batches are started and drawn in the same frame.
+    meshBatch->setTransient(true);
     material->release(); // don't call SAFE_RELEASE since material is used below
 
     // Create the batch
@@ -141,9 +150,33 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
     return batch;
 }
 
+SpriteBatch* SpriteBatch::create(TextureAtlas* atlas, Effect* effect, unsigned int initialCapacity)
+{
+    GP_ASSERT(atlas);
+
+    SpriteBatch* batch = SpriteBatch::create(atlas->getPage(0), effect, initialCapacity);
+    if (batch)
+    {
+        batch->_atlas = atlas;
+        atlas->addRef();
+        // Keep the custom effect for the batches of the other pages.
+        batch->_atlasEffect = effect;
+        if (effect)
+            effect->addRef();
+        batch->_atlasCapacity = initialCapacity;
+    }
+    return batch;
+}
+
 void SpriteBatch::start()
 {
     _batch->start();
+    for (size_t i = 0, count = _pageBatches.size(); i < count; ++i)
+    {
+        // Restarting a page batch would drop the sprites already added to it.
+        if (_pageBatches[i] && !_pageBatches[i]->isStarted())
+            _pageBatches[i]->start();
+    }
 }
 
 bool SpriteBatch::isStarted() const
@@ -162,6 +195,28 @@ void SpriteBatch::draw(const Rectangle& dst, const Rectangle& src, const Vector4
     draw(dst.x, dst.y, dst.width, dst.height, u1, v1, u2, v2, color);
 }
 
+void SpriteBatch::draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color)
+{
+    GP_ASSERT(region);
+    SpriteBatch* batch = getPageBatch(region->page);
+    batch->draw(dst.x, dst.y, dst.width, dst.height, region->u1, region->v1, region->u2, region->v2, color);
+}
+
+void SpriteBatch::draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color, const Rectangle& clip)
+{
+    GP_ASSERT(region);
+    SpriteBatch* batch = getPageBatch(region->page);
+    batch->draw(dst.x, dst.y, dst.width, dst.height, region->u1, region->v1, region->u2, region->v2, color, clip);
+}
+
+void SpriteBatch::draw(const TextureAtlas::Region* region, const Vector3& dst, const Vector2& scale, const Vector4& color,
+                       const Vector2& rotationPoint, float rotationAngle)
+{
+    GP_ASSERT(region);
+    SpriteBatch* batch = getPageBatch(region->page);
+    batch->draw(dst, scale.x, scale.y, region->u1, region->v1, region->u2, region->v2, color, rotationPoint, rotationAngle);
+}
+
 void SpriteBatch::draw(const Vector3& dst, const Rectangle& src, const Vector2& scale, const Vector4& color)
 {
     // Calculate uvs.
@@ -384,6 +439,13 @@ void SpriteBatch::finish()
     // Finish and draw the batch
     _batch->finish();
     _batch->draw();
+
+    // Then the other pages of the atlas
+    for (size_t i = 0, count = _pageBatches.size(); i < count; ++i)
+    {
+        if (_pageBatches[i] && _pageBatches[i]->isStarted())
+            _pageBatches[i]->finish();
+    }
 }
 
 RenderState::StateBlock* SpriteBatch::getStateBlock() const
@@ -404,6 +466,11 @@ Material* SpriteBatch::getMaterial() const
 void SpriteBatch::setProjectionMatrix(const Matrix& matrix)
 {
     _projectionMatrix = matrix;
+    for (size_t i = 0, count = _pageBatches.size(); i < count; ++i)
+    {
+        if (_pageBatches[i])
+            _pageBatches[i]->setProjectionMatrix(matrix);
+    }
 }
 
 const Matrix& SpriteBatch::getProjectionMatrix() const
@@ -411,6 +478,34 @@ const Matrix& SpriteBatch::getProjectionMatrix() const
     return _projectionMatrix;
 }
 
+TextureAtlas* SpriteBatch::getAtlas() const
+{
+    return _atlas;
+}
+
+SpriteBatch* SpriteBatch::getPageBatch(unsigned int page)
+{
+    GP_ASSERT(_atlas && page < _atlas->getPageCount());
+    if (page == 0)
+        return this;
+
+    if (page > _pageBatches.size())
+        _pageBatches.resize(page, NULL);
+    SpriteBatch*& batch = _pageBatches[page - 1];
+    if (batch == NULL)
+    {
+        batch = SpriteBatch::create(_atlas->getPage(page), _atlasEffect, _atlasCapacity);
+        GP_ASSERT(batch);
+
+        // Share the render state and projection of the first page.
+        batch->getMaterial()->setStateBlock(getStateBlock());
+        batch->setProjectionMatrix(_projectionMatrix);
+    }
+    if (isStarted() && !batch->isStarted())
+        batch->start();
+    return batch;
+}
+
 bool SpriteBatch::clipSprite(const Rectangle& clip, float& x, float& y, float& width, float& height, float& u1, float& v1, float& u2, float& v2)
 {
     // Clip the rectangle given by { x, y, width, height } into clip.
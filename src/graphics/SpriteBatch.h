@@ -8,6 +8,7 @@
 #include "../math/Matrix.h"
 #include "../graphics/RenderState.h"
 #include "../graphics/MeshBatch.h"
+#include "../graphics/TextureAtlas.h"
 
 namespace gplay
 {
@@ -27,6 +28,7 @@ class SpriteBatch
     friend class Bundle;
     friend class Font;
     friend class Text;
+    friend class TextLayout;
 
 public:
 
@@ -84,6 +86,27 @@ public:
      */
     static SpriteBatch* create(Texture* texture, Effect* effect = NULL, unsigned int initialCapacity = 0);
 
+    /**
+     * Creates a new SpriteBatch for drawing the regions of a texture atlas.
+     *
+     * Sprites drawn with the region draw methods are merged into one draw call per atlas
+     * page, whatever image they come from. The batch draws the first page itself and
+     * creates a batch with its projection matrix for each other page when it is first
+     * used. Starting and finishing the batch starts and finishes the batches of the
+     * pages, pages being drawn in order. Sprites of different
+     * pages are therefore not drawn in the order they were added.
+     *
+     * The other draw methods draw with the first page of the atlas.
+     *
+     * @param atlas The texture atlas for this sprite batch.
+     * @param effect An optional effect to use with the SpriteBatch.
+     * @param initialCapacity An optional initial capacity of the batch (number of sprites).
+     *
+     * @return A new SpriteBatch for drawing the regions of the atlas.
+     * @script{create}
+     */
+    static SpriteBatch* create(TextureAtlas* atlas, Effect* effect = NULL, unsigned int initialCapacity = 0);
+
     /**
      * Destructor.
      */
@@ -113,6 +136,39 @@ public:
      */
     void draw(const Rectangle& dst, const Rectangle& src, const Vector4& color = Vector4::one());
 
+    /**
+     * Draws a region of the texture atlas of the batch.
+     *
+     * @param region The atlas region to draw.
+     * @param dst The destination rectangle.
+     * @param color The color to tint the sprite. Use white for no tint.
+     */
+    void draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color = Vector4::one());
+
+    /**
+     * Draws a region of the texture atlas of the batch, clipped to a rectangle.
+     *
+     * @param region The atlas region to draw.
+     * @param dst The destination rectangle.
+     * @param color The color to tint the sprite. Use white for no tint.
+     * @param clip The clip rectangle.
+     */
+    void draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color, const Rectangle& clip);
+
+    /**
+     * Draws a rotated region of the texture atlas of the batch.
+     *
+     * @param region The atlas region to draw.
+     * @param dst The destination position.
+     * @param scale The X and Y scale.
+     * @param color The color to tint the sprite. Use white for no tint.
+     * @param rotationPoint The point to rotate around, relative to dst's x and y values.
+     *                      (e.g. Use Vector2(0.5f, 0.5f) to rotate around the quad's center.)
+     * @param rotationAngle The rotation angle in radians.
+     */
+    void draw(const TextureAtlas::Region* region, const Vector3& dst, const Vector2& scale, const Vector4& color,
+              const Vector2& rotationPoint, float rotationAngle);
+
     /**
      * Draws a single sprite.
      * 
@@ -340,7 +396,8 @@ public:
      * When the default effect is used with a SpriteBatch (i.e. when
      * NULL is passed into the 'effect' parameter of SpriteBatch::create),
      * this method sets a custom projection matrix to be used instead
-     * of the default orthographic projection.
+     * of the default orthographic projection. The matrix is also set
+     * on the batches of the other pages of a texture atlas.
      *
      * @param matrix The new projection matrix to be used with the default effect.
      */
@@ -353,6 +410,24 @@ public:
      */
     const Matrix& getProjectionMatrix() const;
 
+    /**
+     * Gets the texture atlas of the batch.
+     *
+     * @return The texture atlas, or NULL if the batch was not created for an atlas.
+     */
+    TextureAtlas* getAtlas() const;
+
+    /**
+     * Gets the batch drawing a page of the texture atlas of the batch, which is this batch
+     * for the first page. Sprites drawn with the page batch use the texture coordinates
+     * of the page.
+     *
+     * @param page The index of the atlas page.
+     *
+     * @return The batch drawing the page.
+     */
+    SpriteBatch* getPageBatch(unsigned int page);
+
 private:
 
     /**
@@ -408,6 +483,10 @@ private:
     float _textureWidthRatio;
     float _textureHeightRatio;
     mutable Matrix _projectionMatrix;
+    TextureAtlas* _atlas;
+    Effect* _atlasEffect;
+    unsigned int _atlasCapacity;
+    std::vector<SpriteBatch*> _pageBatches;
 };
 
 }
@@ -496,6 +496,21 @@ const BoundingBox& Terrain::getBoundingBox() const
     return _boundingBox;
 }
 
+bool Terrain::getBounds(BoundingBox* box, BoundingSphere* sphere) const
+{
+    GP_ASSERT(box);
+    GP_ASSERT(sphere);
+
+    if (!_node)
+        return false;
+
+    box->set(_boundingBox);
+    box->transform(_node->getWorldMatrix());
+    sphere->set(_boundingBox);
+    sphere->transform(_node->getWorldMatrix());
+    return true;
+}
+
 float Terrain::getHeight(float x, float z) const
 {
     // Calculate the correct x, z position relative to the heightfield data.
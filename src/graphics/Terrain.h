@@ -267,6 +267,11 @@ public:
      */
     unsigned int draw();
 
+    /**
+     * @see Drawable#getBounds
+     */
+    bool getBounds(BoundingBox* box, BoundingSphere* sphere) const;
+
 protected:
 
     /**
@@ -265,9 +265,8 @@ unsigned int Text::draw()
         }
     }
     _drawFont->start();
-    _drawFont->drawText(_text.c_str(), Rectangle(position.x, position.y, _width, _height),
-                    Vector4(_color.x, _color.y, _color.z, _color.w * _opacity), _size,
-                    _align, _wrap, _rightToLeft, clipViewport);
+    _layout.set(_drawFont, _text.c_str(), Rectangle(position.x, position.y, _width, _height), _size, _align, _wrap, _rightToLeft);
+    _layout.draw(Vector4(_color.x, _color.y, _color.z, _color.w * _opacity), clipViewport);
     _drawFont->finish();
     return 1;
 }
@@ -5,6 +5,7 @@
 #include "../animation/AnimationTarget.h"
 #include "../core/Properties.h"
 #include "../graphics/Font.h"
+#include "../graphics/TextLayout.h"
 #include "../math/Vector2.h"
 #include "../math/Vector4.h"
 #include "../graphics/Effect.h"
@@ -263,6 +264,7 @@ private:
     bool _rightToLeft;
     Font::Justify _align;
     Rectangle _clip;
+    TextLayout _layout;
     float _opacity;
     Vector4 _color;
 };
@@ -0,0 +1,264 @@
+#include "../core/Base.h"
+#include "../graphics/TextLayout.h"
+#include "../graphics/GlyphCache.h"
+
+// Maximum number of glyphs added to the font batch at once, indices are 16-bit.
+#define TEXT_LAYOUT_MAX_GLYPHS 4096
+
+namespace gplay
+{
+
+TextLayout::TextLayout()
+    : _font(NULL), _drawFont(NULL), _size(0), _justify(Font::ALIGN_TOP_LEFT), _wrap(true), _rightToLeft(false),
+      _evictionCount(0), _dirtyLayout(false), _dirtyTextBounds(true), _textWidth(0), _textHeight(0), _dirtyTextSize(true),
+      _dirtyVertices(true)
+{
+}
+
+TextLayout::~TextLayout()
+{
+    SAFE_RELEASE(_font);
+}
+
+bool TextLayout::set(Font* font, const char* text, const Rectangle& area, unsigned int size, Font::Justify justify, bool wrap, bool rightToLeft)
+{
+    GP_ASSERT(font);
+    GP_ASSERT(text);
+
+    if (font == _font && size == _size && justify == _justify && wrap == _wrap && rightToLeft == _rightToLeft &&
+        area.width == _area.width && area.height == _area.height && _text == text)
+    {
+        // Move the glyphs with the area.
+        const float dx = area.x - _area.x;
+        const float dy = area.y - _area.y;
+        if (dx != 0.0f || dy != 0.0f)
+        {
+            for (size_t i = 0, count = _quads.size(); i < count; ++i)
+            {
+                _quads[i].x += dx;
+                _quads[i].y += dy;
+            }
+            _bounds.x += dx;
+            _bounds.y += dy;
+            _textBounds.x += dx;
+            _textBounds.y += dy;
+            _area = area;
+            _dirtyVertices = true;
+        }
+        return false;
+    }
+
+    if (font != _font || size != _size || _text != text)
+        _dirtyTextSize = true;
+
+    if (font != _font)
+    {
+        font->addRef();
+        SAFE_RELEASE(_font);
+        _font = font;
+    }
+    _text = text;
+    _area = area;
+    _size = size;
+    _justify = justify;
+    _wrap = wrap;
+    _rightToLeft = rightToLeft;
+    _dirtyLayout = true;
+    _dirtyTextBounds = true;
+    return true;
+}
+
+void TextLayout::layout()
+{
+    GP_ASSERT(_font);
+
+    // Lay out with the closest size of the font, as drawn by Font::drawText().
+    unsigned int size = _size;
+    if (size == 0)
+    {
+        size = _font->_size;
+        _drawFont = _font;
+    }
+    else
+    {
+        _drawFont = _font->findClosestSize(size);
+    }
+    GP_ASSERT(_drawFont);
+
+    _quads.clear();
+    _drawFont->layoutText(_text.c_str(), _area, size, _justify, _wrap, _rightToLeft, &_quads);
+    _evictionCount = _drawFont->_glyphCache ? _drawFont->_glyphCache->getEvictionCount() : 0;
+
+    _bounds.set(_area.x, _area.y, 0, 0);
+    if (!_quads.empty())
+    {
+        float left = _quads[0].x;
+        float top = _quads[0].y;
+        float right = left;
+        float bottom = top;
+        for (size_t i = 0, count = _quads.size(); i < count; ++i)
+        {
+            const Font::GlyphQuad& q = _quads[i];
+            left = std::min(left, q.x);
+            top = std::min(top, q.y);
+            right = std::max(right, q.x + q.width);
+            bottom = std::max(bottom, q.y + q.height);
+        }
+        _bounds.set(left, top, right - left, bottom - top);
+    }
+    _dirtyLayout = false;
+    _dirtyVertices = true;
+}
+
+void TextLayout::draw(const Vector4& color, const Rectangle& clip)
+{
+    if (_dirtyLayout)
+        layout();
+
+    if (_drawFont == NULL)
+        return;
+
+    // Keep the glyphs in the atlas of fonts rasterizing them, lay out again if glyphs moved.
+    if (_drawFont->_glyphCache)
+    {
+        _drawFont->useGlyphs(_quads);
+        if (_evictionCount != _drawFont->_glyphCache->getEvictionCount())
+            layout();
+    }
+
+    if (_quads.empty())
+        return;
+
+    if (_dirtyVertices || color != _color || clip != _clip)
+        buildVertices(color, clip);
+
+    _drawFont->lazyStart();
+    SpriteBatch* batch = _drawFont->_batch;
+    GP_ASSERT(batch);
+    const unsigned int glyphCount = (unsigned int)_vertices.size() / 4;
+    for (unsigned int first = 0; first < glyphCount; first += TEXT_LAYOUT_MAX_GLYPHS)
+    {
+        const unsigned int count = std::min(glyphCount - first, (unsigned int)TEXT_LAYOUT_MAX_GLYPHS);
+        batch->draw(&_vertices[first * 4], count * 4, &_indices[0], count * 6 - 2);
+    }
+}
+
+void TextLayout::buildVertices(const Vector4& color, const Rectangle& clip)
+{
+    GP_ASSERT(_drawFont && _drawFont->_batch);
+
+    SpriteBatch* batch = _drawFont->_batch;
+    const bool clipped = clip != Rectangle(0, 0, 0, 0);
+    _vertices.resize(_quads.size() * 4);
+    unsigned int glyphCount = 0;
+    for (size_t i = 0, count = _quads.size(); i < count; ++i)
+    {
+        const Font::GlyphQuad& q = _quads[i];
+        float x = q.x;
+        float y = q.y;
+        float width = q.width;
+        float height = q.height;
+        float u1 = q.uvs[0];
+        float v1 = q.uvs[1];
+        float u2 = q.uvs[2];
+        float v2 = q.uvs[3];
+        if (clipped && !batch->clipSprite(clip, x, y, width, height, u1, v1, u2, v2))
+            continue;
+        batch->addSprite(x, y, width, height, u1, v1, u2, v2, color, &_vertices[glyphCount * 4]);
+        ++glyphCount;
+    }
+    _vertices.resize(glyphCount * 4);
+
+    // Triangle strips of the glyphs, joined by degenerate triangles.
+    const unsigned int indexedCount = std::min(glyphCount, (unsigned int)TEXT_LAYOUT_MAX_GLYPHS);
+    if (indexedCount > 0 && _indices.size() < indexedCount * 6 - 2)
+    {
+        _indices.clear();
+        for (unsigned int i = 0; i < indexedCount; ++i)
+        {
+            const unsigned short first = (unsigned short)(i * 4);
+            if (i > 0)
+            {
+                _indices.push_back(first - 1);
+                _indices.push_back(first);
+            }
+            _indices.push_back(first);
+            _indices.push_back(first + 1);
+            _indices.push_back(first + 2);
+            _indices.push_back(first + 3);
+        }
+    }
+
+    _color = color;
+    _clip = clip;
+    _dirtyVertices = false;
+}
+
+void TextLayout::clear()
+{
+    SAFE_RELEASE(_font);
+    _drawFont = NULL;
+    _text.clear();
+    _quads.clear();
+    _vertices.clear();
+    _bounds.set(0, 0, 0, 0);
+    _dirtyLayout = false;
+    _dirtyTextBounds = true;
+    _dirtyTextSize = true;
+    _dirtyVertices = true;
+}
+
+Font* TextLayout::getFont() const
+{
+    return _font;
+}
+
+const Rectangle& TextLayout::getBounds()
+{
+    if (_dirtyLayout)
+        layout();
+
+    return _bounds;
+}
+
+unsigned int TextLayout::getGlyphCount()
+{
+    if (_dirtyLayout)
+        layout();
+
+    return (unsigned int)_quads.size();
+}
+
+const Rectangle& TextLayout::getTextBounds()
+{
+    if (_dirtyTextBounds)
+    {
+        if (_font)
+            _font->measureText(_text.c_str(), _area, _size, &_textBounds, _justify, _wrap, true);
+        else
+            _textBounds.set(0, 0, 0, 0);
+        _dirtyTextBounds = false;
+    }
+
+    return _textBounds;
+}
+
+void TextLayout::measureText(unsigned int* width, unsigned int* height)
+{
+    GP_ASSERT(width);
+    GP_ASSERT(height);
+
+    if (_dirtyTextSize)
+    {
+        _textWidth = 0;
+        _textHeight = 0;
+        if (_font)
+            _font->measureText(_text.c_str(), _size, &_textWidth, &_textHeight);
+        _dirtyTextSize = false;
+    }
+
+    *width = _textWidth;
+    *height = _textHeight;
+}
+
+}
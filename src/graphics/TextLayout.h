@@ -0,0 +1,138 @@
+#ifndef TEXTLAYOUT_H_
+#define TEXTLAYOUT_H_
+
+#include "../graphics/Font.h"
+
+namespace gplay
+{
+
+/**
+ * Defines the layout of a text within an area, kept between the frames it is drawn in.
+ *
+ * Laying out a text (line breaking, justification and glyph lookups) costs much more than
+ * drawing it. A text layout lays out its text once and keeps the sprite vertices of its glyphs,
+ * which are added to the font batch with a single copy when the text is drawn.
+ *
+ * The text is only laid out again when the text, font, size, size of the area, justification,
+ * wrapping or direction change, and not before it is drawn or its bounds are needed. Moving the
+ * area moves the glyphs, and the vertices are only rebuilt when the glyphs, the color or the
+ * clip rectangle change. The measurements of the text are kept the same way.
+ *
+ * The glyphs of fonts created from font files can move in their atlas, their text is laid out
+ * again after glyphs were evicted from the atlas.
+ */
+class TextLayout
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    TextLayout();
+
+    /**
+     * Destructor.
+     */
+    ~TextLayout();
+
+    /**
+     * Sets the text to lay out, which is laid out again when next needed if it changed.
+     *
+     * @param font The font to draw the text with.
+     * @param text The text to lay out.
+     * @param area The viewport area to lay out within.
+     * @param size The size to draw text (0 for default size).
+     * @param justify Justification of text within the viewport.
+     * @param wrap Wraps text to fit within the width of the viewport if true.
+     * @param rightToLeft Whether to draw text from right to left.
+     *
+     * @return True if the text will be laid out again, false if the layout was kept.
+     */
+    bool set(Font* font, const char* text, const Rectangle& area, unsigned int size = 0,
+             Font::Justify justify = Font::ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false);
+
+    /**
+     * Draws the laid out text, between the start() and finish() of its font.
+     *
+     * @param color The color of text.
+     * @param clip A region to clip text within (empty for no clipping).
+     */
+    void draw(const Vector4& color, const Rectangle& clip = Rectangle(0, 0, 0, 0));
+
+    /**
+     * Clears the layout and releases its font.
+     */
+    void clear();
+
+    /**
+     * Gets the font the text is laid out with.
+     */
+    Font* getFont() const;
+
+    /**
+     * Gets the bounds of the laid out glyphs, in viewport coordinates.
+     */
+    const Rectangle& getBounds();
+
+    /**
+     * Gets the number of laid out glyphs.
+     */
+    unsigned int getGlyphCount();
+
+    /**
+     * Gets the bounds of all the lines of the text within the area, including the lines
+     * below the area, as measured by Font::measureText().
+     */
+    const Rectangle& getTextBounds();
+
+    /**
+     * Measures the size of the text without wrapping, as Font::measureText() does.
+     *
+     * @param width Destination for the text's width.
+     * @param height Destination for the text's height.
+     */
+    void measureText(unsigned int* width, unsigned int* height);
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    TextLayout(const TextLayout& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TextLayout& operator=(const TextLayout&);
+
+    void layout();
+
+    void buildVertices(const Vector4& color, const Rectangle& clip);
+
+    Font* _font;
+    Font* _drawFont;
+    std::string _text;
+    Rectangle _area;
+    unsigned int _size;
+    Font::Justify _justify;
+    bool _wrap;
+    bool _rightToLeft;
+    unsigned int _evictionCount;
+    std::vector<Font::GlyphQuad> _quads;
+    Rectangle _bounds;
+    bool _dirtyLayout;
+    Rectangle _textBounds;
+    bool _dirtyTextBounds;
+    unsigned int _textWidth;
+    unsigned int _textHeight;
+    bool _dirtyTextSize;
+    bool _dirtyVertices;
+    Vector4 _color;
+    Rectangle _clip;
+    std::vector<SpriteBatch::SpriteVertex> _vertices;
+    std::vector<unsigned short> _indices;
+};
+
+}
+
+#endif
@@ -2,12 +2,11 @@
 #include "../graphics/Image.h"
 #include "../graphics/Texture.h"
 #include "../core/FileSystem.h"
+#include "../core/ResourceCache.h"
 #include "../renderer/BGFXTexture.h"
 
 namespace gplay {
 
-static std::vector<Texture*> __textureCache;
-
 Texture::Texture() :
     _gpuTtexture(nullptr),
     _format(UNKNOWN),
@@ -17,6 +16,7 @@ Texture::Texture() :
     _mipmapped(false),
     _cached(false),
     _compressed(false),
+    _storageSize(0),
     _wrapS(Texture::REPEAT),
     _wrapT(Texture::REPEAT),
     _wrapR(Texture::REPEAT),
@@ -35,11 +35,7 @@ Texture::~Texture()
     // Remove ourself from the texture cache.
     if (_cached)
     {
-        std::vector<Texture*>::iterator itr = std::find(__textureCache.begin(), __textureCache.end(), this);
-        if (itr != __textureCache.end())
-        {
-            __textureCache.erase(itr);
-        }
+        ResourceCache::remove(ResourceCache::TEXTURE, _path.c_str(), this);
     }
 }
 
@@ -48,39 +44,18 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     GP_ASSERT( path );
 
     // Search texture cache first.
-    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    Texture* texture = getCached(path, generateMipmaps);
+    if (texture)
     {
-        Texture* t = __textureCache[i];
-        GP_ASSERT( t );
-        if (t->_path == path)
-        {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
-
-            // Found a match.
-            t->addRef();
-
-            return t;
-        }
+        return texture;
     }
 
     // Create texture.
-    Texture* texture = BGFXTexture::createFromFile(path);
+    texture = BGFXTexture::createFromFile(path, generateMipmaps);
 
     if (texture)
     {
-        GP_ASSERT(texture->_gpuTtexture);
-
-        texture->_path = path;
-        texture->_cached = true;
-
-        // Add to texture cache.
-        __textureCache.push_back(texture);
-
+        addCached(texture, path);
         return texture;
     }
 
@@ -88,6 +63,39 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     return NULL;
 }
 
+Texture* Texture::getCached(const char* path, bool generateMipmaps)
+{
+    GP_ASSERT( path );
+
+    Texture* t = static_cast<Texture*>(ResourceCache::find(ResourceCache::TEXTURE, path));
+    if (t)
+    {
+        // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the
+        // texture to generate its mipmap chain if it hasn't already done so.
+        if (generateMipmaps)
+        {
+            t->generateMipmaps();
+        }
+
+        // Found a match.
+        t->addRef();
+    }
+    return t;
+}
+
+void Texture::addCached(Texture* texture, const char* path)
+{
+    GP_ASSERT( texture );
+    GP_ASSERT( texture->_gpuTtexture );
+    GP_ASSERT( path );
+
+    texture->_path = path;
+    texture->_cached = true;
+
+    // Add to texture cache.
+    ResourceCache::add(ResourceCache::TEXTURE, path, texture, texture->_storageSize);
+}
+
 Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT( image );
@@ -135,11 +143,7 @@ Texture* Texture::create(Format format, unsigned int width, unsigned int height,
     textureInfo.id = "";
     textureInfo.flags = 0;
 
-    Texture* texture = BGFXTexture::createFromData(textureInfo, data);
-    if (generateMipmaps)
-        texture->generateMipmaps();
-
-    return texture;
+    return BGFXTexture::createFromData(textureInfo, data, BGFX_TEXTURE_NONE, generateMipmaps);
 }
 
 Texture* Texture::create(TextureInfo& textureInfo)
@@ -210,24 +214,25 @@ BGFXTexture *Texture::getHandle() const
 
 void Texture::generateMipmaps()
 {
-    if (!_mipmapped)
+    if (_mipmapped)
+        return;
+
+    // bgfx textures are immutable, reload the texture with its mipmaps.
+    if (!_cached || _compressed)
     {
-        _mipmapped = true;
+        GP_WARN("Mipmaps can only be generated for textures loaded from uncompressed image files.");
+        return;
     }
 
-    //@@if (!_mipmapped)
-    //@@{
-    //@@    GLenum target = (GLenum)_type;
-    //@@    GL_ASSERT( glBindTexture(target, _handle) );
-    //@@    GL_ASSERT( glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST) );
-    //@@    if( std::addressof(glGenerateMipmap) )
-    //@@        GL_ASSERT( glGenerateMipmap(target) );
-    //@@
-    //@@    _mipmapped = true;
-    //@@
-    //@@    // Restore the texture id
-    //@@    GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
-    //@@}
+    Texture* texture = BGFXTexture::createFromFile(_path.c_str(), true);
+    if (texture && texture->_gpuTtexture)
+    {
+        std::swap(_gpuTtexture, texture->_gpuTtexture);
+        _mipmapped = texture->_mipmapped;
+        _storageSize = texture->_storageSize;
+        ResourceCache::setMemory(ResourceCache::TEXTURE, _path.c_str(), this, _storageSize);
+    }
+    SAFE_RELEASE(texture);
 }
 
 bool Texture::isMipmapped() const
@@ -19,6 +19,7 @@ class Texture : public Ref
     friend class Sampler;
     friend class BGFXTexture;
     friend class FrameBuffer;
+    friend class AssetLoader;
 
 public:
 
@@ -43,6 +44,21 @@ public:
         D16F,
         D24F,
         D32F,
+        BC1,
+        BC2,
+        BC3,
+        BC4,
+        BC5,
+        BC6H,
+        BC7,
+        ETC1,
+        ETC2,
+        ETC2A,
+        ETC2A1,
+        PTC12,
+        PTC14,
+        PTC12A,
+        PTC14A,
     };
 
     /**
@@ -207,8 +223,16 @@ public:
     /**
      * Creates a texture from the given image resource.
      *
-     * Note that for textures that include mipmap data in the source data (such as most compressed textures),
-     * the generateMipmaps flags should NOT be set to true.
+     * PNG, JPEG, TGA, HDR, KTX, DDS and PVR files are supported. Compressed KTX, DDS and PVR
+     * files are created with the mip levels they contain, and are decoded on load when the
+     * renderer doesn't support their format.
+     *
+     * If the 'textureExtension' property of the 'graphics' namespace of the game config is set
+     * (e.g. ".ktx"), a file with that extension and the same name as the path is loaded instead
+     * when it exists. This lets a game reference its source images and ship compressed textures.
+     *
+     * Mipmaps are generated with a box filter on the image data when it has a single level, in an
+     * uncompressed 8 bits per channel format. Textures that include their mipmaps are loaded as is.
      *
      * @param path The image resource path.
      * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
@@ -313,6 +337,9 @@ public:
 
     /**
      * Generates a full mipmap chain for this texture if it isn't already mipmapped.
+     *
+     * The texture is reloaded from its file with its mipmaps. Textures that were not loaded
+     * from a file must be created with the generateMipmaps parameter instead.
      */
     void generateMipmaps();
 
@@ -360,6 +387,21 @@ private:
 
     static size_t getFormatBPP(Format format);
 
+    /**
+     * Returns the cached texture loaded from the given path, with an added reference.
+     *
+     * @param path The path of the texture.
+     * @param generateMipmaps Forces the cached texture to generate its mipmap chain.
+     *
+     * @return The cached texture, or NULL if the texture is not cached.
+     */
+    static Texture* getCached(const char* path, bool generateMipmaps);
+
+    /**
+     * Adds a texture loaded from the given path to the cache.
+     */
+    static void addCached(Texture* texture, const char* path);
+
     std::string _path;
     BGFXTexture * _gpuTtexture;
     Format _format;
@@ -369,6 +411,7 @@ private:
     bool _mipmapped;
     bool _cached;
     bool _compressed;
+    size_t _storageSize;
     Wrap _wrapS;
     Wrap _wrapT;
     Wrap _wrapR;
@@ -0,0 +1,354 @@
+#include "../core/Base.h"
+#include "../graphics/TextureAtlas.h"
+#include "../graphics/Image.h"
+#include "../core/Properties.h"
+#include "../renderer/BGFXTexture.h"
+
+// Alignment of the images in the pages, images cover whole texels of the first mip levels.
+#define TEXTURE_ATLAS_ALIGNMENT 4
+
+namespace gplay
+{
+
+static unsigned int align(unsigned int value)
+{
+    return (value + TEXTURE_ATLAS_ALIGNMENT - 1) & ~(TEXTURE_ATLAS_ALIGNMENT - 1);
+}
+
+TextureAtlas::TextureAtlas(unsigned int pageWidth, unsigned int pageHeight, unsigned int padding)
+    : _pageWidth(pageWidth), _pageHeight(pageHeight), _padding(padding)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_pages[i].texture);
+    }
+    for (size_t i = 0, count = _regions.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_regions[i]);
+    }
+}
+
+TextureAtlas* TextureAtlas::create(unsigned int pageWidth, unsigned int pageHeight, unsigned int padding)
+{
+    GP_ASSERT(pageWidth > 0 && pageHeight > 0);
+
+    TextureAtlas* atlas = new TextureAtlas(pageWidth, pageHeight, padding);
+    if (!atlas->addPage())
+    {
+        SAFE_RELEASE(atlas);
+        return NULL;
+    }
+    return atlas;
+}
+
+TextureAtlas* TextureAtlas::create(const char* url)
+{
+    GP_ASSERT(url);
+
+    Properties* properties = Properties::create(url);
+    if (properties == NULL)
+    {
+        GP_WARN("Failed to create texture atlas from file '%s'.", url);
+        return NULL;
+    }
+    Properties* atlasProperties = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+    if (atlasProperties == NULL || strcmp(atlasProperties->getNamespace(), "atlas") != 0)
+    {
+        GP_WARN("Texture atlas file '%s' has no 'atlas' namespace.", url);
+        SAFE_DELETE(properties);
+        return NULL;
+    }
+
+    Vector2 pageSize(1024.0f, 1024.0f);
+    atlasProperties->getVector2("pageSize", &pageSize);
+    int padding = atlasProperties->getInt("padding");
+    if (!atlasProperties->exists("padding"))
+        padding = 2;
+
+    // Load all the images, then pack them from the tallest to the shortest.
+    std::vector<std::pair<std::string, Image*> > images;
+    const char* name;
+    while ((name = atlasProperties->getNextProperty()) != NULL)
+    {
+        std::string path;
+        if (strcmp(name, "pageSize") == 0 || strcmp(name, "padding") == 0 || !atlasProperties->getPath(name, &path))
+        {
+            if (strcmp(name, "pageSize") != 0 && strcmp(name, "padding") != 0)
+                GP_WARN("Image '%s' of texture atlas '%s' not found.", atlasProperties->getString(name), url);
+            continue;
+        }
+        Image* image = Image::create(path.c_str());
+        if (image)
+            images.push_back(std::make_pair(path, image));
+    }
+    SAFE_DELETE(properties);
+
+    std::stable_sort(images.begin(), images.end(), [](const std::pair<std::string, Image*>& a, const std::pair<std::string, Image*>& b)
+    {
+        return a.second->getHeight() > b.second->getHeight();
+    });
+
+    TextureAtlas* atlas = create((unsigned int)pageSize.x, (unsigned int)pageSize.y, (unsigned int)std::max(padding, 0));
+    for (size_t i = 0, count = images.size(); i < count; ++i)
+    {
+        if (atlas)
+            atlas->addImage(images[i].first.c_str(), images[i].second);
+        SAFE_RELEASE(images[i].second);
+    }
+    return atlas;
+}
+
+const TextureAtlas::Region* TextureAtlas::addImage(const char* path)
+{
+    GP_ASSERT(path);
+
+    const Region* region = getRegion(path);
+    if (region)
+        return region;
+
+    Image* image = Image::create(path);
+    if (image == NULL)
+    {
+        GP_WARN("Failed to load image '%s' for texture atlas.", path);
+        return NULL;
+    }
+    region = addImage(path, image);
+    SAFE_RELEASE(image);
+    return region;
+}
+
+const TextureAtlas::Region* TextureAtlas::addImage(const char* name, Image* image)
+{
+    GP_ASSERT(name);
+    GP_ASSERT(image);
+
+    const Region* existing = getRegion(name);
+    if (existing)
+        return existing;
+
+    const unsigned int width = align(image->getWidth() + _padding * 2);
+    const unsigned int height = align(image->getHeight() + _padding * 2);
+    if (width > _pageWidth || height > _pageHeight)
+    {
+        GP_WARN("Image '%s' (%dx%d) is too large for the texture atlas pages (%dx%d).", name, image->getWidth(), image->getHeight(), _pageWidth, _pageHeight);
+        return NULL;
+    }
+
+    // Use the page where the image is the lowest, or a new page.
+    int pageIndex = -1;
+    int nodeIndex = -1;
+    unsigned int x = 0;
+    unsigned int y = 0;
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        unsigned int pageX, pageY;
+        int index = findPosition(_pages[i], width, height, &pageX, &pageY);
+        if (index >= 0 && (pageIndex < 0 || pageY < y))
+        {
+            pageIndex = (int)i;
+            nodeIndex = index;
+            x = pageX;
+            y = pageY;
+        }
+    }
+    if (pageIndex < 0)
+    {
+        if (!addPage())
+            return NULL;
+        pageIndex = (int)_pages.size() - 1;
+        nodeIndex = findPosition(_pages[pageIndex], width, height, &x, &y);
+        GP_ASSERT(nodeIndex >= 0);
+    }
+
+    Page& page = _pages[pageIndex];
+    insertSkylineNode(page, nodeIndex, x, y, width, height);
+    upload(page, image, x, y);
+
+    Region* region = new Region();
+    region->name = name;
+    region->page = (unsigned int)pageIndex;
+    region->bounds.set((float)(x + _padding), (float)(y + _padding), (float)image->getWidth(), (float)image->getHeight());
+
+    // Same convention as SpriteBatch::draw(const Rectangle&, const Rectangle&, const Vector4&).
+    region->u1 = region->bounds.x / _pageWidth;
+    region->v1 = 1.0f - region->bounds.y / _pageHeight;
+    region->u2 = region->bounds.right() / _pageWidth;
+    region->v2 = 1.0f - region->bounds.bottom() / _pageHeight;
+
+    _regions.push_back(region);
+    _regionsByName[region->name] = region;
+    return region;
+}
+
+const TextureAtlas::Region* TextureAtlas::getRegion(const char* name) const
+{
+    GP_ASSERT(name);
+    std::map<std::string, Region*>::const_iterator itr = _regionsByName.find(name);
+    return itr != _regionsByName.end() ? itr->second : NULL;
+}
+
+unsigned int TextureAtlas::getRegionCount() const
+{
+    return (unsigned int)_regions.size();
+}
+
+unsigned int TextureAtlas::getPageCount() const
+{
+    return (unsigned int)_pages.size();
+}
+
+Texture* TextureAtlas::getPage(unsigned int index) const
+{
+    GP_ASSERT(index < _pages.size());
+    return _pages[index].texture;
+}
+
+unsigned int TextureAtlas::getPageWidth() const
+{
+    return _pageWidth;
+}
+
+unsigned int TextureAtlas::getPageHeight() const
+{
+    return _pageHeight;
+}
+
+unsigned int TextureAtlas::getPadding() const
+{
+    return _padding;
+}
+
+bool TextureAtlas::addPage()
+{
+    char id[32];
+    sprintf(id, "atlas_%p_%u", (void*)this, (unsigned int)_pages.size());
+    Texture* texture = Texture::create(id, _pageWidth, _pageHeight, Texture::RGBA);
+    if (texture == NULL)
+    {
+        GP_WARN("Failed to create texture atlas page (%dx%d).", _pageWidth, _pageHeight);
+        return false;
+    }
+
+    Page page;
+    page.texture = texture;
+    SkylineNode node = { 0, 0, _pageWidth };
+    page.skyline.push_back(node);
+    _pages.push_back(page);
+    return true;
+}
+
+int TextureAtlas::findPosition(const Page& page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y) const
+{
+    int bestIndex = -1;
+    unsigned int bestY = UINT_MAX;
+    unsigned int bestWidth = UINT_MAX;
+    const std::vector<SkylineNode>& skyline = page.skyline;
+    for (size_t i = 0, count = skyline.size(); i < count; ++i)
+    {
+        if (skyline[i].x + width > _pageWidth)
+            break;
+
+        // The rectangle rests on the highest node it spans.
+        unsigned int top = 0;
+        unsigned int remaining = width;
+        for (size_t j = i; remaining > 0; ++j)
+        {
+            GP_ASSERT(j < count);
+            top = std::max(top, skyline[j].y);
+            remaining -= std::min(remaining, skyline[j].width);
+        }
+        if (top + height > _pageHeight)
+            continue;
+
+        // Prefer the lowest position, then the narrowest node to limit wasted space.
+        if (top < bestY || (top == bestY && skyline[i].width < bestWidth))
+        {
+            bestIndex = (int)i;
+            bestY = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+
+    if (bestIndex >= 0)
+    {
+        *x = skyline[bestIndex].x;
+        *y = bestY;
+    }
+    return bestIndex;
+}
+
+void TextureAtlas::insertSkylineNode(Page& page, int index, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    std::vector<SkylineNode>& skyline = page.skyline;
+    SkylineNode node = { x, y + height, width };
+    skyline.insert(skyline.begin() + index, node);
+
+    // Shrink or remove the nodes covered by the new one.
+    for (size_t i = index + 1; i < skyline.size(); )
+    {
+        const unsigned int end = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= end)
+            break;
+
+        const unsigned int shrink = end - skyline[i].x;
+        if (skyline[i].width <= shrink)
+        {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        break;
+    }
+
+    // Merge the neighbour nodes of the same height.
+    for (size_t i = 0; i + 1 < skyline.size(); )
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void TextureAtlas::upload(const Page& page, Image* image, unsigned int x, unsigned int y) const
+{
+    const unsigned int imageWidth = image->getWidth();
+    const unsigned int imageHeight = image->getHeight();
+    const unsigned int width = imageWidth + _padding * 2;
+    const unsigned int height = imageHeight + _padding * 2;
+    const unsigned int srcBpp = image->getFormat() == Image::RGBA ? 4 : 3;
+    const unsigned char* src = image->getData();
+
+    // Copy the image to RGBA, clamping the coordinates so that the padding repeats the edge pixels.
+    const bgfx::Memory* mem = bgfx::alloc(width * height * 4);
+    unsigned char* dst = mem->data;
+    for (unsigned int row = 0; row < height; ++row)
+    {
+        const unsigned int srcY = (unsigned int)std::min(std::max((int)row - (int)_padding, 0), (int)imageHeight - 1);
+        for (unsigned int column = 0; column < width; ++column)
+        {
+            const unsigned int srcX = (unsigned int)std::min(std::max((int)column - (int)_padding, 0), (int)imageWidth - 1);
+            const unsigned char* pixel = src + (srcY * imageWidth + srcX) * srcBpp;
+            dst[0] = pixel[0];
+            dst[1] = pixel[1];
+            dst[2] = pixel[2];
+            dst[3] = srcBpp == 4 ? pixel[3] : 255;
+            dst += 4;
+        }
+    }
+
+    GP_ASSERT(page.texture && page.texture->getHandle());
+    page.texture->getHandle()->update(x, y, width, height, mem);
+}
+
+}
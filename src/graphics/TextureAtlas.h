@@ -0,0 +1,209 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include "../core/Ref.h"
+#include "../graphics/Texture.h"
+#include "../math/Rectangle.h"
+
+namespace gplay
+{
+
+class Image;
+class Properties;
+
+/**
+ * Defines a texture atlas, which packs images into shared texture pages.
+ *
+ * Images are packed with a skyline bottom-left rectangle packer into pages of a fixed
+ * size, a new page being added when an image doesn't fit in the existing ones. Each
+ * image is surrounded by padding filled with its edge pixels, so that bilinear filtering
+ * doesn't bleed neighbour images into it, and is aligned so that it covers whole texels
+ * of the first mip levels.
+ *
+ * Sprites drawn from the regions of an atlas with a SpriteBatch created for the atlas
+ * are merged into one draw call per page, whatever image they use.
+ *
+ * An atlas can be described by a properties file, which lists the images packed
+ * together when the atlas is created. Every property other than the page size and the
+ * padding is an image, the regions being named by the image paths:
+ *
+ * @verbatim
+    atlas
+    {
+        pageSize = 1024, 1024
+        padding = 2
+        button = res/ui/button.png
+        icons = res/ui/icons.png
+    }
+   @endverbatim
+ */
+class TextureAtlas : public Ref
+{
+public:
+
+    /**
+     * A region of an atlas page containing an image.
+     */
+    struct Region
+    {
+        std::string name;       // Name of the image, the path of image files.
+        unsigned int page;      // Index of the page containing the image.
+        Rectangle bounds;       // Bounds of the image in the page, in pixels.
+        float u1, v1, u2, v2;   // Texture coordinates of the image in the page.
+    };
+
+    /**
+     * Creates an empty texture atlas.
+     *
+     * @param pageWidth The width of the pages, in pixels.
+     * @param pageHeight The height of the pages, in pixels.
+     * @param padding The number of pixels around each image, filled with its edge pixels.
+     *
+     * @return The new texture atlas.
+     * @script{create}
+     */
+    static TextureAtlas* create(unsigned int pageWidth = 1024, unsigned int pageHeight = 1024, unsigned int padding = 2);
+
+    /**
+     * Creates a texture atlas from a properties file listing its images.
+     *
+     * The images are sorted by size before being packed, which packs them tighter than
+     * adding them one by one.
+     *
+     * @param url The URL of the atlas properties (e.g. "res/ui/hud.atlas#atlas").
+     *
+     * @return The new texture atlas, or NULL if the file can't be read.
+     * @script{create}
+     */
+    static TextureAtlas* create(const char* url);
+
+    /**
+     * Adds an image file to the atlas, or returns its region if it was already added.
+     *
+     * @param path The path of the image, which is also the name of the region.
+     *
+     * @return The region of the image, or NULL if the image can't be loaded or is larger than a page.
+     */
+    const Region* addImage(const char* path);
+
+    /**
+     * Adds an image to the atlas, or returns the region of the given name if it exists.
+     *
+     * @param name The name of the region.
+     * @param image The RGB or RGBA image to add.
+     *
+     * @return The region of the image, or NULL if the image is larger than a page.
+     */
+    const Region* addImage(const char* name, Image* image);
+
+    /**
+     * Returns the region of the given name.
+     *
+     * @param name The name of the region.
+     *
+     * @return The region, or NULL if the atlas has no region of that name.
+     */
+    const Region* getRegion(const char* name) const;
+
+    /**
+     * Returns the number of regions in the atlas.
+     */
+    unsigned int getRegionCount() const;
+
+    /**
+     * Returns the number of pages in the atlas, which has at least one page.
+     */
+    unsigned int getPageCount() const;
+
+    /**
+     * Returns the texture of an atlas page.
+     *
+     * @param index The index of the page.
+     *
+     * @return The texture of the page.
+     */
+    Texture* getPage(unsigned int index) const;
+
+    /**
+     * Returns the width of the pages, in pixels.
+     */
+    unsigned int getPageWidth() const;
+
+    /**
+     * Returns the height of the pages, in pixels.
+     */
+    unsigned int getPageHeight() const;
+
+    /**
+     * Returns the number of padding pixels around each image.
+     */
+    unsigned int getPadding() const;
+
+private:
+
+    /**
+     * A segment of the skyline of a page: the top of the images packed below it.
+     */
+    struct SkylineNode
+    {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    /**
+     * A page of the atlas.
+     */
+    struct Page
+    {
+        Texture* texture;
+        std::vector<SkylineNode> skyline;
+    };
+
+    /**
+     * Constructor.
+     */
+    TextureAtlas(unsigned int pageWidth, unsigned int pageHeight, unsigned int padding);
+
+    /**
+     * Destructor.
+     */
+    ~TextureAtlas();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TextureAtlas(const TextureAtlas& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TextureAtlas& operator=(const TextureAtlas&);
+
+    bool addPage();
+
+    /**
+     * Finds the lowest position where a rectangle fits in the skyline of a page.
+     *
+     * @return The index of the skyline node the rectangle starts at, or -1 if it doesn't fit.
+     */
+    int findPosition(const Page& page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y) const;
+
+    void insertSkylineNode(Page& page, int index, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+    /**
+     * Copies an image and its padded edges into a page.
+     */
+    void upload(const Page& page, Image* image, unsigned int x, unsigned int y) const;
+
+    unsigned int _pageWidth;
+    unsigned int _pageHeight;
+    unsigned int _padding;
+    std::vector<Page> _pages;
+    std::vector<Region*> _regions;
+    std::map<std::string, Region*> _regionsByName;
+};
+
+}
+
+#endif
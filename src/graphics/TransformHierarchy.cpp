@@ -0,0 +1,249 @@
+#include "../core/Base.h"
+#include "../graphics/TransformHierarchy.h"
+#include "../graphics/Node.h"
+#include "../physics/PhysicsCollisionObject.h"
+#include "../core/Game.h"
+
+// Node dirty flags (see Node.cpp)
+#define NODE_DIRTY_WORLD 1
+
+// Minimum number of nodes for the update to be split across the job scheduler threads.
+#define TRANSFORM_HIERARCHY_PARALLEL_THRESHOLD 256
+
+namespace gplay
+{
+
+TransformHierarchy::TransformHierarchy(Node* root)
+    : _root(root), _anyDirty(true), _structureDirty(true)
+{
+    GP_ASSERT(root);
+    _root->addRef();
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+    clear();
+    SAFE_RELEASE(_root);
+}
+
+TransformHierarchy* TransformHierarchy::create(Node* root)
+{
+    GP_ASSERT(root);
+    if (root->_transformHierarchy)
+    {
+        GP_ERROR("Node '%s' already belongs to a transform hierarchy.", root->getId());
+        return NULL;
+    }
+
+    TransformHierarchy* hierarchy = new TransformHierarchy(root);
+    hierarchy->rebuild();
+    return hierarchy;
+}
+
+Node* TransformHierarchy::getRoot() const
+{
+    return _root;
+}
+
+unsigned int TransformHierarchy::getNodeCount() const
+{
+    return (unsigned int)_nodes.size();
+}
+
+void TransformHierarchy::clear()
+{
+    for (size_t i = 0, count = _nodes.size(); i < count; ++i)
+    {
+        Node* node = _nodes[i];
+        if (node && node->_transformHierarchy == this)
+        {
+            node->_transformHierarchy = NULL;
+        }
+    }
+    _nodes.clear();
+    _parents.clear();
+    _subtreeEnds.clear();
+    _local.clear();
+    _world.clear();
+    _dirty.clear();
+    _changed.clear();
+}
+
+void TransformHierarchy::rebuild()
+{
+    clear();
+    flatten(_root, -1);
+
+    const size_t count = _nodes.size();
+    _local.resize(count);
+    _world.resize(count);
+    _changed.resize(count);
+
+    // Everything is evaluated on the next update.
+    _dirty.assign((count + 31) / 32, 0xffffffff);
+
+    _structureDirty = false;
+    _anyDirty = true;
+}
+
+void TransformHierarchy::flatten(Node* node, int parentIndex)
+{
+    GP_ASSERT(node);
+    if (node->_transformHierarchy && node->_transformHierarchy != this)
+    {
+        // Leave the subtree to the hierarchy that owns it, it is evaluated as a root there.
+        GP_WARN("Node '%s' already belongs to another transform hierarchy.", node->getId());
+        return;
+    }
+
+    const unsigned int index = (unsigned int)_nodes.size();
+    node->_transformHierarchy = this;
+    node->_transformIndex = index;
+    _nodes.push_back(node);
+    _parents.push_back(parentIndex);
+    _subtreeEnds.push_back(index + 1);
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        flatten(child, (int)index);
+    }
+    _subtreeEnds[index] = (unsigned int)_nodes.size();
+}
+
+void TransformHierarchy::setDirty(unsigned int index)
+{
+    GP_ASSERT(index < _nodes.size());
+    _dirty[index >> 5] |= 1u << (index & 31);
+    _anyDirty = true;
+}
+
+bool TransformHierarchy::isDirty(unsigned int index) const
+{
+    return (_dirty[index >> 5] & (1u << (index & 31))) != 0;
+}
+
+void TransformHierarchy::setStructureDirty()
+{
+    _structureDirty = true;
+    _anyDirty = true;
+}
+
+void TransformHierarchy::nodeDestroyed(unsigned int index)
+{
+    GP_ASSERT(index < _nodes.size());
+    _nodes[index] = NULL;
+    setStructureDirty();
+}
+
+void TransformHierarchy::nodeRemoved(Node* node)
+{
+    GP_ASSERT(node);
+    if (node == _root)
+    {
+        // The root stays ours, only the world matrix of its parent changes.
+        return;
+    }
+
+    // The node may be added to another hierarchy before we are rebuilt.
+    if (node->_transformHierarchy == this)
+    {
+        _nodes[node->_transformIndex] = NULL;
+        node->_transformHierarchy = NULL;
+    }
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        nodeRemoved(child);
+    }
+    setStructureDirty();
+}
+
+void TransformHierarchy::update()
+{
+    if (_structureDirty)
+    {
+        rebuild();
+    }
+    if (!_anyDirty || _nodes.empty())
+        return;
+
+    // Clear the flag first: getWorldMatrix() on the parent of the root may come back here.
+    _anyDirty = false;
+
+    Node* parent = _root->getParent();
+    _rootParentWorld = parent ? parent->getWorldMatrix() : Matrix::identity();
+
+    const unsigned int count = (unsigned int)_nodes.size();
+    JobScheduler* scheduler = Game::getInstance()->getJobScheduler();
+    if (count < TRANSFORM_HIERARCHY_PARALLEL_THRESHOLD || !scheduler || scheduler->getThreadCount() < 2)
+    {
+        updateRange(0, count);
+    }
+    else
+    {
+        // The root first, then the subtrees of its children, which are independent ranges.
+        updateRange(0, 1);
+
+        std::vector<unsigned int> starts;
+        for (unsigned int i = 1; i < count; i = _subtreeEnds[i])
+        {
+            starts.push_back(i);
+        }
+        scheduler->parallelFor((unsigned int)starts.size(), 1, [this, &starts](unsigned int start, unsigned int end)
+        {
+            for (unsigned int i = start; i < end; ++i)
+            {
+                updateRange(starts[i], _subtreeEnds[starts[i]]);
+            }
+        });
+    }
+
+    memset(&_dirty[0], 0, _dirty.size() * sizeof(unsigned int));
+}
+
+void TransformHierarchy::updateRange(unsigned int start, unsigned int end)
+{
+    for (unsigned int i = start; i < end; ++i)
+    {
+        // A node changes if its transform was changed or if its parent changed.
+        const int parentIndex = _parents[i];
+        bool changed = isDirty(i) || (parentIndex >= 0 && _changed[parentIndex]);
+        _changed[i] = changed;
+
+        Node* node = _nodes[i];
+        if (!changed || !node)
+            continue;
+
+        _local[i] = node->getMatrix();
+
+        // Same rules as Node::getWorldMatrix().
+        if (node->isStatic())
+        {
+            _world[i] = node->_world;
+        }
+        else
+        {
+            PhysicsCollisionObject* collisionObject = node->getCollisionObject();
+            if (collisionObject && !collisionObject->isKinematic())
+            {
+                _world[i] = _local[i];
+            }
+            else if (parentIndex >= 0)
+            {
+                Matrix::multiply(_world[parentIndex], _local[i], &_world[i]);
+            }
+            else if (node->getParent())
+            {
+                Matrix::multiply(_rootParentWorld, _local[i], &_world[i]);
+            }
+            else
+            {
+                _world[i] = _local[i];
+            }
+        }
+
+        node->_world = _world[i];
+        node->_dirtyBits &= ~NODE_DIRTY_WORLD;
+    }
+}
+
+}
@@ -0,0 +1,130 @@
+#ifndef TRANSFORMHIERARCHY_H_
+#define TRANSFORMHIERARCHY_H_
+
+#include "../core/Ref.h"
+#include "../math/Matrix.h"
+
+namespace gplay
+{
+
+class Node;
+
+/**
+ * Defines a flattened store for the transforms of a node hierarchy.
+ *
+ * The nodes of the hierarchy are laid out in depth-first order, so parents come
+ * before their children and each subtree is a contiguous range, with contiguous
+ * arrays of parent indices, local and world matrices and a dirty bitset.
+ *
+ * Changing the transform of a stored node only sets its dirty bit. World matrices
+ * are then recomputed for all the dirty nodes and their descendants in a single
+ * linear pass, the first time a world matrix of the hierarchy is requested (or when
+ * update() is called), instead of the recursive per node evaluation. Large
+ * hierarchies are updated in parallel by subtree using the game's job scheduler.
+ *
+ * Adding or removing nodes in the hierarchy is detected and the store is rebuilt on
+ * the next update. A node can only belong to one transform hierarchy.
+ */
+class TransformHierarchy : public Ref
+{
+    friend class Node;
+
+public:
+
+    /**
+     * Creates a transform hierarchy for the given node and all its descendants.
+     *
+     * @param root The root node of the hierarchy.
+     *
+     * @return The new transform hierarchy.
+     * @script{create}
+     */
+    static TransformHierarchy* create(Node* root);
+
+    /**
+     * Returns the root node of the hierarchy.
+     *
+     * @return The root node.
+     */
+    Node* getRoot() const;
+
+    /**
+     * Returns the number of nodes in the hierarchy.
+     *
+     * @return The number of nodes.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Recomputes the world matrices of the nodes that changed since the last update.
+     */
+    void update();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    TransformHierarchy(Node* root);
+
+    /**
+     * Destructor. Hidden use release() instead.
+     */
+    ~TransformHierarchy();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TransformHierarchy(const TransformHierarchy& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TransformHierarchy& operator=(const TransformHierarchy&);
+
+    /**
+     * Flattens the hierarchy of the root node into the arrays.
+     */
+    void rebuild();
+
+    /**
+     * Detaches all the nodes from this store.
+     */
+    void clear();
+
+    void flatten(Node* node, int parentIndex);
+
+    /**
+     * Recomputes the world matrices of the range [start, end), which contains whole subtrees.
+     */
+    void updateRange(unsigned int start, unsigned int end);
+
+    void setDirty(unsigned int index);
+
+    void setStructureDirty();
+
+    void nodeDestroyed(unsigned int index);
+
+    /**
+     * Detaches a node removed from the hierarchy and its descendants from this store.
+     */
+    void nodeRemoved(Node* node);
+
+    bool isDirty(unsigned int index) const;
+
+    Node* _root;
+    std::vector<Node*> _nodes;
+    std::vector<int> _parents;
+    std::vector<unsigned int> _subtreeEnds;
+    std::vector<Matrix> _local;
+    std::vector<Matrix> _world;
+    std::vector<unsigned int> _dirty;
+    std::vector<unsigned char> _changed;
+    Matrix _rootParentWorld;
+    bool _anyDirty;
+    bool _structureDirty;
+};
+
+}
+
+#endif
@@ -4,6 +4,20 @@
 namespace gplay
 {
 
+static unsigned int getAttribTypeSize(VertexFormat::AttribType type)
+{
+    switch (type)
+    {
+    case VertexFormat::Uint8:
+        return 1;
+    case VertexFormat::Int16:
+    case VertexFormat::Half:
+        return 2;
+    default:
+        return sizeof(float);
+    }
+}
+
 VertexFormat::VertexFormat(const Element* elements, unsigned int elementCount)
     : _vertexSize(0)
 {
@@ -17,7 +31,7 @@ VertexFormat::VertexFormat(const Element* elements, unsigned int elementCount)
         memcpy(&element, &elements[i], sizeof(Element));
         _elements.push_back(element);
 
-        _vertexSize += element.size * sizeof(float);
+        _vertexSize += element.size * getAttribTypeSize(element.type);
     }
 }
 
@@ -73,7 +87,7 @@ VertexFormat::Element::Element(Usage usage, unsigned int size, AttribType type,
 
 bool VertexFormat::Element::operator == (const VertexFormat::Element& e) const
 {
-    return (size == e.size && usage == e.usage);
+    return (size == e.size && usage == e.usage && type == e.type && normalized == e.normalized);
 }
 
 bool VertexFormat::Element::operator != (const VertexFormat::Element& e) const
@@ -37,21 +37,26 @@ public:
     };
 
 
+    /**
+     * Defines the data type of the values of a vertex element.
+     *
+     * The values are stored in bundles, do not reorder.
+     */
     enum AttribType
     {
         Uint8,
         Int16,
-        Float
+        Float,
+        Half
     };
 
 
     /**
      * Defines a single element within a vertex format.
      *
-     * All vertex elements are assumed to be of type float, but can
-     * have a varying number of float values (1-4), which is represented
-     * by the size attribute. Additionally, vertex elements are assumed
-     * to be tightly packed.
+     * Vertex elements have a varying number of values (1-4) of the
+     * given type, which is represented by the size attribute.
+     * Additionally, vertex elements are assumed to be tightly packed.
      */
     class Element
     {
@@ -67,7 +72,14 @@ public:
         unsigned int size;
 
 
+        /**
+         * The data type of the values in the vertex element.
+         */
         AttribType type;
+
+        /**
+         * True if integer values are normalized to the [0, 1] or [-1, 1] range.
+         */
         bool normalized;
 
 
@@ -81,7 +93,9 @@ public:
          * Constructor.
          *
          * @param usage The vertex element usage semantic.
-         * @param size The number of float values in the vertex element.
+         * @param size The number of values in the vertex element.
+         * @param type The data type of the values in the vertex element.
+         * @param normalized True if integer values are normalized.
          */
         Element(Usage usage, unsigned int size, AttribType type = AttribType::Float, bool normalized = false);
 
@@ -1,5 +1,6 @@
 #include "../graphics/View.h"
 #include "../renderer/BGFXRenderer.h"
+#include "../renderer/BGFXUniform.h"
 #include <unordered_map>
 
 namespace gplay {
@@ -52,6 +53,7 @@ View::View() :
   , _depth(1.0f)
   , _stencil(0)
   , _name(0)
+  , _sortingMode(SortingMode::DEFAULT)
 {
     uint16_t clearFlags = static_cast<uint16_t>(_clearFlags);
     bgfx::setViewClear(_id, clearFlags, _clearColor, _depth, _stencil);
@@ -73,6 +75,7 @@ View* View::create(unsigned short id, Rectangle rectangle, ClearFlags clearFlags
     {
         // reset existing view
         view = __views.at(id);
+        view->_sortingMode = SortingMode::DEFAULT;
         bgfx::resetView(id);
     }
 
@@ -99,6 +102,10 @@ View* View::create(unsigned short id, Rectangle rectangle, ClearFlags clearFlags
 
 void View::bind()
 {
+    // Uniform values uploaded for another view are not bound for this one.
+    if (_curentViewId != _id)
+        BGFXUniform::invalidateValueCache();
+
     _curentViewId = _id;
 
     uint16_t clearFlags = static_cast<uint16_t>(_clearFlags);
@@ -122,8 +129,14 @@ void View::setViewClear(unsigned int clearColor, float depth, unsigned char sten
 
 void View::setViewSortingMode(SortingMode viewMode)
 {
+    _sortingMode = viewMode;
     bgfx::ViewMode::Enum mode = static_cast<bgfx::ViewMode::Enum>(viewMode);
     bgfx::setViewMode(_id, mode);
 }
 
+View::SortingMode View::getViewSortingMode() const
+{
+    return _sortingMode;
+}
+
 }
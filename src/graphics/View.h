@@ -88,6 +88,11 @@ public:
      */
     void setViewSortingMode(SortingMode viewMode);
 
+    /**
+     * @brief Get the view sorting mode.
+     * @return The sorting mode.
+     */
+    SortingMode getViewSortingMode() const;
 
     /**
      * @brief Get a view from id.
@@ -124,6 +129,7 @@ private:
     float _depth;
     unsigned char _stencil;
     const char* _name;
+    SortingMode _sortingMode;
     static unsigned short _curentViewId;
 };
 
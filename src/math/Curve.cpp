@@ -89,23 +89,32 @@ Curve* Curve::create(unsigned int pointCount, unsigned int componentCount)
 }
 
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL),
+      _times(NULL), _data(NULL)
 {
+    // Point values are stored in one block, the values of all the points followed
+    // by their in tangents then their out tangents.
     _points = new Point[_pointCount];
+    _times = new float[_pointCount];
+    _data = new float[_pointCount * _componentCount * 3];
     for (unsigned int i = 0; i < _pointCount; i++)
     {
         _points[i].time = 0.0f;
-        _points[i].value = new float[_componentCount];
-        _points[i].inValue = new float[_componentCount];
-        _points[i].outValue = new float[_componentCount];
+        _points[i].value = _data + i * _componentCount;
+        _points[i].inValue = _data + (_pointCount + i) * _componentCount;
+        _points[i].outValue = _data + (_pointCount * 2 + i) * _componentCount;
         _points[i].type = LINEAR;
+        _times[i] = 0.0f;
     }
     _points[_pointCount - 1].time = 1.0f;
+    _times[_pointCount - 1] = 1.0f;
 }
 
 Curve::~Curve()
 {
     SAFE_DELETE_ARRAY(_points);
+    SAFE_DELETE_ARRAY(_times);
+    SAFE_DELETE_ARRAY(_data);
     SAFE_DELETE_ARRAY(_quaternionOffset);
 }
 
@@ -116,9 +125,21 @@ Curve::Point::Point()
 
 Curve::Point::~Point()
 {
-    SAFE_DELETE_ARRAY(value);
-    SAFE_DELETE_ARRAY(inValue);
-    SAFE_DELETE_ARRAY(outValue);
+    // The values are owned by the curve.
+}
+
+Curve::Cursor::Cursor()
+{
+    reset();
+}
+
+void Curve::Cursor::reset()
+{
+    _startTime = -1.0f;
+    _endTime = -1.0f;
+    _min = 0;
+    _max = 0;
+    _index = 0;
 }
 
 unsigned int Curve::getPointCount() const
@@ -179,6 +200,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
     _points[index].time = time;
     _points[index].type = type;
+    _times[index] = time;
 
     if (value)
         memcpy(_points[index].value, value, _componentSize);
@@ -211,6 +233,11 @@ void Curve::evaluate(float time, float* dst) const
 }
 
 void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const
+{
+    evaluate(time, startTime, endTime, loopBlendTime, dst, NULL);
+}
+
+void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, Cursor* cursor) const
 {
     assert(dst && startTime >= 0.0f && startTime <= endTime && endTime <= 1.0f && loopBlendTime >= 0.0f);
 
@@ -227,8 +254,23 @@ void Curve::evaluate(float time, float startTime, float endTime, float loopBlend
     if (startTime > 0.0f || endTime < 1.0f)
     {
         // Evaluating a sub section of the curve
-        min = determineIndex(startTime, 0, max);
-        max = determineIndex(endTime, min, max);
+        if (cursor && cursor->_startTime == startTime && cursor->_endTime == endTime)
+        {
+            min = cursor->_min;
+            max = cursor->_max;
+        }
+        else
+        {
+            min = determineIndex(startTime, 0, max);
+            max = determineIndex(endTime, min, max);
+            if (cursor)
+            {
+                cursor->_startTime = startTime;
+                cursor->_endTime = endTime;
+                cursor->_min = min;
+                cursor->_max = max;
+            }
+        }
 
         // Convert time to fall within the subregion
         localTime = _points[min].time + (_points[max].time - _points[min].time) * time;
@@ -283,8 +325,17 @@ void Curve::evaluate(float time, float startTime, float endTime, float loopBlend
     }
     else
     {
-        // Locate the points we are interpolating between using a binary search.
-        index = determineIndex(localTime, min, max);
+        // Locate the points we are interpolating between, starting from the
+        // points of the previous evaluation when we have a cursor.
+        if (cursor)
+        {
+            index = determineIndex(localTime, min, max, cursor->_index);
+            cursor->_index = index;
+        }
+        else
+        {
+            index = determineIndex(localTime, min, max);
+        }
         from = &_points[index];
         to = &_points[index == max ? index : index+1];
 
@@ -1256,9 +1307,9 @@ int Curve::determineIndex(float time, unsigned int min, unsigned int max) const
     {
         mid = (min + max) >> 1;
 
-        if (time >= _points[mid].time && time < _points[mid + 1].time)
+        if (time >= _times[mid] && time < _times[mid + 1])
             return mid;
-        else if (time < _points[mid].time)
+        else if (time < _times[mid])
             max = mid - 1;
         else
             min = mid + 1;
@@ -1267,6 +1318,26 @@ int Curve::determineIndex(float time, unsigned int min, unsigned int max) const
     return max;
 }
 
+int Curve::determineIndex(float time, unsigned int min, unsigned int max, unsigned int hint) const
+{
+    // Playing forward, the time is usually still between the same points or the next ones.
+    if (hint >= min && hint < max)
+    {
+        if (time >= _times[hint])
+        {
+            if (time < _times[hint + 1])
+                return hint;
+            if (hint + 1 < max && time < _times[hint + 2])
+                return hint + 1;
+        }
+        else if (hint > min && time >= _times[hint - 1])
+        {
+            return hint - 1;
+        }
+    }
+    return determineIndex(time, min, max);
+}
+
 int Curve::getInterpolationType(const char* curveId)
 {
     if (strcmp(curveId, "BEZIER") == 0)
@@ -414,6 +414,53 @@ public:
      */
     void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const;
 
+    /**
+     * Caches the key lookups of successive evaluations of a curve.
+     *
+     * A cursor remembers the subregion and the pair of points found by the last
+     * evaluation, so evaluating the curve at increasing times (normal playback)
+     * finds the next pair of points in constant time instead of a binary search.
+     * A cursor is only a hint: a stale cursor gives the same result, only slower.
+     * A cursor should be used with a single curve.
+     */
+    class Cursor
+    {
+        friend class Curve;
+
+    public:
+
+        /**
+         * Constructor.
+         */
+        Cursor();
+
+        /**
+         * Invalidates the cached lookups.
+         */
+        void reset();
+
+    private:
+
+        float _startTime;
+        float _endTime;
+        unsigned int _min;
+        unsigned int _max;
+        unsigned int _index;
+    };
+
+    /**
+     * Evaluates the curve like evaluate(float, float, float, float, float*), using
+     * and updating the given cursor to locate the points to interpolate between.
+     *
+     * @param time The position within the subregion of the curve to evaluate the curve at.
+     * @param startTime Start time for the subregion (between 0.0 - 1.0).
+     * @param endTime End time for the subregion (between 0.0 - 1.0).
+     * @param loopBlendTime Time (in milliseconds) to blend between the end points of the curve.
+     * @param dst The evaluated value of the curve at the given time.
+     * @param cursor The cursor caching the lookups of the previous evaluation, may be NULL.
+     */
+    void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, Cursor* cursor) const;
+
     /**
      * Linear interpolation function.
      */
@@ -523,6 +570,12 @@ private:
      */
     int determineIndex(float time, unsigned int min, unsigned int max) const;
 
+    /**
+     * Determines the current keyframe like determineIndex(), checking the given keyframe
+     * and the next one first.
+     */
+    int determineIndex(float time, unsigned int min, unsigned int max, unsigned int hint) const;
+
     /**
      * Sets the offset for the beginning of a Quaternion piece of data within the curve's value span at the specified
      * index. The next four components of data starting at the given index will be interpolated as a Quaternion.
@@ -546,6 +599,8 @@ private:
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
     Point* _points;                     // The points on the curve.
+    float* _times;                      // The times of the points, contiguous for the keyframe lookups.
+    float* _data;                       // The values, in and out tangents of all the points.
 };
 
 }
@@ -25,4 +25,33 @@ void MathUtil::smooth(float* x, float target, float elapsedTime, float riseTime,
     }
 }
 
+float MathUtil::halfToFloat(unsigned short value)
+{
+    const unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+    unsigned int exponent = (value >> 10) & 0x1f;
+    unsigned int mantissa = value & 0x3ff;
+    union
+    {
+        unsigned int u;
+        float f;
+    } bits;
+
+    if (exponent == 0x1f)
+    {
+        // Infinity or NaN
+        bits.u = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else if (exponent == 0)
+    {
+        // Zero or denormalized half
+        bits.f = mantissa * (1.0f / 16777216.0f);
+        bits.u |= sign;
+    }
+    else
+    {
+        bits.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    return bits.f;
+}
+
 }
@@ -12,6 +12,7 @@ class MathUtil
 {
     friend class Matrix;
     friend class Vector3;
+    friend class MeshSkin;
 
 public:
 
@@ -44,6 +45,15 @@ public:
      */
     static void smooth(float* x, float target, float elapsedTime, float riseTime, float fallTime);
 
+    /**
+     * Converts a half precision float, as stored in quantized vertex data, to a float.
+     *
+     * @param value The bits of the half precision float.
+     *
+     * @return The float value.
+     */
+    static float halfToFloat(unsigned short value);
+
 private:
 
     inline static void addMatrix(const float* m, float scalar, float* dst);
@@ -66,6 +76,12 @@ private:
 
     inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
+    /**
+     * Multiplies m1 by m2 and stores the first three rows of the product into dst
+     * as 12 floats, row by row (the layout of a skinning matrix palette entry).
+     */
+    inline static void multiplyMatrixRows3(const float* m1, const float* m2, float* dst);
+
     MathUtil();
 };
 
@@ -73,8 +89,16 @@ private:
 
 #define MATRIX_SIZE ( sizeof(float) * 16)
 
+// SSE is used by default on x86 targets, unless GP_NO_SSE is defined.
+#if !defined(GP_USE_NEON) && !defined(GP_USE_SSE) && !defined(GP_NO_SSE) && \
+    (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define GP_USE_SSE
+#endif
+
 #ifdef GP_USE_NEON
 #include "MathUtilNeon.inl"
+#elif defined(GP_USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
@@ -172,6 +172,16 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtil::multiplyMatrixRows3(const float* m1, const float* m2, float* dst)
+{
+    // dst[r * 4 + c] is the element of row r and column c of the product.
+    for (int r = 0; r < 3; ++r)
+    {
+        dst[r * 4 + 0] = m1[r] * m2[0]  + m1[r + 4] * m2[1]  + m1[r + 8] * m2[2]  + m1[r + 12] * m2[3];
+        dst[r * 4 + 1] = m1[r] * m2[4]  + m1[r + 4] * m2[5]  + m1[r + 8] * m2[6]  + m1[r + 12] * m2[7];
+        dst[r * 4 + 2] = m1[r] * m2[8]  + m1[r + 4] * m2[9]  + m1[r + 8] * m2[10] + m1[r + 12] * m2[11];
+        dst[r * 4 + 3] = m1[r] * m2[12] + m1[r + 4] * m2[13] + m1[r + 8] * m2[14] + m1[r + 12] * m2[15];
+    }
 }
 
-
+}
@@ -0,0 +1,137 @@
+#include <xmmintrin.h>
+
+namespace gplay
+{
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m[0]),  s));
+    _mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m[4]),  s));
+    _mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m[8]),  s));
+    _mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+    _mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+    _mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+    _mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(&dst[0],  _mm_sub_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+    _mm_storeu_ps(&dst[4],  _mm_sub_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+    _mm_storeu_ps(&dst[8],  _mm_sub_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+    _mm_storeu_ps(&dst[12], _mm_sub_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(&dst[0],  _mm_mul_ps(_mm_loadu_ps(&m[0]),  s));
+    _mm_storeu_ps(&dst[4],  _mm_mul_ps(_mm_loadu_ps(&m[4]),  s));
+    _mm_storeu_ps(&dst[8],  _mm_mul_ps(_mm_loadu_ps(&m[8]),  s));
+    _mm_storeu_ps(&dst[12], _mm_mul_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+/**
+ * Returns the column c of m1 * m2, a linear combination of the columns of m1.
+ */
+inline static __m128 __multiplyMatrixColumn(__m128 c0, __m128 c1, __m128 c2, __m128 c3, const float* c)
+{
+    __m128 r = _mm_mul_ps(c0, _mm_set1_ps(c[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(c[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(c[2])));
+    r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(c[3])));
+    return r;
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    // Support the case where m1 or m2 is the same array as dst: everything is loaded first.
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    __m128 p0 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[0]);
+    __m128 p1 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[4]);
+    __m128 p2 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[8]);
+    __m128 p3 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[12]);
+
+    _mm_storeu_ps(&dst[0],  p0);
+    _mm_storeu_ps(&dst[4],  p1);
+    _mm_storeu_ps(&dst[8],  p2);
+    _mm_storeu_ps(&dst[12], p3);
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+    __m128 sign = _mm_set1_ps(-0.0f);
+    _mm_storeu_ps(&dst[0],  _mm_xor_ps(_mm_loadu_ps(&m[0]),  sign));
+    _mm_storeu_ps(&dst[4],  _mm_xor_ps(_mm_loadu_ps(&m[4]),  sign));
+    _mm_storeu_ps(&dst[8],  _mm_xor_ps(_mm_loadu_ps(&m[8]),  sign));
+    _mm_storeu_ps(&dst[12], _mm_xor_ps(_mm_loadu_ps(&m[12]), sign));
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(&dst[0],  c0);
+    _mm_storeu_ps(&dst[4],  c1);
+    _mm_storeu_ps(&dst[8],  c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    dst[0] = x * m[0] + y * m[4] + z * m[8] + w * m[12];
+    dst[1] = x * m[1] + y * m[5] + z * m[9] + w * m[13];
+    dst[2] = x * m[2] + y * m[6] + z * m[10] + w * m[14];
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+    // Handle case where v == dst.
+    __m128 r = __multiplyMatrixColumn(_mm_loadu_ps(&m[0]), _mm_loadu_ps(&m[4]), _mm_loadu_ps(&m[8]), _mm_loadu_ps(&m[12]), v);
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+    float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+    float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+    float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+}
+
+inline void MathUtil::multiplyMatrixRows3(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    __m128 p0 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[0]);
+    __m128 p1 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[4]);
+    __m128 p2 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[8]);
+    __m128 p3 = __multiplyMatrixColumn(c0, c1, c2, c3, &m2[12]);
+
+    // Columns to rows, the last row is dropped.
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+    _mm_storeu_ps(&dst[0], p0);
+    _mm_storeu_ps(&dst[4], p1);
+    _mm_storeu_ps(&dst[8], p2);
+}
+
+}
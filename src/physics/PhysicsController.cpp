@@ -1134,11 +1134,22 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
     shapeMeshData->vertexData = new float[vertexCount * 3];
     Vector3 v;
     int vertexStride = data->vertexFormat.getVertexSize();
+    GP_ASSERT(data->vertexFormat.getElement(0).usage == VertexFormat::POSITION);
+    const bool halfPositions = data->vertexFormat.getElement(0).type == VertexFormat::Half;
     for (unsigned int i = 0; i < data->vertexCount; i++)
     {
-        v.set(*((float*)&data->vertexData[i * vertexStride + 0 * sizeof(float)]),
-                *((float*)&data->vertexData[i * vertexStride + 1 * sizeof(float)]),
-                *((float*)&data->vertexData[i * vertexStride + 2 * sizeof(float)]));
+        if (halfPositions)
+        {
+            // Positions of quantized meshes are half floats
+            const unsigned short* position = (const unsigned short*)&data->vertexData[i * vertexStride];
+            v.set(MathUtil::halfToFloat(position[0]), MathUtil::halfToFloat(position[1]), MathUtil::halfToFloat(position[2]));
+        }
+        else
+        {
+            v.set(*((float*)&data->vertexData[i * vertexStride + 0 * sizeof(float)]),
+                    *((float*)&data->vertexData[i * vertexStride + 1 * sizeof(float)]),
+                    *((float*)&data->vertexData[i * vertexStride + 2 * sizeof(float)]));
+        }
         v *= m;
         memcpy(&(shapeMeshData->vertexData[i * 3]), &v, sizeof(float) * 3);
     }
@@ -1198,10 +1209,22 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
                     return NULL;
                 }
 
-                // Move the index data into the rigid body's local buffer.
-                // Set it to NULL in the MeshPartData so it is not released when the data is freed.
-                shapeMeshData->indexData.push_back(meshPart->indexData);
-                meshPart->indexData = NULL;
+                if (data->releaseData)
+                {
+                    // The index data belongs to the mapped bundle, which is released along with the data,
+                    // so copy it into the rigid body's local buffer.
+                    const unsigned int indexDataSize = meshPart->indexCount * indexStride;
+                    unsigned char* indexData = new unsigned char[indexDataSize];
+                    memcpy(indexData, meshPart->indexData, indexDataSize);
+                    shapeMeshData->indexData.push_back(indexData);
+                }
+                else
+                {
+                    // Move the index data into the rigid body's local buffer.
+                    // Set it to NULL in the MeshPartData so it is not released when the data is freed.
+                    shapeMeshData->indexData.push_back(meshPart->indexData);
+                    meshPart->indexData = NULL;
+                }
 
                 // Create a btIndexedMesh object for the current mesh part.
                 btIndexedMesh indexedMesh;
@@ -1346,6 +1369,7 @@ PhysicsController::DebugDrawer::DebugDrawer()
         VertexFormat::Element(VertexFormat::COLOR, 4),
     };
     _meshBatch = MeshBatch::create(VertexFormat(elements, 2), Mesh::LINES, material, false, 4096, 4096);
+    _meshBatch->setTransient(true);
     SAFE_RELEASE(material);
     SAFE_RELEASE(effect);
 }
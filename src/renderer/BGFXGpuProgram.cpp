@@ -3,8 +3,434 @@
 
 #include <brtshaderc/brtshaderc.h>
 
+// Version of the shader cache entries, change it to invalidate all cached shaders (e.g. when updating shaderc).
+#define SHADER_CACHE_VERSION 1
+
+// Identifier and version of the shader archives written by tools/shaderpack.
+#define SHADER_ARCHIVE_MAGIC "GPSA"
+#define SHADER_ARCHIVE_VERSION 1
+
 namespace gplay {
 
+static std::string __shaderCacheDirectory("shadercache/");
+
+/**
+ * Header of a shader archive.
+ *
+ * The header is followed by an open addressing hash table of tableSize entries (a power
+ * of two) indexed by the shader keys, then by the compiled shaders.
+ */
+struct ShaderArchiveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t rendererType;
+    uint32_t tableSize;
+    uint32_t entryCount;
+    uint32_t reserved[3];
+};
+
+/**
+ * Entry of the hash table of a shader archive, a key of 0 marks an empty slot.
+ */
+struct ShaderArchiveEntry
+{
+    uint64_t key;
+    uint32_t offset;
+    uint32_t size;
+};
+
+/**
+ * Reference to the archive memory that is held by bgfx until a shader is created.
+ */
+struct ShaderArchiveData
+{
+    Stream::ReleaseDataFunction release;
+    void* handle;
+};
+
+static Stream* __shaderArchive = NULL;
+static char* __shaderArchiveBuffer = NULL;
+static const unsigned char* __shaderArchiveData = NULL;
+static const ShaderArchiveEntry* __shaderArchiveTable = NULL;
+static uint32_t __shaderArchiveTableMask = 0;
+
+/**
+ * 64 bits FNV-1a hash.
+ */
+static uint64_t hashData(const void* data, size_t size, uint64_t hash)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hashString(const std::string& str, uint64_t hash)
+{
+    // Hash the terminating null too so that concatenations don't collide.
+    return hashData(str.c_str(), str.size() + 1, hash);
+}
+
+#ifndef GP_NO_SHADER_COMPILER
+
+/**
+ * Hashes a shader source file and, recursively, the files it includes.
+ * Includes are looked up relative to the including file then to the directory of the main shader,
+ * like shaderc does.
+ */
+static bool hashShaderFile(const std::string& path, const std::string& shaderDir, std::set<std::string>& visited, uint64_t* hash)
+{
+    if (!visited.insert(path).second)
+        return true;
+
+    int size = 0;
+    char* source = FileSystem::readAll(path.c_str(), &size);
+    if (!source)
+        return false;
+
+    *hash = hashString(path, *hash);
+    *hash = hashData(source, size, *hash);
+
+    bool result = true;
+    const std::string fileDir = FileSystem::getDirectoryName(path.c_str());
+    for (const char* line = source; line && *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL)
+    {
+        while (*line == ' ' || *line == '\t')
+            ++line;
+        if (strncmp(line, "#include", 8) != 0)
+            continue;
+
+        const char* start = strpbrk(line + 8, "\"<\n");
+        if (!start || *start == '\n')
+            continue;
+        const char* end = strpbrk(start + 1, "\">\n");
+        if (!end || *end == '\n')
+            continue;
+
+        std::string name(start + 1, end - start - 1);
+        std::string includePath = fileDir + name;
+        if (!FileSystem::fileExists(includePath.c_str()))
+            includePath = shaderDir + name;
+
+        // Includes that can't be found make the compilation fail, don't cache anything then.
+        if (!FileSystem::fileExists(includePath.c_str()))
+        {
+            GP_WARN("Shader caching disabled, file '%s' included by '%s' not found.", name.c_str(), path.c_str());
+            result = false;
+            break;
+        }
+        if (!hashShaderFile(includePath, shaderDir, visited, hash))
+        {
+            result = false;
+            break;
+        }
+    }
+
+    SAFE_DELETE_ARRAY(source);
+    return result;
+}
+
+/**
+ * Frees a compiled shader which won't be used, bgfx only frees the memory it is given.
+ */
+static void releaseShaderMemory(const bgfx::Memory* mem)
+{
+    if (mem)
+        bgfx::destroy(bgfx::createShader(mem));
+}
+
+/**
+ * Computes the cache key of a shader, returns false if a source file can't be read.
+ */
+static bool getShaderCacheKey(shaderc::ShaderType type, const char* path, const char* defines, const char* varyingPath, uint64_t* key)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned int header[] = { SHADER_CACHE_VERSION, (unsigned int)type, (unsigned int)bgfx::getRendererType() };
+    hash = hashData(header, sizeof(header), hash);
+    hash = hashString(defines ? defines : "", hash);
+
+    std::set<std::string> visited;
+    if (!hashShaderFile(varyingPath, "", visited, &hash))
+        return false;
+    if (!hashShaderFile(path, FileSystem::getDirectoryName(path), visited, &hash))
+        return false;
+
+    *key = hash;
+    return true;
+}
+
+static std::string getShaderCachePath(uint64_t key)
+{
+    char name[32];
+    sprintf(name, "%016llx.bin", (unsigned long long)key);
+    return __shaderCacheDirectory + name;
+}
+
+/**
+ * Loads a compiled shader from the cache, returns NULL on a miss.
+ */
+static const bgfx::Memory* loadCachedShader(uint64_t key)
+{
+    std::string path = getShaderCachePath(key);
+    if (!FileSystem::fileExists(path.c_str()))
+        return NULL;
+
+    int size = 0;
+    char* data = FileSystem::readAll(path.c_str(), &size);
+    if (!data)
+        return NULL;
+
+    // Header: cache key and size of the compiled shader.
+    const bgfx::Memory* mem = NULL;
+    const size_t headerSize = sizeof(uint64_t) + sizeof(uint32_t);
+    uint64_t fileKey = 0;
+    uint32_t shaderSize = 0;
+    if ((size_t)size > headerSize)
+    {
+        memcpy(&fileKey, data, sizeof(fileKey));
+        memcpy(&shaderSize, data + sizeof(fileKey), sizeof(shaderSize));
+    }
+    if (fileKey == key && shaderSize == size - headerSize)
+    {
+        mem = bgfx::copy(data + headerSize, shaderSize);
+    }
+    else
+    {
+        GP_WARN("Corrupted shader cache entry '%s'.", path.c_str());
+    }
+    SAFE_DELETE_ARRAY(data);
+    return mem;
+}
+
+static void storeCachedShader(uint64_t key, const bgfx::Memory* mem)
+{
+    GP_ASSERT(mem);
+    if (!FileSystem::createDirectory(__shaderCacheDirectory.c_str()))
+    {
+        GP_WARN("Failed to create shader cache directory '%s'.", __shaderCacheDirectory.c_str());
+        return;
+    }
+
+    std::string path = getShaderCachePath(key);
+    Stream* stream = FileSystem::open(path.c_str(), FileSystem::WRITE);
+    if (!stream)
+    {
+        GP_WARN("Failed to write shader cache entry '%s'.", path.c_str());
+        return;
+    }
+    stream->write(&key, sizeof(key), 1);
+    stream->write(&mem->size, sizeof(mem->size), 1);
+    stream->write(mem->data, 1, mem->size);
+    SAFE_DELETE(stream);
+}
+
+/**
+ * Loads a shader from the cache or compiles it and adds it to the cache.
+ */
+static const bgfx::Memory* loadShader(shaderc::ShaderType type, const char* path, const char* defines, const char* varyingPath)
+{
+    uint64_t key = 0;
+    bool cached = !__shaderCacheDirectory.empty() && getShaderCacheKey(type, path, defines, varyingPath, &key);
+    if (cached)
+    {
+        const bgfx::Memory* mem = loadCachedShader(key);
+        if (mem)
+            return mem;
+    }
+
+    const bgfx::Memory* mem = shaderc::compileShader(type, path, defines, varyingPath);
+    if (mem && cached)
+    {
+        storeCachedShader(key, mem);
+    }
+    return mem;
+}
+
+#endif // GP_NO_SHADER_COMPILER
+
+/**
+ * Returns the defines of a shader in a canonical form: trimmed, sorted and without duplicates.
+ */
+static std::string normalizeDefines(const char* defines)
+{
+    std::vector<std::string> tokens;
+    for (const char* start = defines; start && *start; )
+    {
+        const char* end = strchr(start, ';');
+        if (!end)
+            end = start + strlen(start);
+
+        const char* first = start;
+        const char* last = end;
+        while (first < last && isspace((unsigned char)*first))
+            ++first;
+        while (last > first && isspace((unsigned char)last[-1]))
+            --last;
+        if (first < last)
+            tokens.push_back(std::string(first, last - first));
+
+        start = *end ? end + 1 : end;
+    }
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    std::string result;
+    for (size_t i = 0, count = tokens.size(); i < count; ++i)
+    {
+        if (i > 0)
+            result += ';';
+        result += tokens[i];
+    }
+    return result;
+}
+
+/**
+ * Computes the key of a shader in the shader archive, tools/shaderpack computes the same key.
+ */
+static uint64_t getShaderArchiveKey(shaderc::ShaderType type, const char* path, const char* defines)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const uint32_t stage = (uint32_t)type;
+    hash = hashData(&stage, sizeof(stage), hash);
+    hash = hashString(path, hash);
+    hash = hashString(normalizeDefines(defines), hash);
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * Looks up a shader in the shader archive, returns NULL if it is not in the archive.
+ */
+static const ShaderArchiveEntry* findArchivedShader(shaderc::ShaderType type, const char* path, const char* defines)
+{
+    if (!__shaderArchiveTable)
+        return NULL;
+
+    const uint64_t key = getShaderArchiveKey(type, path, defines);
+    for (uint32_t i = (uint32_t)key & __shaderArchiveTableMask; __shaderArchiveTable[i].key != 0; i = (i + 1) & __shaderArchiveTableMask)
+    {
+        if (__shaderArchiveTable[i].key == key)
+            return &__shaderArchiveTable[i];
+    }
+    return NULL;
+}
+
+static void releaseArchivedShader(void* ptr, void* userData)
+{
+    ShaderArchiveData* data = (ShaderArchiveData*)userData;
+    GP_ASSERT(data);
+    data->release(data->handle);
+    delete data;
+}
+
+/**
+ * Returns a compiled shader of the archive. The memory of a mapped archive is referenced, not copied.
+ */
+static const bgfx::Memory* loadArchivedShader(const ShaderArchiveEntry* entry)
+{
+    GP_ASSERT(entry && __shaderArchive);
+    const unsigned char* shader = __shaderArchiveData + entry->offset;
+
+    void* handle = NULL;
+    Stream::ReleaseDataFunction release = __shaderArchiveBuffer ? NULL : __shaderArchive->retainData(&handle);
+    if (release)
+    {
+        ShaderArchiveData* data = new ShaderArchiveData();
+        data->release = release;
+        data->handle = handle;
+        return bgfx::makeRef(shader, entry->size, &releaseArchivedShader, data);
+    }
+    return bgfx::copy(shader, entry->size);
+}
+
+bool BGFXGpuProgram::loadShaderArchive(const char* path)
+{
+    GP_ASSERT(path);
+    unloadShaderArchive();
+
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAPPED);
+    if (!stream)
+    {
+        GP_WARN("Failed to open shader archive '%s'.", path);
+        return false;
+    }
+
+    // Read the whole archive when it can't be mapped.
+    const unsigned char* data = (const unsigned char*)stream->getData();
+    size_t size = stream->length();
+    char* buffer = NULL;
+    if (!data)
+    {
+        int bufferSize = 0;
+        buffer = FileSystem::readAll(path, &bufferSize);
+        data = (const unsigned char*)buffer;
+        size = buffer ? (size_t)bufferSize : 0;
+    }
+
+    const ShaderArchiveHeader* header = (const ShaderArchiveHeader*)data;
+    const char* error = NULL;
+    if (size < sizeof(ShaderArchiveHeader) || memcmp(header->magic, SHADER_ARCHIVE_MAGIC, 4) != 0)
+        error = "invalid file";
+    else if (header->version != SHADER_ARCHIVE_VERSION)
+        error = "unsupported version";
+    else if (header->tableSize == 0 || (header->tableSize & (header->tableSize - 1)) != 0 || header->entryCount >= header->tableSize ||
+             size < sizeof(ShaderArchiveHeader) + header->tableSize * sizeof(ShaderArchiveEntry))
+        error = "invalid table";
+    else if (header->rendererType != (uint32_t)bgfx::getRendererType())
+        error = "built for another renderer";
+
+    const ShaderArchiveEntry* table = (const ShaderArchiveEntry*)(data + sizeof(ShaderArchiveHeader));
+    for (uint32_t i = 0; !error && i < header->tableSize; ++i)
+    {
+        if (table[i].key != 0 && ((size_t)table[i].offset + table[i].size > size))
+            error = "truncated file";
+    }
+
+    if (error)
+    {
+        GP_WARN("Failed to load shader archive '%s': %s.", path, error);
+        SAFE_DELETE_ARRAY(buffer);
+        SAFE_DELETE(stream);
+        return false;
+    }
+
+    __shaderArchive = stream;
+    __shaderArchiveBuffer = buffer;
+    __shaderArchiveData = data;
+    __shaderArchiveTable = table;
+    __shaderArchiveTableMask = header->tableSize - 1;
+    return true;
+}
+
+void BGFXGpuProgram::unloadShaderArchive()
+{
+    // Shaders referencing a mapped archive keep the mapping alive until bgfx is done with them.
+    SAFE_DELETE(__shaderArchive);
+    SAFE_DELETE_ARRAY(__shaderArchiveBuffer);
+    __shaderArchiveData = NULL;
+    __shaderArchiveTable = NULL;
+    __shaderArchiveTableMask = 0;
+}
+
+bool BGFXGpuProgram::isShaderArchiveLoaded()
+{
+    return __shaderArchive != NULL;
+}
+
+void BGFXGpuProgram::setShaderCacheDirectory(const char* path)
+{
+    __shaderCacheDirectory = path ? path : "";
+    if (!__shaderCacheDirectory.empty() && __shaderCacheDirectory.back() != '/')
+        __shaderCacheDirectory += '/';
+}
+
+const char* BGFXGpuProgram::getShaderCacheDirectory()
+{
+    return __shaderCacheDirectory.c_str();
+}
+
 BGFXGpuProgram::BGFXGpuProgram() :
     _vsh(BGFX_INVALID_HANDLE)
     , _fsh(BGFX_INVALID_HANDLE)
@@ -14,6 +440,11 @@ BGFXGpuProgram::BGFXGpuProgram() :
 }
 
 BGFXGpuProgram::~BGFXGpuProgram()
+{
+    destroy();
+}
+
+void BGFXGpuProgram::destroy()
 {
     if(bgfx::isValid(_program))
         bgfx::destroy(_program);
@@ -23,39 +454,75 @@ BGFXGpuProgram::~BGFXGpuProgram()
         bgfx::destroy(_fsh);
     if(bgfx::isValid(_csh))
         bgfx::destroy(_csh);
+
+    _program = BGFX_INVALID_HANDLE;
+    _vsh = BGFX_INVALID_HANDLE;
+    _fsh = BGFX_INVALID_HANDLE;
+    _csh = BGFX_INVALID_HANDLE;
+    _uniformsInfo.clear();
 }
 
 bool BGFXGpuProgram::set(const char* vshPath, const char* fshPath, const char* defines)
 {
-    // use custom varying def file if exists or default "varying.def.sc"
-    std::string basename = FileSystem::getBaseName(vshPath);
-    std::string varyingFile = basename + ".io";
-    bool useCustomVaryingDef = FileSystem::fileExists(varyingFile.c_str());
-    if(!useCustomVaryingDef)
-        varyingFile = "res/core/shaders/varying.def.sc";
+    return create(vshPath, fshPath, defines, true);
+}
 
+bool BGFXGpuProgram::create(const char* vshPath, const char* fshPath, const char* defines, bool useArchive)
+{
     // store files path for hot reloading
     _vshFile = vshPath;
     _fshFile = fshPath;
     if(defines)
         _defines = defines;
 
-    // Compile shaders using brtshaderc library
-    const bgfx::Memory* memVsh = shaderc::compileShader(shaderc::ST_VERTEX, vshPath, defines, varyingFile.c_str());
-    const bgfx::Memory* memFsh = shaderc::compileShader(shaderc::ST_FRAGMENT, fshPath, defines, varyingFile.c_str());
+    const bgfx::Memory* memVsh = NULL;
+    const bgfx::Memory* memFsh = NULL;
+
+    // Use the precompiled shaders of the shader archive when it contains both stages.
+    const ShaderArchiveEntry* vshEntry = useArchive ? findArchivedShader(shaderc::ST_VERTEX, vshPath, defines) : NULL;
+    const ShaderArchiveEntry* fshEntry = useArchive ? findArchivedShader(shaderc::ST_FRAGMENT, fshPath, defines) : NULL;
+    if(vshEntry && fshEntry)
+    {
+        memVsh = loadArchivedShader(vshEntry);
+        memFsh = loadArchivedShader(fshEntry);
+    }
+    else
+    {
+        // The line can be added to the permutation list of tools/shaderpack.
+        if(useArchive && isShaderArchiveLoaded())
+            GP_WARN("Shader permutation not found in the shader archive: %s %s %s", vshPath, fshPath, defines ? defines : "");
+
+#ifndef GP_NO_SHADER_COMPILER
+        // use custom varying def file if exists or default "varying.def.sc"
+        std::string basename = FileSystem::getBaseName(vshPath);
+        std::string varyingFile = basename + ".io";
+        bool useCustomVaryingDef = FileSystem::fileExists(varyingFile.c_str());
+        if(!useCustomVaryingDef)
+            varyingFile = "res/core/shaders/varying.def.sc";
+
+        // Load shaders from the cache or compile them using brtshaderc library
+        memVsh = loadShader(shaderc::ST_VERTEX, vshPath, defines, varyingFile.c_str());
+        memFsh = loadShader(shaderc::ST_FRAGMENT, fshPath, defines, varyingFile.c_str());
+#endif
+    }
 
     if(!memVsh)
     {
         GP_WARN("Error while compiling vertex shader %s.", vshPath);
+        releaseShaderMemory(memFsh);
         return false;
     }
 
     if(!memFsh)
     {
         GP_WARN("Error while compiling fragment shader %s.", fshPath);
+        releaseShaderMemory(memVsh);
         return false;
     }
 
+    // Release the previous shaders when reloading.
+    destroy();
+
     // Create shaders.
     _vsh = bgfx::createShader(memVsh);
     _fsh = bgfx::createShader(memFsh);
@@ -122,7 +589,12 @@ const bgfx::ProgramHandle BGFXGpuProgram::getProgram() const
 
 bool BGFXGpuProgram::reload()
 {
-    return set(_vshFile.c_str(), _fshFile.c_str(), _defines.c_str());
+#ifdef GP_NO_SHADER_COMPILER
+    return create(_vshFile.c_str(), _fshFile.c_str(), _defines.c_str(), true);
+#else
+    // Reloaded shaders are compiled from their modified sources, not taken from the archive.
+    return create(_vshFile.c_str(), _fshFile.c_str(), _defines.c_str(), false);
+#endif
 }
 
 
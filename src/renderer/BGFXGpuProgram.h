@@ -21,11 +21,53 @@ public:
     const char* getVertexShaderFile() { return _vshFile.c_str(); }
     const char* getFragmentShaderFile() { return _fshFile.c_str(); }
 
+    /**
+     * Sets the directory where compiled shaders are cached, relative to the resource path.
+     *
+     * Compiled shaders are stored under a hash of their source and included files, defines,
+     * varying definitions and renderer type, and loaded from there instead of being compiled
+     * again. Modified shaders get a new hash, so hot reloading never uses stale binaries.
+     *
+     * @param path The cache directory, or an empty string to disable the cache.
+     */
+    static void setShaderCacheDirectory(const char* path);
+
+    /**
+     * Returns the directory where compiled shaders are cached.
+     */
+    static const char* getShaderCacheDirectory();
+
+    /**
+     * Loads a shader archive built by tools/shaderpack, replacing the current one.
+     *
+     * The archive is memory mapped and indexed by a hash table, the shaders it contains are
+     * created from it without opening their source files nor invoking the shader compiler.
+     * Shaders that are not in the archive are compiled as usual, unless the engine is built
+     * with GP_NO_SHADER_COMPILER.
+     *
+     * @param path The path of the archive, which must be built for the current renderer.
+     *
+     * @return true if the archive is loaded, false otherwise.
+     */
+    static bool loadShaderArchive(const char* path);
+
+    /**
+     * Unloads the current shader archive.
+     */
+    static void unloadShaderArchive();
+
+    /**
+     * Determines if a shader archive is loaded.
+     */
+    static bool isShaderArchiveLoaded();
+
 protected:
     std::vector<Uniform::UniformInfo> _uniformsInfo;
 
 private:
+    bool create(const char* vshPath, const char* fshPath, const char* defines, bool useArchive);
     void getUniformsFromShader(bgfx::ShaderHandle shaderHandle);
+    void destroy();
 
     bgfx::ShaderHandle _vsh;
     bgfx::ShaderHandle _fsh;
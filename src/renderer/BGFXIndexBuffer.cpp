@@ -55,7 +55,12 @@ void BGFXIndexBuffer::createStaticBuffer()
 
     void * dataPtr = _memoryBuffer.map(0);
     GP_ASSERT(dataPtr);
-    const bgfx::Memory * mem = bgfx::makeRef(dataPtr, _memoryBuffer.getSize());
+    createStaticBuffer(bgfx::makeRef(dataPtr, _memoryBuffer.getSize()));
+}
+
+void BGFXIndexBuffer::createStaticBuffer(const bgfx::Memory* mem)
+{
+    GP_ASSERT(!_dynamic && !bgfx::isValid(_sibh));
 
     uint16_t flags = /*BGFX_BUFFER_NONE; //*/BGFX_BUFFER_ALLOW_RESIZE;
     if(_indexFormat == Mesh::INDEX32)
@@ -96,6 +101,24 @@ void BGFXIndexBuffer::set(const void* data, uint32_t count, uint32_t start)
     }
 }
 
+void BGFXIndexBuffer::setShared(const void* data, uint32_t count, ReleaseFunction release, void* userData)
+{
+    if(_dynamic || bgfx::isValid(_sibh) || count > _elementCount)
+    {
+        GeometryBuffer::setShared(data, count, release, userData);
+        return;
+    }
+
+    // The data is referenced until the renderer has uploaded it, no cpu copy is kept.
+    _memoryBuffer.destroy();
+    setRange(0, count);
+
+    SharedData* shared = new SharedData();
+    shared->release = release;
+    shared->userData = userData;
+    createStaticBuffer(bgfx::makeRef(data, count * _elementSize, &GeometryBuffer::releaseSharedData, shared));
+}
+
 void BGFXIndexBuffer::bind() const
 {
     if(_dynamic)
@@ -13,12 +13,14 @@ public:
     BGFXIndexBuffer(const Mesh::IndexFormat indexFormat, uint32_t indexCount, bool dynamic);
     virtual ~BGFXIndexBuffer();
     void set(const void* data, uint32_t count, uint32_t start) override;
+    void setShared(const void* data, uint32_t count, ReleaseFunction release, void* userData) override;
     void bind() const override;
     void* lock(uint32_t start, uint32_t count) override;
     void unLock() override;
 
 private:
     void createStaticBuffer();
+    void createStaticBuffer(const bgfx::Memory* mem);
     void createDynamicBuffer();
 
     bgfx::IndexBufferHandle _sibh;              // static index buffer handle
@@ -3,6 +3,7 @@
 #include "../core/Game.h"
 #include "../renderer/BGFXGpuProgram.h"
 #include "../graphics/View.h"
+#include "../renderer/BGFXUniform.h"
 
 #include <bgfx/bgfx.h>
 
@@ -18,6 +19,8 @@ BGFXRenderer::BGFXRenderer()
 
     _debug_flags = BGFX_DEBUG_TEXT;
     _reset_flags = BGFX_RESET_NONE;
+    _lastSubmitViewId = 0;
+    _frameNumber = 0;
 
     GP_ASSERT(!_instance); // Instance already exists
     _instance = this;
@@ -90,6 +93,8 @@ void BGFXRenderer::queryCaps()
 {
     // Query caps and limits.
     _caps._maxFrameBufferAttachments = bgfx::getCaps()->limits.maxFBAttachments;
+    _caps._instancing = (bgfx::getCaps()->supported & BGFX_CAPS_INSTANCING) != 0;
+    _caps._vertexAttribHalf = (bgfx::getCaps()->supported & BGFX_CAPS_VERTEX_ATTRIB_HALF) != 0;
 }
 
 void BGFXRenderer::beginFrame()
@@ -101,14 +106,31 @@ void BGFXRenderer::beginFrame()
 
 void BGFXRenderer::endFrame()
 {
-    bgfx::frame();
+    _frameNumber = bgfx::frame();
+    BGFXUniform::invalidateValueCache();
 }
 
 void BGFXRenderer::submit(const BGFXGpuProgram *gpuProgram)
 {
     GP_ASSERT(gpuProgram && bgfx::isValid(gpuProgram->getProgram()));
 
-    bgfx::submit(View::getCurrentViewId(), gpuProgram->getProgram());
+    submit(gpuProgram, View::getCurrentViewId(), 0);
+}
+
+void BGFXRenderer::submit(const BGFXGpuProgram *gpuProgram, unsigned short viewId, uint32_t depth)
+{
+    GP_ASSERT(gpuProgram && bgfx::isValid(gpuProgram->getProgram()));
+
+    bgfx::submit(viewId, gpuProgram->getProgram(), depth);
+
+    // Uniform values uploaded before this submit are only known to be still bound
+    // for the next draw call if bgfx executes the view in submission order.
+    View* view = View::getView(viewId);
+    if (viewId != _lastSubmitViewId || !view || view->getViewSortingMode() != View::SortingMode::SEQUENTIAL)
+    {
+        BGFXUniform::invalidateValueCache();
+    }
+    _lastSubmitViewId = viewId;
 }
 
 
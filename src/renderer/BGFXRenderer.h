@@ -21,6 +21,10 @@ class BGFXRenderer
     {
         // limits
         uint32_t _maxFrameBufferAttachments;
+
+        // features
+        bool _instancing;
+        bool _vertexAttribHalf;
     };
 
 public:
@@ -52,9 +56,11 @@ public:
     bool isVSync() { return _isVsync; }
 
     void submit(const BGFXGpuProgram * gpuProgram);
+    void submit(const BGFXGpuProgram * gpuProgram, unsigned short viewId, uint32_t depth);
 
     void beginFrame();
     void endFrame();
+    uint32_t getFrameNumber() const { return _frameNumber; }
 
 
 
@@ -71,6 +77,8 @@ protected:
     unsigned    _width;
     unsigned    _height;
     bool        _isVsync;
+    unsigned short _lastSubmitViewId;
+    uint32_t    _frameNumber;
 };
 
 
@@ -2,6 +2,7 @@
 #include "../graphics/Texture.h"
 #include "../renderer/BGFXUniform.h"
 #include "../core/FileSystem.h"
+#include "../core/Game.h"
 
 #ifdef GP_USE_MEM_LEAK_DETECTION
 #undef new
@@ -51,6 +52,21 @@ bgfx::TextureFormat::Enum BGFXTexture::toBgfxFormat(Texture::Format gp3dFormat)
     case Texture::Format::D16F        : return bgfx::TextureFormat::D16F;
     case Texture::Format::D24F        : return bgfx::TextureFormat::D24F;
     case Texture::Format::D32F        : return bgfx::TextureFormat::D32F;
+    case Texture::Format::BC1        : return bgfx::TextureFormat::BC1;
+    case Texture::Format::BC2        : return bgfx::TextureFormat::BC2;
+    case Texture::Format::BC3        : return bgfx::TextureFormat::BC3;
+    case Texture::Format::BC4        : return bgfx::TextureFormat::BC4;
+    case Texture::Format::BC5        : return bgfx::TextureFormat::BC5;
+    case Texture::Format::BC6H       : return bgfx::TextureFormat::BC6H;
+    case Texture::Format::BC7        : return bgfx::TextureFormat::BC7;
+    case Texture::Format::ETC1       : return bgfx::TextureFormat::ETC1;
+    case Texture::Format::ETC2       : return bgfx::TextureFormat::ETC2;
+    case Texture::Format::ETC2A      : return bgfx::TextureFormat::ETC2A;
+    case Texture::Format::ETC2A1     : return bgfx::TextureFormat::ETC2A1;
+    case Texture::Format::PTC12      : return bgfx::TextureFormat::PTC12;
+    case Texture::Format::PTC14      : return bgfx::TextureFormat::PTC14;
+    case Texture::Format::PTC12A     : return bgfx::TextureFormat::PTC12A;
+    case Texture::Format::PTC14A     : return bgfx::TextureFormat::PTC14A;
     default:
         GP_ASSERT(!"gp3d texture format unknown.");
         return bgfx::TextureFormat::Unknown;
@@ -76,9 +92,21 @@ Texture::Format BGFXTexture::toGp3dFormat(bgfx::TextureFormat::Enum bimgTextureF
     case bgfx::TextureFormat::D24F      : return Texture::Format::D24F;
     case bgfx::TextureFormat::D32F      : return Texture::Format::D32F;
 
-    case bgfx::TextureFormat::BC2       : return Texture::Format::RGBA;
-    case bgfx::TextureFormat::BC3       : return Texture::Format::RGBA;
-    case bgfx::TextureFormat::BC5       : return Texture::Format::RGBA;
+    case bgfx::TextureFormat::BC1       : return Texture::Format::BC1;
+    case bgfx::TextureFormat::BC2       : return Texture::Format::BC2;
+    case bgfx::TextureFormat::BC3       : return Texture::Format::BC3;
+    case bgfx::TextureFormat::BC4       : return Texture::Format::BC4;
+    case bgfx::TextureFormat::BC5       : return Texture::Format::BC5;
+    case bgfx::TextureFormat::BC6H      : return Texture::Format::BC6H;
+    case bgfx::TextureFormat::BC7       : return Texture::Format::BC7;
+    case bgfx::TextureFormat::ETC1      : return Texture::Format::ETC1;
+    case bgfx::TextureFormat::ETC2      : return Texture::Format::ETC2;
+    case bgfx::TextureFormat::ETC2A     : return Texture::Format::ETC2A;
+    case bgfx::TextureFormat::ETC2A1    : return Texture::Format::ETC2A1;
+    case bgfx::TextureFormat::PTC12     : return Texture::Format::PTC12;
+    case bgfx::TextureFormat::PTC14     : return Texture::Format::PTC14;
+    case bgfx::TextureFormat::PTC12A    : return Texture::Format::PTC12A;
+    case bgfx::TextureFormat::PTC14A    : return Texture::Format::PTC14A;
 
     default:
         GP_ASSERT(!"bimg texture format not supported.");
@@ -138,7 +166,117 @@ bx::AllocatorI* getDefaultAllocator()
     return &s_allocator;
 }
 
-bgfx::TextureHandle createTexture(bimg::ImageContainer* imageContainer, uint32_t flags, bgfx::TextureInfo* info = NULL)
+// Extension of the files loaded instead of the image files, when they exist.
+static std::string __textureExtension;
+
+/**
+ * Returns the number of bytes per pixel of the formats mipmaps can be generated for, or 0.
+ */
+static uint32_t getMipmapBytesPerPixel(bimg::TextureFormat::Enum format)
+{
+    switch (format)
+    {
+    case bimg::TextureFormat::R8:
+        return 1;
+    case bimg::TextureFormat::RG8:
+        return 2;
+    case bimg::TextureFormat::RGB8:
+        return 3;
+    case bimg::TextureFormat::RGBA8:
+    case bimg::TextureFormat::BGRA8:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Computes a mip level from the previous one with a 2x2 box filter.
+ * Odd sizes repeat the last column or row of the previous level.
+ */
+static void downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t bpp)
+{
+    const uint32_t srcPitch = srcWidth * bpp;
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        const uint8_t* row0 = src + std::min(y * 2, srcHeight - 1) * srcPitch;
+        const uint8_t* row1 = src + std::min(y * 2 + 1, srcHeight - 1) * srcPitch;
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            const uint32_t x0 = std::min(x * 2, srcWidth - 1) * bpp;
+            const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1) * bpp;
+            for (uint32_t c = 0; c < bpp; ++c)
+            {
+                *dst++ = uint8_t((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+/**
+ * Returns an image with a full mipmap chain, replacing the given image with a single level.
+ * Images that have mipmaps, or that are compressed, cube, volume or array images are returned as is.
+ */
+static bimg::ImageContainer* generateMipmaps(bimg::ImageContainer* image)
+{
+    if (image->m_numMips > 1 || image->m_cubeMap || image->m_depth > 1 || image->m_numLayers > 1)
+        return image;
+
+    const uint32_t bpp = getMipmapBytesPerPixel(image->m_format);
+    if (bpp == 0)
+    {
+        GP_WARN("Mipmaps can't be generated for images of format %d.", image->m_format);
+        return image;
+    }
+
+    bimg::ImageContainer* mipmapped = bimg::imageAlloc(getDefaultAllocator(), image->m_format,
+                                                       uint16_t(image->m_width), uint16_t(image->m_height), 1, 1, false, true);
+    mipmapped->m_orientation = image->m_orientation;
+    mipmapped->m_srgb = image->m_srgb;
+
+    // The levels are stored one after the other, from the largest.
+    uint8_t* level = (uint8_t*)mipmapped->m_data;
+    uint32_t width = image->m_width;
+    uint32_t height = image->m_height;
+    memcpy(level, image->m_data, width * height * bpp);
+    for (uint8_t lod = 1; lod < mipmapped->m_numMips; ++lod)
+    {
+        const uint32_t levelWidth = std::max(width >> 1, 1u);
+        const uint32_t levelHeight = std::max(height >> 1, 1u);
+        uint8_t* nextLevel = level + width * height * bpp;
+        downsample(level, width, height, nextLevel, levelWidth, levelHeight, bpp);
+        level = nextLevel;
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    bimg::imageFree(image);
+    return mipmapped;
+}
+
+/**
+ * Decodes the compressed images the renderer doesn't support.
+ */
+static bimg::ImageContainer* decodeUnsupportedFormat(const char* path, bimg::ImageContainer* image)
+{
+    const bgfx::Caps* caps = bgfx::getCaps();
+    if (!bimg::isCompressed(image->m_format) || (caps->formats[image->m_format] & BGFX_CAPS_FORMAT_TEXTURE_2D) != 0)
+        return image;
+
+    GP_WARN("Texture format of '%s' is not supported by the renderer, decoding it on load.", path);
+    bimg::ImageContainer* decoded = bimg::imageConvert(getDefaultAllocator(), bimg::TextureFormat::RGBA8, *image);
+    if (decoded == NULL)
+        return image;
+    bimg::imageFree(image);
+    return decoded;
+}
+
+static void releaseImageContainer(void* ptr, void* userData)
+{
+    bimg::imageFree((bimg::ImageContainer*)userData);
+}
+
+bgfx::TextureHandle createTexture(bimg::ImageContainer* imageContainer, uint32_t flags, bgfx::TextureInfo* info = NULL, bgfx::ReleaseFn releaseFn = NULL)
 {
     bgfx::TextureHandle handle = BGFX_INVALID_HANDLE;
 
@@ -148,7 +286,7 @@ bgfx::TextureHandle createTexture(bimg::ImageContainer* imageContainer, uint32_t
         mem = bgfx::makeRef(
                     imageContainer->m_data
                     , imageContainer->m_size
-                    , 0
+                    , releaseFn
                     , imageContainer
                     );
     }
@@ -206,33 +344,69 @@ bgfx::TextureHandle createTexture(bimg::ImageContainer* imageContainer, uint32_t
     return handle;
 }
 
-bgfx::TextureHandle loadTexture(const char* filePath, uint32_t flags, bgfx::TextureInfo* info = NULL, bimg::Orientation::Enum* orientation = NULL)
+static bimg::ImageContainer* parseImage(const char* path)
 {
     // Read file
     int size = 0;
-    char * data = FileSystem::readAll(filePath, &size);
+    char * data = FileSystem::readAll(path, &size);
     if (data == NULL)
     {
-        GP_ERROR("Failed to read image from file '%s'.", filePath);
-        return BGFX_INVALID_HANDLE;
+        GP_ERROR("Failed to read image from file '%s'.", path);
+        return nullptr;
     }
 
     // Parse data
     bimg::ImageContainer* imageContainer = bimg::imageParse(getDefaultAllocator(), data, size);
+
+    // free file data
+    delete[] data;
+
     if(imageContainer == nullptr)
     {
-        GP_ERROR("Failed to parse image data from file '%s'.", filePath);
-        return BGFX_INVALID_HANDLE;
+        GP_ERROR("Failed to parse image data from file '%s'.", path);
+        return nullptr;
     }
 
-    // create bgfx texture
-    bgfx::TextureHandle handle = createTexture(imageContainer, flags, info);
-    GP_ASSERT(bgfx::isValid(handle));
+    return imageContainer;
+}
 
-    // free file data
-    delete[] data;
+void BGFXTexture::initialize()
+{
+    Properties* graphicsConfig = Game::getInstance()->getConfig()->getNamespace("graphics", true);
+    const char* textureExtension = graphicsConfig ? graphicsConfig->getString("textureExtension") : NULL;
+    __textureExtension = textureExtension ? textureExtension : "";
+}
 
-    return handle;
+bimg::ImageContainer* BGFXTexture::loadImage(const char* path, bool generateMipmaps)
+{
+    bimg::ImageContainer* imageContainer = nullptr;
+
+    // Prefer the texture shipped in place of the image, usually compressed and mipmapped.
+    if (!__textureExtension.empty())
+    {
+        std::string texturePath = path;
+        size_t dot = texturePath.find_last_of('.');
+        size_t slash = texturePath.find_last_of("/\\");
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+            texturePath.erase(dot);
+        texturePath += __textureExtension;
+        if (texturePath != path && FileSystem::fileExists(texturePath.c_str()))
+            imageContainer = parseImage(texturePath.c_str());
+    }
+
+    if (imageContainer == nullptr)
+        imageContainer = parseImage(path);
+
+    if (imageContainer && generateMipmaps)
+        imageContainer = gplay::generateMipmaps(imageContainer);
+
+    return imageContainer;
+}
+
+void BGFXTexture::freeImage(bimg::ImageContainer* image)
+{
+    if(image)
+        bimg::imageFree(image);
 }
 
 
@@ -248,13 +422,25 @@ BGFXTexture::~BGFXTexture()
         bgfx::destroy(_handle);
 }
 
-Texture * BGFXTexture::createFromFile(const char * path)
+Texture * BGFXTexture::createFromFile(const char * path, bool generateMipmaps)
+{
+    return createFromImage(path, loadImage(path, generateMipmaps));
+}
+
+Texture * BGFXTexture::createFromImage(const char * path, bimg::ImageContainer* image)
 {
     BGFXTexture * bgfxTexture = new BGFXTexture();
 
-    // create texture from file
+    // create texture from image, the image is freed once bgfx has uploaded it
     bgfx::TextureInfo info;
-    bgfxTexture->_handle = loadTexture(path, BGFX_TEXTURE_NONE, &info);
+    memset(&info, 0, sizeof(info));
+    info.format = bgfx::TextureFormat::Unknown;
+    if(image)
+    {
+        image = decodeUnsupportedFormat(path, image);
+        bgfxTexture->_handle = createTexture(image, BGFX_TEXTURE_NONE, &info, releaseImageContainer);
+        GP_ASSERT(bgfx::isValid(bgfxTexture->_handle));
+    }
 
     // create gameplay3d texture
     Texture* texture = new Texture();
@@ -262,8 +448,9 @@ Texture * BGFXTexture::createFromFile(const char * path)
     texture->_type = Texture::TEXTURE_2D;
     texture->_width = info.width;
     texture->_height = info.height;
-    texture->_compressed = false;
+    texture->_compressed = bimg::isCompressed(bimg::TextureFormat::Enum(info.format));
     texture->_mipmapped = info.numMips > 1;
+    texture->_storageSize = info.storageSize;
     texture->_bpp = info.bitsPerPixel / 8;
     texture->_path = path;
     texture->_gpuTtexture = bgfxTexture;
@@ -271,7 +458,7 @@ Texture * BGFXTexture::createFromFile(const char * path)
     return texture;
 }
 
-Texture* BGFXTexture::createFromData(Texture::TextureInfo info, const unsigned char* data, uint32_t flags)
+Texture* BGFXTexture::createFromData(Texture::TextureInfo info, const unsigned char* data, uint32_t flags, bool generateMipmaps)
 {
     BGFXTexture * bgfxTexture = new BGFXTexture();
 
@@ -280,6 +467,7 @@ Texture* BGFXTexture::createFromData(Texture::TextureInfo info, const unsigned c
     uint32_t imgSize = width * height * info.bytePerPixel;
     bimg::TextureFormat::Enum bgfxFormat = (bimg::TextureFormat::Enum)toBgfxFormat(info.format);
     //uint32_t imgSize = bimg::imageGetSize(0, width, height, 1, false, false, 1, bgfxFormat);
+    bool mipmapped = data && generateMipmaps && info.type == Texture::TEXTURE_2D && getMipmapBytesPerPixel(bgfxFormat) == info.bytePerPixel;
 
     bimg::ImageContainer * imageContainer = new bimg::ImageContainer();
     imageContainer->m_size = imgSize;
@@ -297,7 +485,7 @@ Texture* BGFXTexture::createFromData(Texture::TextureInfo info, const unsigned c
     imageContainer->m_format = bgfxFormat;
     imageContainer->m_orientation = bimg::Orientation::R0;
 
-    if(data)
+    if(data && !mipmapped)
     {
         const bgfx::Memory* mem = bgfx::copy(data, imgSize);
         imageContainer->m_data = mem->data;
@@ -310,7 +498,17 @@ Texture* BGFXTexture::createFromData(Texture::TextureInfo info, const unsigned c
     }
 
     bgfx::TextureInfo bgfxInfo;
-    bgfxTexture->_handle = createTexture(imageContainer, flags, &bgfxInfo);
+    if(mipmapped)
+    {
+        // copy the data into an image owned by bgfx, with its mipmaps
+        bimg::ImageContainer* image = bimg::imageAlloc(getDefaultAllocator(), bgfxFormat, uint16_t(width), uint16_t(height), 1, 1, false, false, data);
+        image = gplay::generateMipmaps(image);
+        bgfxTexture->_handle = createTexture(image, flags, &bgfxInfo, releaseImageContainer);
+    }
+    else
+    {
+        bgfxTexture->_handle = createTexture(imageContainer, flags, &bgfxInfo);
+    }
 
     // create gameplay3d texture
     Texture* texture = new Texture();
@@ -320,6 +518,7 @@ Texture* BGFXTexture::createFromData(Texture::TextureInfo info, const unsigned c
     texture->_height = bgfxInfo.height;
     texture->_compressed = false;
     texture->_mipmapped = bgfxInfo.numMips > 1;
+    texture->_storageSize = bgfxInfo.storageSize;
     texture->_bpp = bgfxInfo.bitsPerPixel / 8;
     texture->_gpuTtexture = bgfxTexture;
     texture->_path = info.id;
@@ -344,4 +543,10 @@ void BGFXTexture::bind(Uniform * uniform, Texture * texture, uint32_t customFlag
     bgfx::setTexture(bgfxUniform->getIndex(), bgfxUniform->getHandle(), _handle, flags);
 }
 
+void BGFXTexture::update(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const bgfx::Memory* mem)
+{
+    GP_ASSERT(mem);
+    bgfx::updateTexture2D(_handle, 0, 0, uint16_t(x), uint16_t(y), uint16_t(width), uint16_t(height), mem);
+}
+
 } // end namespace gplay
@@ -4,6 +4,10 @@
 #include "../core/Base.h"
 #include "../graphics/Texture.h"
 
+namespace bimg {
+struct ImageContainer;
+}
+
 namespace gplay {
 
 class BGFXTexture
@@ -13,10 +17,44 @@ class BGFXTexture
 public:
     ~BGFXTexture();
 
-    static Texture* createFromFile(const char* path);
-    static Texture* createFromData(Texture::TextureInfo info, const unsigned char* data = nullptr, uint32_t flags = BGFX_TEXTURE_NONE);
+    /**
+     * Reads the texture settings of the game config.
+     */
+    static void initialize();
+
+    /**
+     * Creates a texture from an image file.
+     *
+     * @param path The path of the image file.
+     * @param generateMipmaps True to generate the mipmaps of images that have a single level.
+     */
+    static Texture* createFromFile(const char* path, bool generateMipmaps = false);
+
+    /**
+     * Reads and decodes an image file, can be called from any thread.
+     * The mipmaps are generated here when requested, so that loader threads do the work.
+     * Returns NULL if the file can't be read or decoded.
+     */
+    static bimg::ImageContainer* loadImage(const char* path, bool generateMipmaps = false);
+
+    /**
+     * Creates a texture from an image returned by loadImage(), which it takes ownership of.
+     */
+    static Texture* createFromImage(const char* path, bimg::ImageContainer* image);
+
+    /**
+     * Frees an image returned by loadImage() that is not used to create a texture.
+     */
+    static void freeImage(bimg::ImageContainer* image);
+    static Texture* createFromData(Texture::TextureInfo info, const unsigned char* data = nullptr, uint32_t flags = BGFX_TEXTURE_NONE, bool generateMipmaps = false);
 
     void bind(Uniform* uniform, Texture* texture, uint32_t customFlags = BGFX_TEXTURE_NONE);
+
+    /**
+     * Updates a rectangle of the first mip level of a texture created without data.
+     * The memory holds the pixels of the rectangle, tightly packed.
+     */
+    void update(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const bgfx::Memory* mem);
     const bgfx::TextureHandle getHandle() const { return _handle; }
     static bgfx::TextureFormat::Enum toBgfxFormat(Texture::Format gp3dFormat);
     static Texture::Format toGp3dFormat(bgfx::TextureFormat::Enum bimgTextureFormat);
@@ -2,9 +2,23 @@
 #include "../math/Vector2.h"
 #include "../math/Vector3.h"
 #include "../math/Vector4.h"
+#include "../math/Matrix.h"
 
 namespace gplay {
 
+/**
+ * Last value uploaded to a bgfx uniform.
+ * Indexed by handle since bgfx shares uniform handles by name between programs.
+ */
+struct UniformValue
+{
+    unsigned int epoch;
+    std::vector<unsigned char> data;
+};
+
+static std::vector<UniformValue> __uniformValues;
+static unsigned int __uniformValuesEpoch = 1;
+
 
 Uniform::Uniform() :
    _type(UT_UNDEFINED), _index(0), _effect(NULL)
@@ -75,12 +89,14 @@ BGFXUniform::~BGFXUniform()
 void BGFXUniform::setValue(float value)
 {
     GP_ASSERT(bgfx::isValid(_handle));
+    forgetData();
     bgfx::setUniform(_handle, &value);
 }
 
 void BGFXUniform::setValue(const float* values, unsigned int count)
 {
     GP_ASSERT(bgfx::isValid(_handle));
+    forgetData();
     bgfx::setUniform(_handle, &values[0], count);
 }
 
@@ -107,51 +123,55 @@ void BGFXUniform::setValue(const int* values, unsigned int count)
 void BGFXUniform::setValue(const Matrix& value)
 {
     GP_ASSERT(bgfx::isValid(_handle));
-    bgfx::setUniform(_handle, &value.m);
+    setData(value.m, sizeof(value.m), 1);
 }
 
 void BGFXUniform::setValue(const Matrix* values, unsigned int count)
 {
     GP_ASSERT(bgfx::isValid(_handle));
     GP_ASSERT(_num >= count);
-    bgfx::setUniform(_handle, &values[0].m, count);
+    setData(values[0].m, sizeof(Matrix) * count, count);
 }
 
 void BGFXUniform::setValue(const Vector2& value)
 {
     GP_ASSERT(bgfx::isValid(_handle));
-    bgfx::setUniform(_handle, &value.x);
+    const Vector4 v(value.x, value.y, 0.0f, 0.0f);
+    setData(&v.x, sizeof(Vector4), 1);
 }
 
 void BGFXUniform::setValue(const Vector2* values, unsigned int count)
 {
     GP_ASSERT(bgfx::isValid(_handle));
+    forgetData();
     bgfx::setUniform(_handle, &values[0].x, count);
 }
 
 void BGFXUniform::setValue(const Vector3& value)
 {
     GP_ASSERT(bgfx::isValid(_handle));
-    bgfx::setUniform(_handle, &value.x);
+    const Vector4 v(value.x, value.y, value.z, 0.0f);
+    setData(&v.x, sizeof(Vector4), 1);
 }
 
 void BGFXUniform::setValue(const Vector3* values, unsigned int count)
 {
     GP_ASSERT(bgfx::isValid(_handle));
+    forgetData();
     bgfx::setUniform(_handle, &values[0].x, count);
 }
 
 void BGFXUniform::setValue(const Vector4& value)
 {
     GP_ASSERT(bgfx::isValid(_handle));
-    bgfx::setUniform(_handle, &value.x);
+    setData(&value.x, sizeof(Vector4), 1);
 }
 
 void BGFXUniform::setValue(const Vector4* values, unsigned int count)
 {
     GP_ASSERT(bgfx::isValid(_handle));
     GP_ASSERT(_num >= count);
-    bgfx::setUniform(_handle, &values[0].x, count);
+    setData(&values[0].x, sizeof(Vector4) * count, count);
 }
 
 void BGFXUniform::setValue(const Texture::Sampler* sampler)
@@ -178,4 +198,35 @@ void BGFXUniform::setValue(const Texture::Sampler** values, unsigned int count)
     }
 }
 
+void BGFXUniform::setData(const void* data, unsigned int size, uint16_t count)
+{
+    if (_handle.idx >= __uniformValues.size())
+    {
+        UniformValue empty;
+        empty.epoch = 0;
+        __uniformValues.resize(_handle.idx + 1, empty);
+    }
+
+    UniformValue& last = __uniformValues[_handle.idx];
+    if (last.epoch == __uniformValuesEpoch && last.data.size() == size && memcmp(&last.data[0], data, size) == 0)
+        return;
+
+    last.epoch = __uniformValuesEpoch;
+    last.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+    bgfx::setUniform(_handle, data, count);
+}
+
+void BGFXUniform::forgetData()
+{
+    if (_handle.idx < __uniformValues.size())
+    {
+        __uniformValues[_handle.idx].epoch = 0;
+    }
+}
+
+void BGFXUniform::invalidateValueCache()
+{
+    ++__uniformValuesEpoch;
+}
+
 } // end namespace gplay
@@ -243,7 +243,28 @@ public:
 
     bgfx::UniformHandle getHandle() { return _handle; }
 
+    /**
+     * Forgets the last uploaded uniform values.
+     *
+     * Uploads are skipped when a uniform is set with the value it already holds.
+     * This is only valid while draw calls are executed in submission order, so the
+     * renderer invalidates the values on each frame, on view changes and after
+     * each submit in a view that is not sequential.
+     */
+    static void invalidateValueCache();
+
 private:
+
+    /**
+     * Uploads the given data to the uniform, unless the uniform already holds it.
+     */
+    void setData(const void* data, unsigned int size, uint16_t count);
+
+    /**
+     * Forgets the last uploaded value of this uniform, for uploads that are not tracked.
+     */
+    void forgetData();
+
     bgfx::UniformHandle _handle;    // uniform handle
     unsigned int _num;              // number of elements in array
 };
@@ -70,6 +70,9 @@ bgfx::AttribType::Enum getBgfxAttributeType(const VertexFormat::AttribType type)
     case VertexFormat::Float:
         return bgfx::AttribType::Float;
         break;
+    case VertexFormat::Half:
+        return bgfx::AttribType::Half;
+        break;
     default:
         GP_ERROR("Attribute type unknown.");
         break;
@@ -87,11 +90,16 @@ void BGFXVertexBuffer::createVertexDecl(const VertexFormat &vertexFormat, bgfx::
         bgfx::Attrib::Enum attrib;
         getBgfxAttribute(element, attrib);
 
+        if (element.type == VertexFormat::Half && !(bgfx::getCaps()->supported & BGFX_CAPS_VERTEX_ATTRIB_HALF))
+        {
+            GP_ERROR("Half float vertex attributes are not supported by the renderer, vertex element %d can't be drawn.", (int)i);
+        }
+
         bgfx::AttribType::Enum type = getBgfxAttributeType(element.type);
         bool normalized = element.normalized;
         uint8_t num = element.size;
 
-        bool asInt = element.type == VertexFormat::Float ? false : true;
+        bool asInt = (element.type == VertexFormat::Float || element.type == VertexFormat::Half) ? false : true;
 
         vertexDecl.add(attrib,num,type,normalized,asInt);
     }
@@ -106,7 +114,12 @@ void BGFXVertexBuffer::createStaticBuffer()
 
     void* dataPtr = _memoryBuffer.map(0);
     GP_ASSERT(dataPtr);
-    const bgfx::Memory * mem = bgfx::makeRef(dataPtr, _memoryBuffer.getSize());
+    createStaticBuffer(bgfx::makeRef(dataPtr, _memoryBuffer.getSize()));
+}
+
+void BGFXVertexBuffer::createStaticBuffer(const bgfx::Memory* mem)
+{
+    GP_ASSERT(!_dynamic && !bgfx::isValid(_svbh));
 
     uint16_t flags = BGFX_BUFFER_NONE;
     _svbh = bgfx::createVertexBuffer(mem, _vertexDecl, flags);
@@ -141,6 +154,24 @@ void BGFXVertexBuffer::set(const void* data, uint32_t count, uint32_t start)
     }
 }
 
+void BGFXVertexBuffer::setShared(const void* data, uint32_t count, ReleaseFunction release, void* userData)
+{
+    if(_dynamic || bgfx::isValid(_svbh) || count > _elementCount)
+    {
+        GeometryBuffer::setShared(data, count, release, userData);
+        return;
+    }
+
+    // The data is referenced until the renderer has uploaded it, no cpu copy is kept.
+    _memoryBuffer.destroy();
+    setRange(0, count);
+
+    SharedData* shared = new SharedData();
+    shared->release = release;
+    shared->userData = userData;
+    createStaticBuffer(bgfx::makeRef(data, count * _elementSize, &GeometryBuffer::releaseSharedData, shared));
+}
+
 void BGFXVertexBuffer::bind() const
 {
     if(_dynamic)
@@ -17,12 +17,14 @@ public:
     const bgfx::VertexDecl getVertexDecl() const { return _vertexDecl; }
 
     void set(const void* data, uint32_t count, uint32_t start) override;
+    void setShared(const void* data, uint32_t count, ReleaseFunction release, void* userData) override;
     void bind() const override;
     void* lock(uint32_t start, uint32_t count) override;
     void unLock() override;
 
 private:
     void createStaticBuffer();
+    void createStaticBuffer(const bgfx::Memory* mem);
     void createDynamicBuffer();
 
     bgfx::VertexBufferHandle _svbh;             // static vertex buffer handle
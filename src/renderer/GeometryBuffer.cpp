@@ -83,6 +83,22 @@ void GeometryBuffer::set(const void* data, uint32_t count, uint32_t start)
     }
 }
 
+void GeometryBuffer::setShared(const void* data, uint32_t count, ReleaseFunction release, void* userData)
+{
+    set(data, count, 0);
+    if (release)
+        release(userData);
+}
+
+void GeometryBuffer::releaseSharedData(void* ptr, void* sharedData)
+{
+    SharedData* shared = (SharedData*)sharedData;
+    GP_ASSERT(shared);
+    if (shared->release)
+        shared->release(shared->userData);
+    delete shared;
+}
+
 void GeometryBuffer::bind() const
 {
 }
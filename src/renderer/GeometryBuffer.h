@@ -14,9 +14,21 @@ public:
         LOCK_ACTIVE,
     };
 
+    /**
+     * Function called once the data given to setShared() is no longer referenced.
+     */
+    typedef void (*ReleaseFunction)(void* userData);
+
     GeometryBuffer();
     virtual ~GeometryBuffer();
     virtual void set(const void* data, uint32_t count, uint32_t start);
+
+    /**
+     * Sets the whole content of a static buffer from memory that is referenced in place
+     * instead of copied, release is called with userData once the data is no longer needed.
+     * Buffers that don't support it copy the data and release it immediately.
+     */
+    virtual void setShared(const void* data, uint32_t count, ReleaseFunction release, void* userData);
     virtual void bind() const;
     virtual void* lock(uint32_t start, uint32_t count);
     virtual void unLock();
@@ -26,6 +38,17 @@ public:
     bool setRange(uint32_t start, uint32_t count);
 
 protected:
+    struct SharedData
+    {
+        ReleaseFunction release;
+        void* userData;
+    };
+
+    /**
+     * Renderer memory release callback for the data given to setShared(), takes a SharedData.
+     */
+    static void releaseSharedData(void* ptr, void* sharedData);
+
     uint32_t _elementSize;      // size of 1 element
     uint32_t _elementCount;     // number of element
     MemoryBuffer _memoryBuffer; // memory buffer
@@ -1,18 +1,25 @@
 #include "../core/Base.h"
 #include "../ui/ImageControl.h"
 
+// Size of the pages of the atlas shared by the images of the controls
+#define IMAGE_ATLAS_PAGE_SIZE 1024
+
 namespace gplay
 {
 
+static TextureAtlas* __imageAtlas = NULL;
+static SpriteBatch* __imageAtlasBatch = NULL;
+static unsigned int __imageAtlasUsers = 0;
+
 ImageControl::ImageControl() :
-    _srcRegion(Rectangle::empty()), _dstRegion(Rectangle::empty()), _batch(NULL),
+    _srcRegion(Rectangle::empty()), _dstRegion(Rectangle::empty()), _batch(NULL), _region(NULL),
     _tw(0.0f), _th(0.0f), _uvs(Theme::UVs::full())
 {
 }
 
 ImageControl::~ImageControl()
 {
-    SAFE_DELETE(_batch);
+    releaseImage();
 }
 
 ImageControl* ImageControl::create(const char* id, Theme::Style* style)
@@ -65,21 +72,81 @@ const char* ImageControl::getTypeName() const
 
 void ImageControl::setImage(const char* path)
 {
-    SAFE_DELETE(_batch);
-    Texture* texture = Texture::create(path);
-    _batch = SpriteBatch::create(texture);
-    _tw = 1.0f / texture->getWidth();
-    _th = 1.0f / texture->getHeight();
-    texture->release();
+    releaseImage();
+
+    if (__imageAtlas == NULL)
+    {
+        __imageAtlas = TextureAtlas::create(IMAGE_ATLAS_PAGE_SIZE, IMAGE_ATLAS_PAGE_SIZE);
+        if (__imageAtlas)
+            __imageAtlasBatch = SpriteBatch::create(__imageAtlas);
+    }
+    if (__imageAtlasBatch)
+    {
+        _region = __imageAtlas->addImage(path);
+    }
+    if (!_region && __imageAtlasUsers == 0)
+    {
+        // No image uses the shared atlas yet, don't keep it alive.
+        SAFE_DELETE(__imageAtlasBatch);
+        SAFE_RELEASE(__imageAtlas);
+    }
+
+    if (_region)
+    {
+        ++__imageAtlasUsers;
+        _batch = __imageAtlasBatch;
+        _tw = 1.0f / __imageAtlas->getPageWidth();
+        _th = 1.0f / __imageAtlas->getPageHeight();
+        _uvs = Theme::UVs(_region->u1, _region->v1, _region->u2, _region->v2);
+    }
+    else
+    {
+        // The image doesn't fit in an atlas page.
+        Texture* texture = Texture::create(path);
+        _batch = SpriteBatch::create(texture);
+        _tw = 1.0f / texture->getWidth();
+        _th = 1.0f / texture->getHeight();
+        texture->release();
+        _uvs = Theme::UVs::full();
+    }
+
+    if (!_srcRegion.isEmpty())
+        setRegionSrc(_srcRegion);
 
     if (_autoSize != AUTO_SIZE_NONE)
         setDirty(DIRTY_BOUNDS);
 }
 
+void ImageControl::releaseImage()
+{
+    if (_region)
+    {
+        _region = NULL;
+        _batch = NULL;
+        GP_ASSERT(__imageAtlasUsers > 0);
+        if (--__imageAtlasUsers == 0)
+        {
+            SAFE_DELETE(__imageAtlasBatch);
+            SAFE_RELEASE(__imageAtlas);
+        }
+    }
+    else
+    {
+        SAFE_DELETE(_batch);
+    }
+}
+
 void ImageControl::setRegionSrc(float x, float y, float width, float height)
 {
     _srcRegion.set(x, y, width, height);
 
+    // The source region is relative to the image, which is offset in the atlas page.
+    if (_region)
+    {
+        x += _region->bounds.x;
+        y += _region->bounds.y;
+    }
+
     _uvs.u1 = x * _tw;
     _uvs.u2 = (x + width) * _tw;
     _uvs.v1 = 1.0f - (y * _th);
@@ -116,19 +183,21 @@ unsigned int ImageControl::drawImages(Form* form, const Rectangle& clip)
     if (!_batch)
         return 0;
 
+    // The batch of the first atlas page starts and finishes the batches of the other pages.
     startBatch(form, _batch);
+    SpriteBatch* batch = _region ? _batch->getPageBatch(_region->page) : _batch;
 
     Vector4 color = Vector4::one();
     color.w *= _opacity;
 
     if (_dstRegion.isEmpty())
     {
-        _batch->draw(_viewportBounds.x, _viewportBounds.y, _viewportBounds.width, _viewportBounds.height,
+        batch->draw(_viewportBounds.x, _viewportBounds.y, _viewportBounds.width, _viewportBounds.height,
             _uvs.u1, _uvs.v1, _uvs.u2, _uvs.v2, color, _viewportClipBounds);
     }
     else
     {
-        _batch->draw(_viewportBounds.x + _dstRegion.x, _viewportBounds.y + _dstRegion.y,
+        batch->draw(_viewportBounds.x + _dstRegion.x, _viewportBounds.y + _dstRegion.y,
             _dstRegion.width, _dstRegion.height,
             _uvs.u1, _uvs.v1, _uvs.u2, _uvs.v2, color, _viewportClipBounds);
     }
@@ -142,14 +211,18 @@ void ImageControl::updateBounds()
 {
     if (_batch)
     {
+        const Texture* texture = _batch->getSampler()->getTexture();
+        const float width = _region ? _region->bounds.width : texture->getWidth();
+        const float height = _region ? _region->bounds.height : texture->getHeight();
+
         if (_autoSize & AUTO_SIZE_WIDTH)
         {
-            setWidthInternal(_batch->getSampler()->getTexture()->getWidth());
+            setWidthInternal(width);
         }
 
         if (_autoSize & AUTO_SIZE_HEIGHT)
         {
-            setHeightInternal(_batch->getSampler()->getTexture()->getWidth());
+            setHeightInternal(height);
         }
     }
 
@@ -48,6 +48,10 @@ public:
     /**
      * Set the path of the image for this ImageControl to display.
      *
+     * The images of all the image controls are packed into a shared texture atlas, so that
+     * the images of a batched form are drawn with one draw call per atlas page. Images larger
+     * than an atlas page are drawn with their own texture.
+     *
      * @param path The path to the image.
      */
     void setImage(const char* path);
@@ -138,11 +142,18 @@ private:
 
     ImageControl(const ImageControl& copy);
 
+    /**
+     * Releases the image, and the shared atlas once no control uses it.
+     */
+    void releaseImage();
+
     // Source region.
     Rectangle _srcRegion;
     // Destination region.
     Rectangle _dstRegion;
     SpriteBatch* _batch;
+    // Region of the image in the shared atlas, or NULL if the image has its own batch.
+    const TextureAtlas::Region* _region;
 
     // One over texture width and height, for use when calculating UVs from a new source region.
     float _tw;
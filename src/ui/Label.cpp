@@ -101,8 +101,10 @@ void Label::updateBounds()
         // Measure bounds based only on normal state so that bounds updates are not always required on state changes.
         // This is a trade-off for functionality vs performance, but changing the size of UI controls on hover/focus/etc
         // is a pretty bad practice so we'll prioritize performance here.
+        // The text layout keeps the measurement until the text, font or size change.
         unsigned int w, h;
-        _font->measureText(_text.c_str(), getFontSize(NORMAL), &w, &h);
+        _textLayout.set(_font, _text.c_str(), _textBounds, getFontSize(NORMAL), getTextAlignment(NORMAL), true, getTextRightToLeft(NORMAL));
+        _textLayout.measureText(&w, &h);
         if (_autoSize & AUTO_SIZE_WIDTH)
         {
             setWidthInternal(w + getBorder(NORMAL).left + getBorder(NORMAL).right + getPadding().left + getPadding().right);
@@ -131,7 +133,8 @@ unsigned int Label::drawText(Form* form, const Rectangle& clip)
 
         SpriteBatch* batch = _font->getSpriteBatch(fontSize);
         startBatch(form, batch);
-        _font->drawText(_text.c_str(), _textBounds, _textColor, fontSize, getTextAlignment(state), true, getTextRightToLeft(state), _viewportClipBounds);
+        _textLayout.set(_font, _text.c_str(), _textBounds, fontSize, getTextAlignment(state), true, getTextRightToLeft(state));
+        _textLayout.draw(_textColor, _viewportClipBounds);
         finishBatch(form, batch);
 
         return 1;
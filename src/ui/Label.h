@@ -3,6 +3,7 @@
 
 #include "../ui/Control.h"
 #include "../ui/Theme.h"
+#include "../graphics/TextLayout.h"
 
 namespace gplay
 {
@@ -141,6 +142,11 @@ protected:
      */
     Rectangle _textBounds;
 
+    /**
+     * The layout of the text, kept until the text or its bounds change.
+     */
+    TextLayout _textLayout;
+
 private:
 
     /**
@@ -482,7 +482,8 @@ unsigned int Slider::drawText(Form* form, const Rectangle& clip)
 
         SpriteBatch* batch = _font->getSpriteBatch(fontSize);
         startBatch(form, batch);
-        _font->drawText(_valueText.c_str(), _textBounds, _textColor, fontSize, _valueTextAlignment, true, getTextRightToLeft(state), _viewportClipBounds);
+        _valueTextLayout.set(_font, _valueText.c_str(), _textBounds, fontSize, _valueTextAlignment, true, getTextRightToLeft(state));
+        _valueTextLayout.draw(_textColor, _viewportClipBounds);
         finishBatch(form, batch);
 
         ++drawCalls;
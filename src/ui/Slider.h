@@ -303,6 +303,11 @@ private:
      */
     std::string _valueText;
 
+    /**
+     * The layout of the value text.
+     */
+    TextLayout _valueTextLayout;
+
     float _trackHeight;
 
     float _gamepadValue;
@@ -386,7 +386,8 @@ unsigned int TextBox::drawText(Form* form, const Rectangle& clip)
 
         SpriteBatch* batch = _font->getSpriteBatch(fontSize);
         startBatch(form, batch);
-        _font->drawText(displayedText.c_str(), _textBounds, _textColor, fontSize, getTextAlignment(state), true, getTextRightToLeft(state), _viewportClipBounds);
+        _textLayout.set(_font, displayedText.c_str(), _textBounds, fontSize, getTextAlignment(state), true, getTextRightToLeft(state));
+        _textLayout.draw(_textColor, _viewportClipBounds);
         finishBatch(form, batch);
 
         return 1;
@@ -424,8 +425,8 @@ void TextBox::setCaretLocation(int x, int y)
     if (index == -1)
     {
         // Attempt to find the nearest valid caret location.
-        Rectangle textBounds;
-        font->measureText(displayedText.c_str(), _textBounds, fontSize, &textBounds, textAlignment, true, true);
+        _textLayout.set(font, displayedText.c_str(), _textBounds, fontSize, textAlignment, true, rightToLeft);
+        const Rectangle textBounds = _textLayout.getTextBounds();
 
         if (point.x > textBounds.x + textBounds.width &&
             point.y > textBounds.y + textBounds.height)
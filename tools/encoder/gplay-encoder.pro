@@ -77,7 +77,6 @@ SOURCES += src/Mesh.cpp \
     src/Camera.cpp \
     src/Constants.cpp \
     src/Curve.cpp \
-    src/edtaa3func.c \
     src/Effect.cpp \
     src/EncoderArguments.cpp \
     src/FBXSceneEncoder.cpp \
@@ -100,6 +99,7 @@ SOURCES += src/Mesh.cpp \
     src/Node.cpp \
     src/NormalMapGenerator.cpp \
     src/Object.cpp \
+    src/PropertiesCompiler.cpp \
     src/Quaternion.cpp \
     src/Reference.cpp \
     src/ReferenceTable.cpp \
@@ -126,7 +126,6 @@ HEADERS += src/AnimationChannel.h \
     src/Constants.h \
     src/Curve.h \
     src/Curve.inl \
-    src/edtaa3func.h \
     src/Effect.h \
     src/EncoderArguments.h \
     src/FBXSceneEncoder.h \
@@ -150,6 +149,7 @@ HEADERS += src/AnimationChannel.h \
     src/Node.h \
     src/NormalMapGenerator.h \
     src/Object.h \
+    src/PropertiesCompiler.h \
     src/Quaternion.h \
     src/Quaternion.inl \
     src/Reference.h \
@@ -48,7 +48,7 @@ using std::endl;
 
 // PNG
 #include <png/png.h>
-#include "edtaa3func.h"
+#include <edtaa3func/edtaa3func.h>
 
 // Defines
 #ifndef M_1_PI        
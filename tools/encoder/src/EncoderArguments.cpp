@@ -27,6 +27,8 @@ EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontFormat(Font::BITMAP),
     _textOutput(false),
     _optimizeAnimations(false),
+    _optimizeMeshes(false),
+    _quantizeMeshes(false),
     _animationGrouping(ANIMATIONGROUP_PROMPT),
     _outputMaterial(false),
     _generateTextureGutter(false)
@@ -119,6 +121,12 @@ std::string EncoderArguments::getOutputFileExtension() const
     {
     case FILEFORMAT_TMX:
         return ".scene";
+    case FILEFORMAT_PROPERTIES:
+        {
+            // Keep the input extension, the compiled file replaces the text one when packaged.
+            size_t pos = _filePath.find_last_of('.');
+            return _filePath.substr(pos) + ".bin";
+        }
     case FILEFORMAT_PNG:
     case FILEFORMAT_RAW:
         if (_normalMap)
@@ -256,6 +264,8 @@ void EncoderArguments::printUsage() const
     "Supported file extensions:\n" \
     "  .fbx\t(FBX scenes)\n" \
     "  .ttf\t(TrueType fonts)\n" \
+    "  .material, .scene, .form, .physics, .theme, .properties...\n" \
+    "  \t(Properties files, compiled to the binary form loaded by the engine)\n" \
     "\n" \
     "General options:\n" \
     "  -v <verbosity>\tVerbosity level (0-4).\n" \
@@ -276,6 +286,16 @@ void EncoderArguments::printUsage() const
         "\t\tremoving any channels that contain default/identity values\n" \
         "\t\tand removing any duplicate contiguous keyframes, which are \n" \
         "\t\tcommon when exporting baked animation data.\n" \
+    "  -om\n" \
+        "\t\tOptimizes meshes by reordering triangles for the vertex cache\n" \
+        "\t\tand to reduce overdraw, and vertices in the order they are used.\n" \
+    "  -oq\n" \
+        "\t\tQuantizes mesh vertices, writing normals, tangents and binormals\n" \
+        "\t\tas 16-bit normalized integers, texture coordinates and positions\n" \
+        "\t\tas half floats (positions of meshes far from their origin are\n" \
+        "\t\tkept as floats). Half float vertex attributes need renderer\n" \
+        "\t\tsupport (BGFX_CAPS_VERTEX_ATTRIB_HALF), other renderers convert\n" \
+        "\t\tthem to floats when loading the meshes.\n" \
     "  -h <size> \"<node ids>\" <filename>\n" \
         "\t\tGenerates a single heightmap image using meshes from the \n" \
         "\t\tspecified nodes. \n" \
@@ -334,6 +354,16 @@ bool EncoderArguments::optimizeAnimationsEnabled() const
     return _optimizeAnimations;
 }
 
+bool EncoderArguments::optimizeMeshesEnabled() const
+{
+    return _optimizeMeshes;
+}
+
+bool EncoderArguments::quantizeMeshesEnabled() const
+{
+    return _quantizeMeshes;
+}
+
 bool EncoderArguments::outputMaterialEnabled() const
 {
     return _outputMaterial;
@@ -403,6 +433,13 @@ EncoderArguments::FileFormat EncoderArguments::getFileFormat() const
     {
         return FILEFORMAT_RAW;
     }
+    if (ext.compare("material") == 0 || ext.compare("scene") == 0 || ext.compare("form") == 0 ||
+        ext.compare("physics") == 0 || ext.compare("theme") == 0 || ext.compare("properties") == 0 ||
+        ext.compare("config") == 0 || ext.compare("particle") == 0 || ext.compare("terrain") == 0 ||
+        ext.compare("animation") == 0 || ext.compare("audio") == 0 || ext.compare("atlas") == 0)
+    {
+        return FILEFORMAT_PROPERTIES;
+    }
 
     return FILEFORMAT_UNKNOWN;
 }
@@ -471,6 +508,16 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
             // Optimize animations
             _optimizeAnimations = true;
         }
+        else if (str == "-om")
+        {
+            // Optimize meshes
+            _optimizeMeshes = true;
+        }
+        else if (str == "-oq")
+        {
+            // Quantize mesh vertices
+            _quantizeMeshes = true;
+        }
         break;
     case 'h':
         {
@@ -24,7 +24,8 @@ public:
         FILEFORMAT_OTF,
         FILEFORMAT_GPB,
         FILEFORMAT_PNG,
-        FILEFORMAT_RAW
+        FILEFORMAT_RAW,
+        FILEFORMAT_PROPERTIES
     };
 
     struct HeightmapOption
@@ -174,6 +175,10 @@ public:
 
     bool optimizeAnimationsEnabled() const;
 
+    bool optimizeMeshesEnabled() const;
+
+    bool quantizeMeshesEnabled() const;
+
     bool outputMaterialEnabled() const;
 
     bool generateTextureGutter() const;
@@ -222,6 +227,8 @@ private:
     Font::FontFormat _fontFormat;
     bool _textOutput;
     bool _optimizeAnimations;
+    bool _optimizeMeshes;
+    bool _quantizeMeshes;
     AnimationGroupOption _animationGrouping;
     bool _outputMaterial;
     bool _generateTextureGutter;
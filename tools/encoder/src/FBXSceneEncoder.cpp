@@ -11,6 +11,9 @@ using std::vector;
 using std::map;
 using std::ostringstream;
 
+// Field of view in degrees used to convert LOD group distance thresholds to screen sizes
+#define LOD_REFERENCE_FIELD_OF_VIEW 45.0f
+
 namespace gplayencoder {
 
 // Fix bad material names
@@ -491,6 +494,7 @@ Node* FBXSceneEncoder::loadNode(FbxNode* fbxNode)
     loadCamera(fbxNode, node);
     loadLight(fbxNode, node);
     loadModel(fbxNode, node);
+    const bool lodGroup = loadLodGroup(fbxNode, node);
 
     if (fbxNode->GetSkeleton())
     {
@@ -499,8 +503,8 @@ Node* FBXSceneEncoder::loadNode(FbxNode* fbxNode)
         node->setIsJoint(true);
     }
 
-    // Load child nodes
-    const int childCount = fbxNode->GetChildCount();
+    // Load child nodes, the children of a LOD group are its levels and were merged into the node model
+    const int childCount = lodGroup ? 0 : fbxNode->GetChildCount();
     for (int i = 0; i < childCount; ++i)
     {
         Node* child = loadNode(fbxNode->GetChild(i));
@@ -875,6 +879,95 @@ void FBXSceneEncoder::loadModel(FbxNode* fbxNode, Node* node)
     }
 }
 
+bool FBXSceneEncoder::loadLodGroup(FbxNode* fbxNode, Node* node)
+{
+    FbxLODGroup* fbxLodGroup = fbxNode->GetLodGroup();
+    if (!fbxLodGroup || node->getModel() || fbxNode->GetChildCount() == 0)
+    {
+        return false;
+    }
+
+    // The first level is the model itself
+    FbxNode* baseNode = fbxNode->GetChild(0);
+    FbxMesh* baseMesh = baseNode->GetMesh();
+    if (!baseMesh || baseMesh->GetPolygonVertexCount() == 0 || !baseMesh->IsTriangleMesh())
+    {
+        return false;
+    }
+    loadModel(baseNode, node);
+    Model* model = node->getModel();
+    if (!model)
+    {
+        return false;
+    }
+    // Materials are looked up by FBX node, let the first level resolve to this node
+    _nodeMap[baseNode] = node;
+
+    if (model->getSkin())
+    {
+        LOG(1, "Warning: Levels of detail are not supported on skinned mesh '%s'.\n", model->getMesh()->getId().c_str());
+        return true;
+    }
+
+    Mesh* mesh = model->getMesh();
+    mesh->computeBounds();
+    const bool percentage = fbxLodGroup->ThresholdsUsedAsPercentage.Get();
+    if (!percentage)
+    {
+        LOG(1, "Warning: LOD group '%s' uses distance thresholds, converting to screen sizes for a %.0f degrees field of view.\n",
+            fbxNode->GetName(), LOD_REFERENCE_FIELD_OF_VIEW);
+    }
+
+    const int childCount = fbxNode->GetChildCount();
+    for (int i = 1; i < childCount; ++i)
+    {
+        FbxNode* levelNode = fbxNode->GetChild(i);
+        FbxMesh* levelMesh = levelNode->GetMesh();
+        if (!levelMesh || levelMesh->GetPolygonVertexCount() == 0 || !levelMesh->IsTriangleMesh())
+        {
+            LOG(1, "Warning: Skipping level %d of LOD group '%s' which has no triangle mesh.\n", i, fbxNode->GetName());
+            continue;
+        }
+        if (levelMesh->GetDeformerCount(FbxDeformer::eSkin) > 0)
+        {
+            LOG(1, "Warning: Skipping skinned level %d of LOD group '%s'.\n", i, fbxNode->GetName());
+            continue;
+        }
+
+        // Threshold i - 1 is the switch distance or screen percentage from level i - 1 to level i
+        float screenSize = 0.0f;
+        if (i - 1 < fbxLodGroup->GetNumThresholds())
+        {
+            if (percentage)
+            {
+                FbxDouble threshold;
+                if (fbxLodGroup->GetThreshold(i - 1, threshold))
+                {
+                    screenSize = (float)threshold * 0.01f;
+                }
+            }
+            else
+            {
+                FbxDistance threshold;
+                if (fbxLodGroup->GetThreshold(i - 1, threshold) && threshold.value() > 0.0f)
+                {
+                    const float cotHalfFov = 1.0f / tan(LOD_REFERENCE_FIELD_OF_VIEW * 0.5f * MATH_PI / 180.0f);
+                    screenSize = mesh->bounds.radius * cotHalfFov / threshold.value();
+                }
+            }
+        }
+
+        Mesh* lodMesh = loadMesh(levelMesh);
+        if (lodMesh->parts.size() != mesh->parts.size())
+        {
+            LOG(1, "Warning: Skipping level %d of LOD group '%s' whose mesh part count differs from the first level.\n", i, fbxNode->GetName());
+            continue;
+        }
+        model->addLod(lodMesh, screenSize);
+    }
+    return true;
+}
+
 void FBXSceneEncoder::loadMaterials(FbxScene* fbxScene)
 {
     FbxNode* rootNode = fbxScene->GetRootNode();
@@ -133,6 +133,18 @@ private:
      */
     void loadModel(FbxNode* fbxNode, Node* node);
 
+    /**
+     * Loads the levels of detail of the given FBX LOD group node into a model on the given GamePlay node.
+     *
+     * The first level child gives the model mesh and the following level children are added as levels of detail.
+     *
+     * @param fbxNode The FBX node to load from.
+     * @param node The GamePlay node to add the model to.
+     *
+     * @return True if the FBX node was a LOD group and its level children were consumed, false otherwise.
+     */
+    bool loadLodGroup(FbxNode* fbxNode, Node* node);
+
     /**
      * Loads materials for each node in the scene.
      */
@@ -326,6 +326,24 @@ void GPBFile::adjust()
         optimizeAnimations();
     }
 
+    if (EncoderArguments::getInstance()->optimizeMeshesEnabled())
+    {
+        LOG(1, "Optimizing meshes.\n");
+        for (std::list<Mesh*>::const_iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+        {
+            (*i)->optimize();
+        }
+    }
+
+    if (EncoderArguments::getInstance()->quantizeMeshesEnabled())
+    {
+        LOG(1, "Quantizing meshes.\n");
+        for (std::list<Mesh*>::const_iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+        {
+            (*i)->quantize();
+        }
+    }
+
     // TODO:
     // remove ambient _lights
     // for each node
@@ -395,6 +413,10 @@ void GPBFile::computeBounds(Node* node)
         {
             mesh->computeBounds();
         }
+        for (unsigned int i = 0; i < model->getLodCount(); ++i)
+        {
+            model->getLodMesh(i)->computeBounds();
+        }
     }
 }
 
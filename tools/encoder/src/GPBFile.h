@@ -21,7 +21,7 @@ namespace gplayencoder
  * Increment the version number when making a change that break binary compatibility.
  * [0] is major, [1] is minor.
  */
-const unsigned char GPB_VERSION[2] = {1, 5};
+const unsigned char GPB_VERSION[2] = {1, 7};
 
 /**
  * The GamePlay Binary file class handles writing the GamePlay Binary file.
@@ -1,7 +1,6 @@
 #include "Material.h"
 #include "FileIO.h"
 #include "StringUtil.h"
-#include "edtaa3func.h"
 
 namespace gplayencoder
 {
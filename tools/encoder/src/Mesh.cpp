@@ -2,9 +2,86 @@
 #include "Mesh.h"
 #include "Model.h"
 
+// Positions are quantized when the largest coordinate is at most this ratio of the mesh size
+#define QUANTIZE_POSITION_RANGE_MAX 2.0f
+
 namespace gplayencoder
 {
 
+static unsigned short floatToHalf(float value)
+{
+    union
+    {
+        float f;
+        unsigned int u;
+    } bits;
+    bits.f = value;
+
+    const unsigned int sign = (bits.u >> 16) & 0x8000;
+    const int exponent = (int)((bits.u >> 23) & 0xff) - 127 + 15;
+    unsigned int mantissa = bits.u & 0x7fffff;
+    if (((bits.u >> 23) & 0xff) == 0xff)
+    {
+        // Infinity or NaN
+        return (unsigned short)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    if (exponent <= 0)
+    {
+        // Denormalized half or zero
+        if (exponent < -10)
+        {
+            return (unsigned short)sign;
+        }
+        mantissa = (mantissa | 0x800000) >> (1 - exponent);
+        return (unsigned short)(sign | ((mantissa + 0x1000) >> 13));
+    }
+    if (exponent >= 31)
+    {
+        // Overflow to infinity
+        return (unsigned short)(sign | 0x7c00);
+    }
+    // Round to nearest, a carry into the exponent gives the next power of two
+    return (unsigned short)((sign | (exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+static unsigned short floatToSnorm16(float value)
+{
+    value = std::max(-1.0f, std::min(1.0f, value));
+    return (unsigned short)(short)floor(value * 32767.0f + 0.5f);
+}
+
+static void writeHalf(const float* values, unsigned int count, unsigned int size, float fill, FILE* file)
+{
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        write(floatToHalf(i < count ? values[i] : fill), file);
+    }
+}
+
+static void writeSnorm16(const float* values, unsigned int count, unsigned int size, FILE* file)
+{
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        write(floatToSnorm16(i < count ? values[i] : 0.0f), file);
+    }
+}
+
+static void writeElementBinary(const VertexElement& element, const float* values, unsigned int count, float fill, FILE* file)
+{
+    switch (element.type)
+    {
+    case VertexElement::HALF:
+        writeHalf(values, count, element.size, fill, file);
+        break;
+    case VertexElement::INT16:
+        writeSnorm16(values, count, element.size, file);
+        break;
+    default: // FLOAT
+        write(values, count, file);
+        break;
+    }
+}
+
 Mesh::Mesh(void) : model(NULL)
 {
 }
@@ -40,7 +117,51 @@ void Mesh::writeBinary(FILE* file)
 
 void Mesh::writeBinaryVertices(FILE* file)
 {
-    if (vertices.size() > 0)
+    if (vertices.size() > 0 && isQuantized())
+    {
+        unsigned int vertexByteSize = 0;
+        for (std::vector<VertexElement>::const_iterator i = _vertexFormat.begin(); i != _vertexFormat.end(); ++i)
+        {
+            vertexByteSize += i->byteSize();
+        }
+        write((unsigned int)(vertices.size() * vertexByteSize), file);
+
+        // Vertex elements are in the order written by Vertex::writeBinary()
+        for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+        {
+            for (std::vector<VertexElement>::const_iterator e = _vertexFormat.begin(); e != _vertexFormat.end(); ++e)
+            {
+                switch (e->usage)
+                {
+                case POSITION:
+                    writeElementBinary(*e, &i->position.x, Vertex::POSITION_COUNT, 1.0f, file);
+                    break;
+                case NORMAL:
+                    writeElementBinary(*e, &i->normal.x, Vertex::NORMAL_COUNT, 0.0f, file);
+                    break;
+                case TANGENT:
+                    writeElementBinary(*e, &i->tangent.x, Vertex::TANGENT_COUNT, 0.0f, file);
+                    break;
+                case BINORMAL:
+                    writeElementBinary(*e, &i->binormal.x, Vertex::BINORMAL_COUNT, 0.0f, file);
+                    break;
+                case COLOR:
+                    writeElementBinary(*e, &i->diffuse.x, Vertex::DIFFUSE_COUNT, 0.0f, file);
+                    break;
+                case BLENDWEIGHTS:
+                    writeElementBinary(*e, &i->blendWeights.x, Vertex::BLEND_WEIGHTS_COUNT, 0.0f, file);
+                    break;
+                case BLENDINDICES:
+                    writeElementBinary(*e, &i->blendIndices.x, Vertex::BLEND_INDICES_COUNT, 0.0f, file);
+                    break;
+                default: // TEXCOORD0 to TEXCOORD7
+                    writeElementBinary(*e, &i->texCoord[e->usage - TEXCOORD0].x, Vertex::TEXCOORD_COUNT, 0.0f, file);
+                    break;
+                }
+            }
+        }
+    }
+    else if (vertices.size() > 0)
     {
         // Assumes that all vertices are the same size.
         // Write the number of bytes for the vertex data
@@ -166,6 +287,18 @@ unsigned int Mesh::getVertexIndex(const Vertex& vertex)
     return it->second;
 }
 
+bool Mesh::isQuantized() const
+{
+    for (std::vector<VertexElement>::const_iterator i = _vertexFormat.begin(); i != _vertexFormat.end(); ++i)
+    {
+        if (i->type != VertexElement::FLOAT)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool Mesh::hasNormals() const
 {
     return !vertices.empty() && vertices[0].hasNormal;
@@ -230,4 +363,118 @@ void Mesh::computeBounds()
     bounds.radius = sqrt(bounds.radius);
 }
 
+void Mesh::optimize()
+{
+    LOG(2, "Optimizing mesh: %s\n", getId().c_str());
+
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->optimizeVertexCache((unsigned int)vertices.size());
+        (*i)->optimizeOverdraw(vertices);
+    }
+    optimizeVertexFetch();
+}
+
+void Mesh::optimizeVertexFetch()
+{
+    // Number the vertices in the order they are first referenced
+    const unsigned int unused = (unsigned int)-1;
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    unsigned int vertexCount = 0;
+    for (std::vector<MeshPart*>::const_iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        const MeshPart* part = *i;
+        for (unsigned int j = 0, count = (unsigned int)part->getIndicesCount(); j < count; ++j)
+        {
+            const unsigned int index = part->getIndex(j);
+            if (remap[index] == unused)
+            {
+                remap[index] = vertexCount++;
+            }
+        }
+    }
+    if (vertexCount == 0)
+    {
+        return;
+    }
+
+    std::vector<Vertex> optimizedVertices(vertexCount);
+    for (unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        if (remap[i] != unused)
+        {
+            optimizedVertices[remap[i]] = vertices[i];
+        }
+    }
+    vertices.swap(optimizedVertices);
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->remapIndices(remap);
+    }
+
+    vertexLookupTable.clear();
+    for (unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        vertexLookupTable[vertices[i]] = i;
+    }
+}
+
+void Mesh::quantize()
+{
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    // Half floats have 11 bits of precision, keep float positions for meshes far from their origin
+    Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+    {
+        min.set(std::min(min.x, i->position.x), std::min(min.y, i->position.y), std::min(min.z, i->position.z));
+        max.set(std::max(max.x, i->position.x), std::max(max.y, i->position.y), std::max(max.z, i->position.z));
+    }
+    const float range = std::max(std::max(fabs(min.x), fabs(min.y)), std::max(std::max(fabs(min.z), fabs(max.x)), std::max(fabs(max.y), fabs(max.z))));
+    const float size = std::max(std::max(max.x - min.x, max.y - min.y), max.z - min.z);
+    const bool quantizePosition = range <= size * QUANTIZE_POSITION_RANGE_MAX && range < 65504.0f;
+    if (!quantizePosition)
+    {
+        LOG(2, "Keeping float positions for mesh: %s\n", getId().c_str());
+    }
+
+    // Sizes are rounded up to 4 components since 3 component 16-bit attributes are not supported by all renderers
+    for (std::vector<VertexElement>::iterator i = _vertexFormat.begin(); i != _vertexFormat.end(); ++i)
+    {
+        switch (i->usage)
+        {
+        case POSITION:
+            if (quantizePosition)
+            {
+                i->type = VertexElement::HALF;
+                i->size = 4;
+            }
+            break;
+        case NORMAL:
+        case TANGENT:
+        case BINORMAL:
+            i->type = VertexElement::INT16;
+            i->normalized = true;
+            i->size = 4;
+            break;
+        case TEXCOORD0:
+        case TEXCOORD1:
+        case TEXCOORD2:
+        case TEXCOORD3:
+        case TEXCOORD4:
+        case TEXCOORD5:
+        case TEXCOORD6:
+        case TEXCOORD7:
+            i->type = VertexElement::HALF;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 }
@@ -63,8 +63,32 @@ public:
     bool hasNormals() const;
     bool hasVertexColors() const;
 
+    /**
+     * Returns true if some vertex elements are not written as floats.
+     */
+    bool isQuantized() const;
+
     void computeBounds();
 
+    /**
+     * Reorders the triangles of each part for the vertex cache and for overdraw, then reorders the vertices
+     * in the order they are first used by the parts for vertex fetch locality.
+     */
+    void optimize();
+
+    /**
+     * Reorders the vertices in the order they are first used by the parts and removes the unused ones.
+     */
+    void optimizeVertexFetch();
+
+    /**
+     * Quantizes the vertex data written to the bundle.
+     *
+     * Normals, tangents and binormals are written as normalized 16-bit integers and texture coordinates as half floats.
+     * Positions are written as half floats unless the precision of a half float is too low for the size of the mesh.
+     */
+    void quantize();
+
     Model* model;
     std::vector<Vertex> vertices;
     std::vector<MeshPart*> parts;
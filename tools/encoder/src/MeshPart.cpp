@@ -1,9 +1,53 @@
 #include "Base.h"
 #include "MeshPart.h"
 
+// Size of the simulated post-transform vertex cache
+#define VERTEX_CACHE_SIZE 32
+
+// Scoring constants of the Forsyth vertex cache optimisation
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+// Size of the FIFO cache simulated to split triangles in clusters and minimum number of triangles per cluster
+#define OVERDRAW_CACHE_SIZE 16
+#define OVERDRAW_CLUSTER_SIZE_MIN 16
+
+// Maximum ratio of the cache miss rate of a cluster to the one of the part
+#define OVERDRAW_THRESHOLD 1.05f
+
 namespace gplayencoder
 {
 
+static float getVertexCacheScore(int cachePosition, unsigned int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+    {
+        // No triangle left to draw with this vertex
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // The vertex was used by the last triangle, a fixed score avoids favouring strips too much
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            const float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            score = pow(1.0f - (cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Boost vertices with few triangles left so that isolated triangles are not left behind
+    score += FORSYTH_VALENCE_BOOST_SCALE * pow((float)remainingTriangles, -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
 MeshPart::MeshPart(void) :
     _primitiveType(TRIANGLES),
     _indexFormat(INDEX16)
@@ -86,6 +130,251 @@ unsigned int MeshPart::getIndex(unsigned int i) const
     return _indices[i];
 }
 
+void MeshPart::optimizeVertexCache(unsigned int vertexCount)
+{
+    if (_primitiveType != TRIANGLES || _indices.size() < 6)
+    {
+        return;
+    }
+    const unsigned int triangleCount = (unsigned int)_indices.size() / 3;
+
+    // Build the list of triangles using each vertex
+    std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+    for (std::vector<unsigned int>::const_iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        remainingTriangles[*i]++;
+    }
+    std::vector<unsigned int> triangleOffsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        triangleOffsets[v + 1] = triangleOffsets[v] + remainingTriangles[v];
+    }
+    std::vector<unsigned int> vertexTriangles(_indices.size());
+    std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+    for (unsigned int t = 0; t < triangleCount; ++t)
+    {
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            const unsigned int v = _indices[t * 3 + k];
+            vertexTriangles[fill[v]++] = t;
+        }
+    }
+
+    // Initial scores
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        vertexScores[v] = getVertexCacheScore(-1, remainingTriangles[v]);
+    }
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> newCache;
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    newCache.reserve(VERTEX_CACHE_SIZE + 3);
+
+    std::vector<unsigned int> indices;
+    indices.reserve(_indices.size());
+    unsigned int nextTriangle = 0;
+    int bestTriangle = -1;
+    for (unsigned int emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (bestTriangle < 0)
+        {
+            // No triangle uses a cached vertex, continue from the first triangle not drawn yet
+            while (emitted[nextTriangle])
+            {
+                nextTriangle++;
+            }
+            bestTriangle = (int)nextTriangle;
+        }
+
+        // Draw the triangle and remove it from the lists of its vertices
+        const unsigned int* triangle = &_indices[bestTriangle * 3];
+        emitted[bestTriangle] = true;
+        newCache.clear();
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            const unsigned int v = triangle[k];
+            indices.push_back(v);
+            newCache.push_back(v);
+
+            unsigned int* begin = &vertexTriangles[triangleOffsets[v]];
+            unsigned int* end = begin + remainingTriangles[v];
+            unsigned int* it = std::find(begin, end, (unsigned int)bestTriangle);
+            std::swap(*it, *(end - 1));
+            remainingTriangles[v]--;
+        }
+
+        // Move the vertices of the triangle to the front of the cache
+        for (std::vector<unsigned int>::const_iterator i = cache.begin(); i != cache.end(); ++i)
+        {
+            if (*i != triangle[0] && *i != triangle[1] && *i != triangle[2])
+            {
+                newCache.push_back(*i);
+            }
+        }
+        cache.swap(newCache);
+
+        // Update the scores of the vertices in the cache and of the ones pushed out of it
+        for (unsigned int c = 0; c < cache.size(); ++c)
+        {
+            const unsigned int v = cache[c];
+            cachePositions[v] = c < VERTEX_CACHE_SIZE ? (int)c : -1;
+            vertexScores[v] = getVertexCacheScore(cachePositions[v], remainingTriangles[v]);
+        }
+
+        // Score the triangles using these vertices and pick the best one
+        float bestScore = -1.0f;
+        bestTriangle = -1;
+        for (unsigned int c = 0; c < cache.size(); ++c)
+        {
+            const unsigned int v = cache[c];
+            for (unsigned int j = 0; j < remainingTriangles[v]; ++j)
+            {
+                const unsigned int t = vertexTriangles[triangleOffsets[v] + j];
+                const float score = vertexScores[_indices[t * 3]] + vertexScores[_indices[t * 3 + 1]] + vertexScores[_indices[t * 3 + 2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = (int)t;
+                }
+            }
+        }
+        if (cache.size() > VERTEX_CACHE_SIZE)
+        {
+            cache.resize(VERTEX_CACHE_SIZE);
+        }
+    }
+    _indices.swap(indices);
+}
+
+void MeshPart::optimizeOverdraw(const std::vector<Vertex>& vertices)
+{
+    if (_primitiveType != TRIANGLES || _indices.size() < OVERDRAW_CLUSTER_SIZE_MIN * 6)
+    {
+        return;
+    }
+    const unsigned int triangleCount = (unsigned int)_indices.size() / 3;
+
+    // Simulate a FIFO cache to find the triangles starting a new region of the mesh
+    std::vector<unsigned int> misses(triangleCount, 0);
+    std::vector<unsigned int> cache(OVERDRAW_CACHE_SIZE, (unsigned int)-1);
+    unsigned int cacheHead = 0;
+    unsigned int missCount = 0;
+    for (unsigned int t = 0; t < triangleCount; ++t)
+    {
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            const unsigned int v = _indices[t * 3 + k];
+            if (std::find(cache.begin(), cache.end(), v) == cache.end())
+            {
+                cache[cacheHead] = v;
+                cacheHead = (cacheHead + 1) % OVERDRAW_CACHE_SIZE;
+                misses[t]++;
+            }
+        }
+        missCount += misses[t];
+    }
+    const float acmr = (float)missCount / triangleCount;
+
+    // Split clusters at such triangles once the cluster vertex cache efficiency is close to the whole part one
+    std::vector<unsigned int> clusters;
+    clusters.push_back(0);
+    unsigned int clusterMisses = 0;
+    for (unsigned int t = 0; t < triangleCount; ++t)
+    {
+        const unsigned int clusterSize = t - clusters.back();
+        if (misses[t] >= 2 && clusterSize >= OVERDRAW_CLUSTER_SIZE_MIN && clusterMisses <= acmr * OVERDRAW_THRESHOLD * clusterSize)
+        {
+            clusters.push_back(t);
+            clusterMisses = 0;
+        }
+        clusterMisses += misses[t];
+    }
+    if (clusters.size() < 2)
+    {
+        return;
+    }
+    clusters.push_back(triangleCount);
+
+    // Area weighted centroid and normal of each cluster and of the whole part
+    const unsigned int clusterCount = (unsigned int)clusters.size() - 1;
+    std::vector<Vector3> clusterCentroids(clusterCount);
+    std::vector<Vector3> clusterNormals(clusterCount);
+    Vector3 centroid;
+    float area = 0.0f;
+    for (unsigned int c = 0; c < clusterCount; ++c)
+    {
+        Vector3 clusterCentroid;
+        Vector3 clusterNormal;
+        float clusterArea = 0.0f;
+        for (unsigned int t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const Vector3& p0 = vertices[_indices[t * 3]].position;
+            const Vector3& p1 = vertices[_indices[t * 3 + 1]].position;
+            const Vector3& p2 = vertices[_indices[t * 3 + 2]].position;
+            Vector3 e1, e2, normal;
+            Vector3::subtract(p1, p0, &e1);
+            Vector3::subtract(p2, p0, &e2);
+            Vector3::cross(e1, e2, &normal);
+            const float triangleArea = normal.length();
+            Vector3 triangleCentroid(p0);
+            triangleCentroid.add(p1);
+            triangleCentroid.add(p2);
+            triangleCentroid.scale(triangleArea / 3.0f);
+            clusterCentroid.add(triangleCentroid);
+            clusterNormal.add(normal);
+            clusterArea += triangleArea;
+        }
+        centroid.add(clusterCentroid);
+        area += clusterArea;
+        if (clusterArea > 0.0f)
+        {
+            clusterCentroid.scale(1.0f / clusterArea);
+        }
+        clusterCentroids[c] = clusterCentroid;
+        clusterNormals[c] = clusterNormal;
+    }
+    if (area <= 0.0f)
+    {
+        return;
+    }
+    centroid.scale(1.0f / area);
+
+    // Clusters facing away from the centroid are likely to occlude the others, draw them first
+    std::vector<std::pair<float, unsigned int> > order(clusterCount);
+    for (unsigned int c = 0; c < clusterCount; ++c)
+    {
+        Vector3 offset;
+        Vector3::subtract(clusterCentroids[c], centroid, &offset);
+        const float length = clusterNormals[c].length();
+        const float occlusion = length > 0.0f ? Vector3::dot(offset, clusterNormals[c]) / length : 0.0f;
+        order[c] = std::make_pair(-occlusion, c);
+    }
+    std::stable_sort(order.begin(), order.end());
+
+    std::vector<unsigned int> indices;
+    indices.reserve(_indices.size());
+    for (unsigned int i = 0; i < clusterCount; ++i)
+    {
+        const unsigned int c = order[i].second;
+        indices.insert(indices.end(), _indices.begin() + clusters[c] * 3, _indices.begin() + clusters[c + 1] * 3);
+    }
+    _indices.swap(indices);
+}
+
+void MeshPart::remapIndices(const std::vector<unsigned int>& remap)
+{
+    _indexFormat = INDEX16;
+    for (std::vector<unsigned int>::iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        *i = remap[*i];
+        updateIndexFormat(*i);
+    }
+}
+
 void MeshPart::writeBinaryIndex(unsigned int index, FILE* file)
 {
     switch (_indexFormat)
@@ -62,6 +62,31 @@ public:
      */
     unsigned int getIndex(unsigned int i) const;
 
+    /**
+     * Reorders the triangles of this part to reuse the vertices of the post-transform vertex cache,
+     * using Tom Forsyth's linear-speed vertex cache optimisation.
+     *
+     * @param vertexCount The number of vertices of the mesh.
+     */
+    void optimizeVertexCache(unsigned int vertexCount);
+
+    /**
+     * Reorders clusters of triangles of this part so that the ones facing outwards are drawn first, which reduces overdraw.
+     *
+     * Triangles should be ordered for the vertex cache first, clusters are split where the vertex cache is restarted
+     * so that the vertex cache efficiency is mostly kept.
+     *
+     * @param vertices The vertices of the mesh.
+     */
+    void optimizeOverdraw(const std::vector<Vertex>& vertices);
+
+    /**
+     * Replaces each index of this part by its value in the given table.
+     *
+     * @param remap The new index of each vertex of the mesh.
+     */
+    void remapIndices(const std::vector<unsigned int>& remap);
+
 private:
 
     /**
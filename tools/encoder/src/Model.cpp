@@ -72,6 +72,13 @@ void Model::writeBinary(FILE* file)
             }
         }
     }
+    // Write the list of levels of detail
+    write((unsigned int)_lods.size(), file);
+    for (std::vector<Lod>::const_iterator i = _lods.begin(); i != _lods.end(); ++i)
+    {
+        i->mesh->writeBinaryXref(file);
+        write(i->screenSize, file);
+    }
 }
 
 void Model::writeText(FILE* file)
@@ -98,6 +105,13 @@ void Model::writeText(FILE* file)
             fprintfElement(file, "material", mat->getId().c_str());
         }
     }
+    for (std::vector<Lod>::const_iterator i = _lods.begin(); i != _lods.end(); ++i)
+    {
+        fprintf(file, "<lod>\n");
+        fprintfElement(file, "ref", i->mesh->getId());
+        fprintfElement(file, "screenSize", i->screenSize);
+        fprintf(file, "</lod>\n");
+    }
     fprintElementEnd(file);
 }
 
@@ -152,4 +166,24 @@ void Model::setMaterial(Material* material, int partIndex)
     }
 }
 
+void Model::addLod(Mesh* mesh, float screenSize)
+{
+    assert(mesh);
+    Lod lod;
+    lod.mesh = mesh;
+    lod.screenSize = screenSize;
+    _lods.push_back(lod);
+}
+
+unsigned int Model::getLodCount() const
+{
+    return (unsigned int)_lods.size();
+}
+
+Mesh* Model::getLodMesh(unsigned int index) const
+{
+    assert(index < _lods.size());
+    return _lods[index].mesh;
+}
+
 }
@@ -34,12 +34,31 @@ public:
     void setSkin(MeshSkin* skin);
     void setMaterial(Material* material, int partIndex = -1);
 
+    /**
+     * Adds a level of detail mesh to this model.
+     *
+     * Levels must be added from the most to the least detailed one.
+     *
+     * @param mesh The mesh to use for this level.
+     * @param screenSize The projected screen size below which this level is used.
+     */
+    void addLod(Mesh* mesh, float screenSize);
+    unsigned int getLodCount() const;
+    Mesh* getLodMesh(unsigned int index) const;
+
 private:
 
+    struct Lod
+    {
+        Mesh* mesh;
+        float screenSize;
+    };
+
     Mesh* _mesh;
     MeshSkin* _meshSkin;
     std::vector<Material*> _materials;
     Material* _material;
+    std::vector<Lod> _lods;
 };
 
 }
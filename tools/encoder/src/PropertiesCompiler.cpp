@@ -0,0 +1,338 @@
+#include "Base.h"
+#include "PropertiesCompiler.h"
+#include "FileIO.h"
+
+// Version of the compiled properties files, must match the engine.
+#define PROPERTIES_BINARY_VERSION 1
+
+// Maximum length of a line, lines are split beyond it as by the engine.
+#define PROPERTIES_LINE_LENGTH 2048
+
+// Marks the root namespace, which has no parent.
+#define PROPERTIES_NO_PARENT 0xFFFFFFFF
+
+namespace gplayencoder
+{
+
+/**
+ * FNV-1a 32 bit hash of a string and its null terminator, as computed by the engine.
+ */
+static unsigned int hashString(const char* str)
+{
+    unsigned int hash = 2166136261u;
+    do
+    {
+        hash = (hash ^ (unsigned char)*str) * 16777619u;
+    }
+    while (*str++);
+    return hash;
+}
+
+static char* trimWhiteSpace(char* str)
+{
+    if (str == NULL)
+        return str;
+
+    while (isspace((unsigned char)*str))
+        str++;
+    if (*str == 0)
+        return str;
+
+    char* end = str + strlen(str) - 1;
+    while (end > str && isspace((unsigned char)*end))
+        end--;
+    *(end + 1) = 0;
+    return str;
+}
+
+/**
+ * Checks if a property name is a variable "${name}" and returns its name.
+ */
+static bool isVariable(const char* str, std::string& name)
+{
+    size_t length = strlen(str);
+    if (length > 3 && str[0] == '$' && str[1] == '{' && str[length - 1] == '}')
+    {
+        name.assign(str + 2, length - 3);
+        return true;
+    }
+    return false;
+}
+
+PropertiesCompiler::PropertiesCompiler()
+    : _position(0)
+{
+}
+
+PropertiesCompiler::~PropertiesCompiler()
+{
+}
+
+bool PropertiesCompiler::compile(const char* inputPath, const char* outputPath)
+{
+    std::ifstream file(inputPath, std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        LOG(1, "Error: Failed to open file: %s\n", inputPath);
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    _text = text.str();
+    _position = 0;
+
+    // Offset 0 of the string table is the empty string.
+    addString("");
+    addNamespace(PROPERTIES_NO_PARENT, "", NULL, NULL);
+    if (!readNamespace(0))
+    {
+        LOG(1, "Error: Failed to parse properties file: %s\n", inputPath);
+        return false;
+    }
+
+    if (!write(outputPath))
+    {
+        LOG(1, "Error: Failed to write file: %s\n", outputPath);
+        return false;
+    }
+
+    size_t propertyCount = 0;
+    for (size_t i = 0; i < _namespaces.size(); ++i)
+        propertyCount += _namespaces[i].properties.size();
+    LOG(1, "Compiled %u namespaces, %u properties and %u variables to: %s\n",
+        (unsigned int)_namespaces.size(), (unsigned int)propertyCount, (unsigned int)_variables.size(), outputPath);
+    return true;
+}
+
+unsigned int PropertiesCompiler::addNamespace(unsigned int parent, const char* name, const char* id, const char* parentID)
+{
+    Namespace space;
+    space.parent = parent;
+    space.name = addString(name);
+    space.id = addString(id ? id : "");
+    space.parentID = addString(parentID ? parentID : "");
+    _namespaces.push_back(space);
+    return (unsigned int)_namespaces.size() - 1;
+}
+
+unsigned int PropertiesCompiler::addString(const char* str)
+{
+    std::map<std::string, unsigned int>::const_iterator itr = _stringOffsets.find(str);
+    if (itr != _stringOffsets.end())
+        return itr->second;
+
+    unsigned int offset = (unsigned int)_strings.size();
+    _strings.append(str);
+    _strings.push_back('\0');
+    _stringOffsets[str] = offset;
+    return offset;
+}
+
+bool PropertiesCompiler::readNamespace(unsigned int space)
+{
+    std::string line;
+    std::string variable;
+    bool comment = false;
+
+    while (true)
+    {
+        skipWhiteSpace();
+        if (!readLine(line))
+            break;
+
+        // Parse a copy of the line, tokenized in place as by the engine.
+        std::vector<char> buffer(line.begin(), line.end());
+        buffer.push_back('\0');
+        char* text = &buffer[0];
+
+        if (comment)
+        {
+            // Check for end of multi-line comment at either start or end of line
+            if (strncmp(text, "*/", 2) == 0)
+            {
+                comment = false;
+            }
+            else
+            {
+                trimWhiteSpace(text);
+                const size_t length = strlen(text);
+                if (length >= 2 && strncmp(text + (length - 2), "*/", 2) == 0)
+                    comment = false;
+            }
+            continue;
+        }
+        if (strncmp(text, "/*", 2) == 0)
+        {
+            comment = true;
+            continue;
+        }
+        if (strncmp(text, "//", 2) == 0)
+            continue;
+
+        if (strchr(text, '=') != NULL)
+        {
+            // Name/value pair or variable assignment.
+            char* name = strtok(text, "=");
+            if (name == NULL)
+            {
+                LOG(1, "Error: Attribute without name.\n");
+                return false;
+            }
+            name = trimWhiteSpace(name);
+            char* value = strtok(NULL, "");
+            if (value == NULL)
+            {
+                LOG(1, "Error: Attribute with name ('%s') but no value.\n", name);
+                return false;
+            }
+            value = trimWhiteSpace(value);
+
+            if (isVariable(name, variable))
+            {
+                Variable v;
+                v.space = space;
+                v.name = addString(variable.c_str());
+                v.value = addString(value);
+                _variables.push_back(v);
+            }
+            else
+            {
+                _namespaces[space].properties.push_back(std::make_pair(addString(name), addString(value)));
+            }
+            continue;
+        }
+
+        // The line begins or ends a namespace, or is a name/value pair without '='.
+        const char* trimmed = trimWhiteSpace(text);
+        const char* lineEnd = trimmed + (strlen(trimmed) - 1);
+        const bool open = strchr(text, '{') != NULL;
+        const bool inherits = strchr(text, ':') != NULL;
+        const char* close = strchr(text, '}');
+
+        char* name = trimWhiteSpace(strtok(text, " \t\n{"));
+        if (name == NULL)
+        {
+            LOG(1, "Error: Failed to determine a valid token for line '%s'.\n", line.c_str());
+            return false;
+        }
+        if (name[0] == '}')
+        {
+            // End of namespace.
+            return true;
+        }
+        char* id = trimWhiteSpace(strtok(NULL, ":{"));
+        char* parentID = inherits ? trimWhiteSpace(strtok(NULL, "{")) : NULL;
+
+        if (open)
+        {
+            unsigned int child = addNamespace(space, name, id, parentID);
+
+            // A namespace closed on the same line is empty.
+            if (!(close && close == lineEnd) && !readNamespace(child))
+                return false;
+        }
+        else
+        {
+            // Find out if the next line starts with "{"
+            skipWhiteSpace();
+            if (_position < _text.size() && _text[_position] == '{')
+            {
+                ++_position;
+                unsigned int child = addNamespace(space, name, id, parentID);
+                if (!readNamespace(child))
+                    return false;
+            }
+            else
+            {
+                _namespaces[space].properties.push_back(std::make_pair(addString(name), addString(id ? id : "")));
+            }
+        }
+    }
+
+    return true;
+}
+
+void PropertiesCompiler::skipWhiteSpace()
+{
+    while (_position < _text.size() && isspace((unsigned char)_text[_position]))
+        ++_position;
+}
+
+bool PropertiesCompiler::readLine(std::string& line)
+{
+    if (_position >= _text.size())
+        return false;
+
+    size_t end = _position;
+    while (end < _text.size() && end - _position < PROPERTIES_LINE_LENGTH - 1 && _text[end] != '\n')
+        ++end;
+    if (end < _text.size() && _text[end] == '\n')
+        ++end;
+    line.assign(_text, _position, end - _position);
+    _position = end;
+    return true;
+}
+
+bool PropertiesCompiler::write(const char* outputPath) const
+{
+    FILE* file = fopen(outputPath, "wb");
+    if (!file)
+        return false;
+
+    // Header.
+    static const char identifier[] = { '\xAB', 'G', 'P', 'P', '\xBB', '\r', '\n', '\x1A', '\n' };
+    fwrite(identifier, 1, sizeof(identifier), file);
+    unsigned int propertyCount = 0;
+    for (size_t i = 0; i < _namespaces.size(); ++i)
+        propertyCount += (unsigned int)_namespaces[i].properties.size();
+    gplayencoder::write((unsigned int)PROPERTIES_BINARY_VERSION, file);
+    gplayencoder::write((unsigned int)_strings.size(), file);
+    gplayencoder::write((unsigned int)_namespaces.size(), file);
+    gplayencoder::write(propertyCount, file);
+    gplayencoder::write((unsigned int)_variables.size(), file);
+
+    // String table.
+    fwrite(_strings.data(), 1, _strings.size(), file);
+
+    // Namespaces, in creation order so that parents come first.
+    unsigned int firstProperty = 0;
+    for (size_t i = 0; i < _namespaces.size(); ++i)
+    {
+        const Namespace& space = _namespaces[i];
+        gplayencoder::write(space.parent, file);
+        gplayencoder::write(space.name, file);
+        gplayencoder::write(space.id, file);
+        gplayencoder::write(space.parentID, file);
+        gplayencoder::write(hashString(_strings.c_str() + space.name), file);
+        gplayencoder::write(hashString(_strings.c_str() + space.id), file);
+        gplayencoder::write(firstProperty, file);
+        gplayencoder::write((unsigned int)space.properties.size(), file);
+        firstProperty += (unsigned int)space.properties.size();
+    }
+
+    // Properties of each namespace.
+    for (size_t i = 0; i < _namespaces.size(); ++i)
+    {
+        const Namespace& space = _namespaces[i];
+        for (size_t j = 0; j < space.properties.size(); ++j)
+        {
+            gplayencoder::write(hashString(_strings.c_str() + space.properties[j].first), file);
+            gplayencoder::write(space.properties[j].first, file);
+            gplayencoder::write(space.properties[j].second, file);
+        }
+    }
+
+    // Variables, in the order they are assigned.
+    for (size_t i = 0; i < _variables.size(); ++i)
+    {
+        gplayencoder::write(_variables[i].space, file);
+        gplayencoder::write(_variables[i].name, file);
+        gplayencoder::write(_variables[i].value, file);
+    }
+
+    bool result = ferror(file) == 0;
+    fclose(file);
+    return result;
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef ENCODER_PROPERTIESCOMPILER_H_
+#define ENCODER_PROPERTIESCOMPILER_H_
+
+#include "Base.h"
+
+namespace gplayencoder
+{
+
+/**
+ * Compiles properties files (.material, .scene, .form, .physics, themes...) to the binary
+ * form loaded by the engine with a single read.
+ *
+ * The text is parsed with the same rules as the engine Properties parser. The compiled file
+ * contains a string table, the flat arrays of the namespaces (parents first), of their
+ * properties and of the variables assignments, and the hashes of the namespace and property
+ * names. Inheritance between namespaces is resolved by the engine when the file is loaded.
+ */
+class PropertiesCompiler
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    PropertiesCompiler();
+
+    /**
+     * Destructor.
+     */
+    ~PropertiesCompiler();
+
+    /**
+     * Compiles a properties file.
+     *
+     * @param inputPath The path of the text properties file.
+     * @param outputPath The path of the compiled file.
+     *
+     * @return True if the file was compiled, false otherwise.
+     */
+    bool compile(const char* inputPath, const char* outputPath);
+
+private:
+
+    struct Namespace
+    {
+        unsigned int parent;
+        unsigned int name;
+        unsigned int id;
+        unsigned int parentID;
+        std::vector<std::pair<unsigned int, unsigned int> > properties;
+    };
+
+    struct Variable
+    {
+        unsigned int space;
+        unsigned int name;
+        unsigned int value;
+    };
+
+    // Hidden copy/assignment
+    PropertiesCompiler(const PropertiesCompiler&);
+    PropertiesCompiler& operator=(const PropertiesCompiler&);
+
+    unsigned int addNamespace(unsigned int parent, const char* name, const char* id, const char* parentID);
+
+    unsigned int addString(const char* str);
+
+    bool readNamespace(unsigned int space);
+
+    void skipWhiteSpace();
+
+    bool readLine(std::string& line);
+
+    bool write(const char* outputPath) const;
+
+    std::string _text;
+    size_t _position;
+    std::string _strings;
+    std::map<std::string, unsigned int> _stringOffsets;
+    std::vector<Namespace> _namespaces;
+    std::vector<Variable> _variables;
+};
+
+}
+
+#endif
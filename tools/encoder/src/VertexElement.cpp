@@ -6,7 +6,9 @@ namespace gplayencoder
 
 VertexElement::VertexElement(unsigned int t, unsigned int c) :
     usage(t),
-    size(c)
+    size(c),
+    type(FLOAT),
+    normalized(false)
 {
 }
 
@@ -23,15 +25,33 @@ void VertexElement::writeBinary(FILE* file)
     Object::writeBinary(file);
     write(usage, file);
     write(size, file);
+    write((unsigned int)type, file);
+    write(normalized, file);
 }
 void VertexElement::writeText(FILE* file)
 {
     fprintElementStart(file);
     fprintfElement(file, "usage", usageStr(usage));
     fprintfElement(file, "size", size);
+    fprintfElement(file, "type", (unsigned int)type);
+    fprintfElement(file, "normalized", normalized ? "true" : "false");
     fprintElementEnd(file);
 }
 
+unsigned int VertexElement::byteSize() const
+{
+    switch (type)
+    {
+    case UINT8:
+        return size;
+    case INT16:
+    case HALF:
+        return size * 2;
+    default: // FLOAT
+        return size * 4;
+    }
+}
+
 const char* VertexElement::usageStr(unsigned int usage)
 {
     switch (usage)
@@ -10,6 +10,17 @@ class VertexElement : public Object
 {
 public:
 
+    /**
+     * Data type of the components of a vertex element, matching the runtime VertexFormat::AttribType.
+     */
+    enum AttribType
+    {
+        UINT8 = 0,
+        INT16 = 1,
+        FLOAT = 2,
+        HALF = 3
+    };
+
     /**
      * Constructor.
      */
@@ -26,8 +37,15 @@ public:
 
     static const char* usageStr(unsigned int usage);
 
+    /**
+     * Returns the size in bytes of this element.
+     */
+    unsigned int byteSize() const;
+
     unsigned int usage;
     unsigned int size;
+    AttribType type;
+    bool normalized;
 };
 
 }
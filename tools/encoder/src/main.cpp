@@ -5,6 +5,7 @@
 #include "GPBDecoder.h"
 #include "EncoderArguments.h"
 #include "NormalMapGenerator.h"
+#include "PropertiesCompiler.h"
 #include "Font.h"
 
 #define FONT_SIZE_DISTANCEFIELD 48
@@ -162,6 +163,13 @@ int main(int argc, const char** argv)
             }
             break;
         }
+    case EncoderArguments::FILEFORMAT_PROPERTIES:
+        {
+            PropertiesCompiler compiler;
+            if (!compiler.compile(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str()))
+                return -1;
+            break;
+        }
    default:
         {
             LOG(1, "Error: Unsupported file format: %s\n", arguments.getFilePathPointer());
@@ -0,0 +1,46 @@
+#--------------------------------------------------------------------
+# path to build directory (generated by cmake)
+#--------------------------------------------------------------------
+PRE_TARGETDEPS += $$PWD/../../setup.pri
+include($$PWD/../../setup.pri)
+
+#--------------------------------------------------------------------
+# project
+#--------------------------------------------------------------------
+TEMPLATE = app
+QT -= core gui
+TARGET = gplay-shaderpack
+CONFIG += c++11
+CONFIG -= qt
+CONFIG -= app_bundle
+
+DESTDIR = $$GPLAY_OUTPUT_DIR/bin
+QMAKE_CLEAN += $$DESTDIR/$$TARGET
+
+CONFIG(debug, debug|release):
+    DEFINES += _DEBUG
+
+INCLUDEPATH += $$GPLAY_OUTPUT_DIR/include/gplayengine/thirdparty
+
+#--------------------------------------------------------------------
+# platform specific
+#--------------------------------------------------------------------
+linux: {
+    DEFINES += __linux__
+    PRE_TARGETDEPS += $$GPLAY_OUTPUT_DIR/lib/libgplay-deps.a
+    LIBS += -L$$GPLAY_OUTPUT_DIR/lib/ -lgplay-deps
+
+    QMAKE_CXXFLAGS += -std=c++11 -lstdc++ -pthread -w
+    LIBS += -lGL -lstdc++ -ldl -lX11 -lpthread
+}
+
+#--------------------------------------------------------------------
+# files
+#--------------------------------------------------------------------
+SOURCES += src/main.cpp \
+    src/MaterialParser.cpp \
+    src/ShaderArchive.cpp
+
+HEADERS += src/Base.h \
+    src/MaterialParser.h \
+    src/ShaderArchive.h
@@ -0,0 +1,42 @@
+#ifndef SHADERPACK_BASE_H_
+#define SHADERPACK_BASE_H_
+
+// C++ includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <sys/stat.h>
+
+#if defined(WIN32)
+    #include <windows.h>
+    #pragma warning( disable : 4996 )
+#else
+    #include <dirent.h>
+#endif
+
+// bgfx
+#include <bgfx/bgfx.h>
+#include <brtshaderc/brtshaderc.h>
+
+// Object deletion macro
+#define SAFE_DELETE(x) \
+    { \
+        delete x; \
+        x = NULL; \
+    }
+
+// Array deletion macro
+#define SAFE_DELETE_ARRAY(x) \
+    { \
+        delete[] x; \
+        x = NULL; \
+    }
+
+#endif
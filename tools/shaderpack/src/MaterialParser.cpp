@@ -0,0 +1,284 @@
+#include "MaterialParser.h"
+
+// Maximum depth of namespace inheritance, deeper chains are assumed to be cyclic.
+#define MAX_INHERITANCE_DEPTH 16
+
+namespace gplayshaderpack
+{
+
+static std::string trim(const std::string& str)
+{
+    size_t first = 0;
+    size_t last = str.size();
+    while (first < last && isspace((unsigned char)str[first]))
+        ++first;
+    while (last > first && isspace((unsigned char)str[last - 1]))
+        --last;
+    return str.substr(first, last - first);
+}
+
+/**
+ * Splits a namespace declaration "type [id] [: parentId]".
+ */
+static void parseDeclaration(const std::string& line, std::string& type, std::string& id, std::string& parentId)
+{
+    std::string declaration = line;
+    size_t colon = declaration.find(':');
+    if (colon != std::string::npos)
+    {
+        parentId = trim(declaration.substr(colon + 1));
+        declaration = declaration.substr(0, colon);
+    }
+    declaration = trim(declaration);
+
+    size_t space = declaration.find_first_of(" \t");
+    type = declaration.substr(0, space);
+    id = space != std::string::npos ? trim(declaration.substr(space)) : "";
+}
+
+MaterialParser::Namespace::~Namespace()
+{
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+        SAFE_DELETE(children[i]);
+    }
+}
+
+const char* MaterialParser::Namespace::getProperty(const char* name) const
+{
+    for (size_t i = 0; i < properties.size(); ++i)
+    {
+        if (properties[i].first == name)
+            return properties[i].second.c_str();
+    }
+    return NULL;
+}
+
+bool MaterialParser::parse(const char* path, std::vector<Permutation>& permutations)
+{
+    Namespace root;
+    if (!read(path, &root))
+        return false;
+
+    for (size_t i = 0; i < root.children.size(); ++i)
+    {
+        Namespace* material = resolve(&root, root.children[i], 0);
+        if (!material || material->type != "material")
+            continue;
+
+        for (size_t j = 0; j < material->children.size(); ++j)
+        {
+            Namespace* technique = resolve(&root, material->children[j], 0);
+            if (!technique || technique->type != "technique")
+                continue;
+
+            for (size_t k = 0; k < technique->children.size(); ++k)
+            {
+                Namespace* pass = resolve(&root, technique->children[k], 0);
+                if (!pass || pass->type != "pass")
+                    continue;
+
+                const char* vertexShader = pass->getProperty("vertexShader");
+                const char* fragmentShader = pass->getProperty("fragmentShader");
+                if (!vertexShader || !fragmentShader)
+                {
+                    fprintf(stderr, "Warning: pass '%s' of material '%s' in '%s' has no shaders.\n", pass->id.c_str(), material->id.c_str(), path);
+                    continue;
+                }
+
+                const char* defines = pass->getProperty("defines");
+                Permutation permutation;
+                permutation.vertexShader = vertexShader;
+                permutation.fragmentShader = fragmentShader;
+                permutation.defines = defines ? defines : "";
+                permutations.push_back(permutation);
+            }
+        }
+    }
+    return true;
+}
+
+bool MaterialParser::read(const char* path, Namespace* root)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Error: failed to open file '%s'.\n", path);
+        return false;
+    }
+
+    std::vector<Namespace*> stack;
+    stack.push_back(root);
+    std::string declaration;
+    bool inComment = false;
+    bool result = true;
+    int lineNumber = 0;
+    char buffer[2048];
+    while (fgets(buffer, sizeof(buffer), file))
+    {
+        ++lineNumber;
+        std::string line = buffer;
+
+        // Strip comments.
+        if (inComment)
+        {
+            size_t end = line.find("*/");
+            if (end == std::string::npos)
+                continue;
+            line = line.substr(end + 2);
+            inComment = false;
+        }
+        size_t start;
+        while ((start = line.find("/*")) != std::string::npos)
+        {
+            size_t end = line.find("*/", start + 2);
+            if (end == std::string::npos)
+            {
+                line = line.substr(0, start);
+                inComment = true;
+                break;
+            }
+            line.erase(start, end + 2 - start);
+        }
+        size_t lineComment = line.find("//");
+        if (lineComment != std::string::npos)
+            line = line.substr(0, lineComment);
+        line = trim(line);
+        if (line.empty())
+            continue;
+
+        size_t equal = line.find('=');
+        size_t brace = line.find('{');
+        if (equal != std::string::npos && (brace == std::string::npos || equal < brace))
+        {
+            // Property.
+            stack.back()->properties.push_back(std::make_pair(trim(line.substr(0, equal)), trim(line.substr(equal + 1))));
+        }
+        else if (brace != std::string::npos)
+        {
+            // Opening of a namespace declared on this line or on the previous one.
+            std::string text = trim(line.substr(0, brace));
+            if (!text.empty())
+                declaration = text;
+            if (declaration.empty())
+            {
+                fprintf(stderr, "Error: unnamed namespace in '%s' line %d.\n", path, lineNumber);
+                result = false;
+                break;
+            }
+
+            Namespace* ns = new Namespace();
+            parseDeclaration(declaration, ns->type, ns->id, ns->parentId);
+            stack.back()->children.push_back(ns);
+            stack.push_back(ns);
+            declaration.clear();
+
+            if (trim(line.substr(brace + 1)) == "}")
+                stack.pop_back();
+        }
+        else if (line == "}")
+        {
+            if (stack.size() <= 1)
+            {
+                fprintf(stderr, "Error: unexpected '}' in '%s' line %d.\n", path, lineNumber);
+                result = false;
+                break;
+            }
+            stack.pop_back();
+        }
+        else
+        {
+            // Namespace declaration, its opening brace is on the next line.
+            declaration = line;
+        }
+    }
+    fclose(file);
+
+    if (result && stack.size() != 1)
+    {
+        fprintf(stderr, "Error: missing '}' at the end of '%s'.\n", path);
+        result = false;
+    }
+    return result;
+}
+
+MaterialParser::Namespace* MaterialParser::find(Namespace* ns, const std::string& id)
+{
+    for (size_t i = 0; i < ns->children.size(); ++i)
+    {
+        if (ns->children[i]->id == id)
+            return ns->children[i];
+        Namespace* child = find(ns->children[i], id);
+        if (child)
+            return child;
+    }
+    return NULL;
+}
+
+MaterialParser::Namespace* MaterialParser::resolve(Namespace* root, Namespace* ns, int depth)
+{
+    if (ns->parentId.empty())
+        return ns;
+
+    Namespace* parent = find(root, ns->parentId);
+    if (!parent || parent == ns || depth >= MAX_INHERITANCE_DEPTH || !resolve(root, parent, depth + 1))
+    {
+        fprintf(stderr, "Error: failed to resolve parent '%s' of namespace '%s'.\n", ns->parentId.c_str(), ns->id.c_str());
+        return NULL;
+    }
+
+    // The derived namespace is a copy of its parent overridden with its own content.
+    Namespace* derived = clone(parent);
+    derived->type = ns->type;
+    derived->id = ns->id;
+    merge(derived, ns);
+
+    std::swap(ns->properties, derived->properties);
+    std::swap(ns->children, derived->children);
+    ns->parentId.clear();
+    SAFE_DELETE(derived);
+    return ns;
+}
+
+void MaterialParser::merge(Namespace* dst, const Namespace* src)
+{
+    for (size_t i = 0; i < src->properties.size(); ++i)
+    {
+        const std::pair<std::string, std::string>& property = src->properties[i];
+        size_t j = 0;
+        while (j < dst->properties.size() && dst->properties[j].first != property.first)
+            ++j;
+        if (j < dst->properties.size())
+            dst->properties[j].second = property.second;
+        else
+            dst->properties.push_back(property);
+    }
+
+    for (size_t i = 0; i < src->children.size(); ++i)
+    {
+        const Namespace* child = src->children[i];
+        size_t j = 0;
+        while (j < dst->children.size() && (dst->children[j]->type != child->type || dst->children[j]->id != child->id))
+            ++j;
+        if (j < dst->children.size() && child->parentId.empty())
+            merge(dst->children[j], child);
+        else
+            dst->children.push_back(clone(child));
+    }
+}
+
+MaterialParser::Namespace* MaterialParser::clone(const Namespace* ns)
+{
+    Namespace* copy = new Namespace();
+    copy->type = ns->type;
+    copy->id = ns->id;
+    copy->parentId = ns->parentId;
+    copy->properties = ns->properties;
+    for (size_t i = 0; i < ns->children.size(); ++i)
+    {
+        copy->children.push_back(clone(ns->children[i]));
+    }
+    return copy;
+}
+
+}
@@ -0,0 +1,67 @@
+#ifndef SHADERPACK_MATERIALPARSER_H_
+#define SHADERPACK_MATERIALPARSER_H_
+
+#include "Base.h"
+
+namespace gplayshaderpack
+{
+
+/**
+ * A shader permutation: the vertex and fragment shaders of a pass and their defines.
+ */
+struct Permutation
+{
+    std::string vertexShader;
+    std::string fragmentShader;
+    std::string defines;
+};
+
+/**
+ * Reads the shader permutations used by the passes of .material files.
+ *
+ * The files are parsed with the syntax of the engine properties files, including
+ * the inheritance of namespaces ("material derived : base").
+ */
+class MaterialParser
+{
+public:
+
+    /**
+     * Parses a .material file and appends the permutations of its passes.
+     *
+     * @param path The path of the material file.
+     * @param permutations The list the permutations are appended to.
+     *
+     * @return true if the file was parsed, false otherwise.
+     */
+    static bool parse(const char* path, std::vector<Permutation>& permutations);
+
+private:
+
+    struct Namespace
+    {
+        ~Namespace();
+
+        const char* getProperty(const char* name) const;
+
+        std::string type;
+        std::string id;
+        std::string parentId;
+        std::vector<std::pair<std::string, std::string> > properties;
+        std::vector<Namespace*> children;
+    };
+
+    static bool read(const char* path, Namespace* root);
+
+    static Namespace* find(Namespace* ns, const std::string& id);
+
+    static Namespace* resolve(Namespace* root, Namespace* ns, int depth);
+
+    static void merge(Namespace* dst, const Namespace* src);
+
+    static Namespace* clone(const Namespace* ns);
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "ShaderArchive.h"
+
+// Must match the values of BGFXGpuProgram.cpp.
+#define SHADER_ARCHIVE_MAGIC "GPSA"
+#define SHADER_ARCHIVE_VERSION 1
+
+// Alignment of the compiled shaders in the archive.
+#define SHADER_ARCHIVE_ALIGNMENT 16
+
+namespace gplayshaderpack
+{
+
+static uint64_t hashData(const void* data, size_t size, uint64_t hash)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hashString(const std::string& str, uint64_t hash)
+{
+    return hashData(str.c_str(), str.size() + 1, hash);
+}
+
+static bool writeData(FILE* file, const void* data, size_t size)
+{
+    return size == 0 || fwrite(data, size, 1, file) == 1;
+}
+
+ShaderArchive::ShaderArchive(bgfx::RendererType::Enum rendererType)
+    : _rendererType(rendererType)
+{
+}
+
+bool ShaderArchive::add(shaderc::ShaderType type, const std::string& path, const std::string& defines, const void* data, uint32_t size)
+{
+    std::vector<unsigned char>& shader = _shaders[getKey(type, path, defines)];
+    if (!shader.empty())
+        return false;
+    shader.assign((const unsigned char*)data, (const unsigned char*)data + size);
+    return true;
+}
+
+bool ShaderArchive::contains(shaderc::ShaderType type, const std::string& path, const std::string& defines) const
+{
+    return _shaders.find(getKey(type, path, defines)) != _shaders.end();
+}
+
+unsigned int ShaderArchive::getShaderCount() const
+{
+    return (unsigned int)_shaders.size();
+}
+
+bool ShaderArchive::write(const char* path) const
+{
+    // Keep the table at most half full so that lookups probe few slots.
+    uint32_t tableSize = 16;
+    while (tableSize < _shaders.size() * 2)
+        tableSize *= 2;
+
+    const uint32_t header[] = { SHADER_ARCHIVE_VERSION, (uint32_t)_rendererType, tableSize, (uint32_t)_shaders.size(), 0, 0, 0 };
+    const uint32_t entrySize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    uint32_t offset = 4 + sizeof(header) + tableSize * entrySize;
+
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t offset;
+        uint32_t size;
+    };
+    std::vector<Entry> table(tableSize);
+    memset(&table[0], 0, tableSize * sizeof(Entry));
+    for (std::map<uint64_t, std::vector<unsigned char> >::const_iterator itr = _shaders.begin(); itr != _shaders.end(); ++itr)
+    {
+        uint32_t slot = (uint32_t)itr->first & (tableSize - 1);
+        while (table[slot].key != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        offset = (offset + SHADER_ARCHIVE_ALIGNMENT - 1) & ~(SHADER_ARCHIVE_ALIGNMENT - 1);
+        table[slot].key = itr->first;
+        table[slot].offset = offset;
+        table[slot].size = (uint32_t)itr->second.size();
+        offset += table[slot].size;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Error: failed to open file '%s' for writing.\n", path);
+        return false;
+    }
+
+    bool result = writeData(file, SHADER_ARCHIVE_MAGIC, 4) && writeData(file, header, sizeof(header));
+    for (uint32_t i = 0; result && i < tableSize; ++i)
+    {
+        result = writeData(file, &table[i].key, sizeof(table[i].key)) &&
+                 writeData(file, &table[i].offset, sizeof(table[i].offset)) &&
+                 writeData(file, &table[i].size, sizeof(table[i].size));
+    }
+
+    // Write the shaders in the order of their offsets, padding them to the alignment.
+    std::vector<const Entry*> entries;
+    for (uint32_t i = 0; i < tableSize; ++i)
+    {
+        if (table[i].key != 0)
+            entries.push_back(&table[i]);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->offset < b->offset; });
+
+    const unsigned char padding[SHADER_ARCHIVE_ALIGNMENT] = { 0 };
+    for (size_t i = 0; result && i < entries.size(); ++i)
+    {
+        long position = ftell(file);
+        result = writeData(file, padding, entries[i]->offset - position) &&
+                 writeData(file, &_shaders.find(entries[i]->key)->second[0], entries[i]->size);
+    }
+
+    fclose(file);
+    if (!result)
+    {
+        fprintf(stderr, "Error: failed to write file '%s'.\n", path);
+        remove(path);
+    }
+    return result;
+}
+
+std::string ShaderArchive::normalizeDefines(const std::string& defines)
+{
+    std::vector<std::string> tokens;
+    size_t start = 0;
+    while (start <= defines.size())
+    {
+        size_t end = defines.find(';', start);
+        if (end == std::string::npos)
+            end = defines.size();
+
+        size_t first = start;
+        size_t last = end;
+        while (first < last && isspace((unsigned char)defines[first]))
+            ++first;
+        while (last > first && isspace((unsigned char)defines[last - 1]))
+            --last;
+        if (first < last)
+            tokens.push_back(defines.substr(first, last - first));
+
+        start = end + 1;
+    }
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    std::string result;
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        if (i > 0)
+            result += ';';
+        result += tokens[i];
+    }
+    return result;
+}
+
+uint64_t ShaderArchive::getKey(shaderc::ShaderType type, const std::string& path, const std::string& defines)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const uint32_t stage = (uint32_t)type;
+    hash = hashData(&stage, sizeof(stage), hash);
+    hash = hashString(path, hash);
+    hash = hashString(normalizeDefines(defines), hash);
+    return hash != 0 ? hash : 1;
+}
+
+}
@@ -0,0 +1,76 @@
+#ifndef SHADERPACK_SHADERARCHIVE_H_
+#define SHADERPACK_SHADERARCHIVE_H_
+
+#include "Base.h"
+
+namespace gplayshaderpack
+{
+
+/**
+ * Writes the shader archives loaded by BGFXGpuProgram::loadShaderArchive().
+ *
+ * File layout (little endian):
+ * - header: "GPSA", version, renderer type, table size, entry count, 3 reserved words.
+ * - hash table: table size entries of { uint64 key, uint32 offset, uint32 size },
+ *   the table size is a power of two and a key of 0 marks an empty slot. Collisions
+ *   are resolved by linear probing from (key & (table size - 1)).
+ * - compiled shaders, aligned on 16 bytes.
+ *
+ * The key of a shader is the 64 bits FNV-1a hash of its stage ('v' or 'f' as a 32 bits
+ * integer), of its path and of its defines (trimmed, sorted, without duplicates and
+ * joined with ';'), each string hashed with its terminating null character.
+ */
+class ShaderArchive
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rendererType The renderer the shaders are compiled for.
+     */
+    ShaderArchive(bgfx::RendererType::Enum rendererType);
+
+    /**
+     * Adds a compiled shader. Returns false if the shader is already in the archive.
+     */
+    bool add(shaderc::ShaderType type, const std::string& path, const std::string& defines, const void* data, uint32_t size);
+
+    /**
+     * Determines if a shader is in the archive.
+     */
+    bool contains(shaderc::ShaderType type, const std::string& path, const std::string& defines) const;
+
+    /**
+     * Returns the number of shaders in the archive.
+     */
+    unsigned int getShaderCount() const;
+
+    /**
+     * Writes the archive.
+     *
+     * @param path The output file path.
+     *
+     * @return true if the archive was written, false otherwise.
+     */
+    bool write(const char* path) const;
+
+    /**
+     * Returns the defines in the canonical form used by the keys.
+     */
+    static std::string normalizeDefines(const std::string& defines);
+
+    /**
+     * Computes the key of a shader.
+     */
+    static uint64_t getKey(shaderc::ShaderType type, const std::string& path, const std::string& defines);
+
+private:
+
+    bgfx::RendererType::Enum _rendererType;
+    std::map<uint64_t, std::vector<unsigned char> > _shaders;
+};
+
+}
+
+#endif
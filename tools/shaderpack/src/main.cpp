@@ -0,0 +1,341 @@
+#include "Base.h"
+#include "MaterialParser.h"
+#include "ShaderArchive.h"
+
+using namespace gplayshaderpack;
+
+#define DEFAULT_SHADER_DIRECTORY "res/core/shaders"
+#define DEFAULT_VARYING_FILE "res/core/shaders/varying.def.sc"
+
+/**
+ * Target of the shader compilation.
+ */
+struct Target
+{
+    const char* name;
+    bgfx::RendererType::Enum rendererType;
+    const char* platform;
+    const char* vertexProfile;
+    const char* fragmentProfile;
+};
+
+static const Target __targets[] =
+{
+    { "d3d9",   bgfx::RendererType::Direct3D9,  "windows", "vs_3_0", "ps_3_0" },
+    { "d3d11",  bgfx::RendererType::Direct3D11, "windows", "vs_4_0", "ps_4_0" },
+    { "d3d12",  bgfx::RendererType::Direct3D12, "windows", "vs_5_0", "ps_5_0" },
+    { "metal",  bgfx::RendererType::Metal,      "osx",     "metal",  "metal" },
+    { "gl",     bgfx::RendererType::OpenGL,     "linux",   "120",    "120" },
+    { "gles",   bgfx::RendererType::OpenGLES,   "android", NULL,     NULL },
+    { "vulkan", bgfx::RendererType::Vulkan,     "linux",   "spirv",  "spirv" },
+};
+
+static void printUsage()
+{
+    fprintf(stderr,
+        "Usage: gplay-shaderpack [options] <output file> <file(s) or directory(s)>\n"
+        "\n"
+        "Compiles the shader permutations used by .material files into a shader archive.\n"
+        "Directories are scanned recursively for .material files. Run the tool from the\n"
+        "game directory, so that shader paths are the ones used at runtime.\n"
+        "\n"
+        "Options:\n"
+        "  -r <renderer>\tTarget renderer: d3d9, d3d11, d3d12, metal, gl, gles or vulkan. (default: gl)\n"
+        "  -s <dir>\tShader directory, each <name>.vert and <name>.frag pair it contains\n"
+        "\t\tis added without defines. (default: " DEFAULT_SHADER_DIRECTORY ")\n"
+        "  -l <file>\tPermutation list, each line is \"<vertex shader> <fragment shader> [defines]\",\n"
+        "\t\tfor effects created from code or with pass callback defines.\n"
+        "\t\tThe engine warns with lines in this format for the missing permutations.\n"
+        "  -v\t\tVerbose output.\n"
+        "\n");
+}
+
+static bool hasExtension(const std::string& path, const char* extension)
+{
+    size_t length = strlen(extension);
+    return path.size() > length && path.compare(path.size() - length, length, extension) == 0;
+}
+
+static bool isDirectory(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR) != 0;
+}
+
+static bool fileExists(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+}
+
+/**
+ * Lists the files of a directory, recursively or not.
+ */
+static void listFiles(const std::string& directory, bool recursive, std::vector<std::string>& files)
+{
+    std::vector<std::string> names;
+#if defined(WIN32)
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((directory + "/*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        names.push_back(data.cFileName);
+    }
+    while (FindNextFileA(handle, &data));
+    FindClose(handle);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        return;
+    while (struct dirent* entry = readdir(dir))
+    {
+        names.push_back(entry->d_name);
+    }
+    closedir(dir);
+#endif
+
+    // Sort the names so that the archive does not depend on the directory order.
+    std::sort(names.begin(), names.end());
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i] == "." || names[i] == "..")
+            continue;
+        std::string path = directory + "/" + names[i];
+        if (isDirectory(path))
+        {
+            if (recursive)
+                listFiles(path, true, files);
+        }
+        else
+        {
+            files.push_back(path);
+        }
+    }
+}
+
+/**
+ * Reads a permutation list, returns false if the file can't be read.
+ */
+static bool readPermutationList(const char* path, std::vector<Permutation>& permutations)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Error: failed to open file '%s'.\n", path);
+        return false;
+    }
+
+    char line[2048];
+    char vertexShader[1024];
+    char fragmentShader[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        int length = 0;
+        if (line[0] == '#' || sscanf(line, "%1023s %1023s %n", vertexShader, fragmentShader, &length) < 2)
+            continue;
+
+        Permutation permutation;
+        permutation.vertexShader = vertexShader;
+        permutation.fragmentShader = fragmentShader;
+        permutation.defines = line + length;
+        permutations.push_back(permutation);
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * Returns the varying definitions used by the shaders of a permutation, like BGFXGpuProgram does.
+ */
+static std::string getVaryingFile(const std::string& vertexShader)
+{
+    std::string varyingFile = vertexShader.substr(0, vertexShader.find_last_of('.')) + ".io";
+    return fileExists(varyingFile) ? varyingFile : DEFAULT_VARYING_FILE;
+}
+
+/**
+ * Compiles a shader and adds it to the archive, unless it is already there.
+ */
+static bool compileShader(ShaderArchive& archive, const Target& target, shaderc::ShaderType type, const std::string& path, const std::string& defines,
+                          const std::string& varyingFile, bool verbose)
+{
+    const std::string normalizedDefines = ShaderArchive::normalizeDefines(defines);
+    if (archive.contains(type, path, normalizedDefines))
+        return true;
+
+    if (verbose)
+        fprintf(stderr, "Compiling %s [%s]\n", path.c_str(), normalizedDefines.c_str());
+
+    const char* profile = type == shaderc::ST_VERTEX ? target.vertexProfile : target.fragmentProfile;
+    const char* typeName = type == shaderc::ST_VERTEX ? "vertex" : "fragment";
+
+    std::vector<const char*> args;
+    args.push_back("shaderc");
+    args.push_back("-f");
+    args.push_back(path.c_str());
+    args.push_back("--type");
+    args.push_back(typeName);
+    args.push_back("--platform");
+    args.push_back(target.platform);
+    args.push_back("--varyingdef");
+    args.push_back(varyingFile.c_str());
+    if (profile)
+    {
+        args.push_back("-p");
+        args.push_back(profile);
+    }
+    if (!normalizedDefines.empty())
+    {
+        args.push_back("--define");
+        args.push_back(normalizedDefines.c_str());
+    }
+
+    const bgfx::Memory* mem = shaderc::compileShader((int)args.size(), &args[0]);
+    if (!mem)
+    {
+        fprintf(stderr, "Error: failed to compile %s shader '%s' with defines [%s].\n", typeName, path.c_str(), normalizedDefines.c_str());
+        return false;
+    }
+    // The memory is not given back to bgfx, the tool exits once the archive is written.
+    archive.add(type, path, normalizedDefines, mem->data, mem->size);
+    return true;
+}
+
+/**
+ * Main application entry point.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The array of command line parameters.
+ */
+int main(int argc, const char** argv)
+{
+    const Target* target = &__targets[4];
+    std::string shaderDirectory = DEFAULT_SHADER_DIRECTORY;
+    std::vector<const char*> permutationLists;
+    std::vector<const char*> inputs;
+    const char* output = NULL;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-r") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            target = NULL;
+            for (size_t j = 0; j < sizeof(__targets) / sizeof(__targets[0]); ++j)
+            {
+                if (strcmp(__targets[j].name, name) == 0)
+                    target = &__targets[j];
+            }
+            if (!target)
+            {
+                fprintf(stderr, "Error: unknown renderer '%s'.\n", name);
+                printUsage();
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "-s") == 0 && i + 1 < argc)
+        {
+            shaderDirectory = argv[++i];
+        }
+        else if (strcmp(arg, "-l") == 0 && i + 1 < argc)
+        {
+            permutationLists.push_back(argv[++i]);
+        }
+        else if (strcmp(arg, "-v") == 0)
+        {
+            verbose = true;
+        }
+        else if (arg[0] == '-')
+        {
+            fprintf(stderr, "Error: unknown option '%s'.\n", arg);
+            printUsage();
+            return -1;
+        }
+        else if (!output)
+        {
+            output = arg;
+        }
+        else
+        {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (!output)
+    {
+        printUsage();
+        return -1;
+    }
+
+    // Collect the permutations.
+    std::vector<Permutation> permutations;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::vector<std::string> files;
+        if (isDirectory(inputs[i]))
+            listFiles(inputs[i], true, files);
+        else
+            files.push_back(inputs[i]);
+
+        for (size_t j = 0; j < files.size(); ++j)
+        {
+            if (hasExtension(files[j], ".material") && !MaterialParser::parse(files[j].c_str(), permutations))
+                return -1;
+        }
+    }
+
+    if (!shaderDirectory.empty())
+    {
+        std::vector<std::string> files;
+        listFiles(shaderDirectory, false, files);
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            if (!hasExtension(files[i], ".vert"))
+                continue;
+            std::string fragmentShader = files[i].substr(0, files[i].size() - 5) + ".frag";
+            if (fileExists(fragmentShader))
+            {
+                Permutation permutation;
+                permutation.vertexShader = files[i];
+                permutation.fragmentShader = fragmentShader;
+                permutations.push_back(permutation);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < permutationLists.size(); ++i)
+    {
+        if (!readPermutationList(permutationLists[i], permutations))
+            return -1;
+    }
+
+    // The shader compiler allocates its results with bgfx.
+    bgfx::Init init;
+    init.type = bgfx::RendererType::Noop;
+    if (!bgfx::init(init))
+    {
+        fprintf(stderr, "Error: failed to initialize bgfx.\n");
+        return -1;
+    }
+
+    ShaderArchive archive(target->rendererType);
+    bool result = true;
+    for (size_t i = 0; result && i < permutations.size(); ++i)
+    {
+        const Permutation& permutation = permutations[i];
+        const std::string varyingFile = getVaryingFile(permutation.vertexShader);
+        result = compileShader(archive, *target, shaderc::ST_VERTEX, permutation.vertexShader, permutation.defines, varyingFile, verbose) &&
+                 compileShader(archive, *target, shaderc::ST_FRAGMENT, permutation.fragmentShader, permutation.defines, varyingFile, verbose);
+    }
+    bgfx::shutdown();
+
+    if (!result || !archive.write(output))
+        return -1;
+
+    fprintf(stderr, "%u shaders from %u permutations written to '%s'.\n", archive.getShaderCount(), (unsigned int)permutations.size(), output);
+    return 0;
+}